@@ -0,0 +1,41 @@
+#ifndef __DATAPROPERTYCACHE_H
+#define __DATAPROPERTYCACHE_H
+
+#include <mitkBaseData.h>
+#include <mitkSmartPointerProperty.h>
+
+namespace lancetAlgorithm
+{
+	/**
+	*Return the cache object of type TCache stored as a SmartPointerProperty named propertyName
+	*on data, or build, attach and return a new one.
+	*
+	* @param data [Input]The data the cache is derived from and stored on.
+	* @param propertyName [Input]Name of the property holding the cache.
+	* @param isValid [Input]bool(const TCache&), true if the stored cache is still up to date.
+	* @param build [Input]void(TCache&), fills a new cache; it is attached to data afterwards.
+	*
+	* The returned pointer is never null.
+	*/
+	template <typename TCache, typename TIsValid, typename TBuild>
+	typename TCache::Pointer GetOrCreateDataPropertyCache(const mitk::BaseData* data, const char* propertyName,
+		TIsValid isValid, TBuild build)
+	{
+		auto property = dynamic_cast<mitk::SmartPointerProperty*>(data->GetProperty(propertyName).GetPointer());
+		if (property != nullptr)
+		{
+			typename TCache::Pointer cache = dynamic_cast<TCache*>(property->GetSmartPointer().GetPointer());
+			if (cache.IsNotNull() && isValid(*cache))
+			{
+				return cache;
+			}
+		}
+
+		typename TCache::Pointer cache = TCache::New();
+		build(*cache);
+		data->GetPropertyList()->SetProperty(propertyName, mitk::SmartPointerProperty::New(cache.GetPointer()));
+		return cache;
+	}
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef __PARALLELFORBLOCKS_H
+#define __PARALLELFORBLOCKS_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace lancetAlgorithm
+{
+	/**
+	*Number of worker threads: requested, or std::thread::hardware_concurrency() if requested is 0.
+	*/
+	inline unsigned int ResolveThreadCount(unsigned int requested)
+	{
+		return requested > 0 ? requested : std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	/**
+	*Number of threads for count items in blocks of blockSize: ResolveThreadCount(requested),
+	*but never more threads than blocks and at least one.
+	*/
+	inline unsigned int ThreadCountForBlocks(unsigned int requested, size_t count, size_t blockSize)
+	{
+		const size_t numberOfBlocks = (count + blockSize - 1) / std::max<size_t>(blockSize, 1);
+		return static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(ResolveThreadCount(requested), numberOfBlocks)));
+	}
+
+	/**
+	*Run body(begin, end) on the blocks of [0, count), blockSize items each, handed out to the
+	*threads through an atomic block counter. The calling thread is one of the workers.
+	*
+	* @param numberOfThreads [Input]0 uses all hardware threads; limited by ThreadCountForBlocks.
+	*/
+	template <typename Body>
+	void ParallelForBlocks(size_t count, unsigned int numberOfThreads, size_t blockSize, Body body)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+		blockSize = std::max<size_t>(blockSize, 1);
+		numberOfThreads = ThreadCountForBlocks(numberOfThreads, count, blockSize);
+		if (numberOfThreads <= 1)
+		{
+			body(size_t(0), count);
+			return;
+		}
+
+		std::atomic<size_t> nextBlock{ 0 };
+		auto worker = [&]() {
+			for (size_t begin = blockSize * nextBlock++; begin < count; begin = blockSize * nextBlock++)
+			{
+				body(begin, std::min(count, begin + blockSize));
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(numberOfThreads - 1);
+		for (unsigned int i = 1; i < numberOfThreads; ++i)
+		{
+			threads.emplace_back(worker);
+		}
+		worker();
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	}
+}
+
+#endif
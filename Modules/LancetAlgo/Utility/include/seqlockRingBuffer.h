@@ -0,0 +1,176 @@
+#ifndef __SEQLOCKRINGBUFFER_H
+#define __SEQLOCKRINGBUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <memory>
+#include <vector>
+
+namespace lancetAlgorithm
+{
+	/**
+	*Lock-free single producer / multiple consumer ring buffer of timestamped samples.
+	*
+	*The acquisition thread pushes every sample, readers on any thread copy the newest sample
+	*or all samples of a time window without ever blocking the producer. Every slot is guarded
+	*by a sequence number (odd while being written); a reader copies the slot and keeps the copy
+	*only if the sequence did not change meanwhile. Samples older than the capacity are overwritten.
+	*
+	*T must be trivially copyable and have a long long timestamp, increasing with every Push().
+	*/
+	template <typename T>
+	class SeqlockRingBuffer
+	{
+	public:
+		/**
+		*@param capacity [Input]rounded up to a power of two.
+		*/
+		explicit SeqlockRingBuffer(size_t capacity)
+		{
+			size_t slots = 1;
+			while (slots < capacity)
+			{
+				slots <<= 1;
+			}
+			m_Slots.reset(new Slot[slots]);
+			m_Mask = slots - 1;
+		}
+
+		/**
+		*Steady clock in microseconds, the clock of the timestamps.
+		*/
+		static long long Now()
+		{
+			return std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		/**
+		*Drop all samples, only while there is no producer.
+		*/
+		void Clear()
+		{
+			for (size_t i = 0; i <= m_Mask; ++i)
+			{
+				m_Slots[i].sequence.store(0, std::memory_order_relaxed);
+			}
+			m_Head.store(0, std::memory_order_release);
+		}
+
+		/**
+		*Producer side, a single thread only.
+		*/
+		void Push(const T& sample)
+		{
+			const unsigned long long index = m_Head.load(std::memory_order_relaxed);
+			Slot& slot = m_Slots[index & m_Mask];
+			slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			slot.sample = sample;
+			slot.sequence.store(2 * index + 2, std::memory_order_release);
+			m_Head.store(index + 1, std::memory_order_release);
+		}
+
+		/**
+		*Newest sample. False if the buffer holds none.
+		*/
+		bool GetLatest(T& sample) const
+		{
+			for (;;)
+			{
+				const unsigned long long head = m_Head.load(std::memory_order_acquire);
+				if (head == 0)
+				{
+					return false;
+				}
+				// only fails if the producer lapped the slot meanwhile, then the next head is newer
+				if (Read(head - 1, sample))
+				{
+					return true;
+				}
+			}
+		}
+
+		/**
+		*Newest sample for which predicate(sample) is true. False if the buffer holds none.
+		*/
+		template <typename Predicate>
+		bool FindLatest(Predicate predicate, T& sample) const
+		{
+			const unsigned long long head = m_Head.load(std::memory_order_acquire);
+			for (unsigned long long index = head; index-- > 0 && head - index <= m_Mask + 1;)
+			{
+				T candidate;
+				if (!Read(index, candidate))
+				{
+					return false; // overwritten, so is everything older
+				}
+				if (predicate(candidate))
+				{
+					sample = candidate;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/**
+		*Appends all samples with begin <= timestamp < end, oldest first, and returns their number.
+		*/
+		size_t GetWindow(long long begin, long long end, std::vector<T>& samples) const
+		{
+			const size_t first = samples.size();
+			const unsigned long long head = m_Head.load(std::memory_order_acquire);
+			for (unsigned long long index = head; index-- > 0 && head - index <= m_Mask + 1;)
+			{
+				T sample;
+				if (!Read(index, sample) || sample.timestamp < begin)
+				{
+					break;
+				}
+				if (sample.timestamp < end)
+				{
+					samples.push_back(sample);
+				}
+			}
+			std::reverse(samples.begin() + first, samples.end());
+			return samples.size() - first;
+		}
+
+		/**
+		*Appends all samples newer than timestamp, oldest first, and returns their number.
+		*/
+		size_t GetSince(long long timestamp, std::vector<T>& samples) const
+		{
+			return GetWindow(timestamp + 1, LLONG_MAX, samples);
+		}
+
+	private:
+		struct Slot
+		{
+			std::atomic<unsigned long long> sequence{ 0 };
+			T sample;
+		};
+
+		bool Read(unsigned long long index, T& sample) const
+		{
+			const Slot& slot = m_Slots[index & m_Mask];
+			const unsigned long long sequence = slot.sequence.load(std::memory_order_acquire);
+			if (sequence != 2 * index + 2)
+			{
+				return false;
+			}
+			sample = slot.sample;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return slot.sequence.load(std::memory_order_relaxed) == sequence;
+		}
+
+		std::unique_ptr<Slot[]> m_Slots;
+		size_t m_Mask{ 0 };
+		std::atomic<unsigned long long> m_Head{ 0 };
+	};
+}
+
+#endif
@@ -5,6 +5,9 @@ set(H_FILES
   Physiology/include/physioModels.h
   Geometry/include/basic.h
   Geometry/include/leastsquaresfit.h
+  Utility/include/dataPropertyCache.h
+  Utility/include/parallelForBlocks.h
+  Utility/include/seqlockRingBuffer.h
 )
 set(CPP_FILES
   Physiology/src/physioModelFactory.cpp
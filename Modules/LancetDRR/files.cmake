@@ -1,9 +1,17 @@
 set(H_FILES
   include/drr.h
+  include/drrRayCaster.h
+  include/drrVolume.h
+  include/drrBatch.h
+  include/drrVolumeCache.h
 )
 
 set(CPP_FILES
   drr.cpp
+  drrRayCaster.cpp
+  drrBatch.cpp
+  drrVolume.cpp
+  drrVolumeCache.cpp
 )
 
 
@@ -3,6 +3,8 @@
 #include "mitkImage.h"
 #include "MitkLancetDRRExports.h"
 #include "mitkImageToImageFilter.h"
+#include "drrRayCaster.h"
+#include "drrVolumeCache.h"
 mitk::Image::Pointer MITKLANCETDRR_EXPORT DRR(mitk::Image::Pointer input);
 
 class MITKLANCETDRR_EXPORT DrrFilter:public mitk::ImageToImageFilter
@@ -45,6 +47,10 @@ public:
 	\brief easy way to set obj rotate at once
 	*/
 	void SetObjRotate(double rx, double ry, double rz);
+	/*!
+	\brief current setters gathered into the geometry used by DrrRayCaster
+	*/
+	DrrGeometry GetGeometryParameters() const;
 
 protected:
 	/*!
@@ -67,7 +73,7 @@ protected:
 	void GenerateData() override;
 
 	/*!
-	\brief Internal templated method calling the ITK drr filter. Here the actual filtering is performed.
+	\brief Internal templated method running DrrRayCaster on the input buffer. Here the actual filtering is performed.
 	*/
 	template <typename TPixel, unsigned int VDimension>
 	void ItkImageProcessing(const itk::Image<TPixel, VDimension>* itkImage);
@@ -107,6 +113,8 @@ private:
 
 	//double m_direction;
 	bool m_verbose { true };
+
+	DrrVolumeCache::Pointer m_VolumeCache;
 };
 
 
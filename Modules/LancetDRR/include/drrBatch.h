@@ -0,0 +1,104 @@
+#ifndef DRRBATCH_H
+#define DRRBATCH_H
+#include "MitkLancetDRRExports.h"
+#include "drrRayCaster.h"
+#include "drrVolumeCache.h"
+#include "mitkImage.h"
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+
+/*!
+\brief object pose of one DRR of a batch (degrees / mm, same as DrrFilter::SetObjRotate / SetObjTranslate)
+*/
+struct MITKLANCETDRR_EXPORT DrrPose
+{
+	double rx{ 270.0 };
+	double ry{ 0.0 };
+	double rz{ 0.0 };
+	double tx{ 0.0 };
+	double ty{ 0.0 };
+	double tz{ 0.0 };
+};
+
+/*!
+\brief Generate DRRs of many object poses from one preprocessed CT volume.
+
+The CT is preprocessed once per input / threshold / attenuation setting (see DrrVolume,
+kept in a DrrVolumeCache) and reused by every call of GenerateDrrs(); the poses of one call are rendered in parallel,
+one pose per worker. All the other C-arm parameters are taken from the base geometry.
+*/
+class MITKLANCETDRR_EXPORT DrrBatchGenerator : public itk::Object
+{
+public:
+	mitkClassMacroItkParent(DrrBatchGenerator, itk::Object);
+	itkNewMacro(Self);
+
+	/*!
+	\brief set the CT, 3D images only
+	*/
+	void SetInput(mitk::Image::Pointer image);
+
+	/*!
+	\brief C-arm parameters shared by all poses, the pose fields (rx..tz) are overwritten per pose
+	*/
+	void SetBaseGeometry(const DrrGeometry& geometry);
+	const DrrGeometry& GetBaseGeometry() const { return m_BaseGeometry; }
+
+	itkSetMacro(ConvertToAttenuation, bool);
+	itkGetMacro(ConvertToAttenuation, bool);
+	itkSetMacro(MuWater, double);
+	itkGetMacro(MuWater, double);
+	itkSetMacro(NumberOfThreads, unsigned int);
+	itkGetMacro(NumberOfThreads, unsigned int);
+	itkSetMacro(verbose, bool);
+
+	/*!
+	\brief crop / convert the CT now; otherwise done by the first GenerateDrrs() call
+	\return false if there is no valid 3D input
+	*/
+	bool Preprocess();
+
+	/*!
+	\brief render one DRR per pose
+	\return float image of dx * dy * poses.size(), slice i is the DRR of poses[i]; nullptr without input
+	*/
+	mitk::Image::Pointer GenerateDrrs(const std::vector<DrrPose>& poses);
+
+	/*!
+	\brief timing of the last GenerateDrrs() call: milliseconds spent rendering each pose
+	*/
+	const std::vector<double>& GetPoseTimes() const { return m_PoseTimes; }
+	/*!
+	\brief timing of the last GenerateDrrs() call: wall clock milliseconds of the whole batch
+	*/
+	itkGetMacro(BatchTime, double);
+	/*!
+	\brief milliseconds spent in the last preprocessing of the CT
+	*/
+	itkGetMacro(PreprocessTime, double);
+
+	/*!
+	\brief preprocessed volume, empty before Preprocess()
+	*/
+	const DrrVolume& GetVolume() const;
+
+protected:
+	DrrBatchGenerator();
+	~DrrBatchGenerator() override;
+
+private:
+	mitk::Image::Pointer m_Input;
+	DrrGeometry m_BaseGeometry;
+	DrrVolumeCache::Pointer m_VolumeCache;
+
+	bool m_ConvertToAttenuation{ false };
+	double m_MuWater{ 0.02 };
+	unsigned int m_NumberOfThreads{ 0 };
+
+	std::vector<double> m_PoseTimes;
+	double m_BatchTime{ 0.0 };
+	double m_PreprocessTime{ 0.0 };
+	bool m_verbose{ false };
+};
+
+#endif // DRRBATCH_H
@@ -0,0 +1,119 @@
+#ifndef DRRRAYCASTER_H
+#define DRRRAYCASTER_H
+#include "MitkLancetDRRExports.h"
+#include "drrVolume.h"
+
+#include <vector>
+
+/*!
+\brief C-arm geometry of one DRR, same meaning as the DrrFilter setters
+(angles in degrees, lengths in mm).
+*/
+struct MITKLANCETDRR_EXPORT DrrGeometry
+{
+	//obj rotation / translation / center
+	double rx{ 270.0 };
+	double ry{ 0.0 };
+	double rz{ 0.0 };
+	double tx{ 0.0 };
+	double ty{ 0.0 };
+	double tz{ 0.0 };
+	double cx{ 0.0 };
+	double cy{ 0.0 };
+	double cz{ 0.0 };
+
+	//drr para
+	double threshold{ 0.0 };
+	double sid{ 400 };
+	double sx{ 0.75 };
+	double sy{ 0.75 };
+	int dx{ 512 };
+	int dy{ 512 };
+	double o2Dx{ 0.0 };
+	double o2Dy{ 0.0 };
+};
+
+/*!
+\brief Multithreaded ray-marching DRR engine.
+
+Produces the same projection as itk::ResampleImageFilter driven by
+itk::RayCastInterpolateImageFunction (the former DrrFilter path): rays go from
+every detector pixel to the focal point, both moved by the centered ZYX Euler
+transform, and the volume is sampled on every voxel plane crossed along the
+dominant ray axis with bilinear interpolation in that plane. Values above the
+threshold are integrated and scaled by the step length in mm. Like the ITK
+interpolator, only origin and spacing of the volume are taken into account.
+
+The geometry of the source/detector is precomputed once per Render() call;
+rays are marched incrementally over the raw voxel buffer in packets of
+neighbouring detector pixels and detector rows are split across threads.
+With a DrrVolume, bricks below the threshold are skipped (empty-space skipping).
+*/
+class MITKLANCETDRR_EXPORT DrrRayCaster
+{
+public:
+	DrrRayCaster();
+	~DrrRayCaster();
+
+	/*!
+	\brief set the volume to project. The buffer is referenced, not copied, and must stay
+	alive while rendering. x runs fastest in memory.
+	*/
+	void SetVolume(const float* buffer, const unsigned int size[3], const double spacing[3], const double origin[3]);
+	/*!
+	\brief set a preprocessed (cropped) volume. The volume is referenced, not copied. The
+	threshold of DrrGeometry is ignored in favour of DrrVolume::GetThreshold().
+	*/
+	void SetVolume(const DrrVolume& volume);
+
+	/*!
+	\brief number of worker threads, 0 means std::thread::hardware_concurrency()
+	*/
+	void SetNumberOfThreads(unsigned int n) { m_NumberOfThreads = n; }
+	unsigned int GetNumberOfThreads() const;
+
+	/*!
+	\brief origin of the output DRR image, as set on the ITK resampler before
+	*/
+	void GetOutputOrigin(const DrrGeometry& geometry, double origin[3]) const;
+
+	/*!
+	\brief render one DRR into output (geometry.dx * geometry.dy floats, x fastest)
+	*/
+	void Render(const DrrGeometry& geometry, float* output) const;
+
+	/*!
+	\brief geometry of the projection shared by all rays of one Render() call
+	*/
+	struct RayGeometry
+	{
+		double focal[3];      // transformed focal point in continuous index space
+		double pixel0[3];     // transformed detector pixel (0,0) in continuous index space
+		double pixelStepX[3]; // detector step along x in continuous index space
+		double pixelStepY[3]; // detector step along y in continuous index space
+		float threshold;
+	};
+
+protected:
+	RayGeometry ComputeRayGeometry(const DrrGeometry& geometry) const;
+	void RenderRows(const RayGeometry& rayGeometry, int dx, int rowBegin, int rowEnd, float* output) const;
+	float CastRay(const RayGeometry& rayGeometry, const double pixel[3]) const;
+	/*!
+	\brief next plane to sample if the brick of (plane, iu, iv) is empty, plane otherwise
+	*/
+	int SkipEmptyBrick(int k, int plane, int iu, int iv, double u0, double du, double v0, double dv) const;
+
+	const float* m_Buffer{ nullptr };
+	int m_Size[3]{ 0, 0, 0 };
+	int m_Offset[3]{ 0, 0, 0 };
+	int m_FullSize[3]{ 0, 0, 0 };
+	const unsigned char* m_EmptyBricks{ nullptr };
+	long long m_BrickStride[3]{ 0, 0, 0 };
+	bool m_UseVolumeThreshold{ false };
+	double m_VolumeThreshold{ 0.0 };
+	double m_Spacing[3]{ 1.0, 1.0, 1.0 };
+	double m_Origin[3]{ 0.0, 0.0, 0.0 };
+	unsigned int m_NumberOfThreads{ 0 };
+};
+
+#endif // DRRRAYCASTER_H
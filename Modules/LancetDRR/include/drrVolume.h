@@ -0,0 +1,153 @@
+#ifndef DRRVOLUME_H
+#define DRRVOLUME_H
+#include "MitkLancetDRRExports.h"
+
+#include <algorithm>
+#include <vector>
+
+/*!
+\brief CT volume preprocessed once for DRR rendering.
+
+Only the bounding box of the voxels above the threshold (grown by one voxel, so
+that bilinear samples at its border are unchanged) is kept as a float buffer;
+everything outside of it can never contribute to a ray integral. Optionally the
+intensities are converted from HU to linear attenuation
+mu = muWater * (1 + HU / 1000); the threshold is converted the same way, so
+the rays still integrate the same tissue.
+
+The reference of the C-arm geometry stays the full volume (GetFullSize()),
+so a DRR of a DrrVolume is the same as a DRR of the original image.
+
+A coarse grid of BrickSize^3 bricks keeps the min/max intensity of every brick,
+including the first voxel layer of the following bricks, since a bilinear sample
+reads voxel i and i + 1. A brick whose max is not above the threshold is empty:
+no sample inside it can contribute, so DrrRayCaster skips it.
+*/
+class MITKLANCETDRR_EXPORT DrrVolume
+{
+public:
+	static constexpr unsigned int BrickSize = 8;
+
+	/*!
+	\brief crop and convert the volume; x runs fastest in buffer
+	*/
+	template <typename TPixel>
+	void Initialize(const TPixel* buffer, const unsigned int size[3], const double spacing[3], const double origin[3],
+		double threshold, bool convertToAttenuation = false, double muWater = 0.02);
+
+	const float* GetBuffer() const { return m_Buffer.empty() ? nullptr : m_Buffer.data(); }
+	const unsigned int* GetSize() const { return m_Size; }
+	const unsigned int* GetOffset() const { return m_Offset; }
+	const unsigned int* GetFullSize() const { return m_FullSize; }
+	const double* GetSpacing() const { return m_Spacing; }
+	const double* GetOrigin() const { return m_Origin; }
+	/*!
+	\brief threshold in the unit of the stored intensities
+	*/
+	double GetThreshold() const { return m_Threshold; }
+	bool IsEmpty() const { return m_Buffer.empty(); }
+
+	const unsigned int* GetBrickCount() const { return m_BrickCount; }
+	/*!
+	\brief one flag per brick (x fastest), nonzero if the brick has no voxel above the threshold
+	*/
+	const unsigned char* GetEmptyBricks() const { return m_EmptyBricks.empty() ? nullptr : m_EmptyBricks.data(); }
+	void GetBrickMinMax(unsigned int bx, unsigned int by, unsigned int bz, float& min, float& max) const;
+	/*!
+	\brief fraction of the bricks that are skipped while ray casting
+	*/
+	double GetEmptyBrickRatio() const;
+
+private:
+	void BuildBrickGrid();
+
+	std::vector<float> m_Buffer;
+	unsigned int m_Size[3]{ 0, 0, 0 };
+	unsigned int m_Offset[3]{ 0, 0, 0 };
+	unsigned int m_FullSize[3]{ 0, 0, 0 };
+	double m_Spacing[3]{ 1.0, 1.0, 1.0 };
+	double m_Origin[3]{ 0.0, 0.0, 0.0 };
+	double m_Threshold{ 0.0 };
+
+	unsigned int m_BrickCount[3]{ 0, 0, 0 };
+	std::vector<float> m_BrickMin;
+	std::vector<float> m_BrickMax;
+	std::vector<unsigned char> m_EmptyBricks;
+};
+
+template <typename TPixel>
+void DrrVolume::Initialize(const TPixel* buffer, const unsigned int size[3], const double spacing[3],
+	const double origin[3], double threshold, bool convertToAttenuation, double muWater)
+{
+	m_Buffer.clear();
+	m_BrickMin.clear();
+	m_BrickMax.clear();
+	m_EmptyBricks.clear();
+	for (int i = 0; i < 3; ++i)
+	{
+		m_FullSize[i] = size[i];
+		m_Spacing[i] = spacing[i];
+		m_Origin[i] = origin[i];
+		m_Size[i] = 0;
+		m_Offset[i] = 0;
+		m_BrickCount[i] = 0;
+	}
+
+	const double scale = convertToAttenuation ? muWater / 1000.0 : 1.0;
+	const double shift = convertToAttenuation ? muWater : 0.0;
+	m_Threshold = threshold * scale + shift;
+
+	// bounding box of the threshold mask
+	unsigned int lower[3] = { size[0], size[1], size[2] };
+	unsigned int upper[3] = { 0, 0, 0 };
+	bool found = false;
+	const TPixel* voxel = buffer;
+	for (unsigned int z = 0; z < size[2]; ++z)
+	{
+		for (unsigned int y = 0; y < size[1]; ++y)
+		{
+			for (unsigned int x = 0; x < size[0]; ++x, ++voxel)
+			{
+				if (static_cast<double>(*voxel) > threshold)
+				{
+					found = true;
+					lower[0] = std::min(lower[0], x);
+					upper[0] = std::max(upper[0], x);
+					lower[1] = std::min(lower[1], y);
+					upper[1] = std::max(upper[1], y);
+					lower[2] = std::min(lower[2], z);
+					upper[2] = std::max(upper[2], z);
+				}
+			}
+		}
+	}
+	if (!found)
+	{
+		return;
+	}
+
+	for (int i = 0; i < 3; ++i)
+	{
+		m_Offset[i] = lower[i] > 0 ? lower[i] - 1 : 0;
+		m_Size[i] = std::min(upper[i] + 2, size[i]) - m_Offset[i];
+	}
+
+	m_Buffer.resize(static_cast<size_t>(m_Size[0]) * m_Size[1] * m_Size[2]);
+	float* out = m_Buffer.data();
+	for (unsigned int z = 0; z < m_Size[2]; ++z)
+	{
+		for (unsigned int y = 0; y < m_Size[1]; ++y)
+		{
+			const TPixel* row = buffer
+				+ (static_cast<size_t>(z + m_Offset[2]) * size[1] + (y + m_Offset[1])) * size[0] + m_Offset[0];
+			for (unsigned int x = 0; x < m_Size[0]; ++x)
+			{
+				*out++ = static_cast<float>(static_cast<double>(row[x]) * scale + shift);
+			}
+		}
+	}
+
+	this->BuildBrickGrid();
+}
+
+#endif // DRRVOLUME_H
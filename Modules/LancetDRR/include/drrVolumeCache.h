@@ -0,0 +1,110 @@
+#ifndef DRRVOLUMECACHE_H
+#define DRRVOLUMECACHE_H
+#include "MitkLancetDRRExports.h"
+#include "drrVolume.h"
+#include "mitkImage.h"
+#include <itkImage.h>
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+#include <chrono>
+
+/*!
+\brief DrrVolume (threshold box + brick grid) of the CT it was built from.
+
+The cache is held by its user (DrrFilter, DrrBatchGenerator) and keyed on the source image and
+its modified time: a different or modified input, or a different threshold / attenuation setting,
+replaces it by a new one, so the float copy of the CT lives only as long as its user needs it.
+*/
+class MITKLANCETDRR_EXPORT DrrVolumeCache : public itk::Object
+{
+public:
+	mitkClassMacroItkParent(DrrVolumeCache, itk::Object);
+	itkNewMacro(Self);
+
+	/*!
+	\brief cache if it is still valid for image and the settings, otherwise a new one built from image
+	\return nullptr if image is not a 3D image
+	*/
+	static DrrVolumeCache::Pointer GetOrCreate(DrrVolumeCache* cache, const mitk::Image* image, double threshold,
+		bool convertToAttenuation = false, double muWater = 0.02);
+
+	/*!
+	\brief same as above, the volume is built from itkImage, the voxels of source
+	*/
+	template <typename TPixel, unsigned int VDimension>
+	static DrrVolumeCache::Pointer GetOrCreate(DrrVolumeCache* cache, const mitk::Image* source,
+		const itk::Image<TPixel, VDimension>* itkImage, double threshold, bool convertToAttenuation = false, double muWater = 0.02);
+
+	const DrrVolume& GetVolume() const { return m_Volume; }
+	/*!
+	\brief milliseconds spent building the cached volume
+	*/
+	itkGetMacro(BuildTime, double);
+
+protected:
+	DrrVolumeCache();
+	~DrrVolumeCache() override;
+
+	bool IsValidFor(const mitk::Image* image, double threshold, bool convertToAttenuation, double muWater) const;
+
+	template <typename TPixel, unsigned int VDimension>
+	void ItkImageBuild(const itk::Image<TPixel, VDimension>* itkImage);
+
+private:
+	DrrVolume m_Volume;
+	const mitk::Image* m_Source{ nullptr }; // identity only, never dereferenced
+	itk::ModifiedTimeType m_ImageTime{ 0 };
+	double m_Threshold{ 0.0 };
+	bool m_ConvertToAttenuation{ false };
+	double m_MuWater{ 0.02 };
+	double m_BuildTime{ 0.0 };
+};
+
+template <typename TPixel, unsigned int VDimension>
+void DrrVolumeCache::ItkImageBuild(const itk::Image<TPixel, VDimension>* itkImage)
+{
+	const auto region = itkImage->GetBufferedRegion();
+	const auto spacing = itkImage->GetSpacing();
+	const auto origin = itkImage->GetOrigin();
+
+	unsigned int volumeSize[3];
+	double volumeSpacing[3];
+	double volumeOrigin[3];
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+		volumeSize[i] = static_cast<unsigned int>(region.GetSize()[i]);
+		volumeSpacing[i] = spacing[i];
+		volumeOrigin[i] = origin[i];
+	}
+
+	m_Volume.Initialize(itkImage->GetBufferPointer(), volumeSize, volumeSpacing, volumeOrigin,
+		m_Threshold, m_ConvertToAttenuation, m_MuWater);
+}
+
+template <typename TPixel, unsigned int VDimension>
+DrrVolumeCache::Pointer DrrVolumeCache::GetOrCreate(DrrVolumeCache* cache, const mitk::Image* source,
+	const itk::Image<TPixel, VDimension>* itkImage, double threshold, bool convertToAttenuation, double muWater)
+{
+	if (source == nullptr || itkImage == nullptr || VDimension != 3)
+	{
+		return nullptr;
+	}
+	if (cache != nullptr && cache->IsValidFor(source, threshold, convertToAttenuation, muWater))
+	{
+		return cache;
+	}
+
+	DrrVolumeCache::Pointer created = DrrVolumeCache::New();
+	created->m_Source = source;
+	created->m_ImageTime = source->GetMTime();
+	created->m_Threshold = threshold;
+	created->m_ConvertToAttenuation = convertToAttenuation;
+	created->m_MuWater = muWater;
+
+	const auto start = std::chrono::steady_clock::now();
+	created->ItkImageBuild(itkImage);
+	created->m_BuildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return created;
+}
+
+#endif // DRRVOLUMECACHE_H
@@ -12,311 +12,109 @@ found in the LICENSE file.
 
 #include "drr.h"
 
-#include "itkCenteredEuler3DTransform.h"
-#include "itkImageFileReader.h"
-#include "itkImageFileWriter.h"
-#include "itkRayCastInterpolateImageFunction.h"
-#include "itkResampleImageFilter.h"
-#include "itkRescaleIntensityImageFilter.h"
+#include "drrRayCaster.h"
+#include "drrVolumeCache.h"
+
 #include "mitkImageAccessByItk.h"
 #include "mitkImageCast.h"
 #include "mitkITKImageImport.h"
-#include <itkShiftScaleImageFilter.h>
 #include <mitkImageToItk.h>
+#include <chrono>
+#include <vector>
 
 template <typename TPixel, unsigned VDimension>
 void DrrFilter::ItkImageProcessing(const itk::Image<TPixel, VDimension> *itkImage)
 {
-    // Software Guide : BeginLatex
-    //
-    // Although we generate a 2D projection of the 3D volume for the
-    // purposes of the interpolator both images must be three dimensional.
-    //
-    // Software Guide : EndLatex
-
-    // Software Guide : BeginCodeSnippet
-
+    // Although we generate a 2D projection of the 3D volume both images are
+    // three dimensional, the DRR being a single slice.
     typedef itk::Image<TPixel, VDimension> InputImageType;
     typedef itk::Image<TPixel, VDimension> OutputImageType;
 
-    // Software Guide : EndCodeSnippet
-
-    // Software Guide : BeginLatex
-    //
-    // For the purposes of this example we assume the input volume has
-    // been loaded into an \code{itk::Image image}.
-    //
-    // Software Guide : EndLatex
-
-    // Print out the details of the input volume
-
-    if (m_verbose)
-    {
-        unsigned int i;
-        const typename InputImageType::SpacingType spacing = itkImage->GetSpacing();
-        std::cout << std::endl << "Input ";
-
-        typename InputImageType::RegionType region = itkImage->GetBufferedRegion();
-        region.Print(std::cout);
-
-        std::cout << "  Resolution: [";
-        for (i = 0; i < VDimension; i++)
-        {
-            std::cout << spacing[i];
-            if (i < VDimension - 1)
-                std::cout << ", ";
-        }
-        std::cout << "]" << std::endl;
-
-        const typename InputImageType::PointType origin = itkImage->GetOrigin();
-        std::cout << "  Origin: [";
-        for (i = 0; i < VDimension; i++)
-        {
-            std::cout << origin[i];
-            if (i < VDimension - 1)
-                std::cout << ", ";
-        }
-        std::cout << "]" << std::endl << std::endl;
-    }
-
-    // Software Guide : BeginLatex
-    //
-    // Creation of a \code{ResampleImageFilter} enables coordinates for
-    // each of the pixels in the DRR image to be generated. These
-    // coordinates are used by the \code{RayCastInterpolateImageFunction}
-    // to determine the equation of each corresponding ray which is cast
-    // through the input volume.
-    //
-    // Software Guide : EndLatex
-
-    // Software Guide : BeginCodeSnippet
-    typedef itk::ResampleImageFilter<InputImageType, InputImageType> FilterType;
-
-    typename FilterType::Pointer filter = FilterType::New();
-
-    filter->SetInput(itkImage);
-    filter->SetDefaultPixelValue(0);
-    // Software Guide : EndCodeSnippet
-
-    // Software Guide : BeginLatex
-    //
-    // An Euler transformation is defined to position the input volume.
-    // The \code{ResampleImageFilter} uses this transform to position the
-    // output DRR image for the desired view.
-    //
-    // Software Guide : EndLatex
-
-    // Software Guide : BeginCodeSnippet
-    typedef itk::CenteredEuler3DTransform<double> TransformType;
-
-    TransformType::Pointer transform = TransformType::New();
-
-    transform->SetComputeZYX(true);
-
-    TransformType::OutputVectorType translation;
-
-    translation[0] = m_tx;
-    translation[1] = m_ty;
-    translation[2] = m_tz;
-
-    // constant for converting degrees into radians
-    const double dtr = (std::atan(1.0) * 4.0) / 180.0;
-
-    transform->SetTranslation(translation);
-    transform->SetRotation(dtr * m_rx, dtr * m_ry, dtr * m_rz);
-
-    typename InputImageType::PointType imOrigin = itkImage->GetOrigin();
-    typename InputImageType::SpacingType imRes = itkImage->GetSpacing();
-
     typedef typename InputImageType::RegionType InputImageRegionType;
     typedef typename InputImageRegionType::SizeType InputImageSizeType;
 
     InputImageRegionType imRegion = itkImage->GetBufferedRegion();
     InputImageSizeType imSize = imRegion.GetSize();
-
-    imOrigin[0] += imRes[0] * static_cast<double>(imSize[0]) / 2.0;
-    imOrigin[1] += imRes[1] * static_cast<double>(imSize[1]) / 2.0;
-    imOrigin[2] += imRes[2] * static_cast<double>(imSize[2]) / 2.0;
-
-    TransformType::InputPointType center;
-    center[0] = m_cx + imOrigin[0];
-    center[1] = m_cy + imOrigin[1];
-    center[2] = m_cz + imOrigin[2];
-
-    transform->SetCenter(center);
+    typename InputImageType::PointType imOrigin = itkImage->GetOrigin();
+    typename InputImageType::SpacingType imRes = itkImage->GetSpacing();
 
     if (m_verbose)
     {
-        std::cout << "Image size: "
-            << imSize[0] << ", " << imSize[1] << ", " << imSize[2]
-            << std::endl << "   resolution: "
-            << imRes[0] << ", " << imRes[1] << ", " << imRes[2]
-            << std::endl << "   origin: "
-            << imOrigin[0] << ", " << imOrigin[1] << ", " << imOrigin[2]
-            << std::endl << "   center: "
-            << center[0] << ", " << center[1] << ", " << center[2]
-            << std::endl << "Transform: " << transform << std::endl;
+        std::cout << std::endl << "Input ";
+        imRegion.Print(std::cout);
+        std::cout << "  Resolution: [" << imRes[0] << ", " << imRes[1] << ", " << imRes[2] << "]" << std::endl
+            << "  Origin: [" << imOrigin[0] << ", " << imOrigin[1] << ", " << imOrigin[2] << "]" << std::endl << std::endl;
     }
-    // Software Guide : EndCodeSnippet
-
-    // Software Guide : BeginLatex
-    //
-    // The \code{RayCastInterpolateImageFunction} is instantiated and passed the transform
-    // object. The \code{RayCastInterpolateImageFunction} uses this
-    // transform to reposition the x-ray source such that the DRR image
-    // and x-ray source move as one around the input volume. This coupling
-    // mimics the rigid geometry of the x-ray gantry.
-    //
-    // Software Guide : EndLatex
-
-    // Software Guide : BeginCodeSnippet
-    typedef itk::RayCastInterpolateImageFunction<InputImageType, double>
-        InterpolatorType;
-    typename InterpolatorType::Pointer interpolator = InterpolatorType::New();
-    interpolator->SetTransform(transform);
-    // Software Guide : EndCodeSnippet
-
-    // Software Guide : BeginLatex
-    //
-    // We can then specify a threshold above which the volume's
-    // intensities will be integrated.
-    //
-    // Software Guide : EndLatex
-
-    // Software Guide : BeginCodeSnippet
-    interpolator->SetThreshold(m_threshold);
-    // Software Guide : EndCodeSnippet
-
-    // Software Guide : BeginLatex
-    //
-    // The ray-cast interpolator needs to know the initial position of the
-    // ray source or focal point. In this example we place the input
-    // volume at the origin and halfway between the ray source and the
-    // screen. The distance between the ray source and the screen
-    // is the "source to image distance" \code{sid} and is specified by
-    // the user.
-    //
-    // Software Guide : EndLatex
-
-    // Software Guide : BeginCodeSnippet
-    typename InterpolatorType::InputPointType focalpoint;
-
-    focalpoint[0] = imOrigin[0];
-    focalpoint[1] = imOrigin[1];
-    focalpoint[2] = imOrigin[2] - m_sid / 2.;
-
-    interpolator->SetFocalPoint(focalpoint);
-    // Software Guide : EndCodeSnippet
 
-    if (m_verbose)
+    // The ray caster marches over the float copy of the voxels inside the threshold box
+    // and its brick grid, kept by the filter until the input or the threshold changes
+    const auto start = std::chrono::steady_clock::now();
+
+    m_VolumeCache = DrrVolumeCache::GetOrCreate(m_VolumeCache, this->GetInput(), itkImage, m_threshold);
+    if (m_VolumeCache.IsNull())
     {
-        std::cout << "Focal Point: "
-            << focalpoint[0] << ", "
-            << focalpoint[1] << ", "
-            << focalpoint[2] << std::endl;
+        MITK_ERROR << "DrrFilter: no volume could be prepared from the input image.";
+        itkExceptionMacro("DrrFilter: no volume could be prepared from the input image.");
     }
 
-    // Software Guide : BeginLatex
-    //
-    // Having initialised the interpolator we pass the object to the
-    // resample filter.
-    //
-    // Software Guide : EndLatex
-
-    // Software Guide : BeginCodeSnippet
-    interpolator->Print(std::cout);
-
-    filter->SetInterpolator(interpolator);
-    filter->SetTransform(transform); // ??
-    
-    // Software Guide : EndCodeSnippet
+    DrrRayCaster rayCaster;
+    rayCaster.SetVolume(m_VolumeCache->GetVolume());
 
-    // Software Guide : BeginLatex
-    //
-    // The size and resolution of the output DRR image is specified via the
-    // resample filter.
-    //
-    // Software Guide : EndLatex
-
-    // Software Guide : BeginCodeSnippet
-
-    // setup the scene
-    typename InputImageType::SizeType size;
+    const DrrGeometry geometry = this->GetGeometryParameters();
 
+    // The size, resolution and position of the output DRR image; unless specified
+    // otherwise the normal from the "screen" to the ray source passes directly
+    // through the centre of the DRR.
+    typename OutputImageType::SizeType size;
     size[0] = m_dx; // number of pixels along X of the 2D DRR image
     size[1] = m_dy; // number of pixels along Y of the 2D DRR image
     size[2] = 1;  // only one slice
 
-    filter->SetSize(size);
-
-    typename InputImageType::SpacingType spacing;
-
+    typename OutputImageType::SpacingType spacing;
     spacing[0] = m_sx;  // pixel spacing along X of the 2D DRR image [mm]
     spacing[1] = m_sy;  // pixel spacing along Y of the 2D DRR image [mm]
     spacing[2] = 1.0; // slice thickness of the 2D DRR image [mm]
 
-    filter->SetOutputSpacing(spacing);
-
-    // Software Guide : EndCodeSnippet
+    double origin[3];
+    rayCaster.GetOutputOrigin(geometry, origin);
 
     if (m_verbose)
     {
-        std::cout << "Output image size: "
-            << size[0] << ", "
-            << size[1] << ", "
-            << size[2] << std::endl;
-
-        std::cout << "Output image spacing: "
-            << spacing[0] << ", "
-            << spacing[1] << ", "
-            << spacing[2] << std::endl;
+        std::cout << "Output image size: " << size[0] << ", " << size[1] << ", " << size[2] << std::endl
+            << "Output image spacing: " << spacing[0] << ", " << spacing[1] << ", " << spacing[2] << std::endl
+            << "Output image origin: " << origin[0] << ", " << origin[1] << ", " << origin[2] << std::endl
+            << "Ray casting threads: " << rayCaster.GetNumberOfThreads() << std::endl
+            << "Empty bricks skipped: " << 100.0 * m_VolumeCache->GetVolume().GetEmptyBrickRatio() << " %" << std::endl;
     }
 
-    // Software Guide : BeginLatex
-    //
-    // In addition the position of the DRR is specified. The default
-    // position of the input volume, prior to its transformation is
-    // half-way between the ray source and screen and unless specified
-    // otherwise the normal from the "screen" to the ray source passes
-    // directly through the centre of the DRR.
-    //
-    // Software Guide : EndLatex
-
-    // Software Guide : BeginCodeSnippet
-
-    double origin[VDimension];
-
-    origin[0] = imOrigin[0] + m_o2Dx - m_sx * ((double)m_dx - 1.) / 2.;
-    origin[1] = imOrigin[1] + m_o2Dy - m_sy * ((double)m_dy - 1.) / 2.;
-    origin[2] = imOrigin[2] + m_sid / 2.;
-
-    filter->SetOutputOrigin(origin);
-    // Software Guide : EndCodeSnippet
+    std::vector<float> drr(static_cast<size_t>(m_dx) * m_dy);
+    rayCaster.Render(geometry, drr.data());
 
     if (m_verbose)
     {
-        std::cout << "Output image origin: "
-            << origin[0] << ", "
-            << origin[1] << ", "
-            << origin[2] << std::endl;
+        std::cout << "DRR generated in "
+            << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+            << " ms" << std::endl;
     }
 
+    typename OutputImageType::Pointer drrImage = OutputImageType::New();
+    typename OutputImageType::RegionType outputRegion;
+    outputRegion.SetSize(size);
+    drrImage->SetRegions(outputRegion);
+    drrImage->SetSpacing(spacing);
+    drrImage->SetOrigin(origin);
+    drrImage->Allocate();
 
-    filter->Update();
-
-    // typedef itk::RescaleIntensityImageFilter<
-    //     InputImageType, InputImageType> RescaleFilterType;
-    // typename RescaleFilterType::Pointer rescaler = RescaleFilterType::New();
-    // rescaler->SetOutputMinimum(0);
-    // rescaler->SetOutputMaximum(255);
-    // rescaler->SetInput(filter->GetOutput());
-    // rescaler->Update();
+    TPixel* outputBuffer = drrImage->GetBufferPointer();
+    for (size_t i = 0; i < drr.size(); ++i)
+    {
+        outputBuffer[i] = static_cast<TPixel>(drr[i]);
+    }
 
     // get  Pointer to output image
     mitk::Image::Pointer resultImage = this->GetOutput();
     // write into output image
-    mitk::CastToMitkImage(filter->GetOutput(), resultImage);
-    //m_out = mitk::ImportItkImage(rescaler->GetOutput())->Clone();
+    mitk::CastToMitkImage(drrImage, resultImage);
 }
 
 DrrFilter::DrrFilter() = default;
@@ -359,3 +157,27 @@ void DrrFilter::SetObjRotate(double rx, double ry, double rz)
 
 }
 
+
+
+DrrGeometry DrrFilter::GetGeometryParameters() const
+{
+    DrrGeometry geometry;
+    geometry.rx = m_rx;
+    geometry.ry = m_ry;
+    geometry.rz = m_rz;
+    geometry.tx = m_tx;
+    geometry.ty = m_ty;
+    geometry.tz = m_tz;
+    geometry.cx = m_cx;
+    geometry.cy = m_cy;
+    geometry.cz = m_cz;
+    geometry.threshold = m_threshold;
+    geometry.sid = m_sid;
+    geometry.sx = m_sx;
+    geometry.sy = m_sy;
+    geometry.dx = m_dx;
+    geometry.dy = m_dy;
+    geometry.o2Dx = m_o2Dx;
+    geometry.o2Dy = m_o2Dy;
+    return geometry;
+}
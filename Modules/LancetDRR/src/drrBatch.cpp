@@ -0,0 +1,151 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "drrBatch.h"
+
+#include "mitkImageWriteAccessor.h"
+#include "parallelForBlocks.h"
+
+#include <chrono>
+
+namespace
+{
+  double MillisecondsSince(const std::chrono::steady_clock::time_point& start)
+  {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+}
+
+DrrBatchGenerator::DrrBatchGenerator() = default;
+
+DrrBatchGenerator::~DrrBatchGenerator() = default;
+
+void DrrBatchGenerator::SetInput(mitk::Image::Pointer image)
+{
+  if (m_Input != image)
+  {
+    m_Input = image;
+    m_VolumeCache = nullptr;
+    this->Modified();
+  }
+}
+
+void DrrBatchGenerator::SetBaseGeometry(const DrrGeometry& geometry)
+{
+  m_BaseGeometry = geometry;
+  this->Modified();
+}
+
+const DrrVolume& DrrBatchGenerator::GetVolume() const
+{
+  static const DrrVolume emptyVolume;
+  return m_VolumeCache.IsNotNull() ? m_VolumeCache->GetVolume() : emptyVolume;
+}
+
+bool DrrBatchGenerator::Preprocess()
+{
+  if (m_Input.IsNull() || m_Input->GetDimension() != 3)
+  {
+    MITK_ERROR << "DrrBatchGenerator: a 3D input image is required.";
+    return false;
+  }
+
+  auto volumeCache = DrrVolumeCache::GetOrCreate(m_VolumeCache, m_Input, m_BaseGeometry.threshold, m_ConvertToAttenuation, m_MuWater);
+  if (volumeCache == m_VolumeCache)
+  {
+    return true;
+  }
+  m_VolumeCache = volumeCache;
+  m_PreprocessTime = m_VolumeCache->GetBuildTime();
+
+  if (m_verbose)
+  {
+    const unsigned int* size = m_VolumeCache->GetVolume().GetSize();
+    MITK_INFO << "DrrBatchGenerator: preprocessed CT in " << m_PreprocessTime << " ms, kept "
+      << size[0] << " x " << size[1] << " x " << size[2] << " voxels in the threshold box, "
+      << 100.0 * m_VolumeCache->GetVolume().GetEmptyBrickRatio() << " % empty bricks";
+  }
+  return true;
+}
+
+mitk::Image::Pointer DrrBatchGenerator::GenerateDrrs(const std::vector<DrrPose>& poses)
+{
+  m_PoseTimes.assign(poses.size(), 0.0);
+  m_BatchTime = 0.0;
+  if (!this->Preprocess() || poses.empty())
+  {
+    return nullptr;
+  }
+
+  const int dx = m_BaseGeometry.dx;
+  const int dy = m_BaseGeometry.dy;
+
+  DrrRayCaster rayCaster;
+  rayCaster.SetVolume(m_VolumeCache->GetVolume());
+
+  unsigned int dimensions[3] = { static_cast<unsigned int>(dx), static_cast<unsigned int>(dy),
+    static_cast<unsigned int>(poses.size()) };
+  auto stack = mitk::Image::New();
+  stack->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions);
+
+  mitk::Vector3D spacing;
+  spacing[0] = m_BaseGeometry.sx;
+  spacing[1] = m_BaseGeometry.sy;
+  spacing[2] = 1.0;
+  stack->SetSpacing(spacing);
+
+  double origin[3];
+  rayCaster.GetOutputOrigin(m_BaseGeometry, origin);
+  mitk::Point3D stackOrigin;
+  stackOrigin[0] = origin[0];
+  stackOrigin[1] = origin[1];
+  stackOrigin[2] = origin[2];
+  stack->SetOrigin(stackOrigin);
+
+  const auto batchStart = std::chrono::steady_clock::now();
+  {
+    mitk::ImageWriteAccessor accessor(stack);
+    float* data = static_cast<float*>(accessor.GetData());
+    const size_t sliceSize = static_cast<size_t>(dx) * dy;
+
+    // one pose per worker, each pose rendered single-threaded: for a batch this keeps every
+    // core busy without splitting a small detector into tiny row blocks
+    const unsigned int hardwareThreads = lancetAlgorithm::ResolveThreadCount(m_NumberOfThreads);
+    const unsigned int numberOfThreads = lancetAlgorithm::ThreadCountForBlocks(hardwareThreads, poses.size(), 1);
+    rayCaster.SetNumberOfThreads(numberOfThreads > 1 ? 1 : hardwareThreads);
+
+    lancetAlgorithm::ParallelForBlocks(poses.size(), numberOfThreads, 1, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i)
+      {
+        DrrGeometry geometry = m_BaseGeometry;
+        geometry.rx = poses[i].rx;
+        geometry.ry = poses[i].ry;
+        geometry.rz = poses[i].rz;
+        geometry.tx = poses[i].tx;
+        geometry.ty = poses[i].ty;
+        geometry.tz = poses[i].tz;
+
+        const auto poseStart = std::chrono::steady_clock::now();
+        rayCaster.Render(geometry, data + i * sliceSize);
+        m_PoseTimes[i] = MillisecondsSince(poseStart);
+      }
+    });
+  }
+  m_BatchTime = MillisecondsSince(batchStart);
+
+  if (m_verbose)
+  {
+    MITK_INFO << "DrrBatchGenerator: " << poses.size() << " DRRs of " << dx << " x " << dy << " in " << m_BatchTime
+      << " ms (" << m_BatchTime / poses.size() << " ms per pose, preprocessing " << m_PreprocessTime << " ms)";
+  }
+  return stack;
+}
@@ -0,0 +1,499 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "drrRayCaster.h"
+
+#include "parallelForBlocks.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  // number of neighbouring detector pixels marched together
+  constexpr int kPacketWidth = 8;
+  // detector rows handed to a worker at once
+  constexpr int kRowBlock = 4;
+
+  void RotationZYX(double rx, double ry, double rz, double m[3][3])
+  {
+    // same convention as itk::Euler3DTransform with ComputeZYX on: R = Rz * Ry * Rx
+    const double cx = std::cos(rx), sx = std::sin(rx);
+    const double cy = std::cos(ry), sy = std::sin(ry);
+    const double cz = std::cos(rz), sz = std::sin(rz);
+
+    m[0][0] = cz * cy;
+    m[0][1] = cz * sy * sx - sz * cx;
+    m[0][2] = cz * sy * cx + sz * sx;
+    m[1][0] = sz * cy;
+    m[1][1] = sz * sy * sx + cz * cx;
+    m[1][2] = sz * sy * cx - cz * sx;
+    m[2][0] = -sy;
+    m[2][1] = cy * sx;
+    m[2][2] = cy * cx;
+  }
+
+  // per ray setup of the plane-by-plane traversal along the dominant axis k
+  struct RaySetup
+  {
+    int axis;      // dominant axis, -1 if the ray misses the volume
+    int kBegin;    // first voxel plane crossed
+    int kEnd;      // one past the last voxel plane crossed
+    float u0, du;  // first minor coordinate at plane 0 and its increment per plane
+    float v0, dv;  // second minor coordinate at plane 0 and its increment per plane
+    float stepMM;  // ray length between two planes in mm
+  };
+
+  // intersect [lo,hi] with the k interval where a + k * s stays inside [0, n - 1]
+  bool ClipAxis(double a, double s, int n, double& lo, double& hi)
+  {
+    const double maxIndex = n - 1;
+    if (std::abs(s) < 1e-12)
+    {
+      return a >= 0.0 && a <= maxIndex;
+    }
+    double k0 = -a / s;
+    double k1 = (maxIndex - a) / s;
+    if (k0 > k1)
+    {
+      std::swap(k0, k1);
+    }
+    lo = std::max(lo, k0);
+    hi = std::min(hi, k1);
+    return lo <= hi;
+  }
+}
+
+DrrRayCaster::DrrRayCaster() = default;
+
+DrrRayCaster::~DrrRayCaster() = default;
+
+void DrrRayCaster::SetVolume(const float* buffer, const unsigned int size[3], const double spacing[3], const double origin[3])
+{
+  m_Buffer = buffer;
+  m_EmptyBricks = nullptr;
+  m_UseVolumeThreshold = false;
+  for (int i = 0; i < 3; ++i)
+  {
+    m_Size[i] = static_cast<int>(size[i]);
+    m_Offset[i] = 0;
+    m_FullSize[i] = m_Size[i];
+    m_Spacing[i] = spacing[i];
+    m_Origin[i] = origin[i];
+  }
+}
+
+void DrrRayCaster::SetVolume(const DrrVolume& volume)
+{
+  m_Buffer = volume.GetBuffer();
+  m_EmptyBricks = volume.GetEmptyBricks();
+  m_BrickStride[0] = 1;
+  m_BrickStride[1] = volume.GetBrickCount()[0];
+  m_BrickStride[2] = static_cast<long long>(volume.GetBrickCount()[0]) * volume.GetBrickCount()[1];
+  m_UseVolumeThreshold = true;
+  m_VolumeThreshold = volume.GetThreshold();
+  for (int i = 0; i < 3; ++i)
+  {
+    m_Size[i] = static_cast<int>(volume.GetSize()[i]);
+    m_Offset[i] = static_cast<int>(volume.GetOffset()[i]);
+    m_FullSize[i] = static_cast<int>(volume.GetFullSize()[i]);
+    m_Spacing[i] = volume.GetSpacing()[i];
+    m_Origin[i] = volume.GetOrigin()[i];
+  }
+}
+
+unsigned int DrrRayCaster::GetNumberOfThreads() const
+{
+  return lancetAlgorithm::ResolveThreadCount(m_NumberOfThreads);
+}
+
+void DrrRayCaster::GetOutputOrigin(const DrrGeometry& geometry, double origin[3]) const
+{
+  // the volume center is the reference of the C-arm, the detector lies sid/2 behind it
+  double imCenter[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    imCenter[i] = m_Origin[i] + m_Spacing[i] * static_cast<double>(m_FullSize[i]) / 2.0;
+  }
+  origin[0] = imCenter[0] + geometry.o2Dx - geometry.sx * (static_cast<double>(geometry.dx) - 1.) / 2.;
+  origin[1] = imCenter[1] + geometry.o2Dy - geometry.sy * (static_cast<double>(geometry.dy) - 1.) / 2.;
+  origin[2] = imCenter[2] + geometry.sid / 2.;
+}
+
+DrrRayCaster::RayGeometry DrrRayCaster::ComputeRayGeometry(const DrrGeometry& geometry) const
+{
+  // constant for converting degrees into radians
+  const double dtr = (std::atan(1.0) * 4.0) / 180.0;
+
+  double imCenter[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    imCenter[i] = m_Origin[i] + m_Spacing[i] * static_cast<double>(m_FullSize[i]) / 2.0;
+  }
+  const double center[3] = { geometry.cx + imCenter[0], geometry.cy + imCenter[1], geometry.cz + imCenter[2] };
+  const double translation[3] = { geometry.tx, geometry.ty, geometry.tz };
+
+  double rotation[3][3];
+  RotationZYX(dtr * geometry.rx, dtr * geometry.ry, dtr * geometry.rz, rotation);
+
+  // T(p) = R * (p - c) + c + t, then physical -> continuous index
+  auto transformPoint = [&](const double p[3], double out[3]) {
+    for (int r = 0; r < 3; ++r)
+    {
+      double v = center[r] + translation[r];
+      for (int c = 0; c < 3; ++c)
+      {
+        v += rotation[r][c] * (p[c] - center[c]);
+      }
+      out[r] = (v - m_Origin[r]) / m_Spacing[r] - m_Offset[r];
+    }
+  };
+  auto transformVector = [&](const double d[3], double out[3]) {
+    for (int r = 0; r < 3; ++r)
+    {
+      double v = 0.0;
+      for (int c = 0; c < 3; ++c)
+      {
+        v += rotation[r][c] * d[c];
+      }
+      out[r] = v / m_Spacing[r];
+    }
+  };
+
+  RayGeometry rayGeometry;
+
+  const double focalPoint[3] = { imCenter[0], imCenter[1], imCenter[2] - geometry.sid / 2. };
+  transformPoint(focalPoint, rayGeometry.focal);
+
+  double outputOrigin[3];
+  this->GetOutputOrigin(geometry, outputOrigin);
+  transformPoint(outputOrigin, rayGeometry.pixel0);
+
+  const double stepX[3] = { geometry.sx, 0.0, 0.0 };
+  const double stepY[3] = { 0.0, geometry.sy, 0.0 };
+  transformVector(stepX, rayGeometry.pixelStepX);
+  transformVector(stepY, rayGeometry.pixelStepY);
+
+  rayGeometry.threshold = static_cast<float>(m_UseVolumeThreshold ? m_VolumeThreshold : geometry.threshold);
+  return rayGeometry;
+}
+
+void DrrRayCaster::Render(const DrrGeometry& geometry, float* output) const
+{
+  const int dx = geometry.dx;
+  const int dy = geometry.dy;
+  if (output == nullptr || dx <= 0 || dy <= 0)
+  {
+    return;
+  }
+  if (m_Buffer == nullptr || m_Size[0] < 2 || m_Size[1] < 2 || m_Size[2] < 2)
+  {
+    std::fill(output, output + static_cast<size_t>(dx) * dy, 0.0f);
+    return;
+  }
+
+  const RayGeometry rayGeometry = this->ComputeRayGeometry(geometry);
+
+  lancetAlgorithm::ParallelForBlocks(dy, this->GetNumberOfThreads(), kRowBlock, [&](size_t rowBegin, size_t rowEnd) {
+    this->RenderRows(rayGeometry, dx, static_cast<int>(rowBegin), static_cast<int>(rowEnd), output);
+  });
+}
+
+void DrrRayCaster::RenderRows(const RayGeometry& rayGeometry, int dx, int rowBegin, int rowEnd, float* output) const
+{
+  const long long stride[3] = { 1, m_Size[0], static_cast<long long>(m_Size[0]) * m_Size[1] };
+
+  RaySetup rays[kPacketWidth];
+  float accumulated[kPacketWidth];
+
+  for (int j = rowBegin; j < rowEnd; ++j)
+  {
+    float* outputRow = output + static_cast<size_t>(j) * dx;
+    for (int i0 = 0; i0 < dx; i0 += kPacketWidth)
+    {
+      const int lanes = std::min(kPacketWidth, dx - i0);
+
+      // set up every ray of the packet and check that they share the dominant axis
+      int packetAxis = -2;
+      int kBegin = 0x7fffffff;
+      int kEnd = 0;
+      bool coherent = true;
+      for (int l = 0; l < lanes; ++l)
+      {
+        double p[3];
+        double b[3];
+        for (int c = 0; c < 3; ++c)
+        {
+          p[c] = rayGeometry.pixel0[c] + (i0 + l) * rayGeometry.pixelStepX[c] + j * rayGeometry.pixelStepY[c];
+          b[c] = rayGeometry.focal[c] - p[c];
+        }
+
+        RaySetup& ray = rays[l];
+        ray.axis = -1;
+        int k = 0;
+        if (std::abs(b[1]) > std::abs(b[k])) k = 1;
+        if (std::abs(b[2]) > std::abs(b[k])) k = 2;
+        if (std::abs(b[k]) > 1e-12)
+        {
+          const int u = (k + 1) % 3;
+          const int v = (k + 2) % 3;
+          const double su = b[u] / b[k];
+          const double sv = b[v] / b[k];
+          const double au = p[u] - p[k] * su;
+          const double av = p[v] - p[k] * sv;
+
+          double lo = 0.0;
+          double hi = m_Size[k] - 1;
+          if (ClipAxis(au, su, m_Size[u], lo, hi) && ClipAxis(av, sv, m_Size[v], lo, hi))
+          {
+            ray.kBegin = static_cast<int>(std::ceil(lo));
+            ray.kEnd = static_cast<int>(std::floor(hi)) + 1;
+            if (ray.kBegin < ray.kEnd)
+            {
+              ray.axis = k;
+              ray.u0 = static_cast<float>(au);
+              ray.du = static_cast<float>(su);
+              ray.v0 = static_cast<float>(av);
+              ray.dv = static_cast<float>(sv);
+              const double mmK = m_Spacing[k];
+              const double mmU = su * m_Spacing[u];
+              const double mmV = sv * m_Spacing[v];
+              ray.stepMM = static_cast<float>(std::sqrt(mmK * mmK + mmU * mmU + mmV * mmV));
+              kBegin = std::min(kBegin, ray.kBegin);
+              kEnd = std::max(kEnd, ray.kEnd);
+            }
+          }
+        }
+
+        if (ray.axis >= 0)
+        {
+          if (packetAxis == -2)
+          {
+            packetAxis = ray.axis;
+          }
+          else if (packetAxis != ray.axis)
+          {
+            coherent = false;
+          }
+        }
+        accumulated[l] = 0.0f;
+      }
+
+      if (packetAxis == -2)
+      {
+        // the whole packet misses the volume
+        std::fill(outputRow + i0, outputRow + i0 + lanes, 0.0f);
+        continue;
+      }
+
+      if (coherent && lanes == kPacketWidth)
+      {
+        // march all lanes plane by plane; the coordinate arithmetic is laid out
+        // lane-wise so that it maps onto SIMD registers
+        const int k = packetAxis;
+        const int u = (k + 1) % 3;
+        const int v = (k + 2) % 3;
+        const int maxU = m_Size[u] - 2;
+        const int maxV = m_Size[v] - 2;
+        const long long strideU = stride[u];
+        const long long strideV = stride[v];
+        const float threshold = rayGeometry.threshold;
+
+        // first plane every lane still has to look at, advanced past empty bricks
+        int nextPlane[kPacketWidth];
+        for (int l = 0; l < kPacketWidth; ++l)
+        {
+          nextPlane[l] = rays[l].axis >= 0 ? rays[l].kBegin : kEnd;
+        }
+
+        for (int plane = kBegin; plane < kEnd;)
+        {
+          const float* planeBuffer = m_Buffer + plane * stride[k];
+          const float fPlane = static_cast<float>(plane);
+
+          float posU[kPacketWidth];
+          float posV[kPacketWidth];
+          for (int l = 0; l < kPacketWidth; ++l)
+          {
+            posU[l] = rays[l].u0 + fPlane * rays[l].du;
+            posV[l] = rays[l].v0 + fPlane * rays[l].dv;
+          }
+
+          int packetNextPlane = kEnd;
+          for (int l = 0; l < kPacketWidth; ++l)
+          {
+            const RaySetup& ray = rays[l];
+            if (ray.axis < 0 || plane >= ray.kEnd)
+            {
+              continue;
+            }
+            if (plane < nextPlane[l])
+            {
+              packetNextPlane = std::min(packetNextPlane, nextPlane[l]);
+              continue;
+            }
+            const int iu = std::min(std::max(static_cast<int>(posU[l]), 0), maxU);
+            const int iv = std::min(std::max(static_cast<int>(posV[l]), 0), maxV);
+
+            const int skipTo = this->SkipEmptyBrick(k, plane, iu, iv, ray.u0, ray.du, ray.v0, ray.dv);
+            if (skipTo > plane)
+            {
+              nextPlane[l] = skipTo;
+              packetNextPlane = std::min(packetNextPlane, skipTo);
+              continue;
+            }
+            nextPlane[l] = plane + 1;
+            packetNextPlane = plane + 1;
+
+            const float fu = posU[l] - iu;
+            const float fv = posV[l] - iv;
+
+            const float* voxel = planeBuffer + iu * strideU + iv * strideV;
+            const float a = voxel[0] + fu * (voxel[strideU] - voxel[0]);
+            const float c = voxel[strideV] + fu * (voxel[strideU + strideV] - voxel[strideV]);
+            const float intensity = a + fv * (c - a);
+            if (intensity > threshold)
+            {
+              accumulated[l] += intensity - threshold;
+            }
+          }
+          plane = std::max(plane + 1, packetNextPlane);
+        }
+
+        for (int l = 0; l < kPacketWidth; ++l)
+        {
+          outputRow[i0 + l] = rays[l].axis >= 0 ? accumulated[l] * rays[l].stepMM : 0.0f;
+        }
+      }
+      else
+      {
+        // incoherent or partial packet: fall back to one ray at a time
+        for (int l = 0; l < lanes; ++l)
+        {
+          double p[3];
+          for (int c = 0; c < 3; ++c)
+          {
+            p[c] = rayGeometry.pixel0[c] + (i0 + l) * rayGeometry.pixelStepX[c] + j * rayGeometry.pixelStepY[c];
+          }
+          outputRow[i0 + l] = this->CastRay(rayGeometry, p);
+        }
+      }
+    }
+  }
+}
+
+float DrrRayCaster::CastRay(const RayGeometry& rayGeometry, const double pixel[3]) const
+{
+  double b[3];
+  for (int c = 0; c < 3; ++c)
+  {
+    b[c] = rayGeometry.focal[c] - pixel[c];
+  }
+  int k = 0;
+  if (std::abs(b[1]) > std::abs(b[k])) k = 1;
+  if (std::abs(b[2]) > std::abs(b[k])) k = 2;
+  if (std::abs(b[k]) <= 1e-12)
+  {
+    return 0.0f;
+  }
+
+  const int u = (k + 1) % 3;
+  const int v = (k + 2) % 3;
+  const double su = b[u] / b[k];
+  const double sv = b[v] / b[k];
+  const double au = pixel[u] - pixel[k] * su;
+  const double av = pixel[v] - pixel[k] * sv;
+
+  double lo = 0.0;
+  double hi = m_Size[k] - 1;
+  if (!ClipAxis(au, su, m_Size[u], lo, hi) || !ClipAxis(av, sv, m_Size[v], lo, hi))
+  {
+    return 0.0f;
+  }
+
+  const long long stride[3] = { 1, m_Size[0], static_cast<long long>(m_Size[0]) * m_Size[1] };
+  const int kBegin = static_cast<int>(std::ceil(lo));
+  const int kEnd = static_cast<int>(std::floor(hi)) + 1;
+  const int maxU = m_Size[u] - 2;
+  const int maxV = m_Size[v] - 2;
+  const float threshold = rayGeometry.threshold;
+
+  float integral = 0.0f;
+  for (int plane = kBegin; plane < kEnd;)
+  {
+    const double posU = au + plane * su;
+    const double posV = av + plane * sv;
+    const int iu = std::min(std::max(static_cast<int>(posU), 0), maxU);
+    const int iv = std::min(std::max(static_cast<int>(posV), 0), maxV);
+
+    const int skipTo = this->SkipEmptyBrick(k, plane, iu, iv, au, su, av, sv);
+    if (skipTo > plane)
+    {
+      plane = skipTo;
+      continue;
+    }
+
+    const float fu = static_cast<float>(posU - iu);
+    const float fv = static_cast<float>(posV - iv);
+
+    const float* voxel = m_Buffer + plane * stride[k] + iu * stride[u] + iv * stride[v];
+    const float a = voxel[0] + fu * (voxel[stride[u]] - voxel[0]);
+    const float c = voxel[stride[v]] + fu * (voxel[stride[u] + stride[v]] - voxel[stride[v]]);
+    const float intensity = a + fv * (c - a);
+    if (intensity > threshold)
+    {
+      integral += intensity - threshold;
+    }
+    ++plane;
+  }
+
+  const double mmK = m_Spacing[k];
+  const double mmU = su * m_Spacing[u];
+  const double mmV = sv * m_Spacing[v];
+  return integral * static_cast<float>(std::sqrt(mmK * mmK + mmU * mmU + mmV * mmV));
+}
+
+int DrrRayCaster::SkipEmptyBrick(int k, int plane, int iu, int iv, double u0, double du, double v0, double dv) const
+{
+  if (m_EmptyBricks == nullptr)
+  {
+    return plane;
+  }
+  const int u = (k + 1) % 3;
+  const int v = (k + 2) % 3;
+  const int brickK = plane / static_cast<int>(DrrVolume::BrickSize);
+  const int brickU = iu / static_cast<int>(DrrVolume::BrickSize);
+  const int brickV = iv / static_cast<int>(DrrVolume::BrickSize);
+  if (!m_EmptyBricks[brickK * m_BrickStride[k] + brickU * m_BrickStride[u] + brickV * m_BrickStride[v]])
+  {
+    return plane;
+  }
+
+  // first plane of the next brick along k, or earlier if the ray leaves the brick
+  // sideways; one plane of margin keeps the float positions on the safe side
+  const double brickSize = DrrVolume::BrickSize;
+  double exitPlane = (brickK + 1) * brickSize;
+  auto sideExit = [&](int brick, double start, double slope) {
+    if (slope > 1e-12)
+    {
+      exitPlane = std::min(exitPlane, std::ceil(((brick + 1) * brickSize - start) / slope) - 1.0);
+    }
+    else if (slope < -1e-12)
+    {
+      exitPlane = std::min(exitPlane, std::ceil((brick * brickSize - start) / slope) - 1.0);
+    }
+  };
+  sideExit(brickU, u0, du);
+  sideExit(brickV, v0, dv);
+
+  return std::max(plane + 1, static_cast<int>(exitPlane));
+}
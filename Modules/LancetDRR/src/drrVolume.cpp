@@ -0,0 +1,86 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "drrVolume.h"
+
+#include <limits>
+
+void DrrVolume::BuildBrickGrid()
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    m_BrickCount[i] = (m_Size[i] + BrickSize - 1) / BrickSize;
+  }
+  const size_t numberOfBricks = static_cast<size_t>(m_BrickCount[0]) * m_BrickCount[1] * m_BrickCount[2];
+  m_BrickMin.assign(numberOfBricks, std::numeric_limits<float>::max());
+  m_BrickMax.assign(numberOfBricks, std::numeric_limits<float>::lowest());
+
+  // every voxel updates the brick it belongs to and, on a brick border, the preceding
+  // brick whose bilinear samples also read it
+  const float* voxel = m_Buffer.data();
+  for (unsigned int z = 0; z < m_Size[2]; ++z)
+  {
+    const unsigned int bz = z / BrickSize;
+    const unsigned int bzEnd = (z % BrickSize == 0 && bz > 0) ? bz - 1 : bz;
+    for (unsigned int y = 0; y < m_Size[1]; ++y)
+    {
+      const unsigned int by = y / BrickSize;
+      const unsigned int byEnd = (y % BrickSize == 0 && by > 0) ? by - 1 : by;
+      for (unsigned int x = 0; x < m_Size[0]; ++x, ++voxel)
+      {
+        const unsigned int bx = x / BrickSize;
+        const unsigned int bxEnd = (x % BrickSize == 0 && bx > 0) ? bx - 1 : bx;
+        const float value = *voxel;
+        for (unsigned int k = bzEnd; k <= bz; ++k)
+        {
+          for (unsigned int j = byEnd; j <= by; ++j)
+          {
+            for (unsigned int i = bxEnd; i <= bx; ++i)
+            {
+              const size_t brick = (static_cast<size_t>(k) * m_BrickCount[1] + j) * m_BrickCount[0] + i;
+              m_BrickMin[brick] = std::min(m_BrickMin[brick], value);
+              m_BrickMax[brick] = std::max(m_BrickMax[brick], value);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  m_EmptyBricks.resize(numberOfBricks);
+  const float threshold = static_cast<float>(m_Threshold);
+  for (size_t i = 0; i < numberOfBricks; ++i)
+  {
+    m_EmptyBricks[i] = m_BrickMax[i] > threshold ? 0 : 1;
+  }
+}
+
+void DrrVolume::GetBrickMinMax(unsigned int bx, unsigned int by, unsigned int bz, float& min, float& max) const
+{
+  const size_t brick = (static_cast<size_t>(bz) * m_BrickCount[1] + by) * m_BrickCount[0] + bx;
+  min = m_BrickMin[brick];
+  max = m_BrickMax[brick];
+}
+
+double DrrVolume::GetEmptyBrickRatio() const
+{
+  if (m_EmptyBricks.empty())
+  {
+    return 0.0;
+  }
+  size_t empty = 0;
+  for (auto flag : m_EmptyBricks)
+  {
+    empty += flag;
+  }
+  return static_cast<double>(empty) / m_EmptyBricks.size();
+}
@@ -0,0 +1,56 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "drrVolumeCache.h"
+
+#include "mitkImageAccessByItk.h"
+
+namespace
+{
+  template <typename TPixel, unsigned int VDimension>
+  void BuildFromItkImage(const itk::Image<TPixel, VDimension>* itkImage, const mitk::Image* image, double threshold,
+    bool convertToAttenuation, double muWater, DrrVolumeCache::Pointer& cache)
+  {
+    cache = DrrVolumeCache::GetOrCreate(nullptr, image, itkImage, threshold, convertToAttenuation, muWater);
+  }
+}
+
+DrrVolumeCache::DrrVolumeCache() = default;
+
+DrrVolumeCache::~DrrVolumeCache() = default;
+
+bool DrrVolumeCache::IsValidFor(const mitk::Image* image, double threshold, bool convertToAttenuation, double muWater) const
+{
+  return m_Source == image
+    && m_ImageTime == image->GetMTime()
+    && m_Threshold == threshold
+    && m_ConvertToAttenuation == convertToAttenuation
+    && (!convertToAttenuation || m_MuWater == muWater);
+}
+
+DrrVolumeCache::Pointer DrrVolumeCache::GetOrCreate(DrrVolumeCache* cache, const mitk::Image* image, double threshold,
+  bool convertToAttenuation, double muWater)
+{
+  if (image == nullptr || image->GetDimension() != 3)
+  {
+    return nullptr;
+  }
+  if (cache != nullptr && cache->IsValidFor(image, threshold, convertToAttenuation, muWater))
+  {
+    return cache;
+  }
+
+  DrrVolumeCache::Pointer created;
+  mitk::Image* input = const_cast<mitk::Image*>(image);
+  AccessFixedDimensionByItk_n(input, BuildFromItkImage, 3, (image, threshold, convertToAttenuation, muWater, created));
+  return created;
+}
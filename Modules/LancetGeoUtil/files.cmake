@@ -2,10 +2,14 @@ set(H_FILES
   include/nodebinder.h
   include/surfaceboolean.h
   include/polish.h
+  include/bonemillingengine.h
+  include/surfacecollisionservice.h
 )
 
 set(CPP_FILES
   nodebinder.cpp
   surfaceboolean.cpp
   polish.cpp
+  bonemillingengine.cpp
+  surfacecollisionservice.cpp
 )
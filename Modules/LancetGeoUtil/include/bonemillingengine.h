@@ -0,0 +1,164 @@
+#ifndef BONEMILLINGENGINE_H
+#define BONEMILLINGENGINE_H
+
+#include "MitkLancetGeoUtilExports.h"
+#include <itkObject.h>
+#include <mitkCommon.h>
+#include "mitkImage.h"
+#include "mitkSurface.h"
+#include <vtkSmartPointer.h>
+
+#include <vector>
+
+class vtkDiscreteFlyingEdges3D;
+class vtkImageData;
+class vtkMatrix4x4;
+class vtkPolyData;
+class vtkPolyDataToImageStencil;
+class vtkTransform;
+class vtkTransformPolyDataFilter;
+class vtkWindowedSincPolyDataFilter;
+
+/**
+ * \brief Incremental voxel milling of a bone label image by a tool surface.
+ *
+ * Initialize() copies label 1 of the bone image into a binary mask, splits the volume into
+ * bricks of BrickSize^3 voxels and extracts the surface of every brick once. Afterwards Mill()
+ * only rasterizes the tool inside the bounding box swept since the previous pose and marks the
+ * bricks whose voxels changed, and UpdateSurface() re-extracts and smooths just those bricks, so
+ * the cost of one tool pose depends on the tool size instead of the CT size.
+ *
+ * The output polydata persists: every brick owns a range of its points and triangles with some
+ * spare room. A re-extracted brick is written into its range, spare triangles collapse onto its
+ * first point; a brick that outgrew its range moves to the end. Ranges left without a surface,
+ * by a brick milled through or moved, are parked on one point of the remaining surface so that
+ * they neither render nor widen the bounds. The output is laid out anew once half of its
+ * triangles are unused.
+ *
+ * Bricks are extracted with the same flying edges and windowed sinc settings as
+ * Polish::DiscreteFlyingEdges3D(). Brick meshes share the vertices on the brick faces and the
+ * smoothing keeps boundary vertices fixed, so neighbouring bricks join without cracks.
+ */
+class MITKLANCETGEOUTIL_EXPORT BoneMillingEngine : public itk::Object
+{
+public:
+  mitkClassMacroItkParent(BoneMillingEngine, itk::Object);
+  itkNewMacro(Self)
+
+  static constexpr int BrickSize = 16;
+
+  /**
+   * \brief Takes the bone (voxels with label 1) of image and extracts the full surface.
+   */
+  void Initialize(mitk::Image *boneImage);
+
+  /**
+   * \brief Drops the mask and all brick meshes.
+   */
+  void Reset();
+
+  bool IsInitialized() const;
+
+  /**
+   * \brief Removes the bone inside the tool, swept from its previous pose to the current one.
+   * \return Number of removed voxels.
+   */
+  unsigned long Mill(mitk::Surface *tool);
+
+  /**
+   * \brief Forget the previous tool pose, the next Mill() does not sweep (e.g. after the tool was lifted).
+   */
+  void ResetSweep();
+
+  /**
+   * \brief Re-extracts the dirty bricks and updates the output surface.
+   */
+  void UpdateSurface();
+
+  /**
+   * \brief Bone surface in world coordinates, the same object for the whole milling.
+   */
+  mitk::Surface::Pointer GetSurface() const;
+
+  /**
+   * \brief The mask (1 bone, 0 milled or background) with the bone image geometry, the same
+   * object for the whole milling. Mill() edits it in place, callers must not modify it.
+   */
+  mitk::Image::Pointer GetMaskImage() const;
+
+  /**
+   * \brief Maximum distance in voxels between two rasterized tool poses of one sweep, 0.5 by default.
+   */
+  itkSetMacro(SweepStep, double);
+  itkGetMacro(SweepStep, double);
+
+  unsigned long GetNumberOfDirtyBricks() const { return static_cast<unsigned long>(m_dirtyBricks.size()); }
+  unsigned long GetNumberOfUpdatedBricks() const { return m_numberOfUpdatedBricks; }
+  double GetLastMillTime() const { return m_lastMillTime; }     ///< ms
+  double GetLastUpdateTime() const { return m_lastUpdateTime; } ///< ms
+
+protected:
+  BoneMillingEngine();
+  ~BoneMillingEngine() override;
+
+private:
+  struct BrickRange
+  {
+    vtkIdType firstPoint{ 0 };
+    vtkIdType pointCapacity{ 0 };
+    vtkIdType firstCell{ 0 };
+    vtkIdType cellCapacity{ 0 };
+    vtkIdType numberOfCells{ 0 };
+  };
+
+  void MarkDirty(int x0, int x1, int y, int z);
+  void ExtractBrick(int brick);
+  void RebuildOutput();
+  void PlaceBrick(int brick);
+  void WriteBrick(int brick);
+  void ReleaseRange(BrickRange &range);
+  void ParkDeadRanges();
+  void ParkRange(const BrickRange &range, vtkIdType point, const double coordinates[3]);
+  unsigned long RasterizeTool(const double toolToIndex[16]);
+
+  unsigned char *Voxel(int x, int y, int z);
+
+  mitk::BaseGeometry::Pointer m_geometry;
+  mitk::Image::Pointer m_maskImage; ///< owns the voxels
+  vtkSmartPointer<vtkImageData> m_mask; ///< view of m_maskImage
+  int m_dimensions[3]{ 0, 0, 0 };
+  int m_bricks[3]{ 0, 0, 0 };
+
+  std::vector<vtkSmartPointer<vtkPolyData>> m_brickMeshes; ///< world coordinates, null if the brick has no surface
+  std::vector<unsigned char> m_isDirty;
+  std::vector<int> m_dirtyBricks;
+
+  double m_previousToolToIndex[16]{};
+  bool m_hasPreviousPose{ false };
+  double m_SweepStep{ 0.5 };
+
+  // reused for every brick
+  vtkSmartPointer<vtkImageData> m_brickImage;
+  vtkSmartPointer<vtkDiscreteFlyingEdges3D> m_flyingEdgeFilter;
+  vtkSmartPointer<vtkWindowedSincPolyDataFilter> m_wsFilter;
+  vtkSmartPointer<vtkTransformPolyDataFilter> m_toWorldFilter;
+
+  // reused for every tool pose
+  vtkSmartPointer<vtkTransform> m_toolToIndex;
+  vtkSmartPointer<vtkTransformPolyDataFilter> m_toolFilter;
+  vtkSmartPointer<vtkPolyDataToImageStencil> m_stencilFilter;
+
+  // persistent output, the polydata of m_surface
+  vtkSmartPointer<vtkPolyData> m_output;
+  std::vector<BrickRange> m_brickRanges;
+  std::vector<BrickRange> m_deadRanges; ///< left behind by bricks that moved
+  int m_parkingBrick{ -1 };             ///< its first point holds the dead ranges
+  bool m_parkingDirty{ false };
+  vtkIdType m_numberOfUsedCells{ 0 };
+  mitk::Surface::Pointer m_surface;
+
+  unsigned long m_numberOfUpdatedBricks{ 0 };
+  double m_lastMillTime{ 0.0 };
+  double m_lastUpdateTime{ 0.0 };
+};
+#endif // BONEMILLINGENGINE_H
@@ -4,13 +4,35 @@
 
 #include "MitkLancetGeoUtilExports.h"
 #include <itkCommand.h>
+#include <vtkSmartPointer.h>
 
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+class QTimer;
 class vtkMatrix4x4;
 
 namespace mitk {
+  class BaseGeometry;
   class DataNode;
+  class ApplyTransformMatrixOperation;
 }
 
+/**
+ * \brief Binding group: moves a set of attachment nodes rigidly with a reference node.
+ *
+ * UpdateBinding() stores the transform from the reference to every attachment in a flat array.
+ * On each geometry change of the reference, all attachments are updated in one batch with a
+ * single reused matrix and operation, attachments that already are in place are skipped, and
+ * one render update is requested for the whole batch.
+ *
+ * With SetMaximumUpdateRate() geometry changes faster than the rate (e.g. the display refresh
+ * while dragging) are coalesced: the newest reference pose is applied by the next change after
+ * the interval or, if none comes, by a single-shot timer at the end of the interval, so the last
+ * pose of a drag is never dropped. Flush() applies a pending one at once.
+ */
 class MITKLANCETGEOUTIL_EXPORT NodeBinder : public itk::Command
 {
 public:
@@ -19,13 +41,17 @@ public:
     typedef Command                              Superclass;
     typedef itk::SmartPointer< Self >            Pointer;
     typedef itk::SmartPointer< const Self >      ConstPointer;
-    typedef std::map<std::string, mitk::DataNode*>  NodeMap;
-    typedef std::map<std::string, vtkMatrix4x4*>    MatrixMap;
     itkTypeMacro(NodeBinder, Command);
     itkNewMacro(Self);
 
     itkGetMacro(isBind, bool);
 
+    /**
+     * \brief Request a render update after each batch, on by default.
+     */
+    itkSetMacro(RequestRenderUpdate, bool);
+    itkGetMacro(RequestRenderUpdate, bool);
+
     void Execute(itk::Object *caller, const itk::EventObject &event) override;
 
     void Execute(const itk::Object *caller, const itk::EventObject &event) override;
@@ -47,13 +73,57 @@ public:
 
     void EnableBind();
 
+    /**
+     * \brief Limit the batches to hz per second, 0 (default) applies every geometry change.
+     */
+    void SetMaximumUpdateRate(double hz);
+    double GetMaximumUpdateRate() const;
+
+    /**
+     * \brief Apply a geometry change held back by the update rate, if any.
+     */
+    void Flush();
+
+    /**
+     * \brief Number of batches applied and geometry changes coalesced since binding.
+     */
+    unsigned long GetNumberOfBatches() const { return m_numberOfBatches; }
+    unsigned long GetNumberOfCoalescedEvents() const { return m_numberOfCoalescedEvents; }
+
+protected:
+    NodeBinder();
+    ~NodeBinder() override;
+
 private:
+    struct Attachment
+    {
+      std::string name;
+      mitk::DataNode *node{ nullptr };
+      double refToAttachment[16];
+      bool isBound{ false }; ///< refToAttachment is valid
+    };
+
+    void ApplyBinding(mitk::BaseGeometry *refGeometry);
+
     mitk::DataNode* m_refNode = nullptr;
 
-    std::map<std::string,mitk::DataNode*> m_attachmentList;
-    std::map<std::string,vtkMatrix4x4*> m_matrixList;
+    std::vector<Attachment> m_attachments;
 
+    // reused for every attachment of every batch
+    vtkSmartPointer<vtkMatrix4x4> m_worldToAttachment;
+    std::unique_ptr<mitk::ApplyTransformMatrixOperation> m_operation;
+
+    mitk::BaseGeometry *m_observedGeometry{ nullptr };
     unsigned long m_commandTag{};
     bool m_isBind{ false };
+    bool m_isApplying{ false };
+    bool m_RequestRenderUpdate{ true };
+
+    std::chrono::steady_clock::duration m_minimumInterval{ 0 };
+    std::chrono::steady_clock::time_point m_lastBatch;
+    bool m_isPending{ false };
+    std::unique_ptr<QTimer> m_trailingTimer; ///< applies the pending pose when no further change comes
+    unsigned long m_numberOfBatches{ 0 };
+    unsigned long m_numberOfCoalescedEvents{ 0 };
 };
 #endif // NODEBINDER_H
@@ -8,6 +8,7 @@
 #include "mitkImage.h"
 #include "mitkSurface.h"
 #include "mitkSurfaceToImageFilter.h"
+#include "bonemillingengine.h"
 #include <vtkDiscreteFlyingEdges3D.h>
 #include <vtkWindowedSincPolyDataFilter.h>
 #include <itkPlatformMultiThreader.h>
@@ -49,6 +50,12 @@ public:
 
   void doPolish();
 
+  /**
+   * \brief Mills the bone with the tool at its current pose and updates the bone surface.
+   *
+   * The first call voxelizes the bone image, later calls only touch the bricks of the milling
+   * engine the tool swept through.
+   */
   void run();
   void run2();
   /**
@@ -68,9 +75,14 @@ public:
   itkSetMacro(toolSurface, mitk::Surface::Pointer)
   void SetboneImage(mitk::Image::Pointer boneImage);
   itkGetMacro(resSurface, mitk::Surface::Pointer)
-  itkGetMacro(resImage, mitk::Image::Pointer)
+  /**
+   * \brief Bone left after milling, label 1. The milling engine's mask itself, updated in place
+   * while polishing, so read it but do not modify it.
+   */
+  mitk::Image::Pointer GetresImage();
   itkGetMacro(boneSurface, mitk::Surface::Pointer);
   itkSetMacro(boneSurface, mitk::Surface::Pointer);
+  itkGetMacro(millingEngine, BoneMillingEngine::Pointer)
   
 private:
   //input
@@ -84,6 +96,7 @@ private:
   vtkSmartPointer<vtkDiscreteFlyingEdges3D> m_flyingEdgeFilter{nullptr};
   vtkSmartPointer<vtkWindowedSincPolyDataFilter> m_wsFilter{nullptr};
   mitk::SurfaceToImageFilter::Pointer m_surface2imagefilter{nullptr};
+  BoneMillingEngine::Pointer m_millingEngine{nullptr};
   //vtkSmartPointer<vtkPolyData> m_Femur_PolyData;
   itk::PlatformMultiThreader::Pointer m_MultiThreader;
   ///< creates tracking thread that continuously polls serial interface for new tracking data
@@ -103,6 +116,7 @@ inline void Polish::SetboneImage(mitk::Image::Pointer boneImage)
   {
       m_boneImage = boneImage;
       m_resImage = boneImage->Clone();
+      m_millingEngine->Reset();
   }
   
 }
@@ -4,8 +4,11 @@
 
 #include "MitkLancetGeoUtilExports.h"
 #include <itkCommand.h>
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
 
 class vtkMatrix4x4;
+class vtkPolyData;
 
 namespace mitk {
   class DataNode;
@@ -49,12 +52,29 @@ public:
     void Enable();
 
 private:
+    /**
+     * \brief Triangulated and cleaned input, redone only when input changed since the last call.
+     */
+    vtkPolyData* CleanInput(vtkPolyData* input, vtkSmartPointer<vtkPolyData>& cleaned, vtkPolyData*& source, vtkMTimeType& sourceTime);
+
     mitk::DataNode* m_RefNode = nullptr;
     mitk::DataNode* m_MoveNode = nullptr;
 
     // std::map<std::string,mitk::DataNode*> m_attachmentList;
     // std::map<std::string,vtkMatrix4x4*> m_matrixList;
 
+    // the cutter polydata is static and only moves with its geometry, the reference changes only by the boolean itself
+    vtkSmartPointer<vtkPolyData> m_CleanedMove;
+    vtkPolyData* m_CleanedMoveSource{ nullptr };
+    vtkMTimeType m_CleanedMoveTime{ 0 };
+    vtkSmartPointer<vtkPolyData> m_CleanedRef;
+    vtkPolyData* m_CleanedRefSource{ nullptr };
+    vtkMTimeType m_CleanedRefTime{ 0 };
+    // reference polydata set by the last boolean and the cutter pose in the reference frame it was cut with
+    vtkPolyData* m_LastResult{ nullptr };
+    vtkMTimeType m_LastResultTime{ 0 };
+    double m_LastMoveToRef[16]{};
+
     unsigned long m_commandTag{};
     bool m_IsEnable{ false };
 };
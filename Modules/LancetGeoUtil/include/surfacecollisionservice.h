@@ -0,0 +1,111 @@
+#ifndef SURFACECOLLISIONSERVICE_H
+#define SURFACECOLLISIONSERVICE_H
+
+#include "MitkLancetGeoUtilExports.h"
+#include <itkObject.h>
+#include <mitkCommon.h>
+#include "mitkSurface.h"
+#include <vtkSmartPointer.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+class vtkImplicitPolyDataDistance;
+class vtkMatrix4x4;
+class vtkPolyData;
+
+/**
+ * \brief Distance, inside and penetration tests of a rigid tool against named surfaces.
+ *
+ * Every surface gets a signed distance function with its own cell locator, built once in the
+ * surface coordinates. A query only maps the tool points into the surface with the current
+ * geometries of tool and surface, so moving either one does not touch the cache, and the
+ * surface is not cleaned or triangulated again. The cache of a surface is rebuilt only when
+ * its polydata changes, so the service is meant for static bone and safety meshes, not for
+ * the surfaces that are being cut.
+ *
+ * Queries read the surfaces and geometries of the data nodes, which the GUI thread modifies,
+ * so the service is used from the GUI thread only, e.g. from the timer that updates the
+ * tracked poses.
+ */
+class MITKLANCETGEOUTIL_EXPORT SurfaceCollisionService : public itk::Object
+{
+public:
+  mitkClassMacroItkParent(SurfaceCollisionService, itk::Object);
+  itkNewMacro(Self)
+
+  struct Result
+  {
+    double distance{ 0.0 };         ///< smallest distance of a tool point outside the surface to it, 0 if a point is inside
+    double penetrationDepth{ 0.0 }; ///< largest distance of a tool point inside the surface to it, 0 if none is inside
+    unsigned int numberOfInsidePoints{ 0 };
+    double toolPoint[3]{ 0, 0, 0 };    ///< world, the tool point closest to the surface, or the deepest one
+    double surfacePoint[3]{ 0, 0, 0 }; ///< world, the surface point closest to toolPoint
+  };
+
+  /**
+   * \brief Registers surface under name, or replaces the surface registered under it.
+   * \param closed The surface bounds a volume; otherwise nothing is ever inside it.
+   */
+  void AddSurface(const std::string &name, mitk::Surface *surface, bool closed = true);
+
+  void RemoveSurface(const std::string &name);
+
+  void Clear();
+
+  bool HasSurface(const std::string &name);
+
+  /**
+   * \brief Sets the tool surface in tool coordinates. At most MaximumNumberOfToolPoints of its
+   * points, evenly picked, are tested.
+   */
+  void SetTool(vtkPolyData *tool);
+
+  itkSetMacro(MaximumNumberOfToolPoints, unsigned int);
+  itkGetMacro(MaximumNumberOfToolPoints, unsigned int);
+
+  unsigned int GetNumberOfToolPoints() const { return static_cast<unsigned int>(m_toolPoints.size() / 3); }
+
+  /**
+   * \brief Tests the tool at toolToWorld against the surface name.
+   * \return False if there is no such surface or no tool.
+   */
+  bool Query(const std::string &name, vtkMatrix4x4 *toolToWorld, Result &result);
+
+  /**
+   * \brief Signed distance of the world point to the surface name, negative inside a closed surface.
+   * \param surfacePoint If not null, receives the closest surface point in world coordinates.
+   * \return False if there is no such surface.
+   */
+  bool GetSignedDistance(const std::string &name, const double point[3], double &distance, double surfacePoint[3] = nullptr);
+
+  bool IsInside(const std::string &name, const double point[3]);
+
+  double GetLastQueryTime() const { return m_lastQueryTime; } ///< ms
+
+protected:
+  SurfaceCollisionService();
+  ~SurfaceCollisionService() override;
+
+private:
+  struct Entry
+  {
+    mitk::Surface::Pointer surface;
+    bool closed{ true };
+    vtkPolyData *polyData{ nullptr }; ///< the polydata the cache was built from
+    vtkMTimeType polyDataTime{ 0 };
+    vtkSmartPointer<vtkImplicitPolyDataDistance> distance;
+    double surfaceToWorld[16];
+    double worldToSurface[16];
+  };
+
+  Entry *Prepare(const std::string &name);
+  double Evaluate(Entry &entry, const double surfacePoint[3], double closestPoint[3]) const;
+
+  std::map<std::string, Entry> m_surfaces;
+  std::vector<double> m_toolPoints; ///< x, y, z in tool coordinates
+  unsigned int m_MaximumNumberOfToolPoints{ 256 };
+  double m_lastQueryTime{ 0.0 };
+};
+#endif // SURFACECOLLISIONSERVICE_H
@@ -0,0 +1,619 @@
+#include "bonemillingengine.h"
+
+#include <vtkCellArray.h>
+#include <vtkDiscreteFlyingEdges3D.h>
+#include <vtkImageData.h>
+#include <vtkImageStencilData.h>
+#include <vtkImageThreshold.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataToImageStencil.h>
+#include <vtkTransform.h>
+#include <vtkTransformPolyDataFilter.h>
+#include <vtkWindowedSincPolyDataFilter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+  // same surface as Polish::DiscreteFlyingEdges3D()
+  constexpr unsigned int smoothingIterations = 20;
+  constexpr double passBand = 0.01;
+  constexpr double featureAngle = 15.0;
+
+  // a jump longer than this many sweep steps is rasterized coarser
+  constexpr int maximumSweepSteps = 64;
+
+  // points or triangles reserved for a brick mesh of size, room to grow in place
+  vtkIdType WithSpare(vtkIdType size)
+  {
+    return size + size / 4 + 8;
+  }
+
+  double MillisecondsSince(std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+}
+
+BoneMillingEngine::BoneMillingEngine()
+{
+  m_brickImage = vtkSmartPointer<vtkImageData>::New();
+
+  m_flyingEdgeFilter = vtkSmartPointer<vtkDiscreteFlyingEdges3D>::New();
+  m_flyingEdgeFilter->SetInputData(m_brickImage);
+  m_flyingEdgeFilter->SetValue(0, 1);
+  m_flyingEdgeFilter->SetComputeGradients(false);
+  m_flyingEdgeFilter->SetComputeNormals(false);
+  m_flyingEdgeFilter->SetComputeScalars(true);
+
+  m_wsFilter = vtkSmartPointer<vtkWindowedSincPolyDataFilter>::New();
+  m_wsFilter->SetInputConnection(m_flyingEdgeFilter->GetOutputPort());
+  m_wsFilter->SetNumberOfIterations(smoothingIterations);
+  m_wsFilter->SetFeatureEdgeSmoothing(false);
+  // fixed boundary vertices are what stitches a brick to its neighbours
+  m_wsFilter->SetBoundarySmoothing(false);
+  m_wsFilter->SetEdgeAngle(15);
+  m_wsFilter->SetFeatureAngle(featureAngle);
+  m_wsFilter->SetPassBand(passBand);
+  m_wsFilter->SetNonManifoldSmoothing(false);
+  m_wsFilter->SetNormalizeCoordinates(false);
+
+  m_toWorldFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+  m_toWorldFilter->SetInputConnection(m_wsFilter->GetOutputPort());
+
+  m_toolToIndex = vtkSmartPointer<vtkTransform>::New();
+  m_toolFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+  m_toolFilter->SetTransform(m_toolToIndex);
+
+  // the tool is stenciled in index coordinates of the mask
+  m_stencilFilter = vtkSmartPointer<vtkPolyDataToImageStencil>::New();
+  m_stencilFilter->SetInputConnection(m_toolFilter->GetOutputPort());
+  m_stencilFilter->SetOutputOrigin(0, 0, 0);
+  m_stencilFilter->SetOutputSpacing(1, 1, 1);
+
+  m_surface = mitk::Surface::New();
+  m_surface->SetVtkPolyData(vtkSmartPointer<vtkPolyData>::New());
+}
+
+BoneMillingEngine::~BoneMillingEngine()
+{
+}
+
+void BoneMillingEngine::Initialize(mitk::Image *boneImage)
+{
+  Reset();
+  if (boneImage == nullptr || !boneImage->IsInitialized() || boneImage->GetVtkImageData() == nullptr)
+  {
+    MITK_ERROR << "BoneMillingEngine: no bone image";
+    return;
+  }
+
+  vtkNew<vtkImageThreshold> threshold;
+  threshold->SetInputData(boneImage->GetVtkImageData());
+  threshold->ThresholdBetween(1, 1);
+  threshold->SetInValue(1);
+  threshold->SetOutValue(0);
+  threshold->ReplaceInOn();
+  threshold->ReplaceOutOn();
+  threshold->SetOutputScalarTypeToUnsignedChar();
+  threshold->Update();
+
+  m_geometry = boneImage->GetGeometry()->Clone();
+  // milled in place through m_mask, GetMaskImage() hands out the image itself
+  m_maskImage = mitk::Image::New();
+  m_maskImage->Initialize(mitk::MakeScalarPixelType<unsigned char>(), *m_geometry);
+  m_maskImage->SetVolume(threshold->GetOutput()->GetScalarPointer());
+  m_mask = m_maskImage->GetVtkImageData();
+  m_mask->GetDimensions(m_dimensions);
+
+  vtkNew<vtkTransform> indexToWorld;
+  indexToWorld->SetMatrix(m_geometry->GetVtkMatrix());
+  m_toWorldFilter->SetTransform(indexToWorld);
+
+  // bricks own the cells, i.e. the voxel pairs, starting in them
+  int numberOfBricks = 1;
+  for (int i = 0; i < 3; ++i)
+  {
+    m_bricks[i] = std::max(0, (m_dimensions[i] - 1 + BrickSize - 1) / BrickSize);
+    numberOfBricks *= m_bricks[i];
+  }
+  m_brickMeshes.assign(numberOfBricks, nullptr);
+  m_isDirty.assign(numberOfBricks, 1);
+  m_dirtyBricks.resize(numberOfBricks);
+  for (int brick = 0; brick < numberOfBricks; ++brick)
+  {
+    m_dirtyBricks[brick] = brick;
+  }
+  UpdateSurface();
+}
+
+void BoneMillingEngine::Reset()
+{
+  m_mask = nullptr;
+  m_maskImage = nullptr;
+  m_geometry = nullptr;
+  std::fill(m_dimensions, m_dimensions + 3, 0);
+  std::fill(m_bricks, m_bricks + 3, 0);
+  m_brickMeshes.clear();
+  m_isDirty.clear();
+  m_dirtyBricks.clear();
+  m_hasPreviousPose = false;
+  m_output = nullptr;
+  m_brickRanges.clear();
+  m_deadRanges.clear();
+  m_parkingBrick = -1;
+  m_parkingDirty = false;
+  m_numberOfUsedCells = 0;
+  m_surface->SetVtkPolyData(vtkSmartPointer<vtkPolyData>::New());
+}
+
+bool BoneMillingEngine::IsInitialized() const
+{
+  return m_mask != nullptr;
+}
+
+unsigned long BoneMillingEngine::Mill(mitk::Surface *tool)
+{
+  const auto start = std::chrono::steady_clock::now();
+  if (!IsInitialized() || tool == nullptr || tool->GetVtkPolyData() == nullptr)
+  {
+    return 0;
+  }
+  m_toolFilter->SetInputData(tool->GetVtkPolyData());
+
+  double worldToIndex[16];
+  vtkMatrix4x4::Invert(m_geometry->GetVtkMatrix()->GetData(), worldToIndex);
+  double toolToIndex[16];
+  vtkMatrix4x4::Multiply4x4(worldToIndex, tool->GetGeometry()->GetVtkMatrix()->GetData(), toolToIndex);
+
+  // sweep the tool along the translation since the previous pose in steps of at most m_SweepStep
+  // voxels, with the current orientation (the burr is rotationally symmetric)
+  int steps = 1;
+  if (m_hasPreviousPose && m_SweepStep > 0)
+  {
+    double distance = 0;
+    for (int row = 0; row < 3; ++row)
+    {
+      const double delta = toolToIndex[4 * row + 3] - m_previousToolToIndex[4 * row + 3];
+      distance += delta * delta;
+    }
+    steps = std::max(1, std::min(maximumSweepSteps, static_cast<int>(std::ceil(std::sqrt(distance) / m_SweepStep))));
+  }
+
+  unsigned long removed = 0;
+  double pose[16];
+  std::memcpy(pose, toolToIndex, sizeof(pose));
+  for (int step = 1; step <= steps; ++step)
+  {
+    if (steps > 1)
+    {
+      const double t = static_cast<double>(step) / steps;
+      for (int row = 0; row < 3; ++row)
+      {
+        const int i = 4 * row + 3;
+        pose[i] = m_previousToolToIndex[i] + t * (toolToIndex[i] - m_previousToolToIndex[i]);
+      }
+    }
+    removed += RasterizeTool(pose);
+  }
+
+  std::memcpy(m_previousToolToIndex, toolToIndex, sizeof(toolToIndex));
+  m_hasPreviousPose = true;
+  m_lastMillTime = MillisecondsSince(start);
+  return removed;
+}
+
+void BoneMillingEngine::ResetSweep()
+{
+  m_hasPreviousPose = false;
+}
+
+void BoneMillingEngine::UpdateSurface()
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int brick : m_dirtyBricks)
+  {
+    ExtractBrick(brick);
+    m_isDirty[brick] = 0;
+    if (m_output != nullptr)
+    {
+      PlaceBrick(brick);
+    }
+  }
+  m_numberOfUpdatedBricks = static_cast<unsigned long>(m_dirtyBricks.size());
+  m_dirtyBricks.clear();
+
+  if (m_output == nullptr || m_numberOfUsedCells < m_output->GetNumberOfPolys() / 2)
+  {
+    RebuildOutput();
+  }
+  else if (m_numberOfUpdatedBricks > 0)
+  {
+    ParkDeadRanges();
+    m_output->GetPoints()->Modified();
+    m_output->GetPolys()->Modified();
+    m_output->Modified();
+    m_surface->Modified();
+  }
+  m_lastUpdateTime = MillisecondsSince(start);
+}
+
+void BoneMillingEngine::RebuildOutput()
+{
+  // every brick mesh, already in world coordinates, gets its ranges with spare room
+  m_brickRanges.assign(m_brickMeshes.size(), BrickRange());
+  vtkIdType numberOfPoints = 0;
+  vtkIdType numberOfCells = 0;
+  for (size_t brick = 0; brick < m_brickMeshes.size(); ++brick)
+  {
+    vtkPolyData *mesh = m_brickMeshes[brick];
+    if (mesh == nullptr)
+    {
+      continue;
+    }
+    BrickRange &range = m_brickRanges[brick];
+    range.firstPoint = numberOfPoints;
+    range.pointCapacity = WithSpare(mesh->GetNumberOfPoints());
+    range.firstCell = numberOfCells;
+    range.cellCapacity = WithSpare(mesh->GetNumberOfPolys());
+    numberOfPoints += range.pointCapacity;
+    numberOfCells += range.cellCapacity;
+  }
+
+  auto points = vtkSmartPointer<vtkPoints>::New();
+  points->SetNumberOfPoints(numberOfPoints);
+  // triangles only, the offsets never change for a cell
+  auto polys = vtkSmartPointer<vtkCellArray>::New();
+  polys->Use64BitStorage();
+  vtkCellArray::ArrayType64 *offsets = polys->GetOffsetsArray64();
+  offsets->SetNumberOfValues(numberOfCells + 1);
+  for (vtkIdType cell = 0; cell <= numberOfCells; ++cell)
+  {
+    offsets->SetValue(cell, 3 * cell);
+  }
+  polys->GetConnectivityArray64()->SetNumberOfValues(3 * numberOfCells);
+
+  m_output = vtkSmartPointer<vtkPolyData>::New();
+  m_output->SetPoints(points);
+  m_output->SetPolys(polys);
+  m_deadRanges.clear();
+  m_parkingBrick = -1;
+  m_parkingDirty = false;
+  m_numberOfUsedCells = 0;
+  for (size_t brick = 0; brick < m_brickMeshes.size(); ++brick)
+  {
+    if (m_brickMeshes[brick] != nullptr)
+    {
+      WriteBrick(static_cast<int>(brick));
+    }
+  }
+  m_surface->SetVtkPolyData(m_output);
+}
+
+void BoneMillingEngine::PlaceBrick(int brick)
+{
+  vtkPolyData *mesh = m_brickMeshes[brick];
+  BrickRange &range = m_brickRanges[brick];
+  if (brick == m_parkingBrick)
+  {
+    // the parked ranges follow its first point
+    m_parkingDirty = true;
+  }
+  if (mesh == nullptr)
+  {
+    // milled through: keep the range to grow back into, parked meanwhile
+    ReleaseRange(range);
+    return;
+  }
+  if (mesh->GetNumberOfPoints() <= range.pointCapacity && mesh->GetNumberOfPolys() <= range.cellCapacity)
+  {
+    WriteBrick(brick);
+    return;
+  }
+
+  // outgrew its range: park it and append a larger one
+  if (range.pointCapacity > 0)
+  {
+    ReleaseRange(range);
+    m_deadRanges.push_back(range);
+  }
+
+  vtkPoints *points = m_output->GetPoints();
+  vtkCellArray *polys = m_output->GetPolys();
+  range.firstPoint = points->GetNumberOfPoints();
+  range.pointCapacity = WithSpare(mesh->GetNumberOfPoints());
+  range.firstCell = polys->GetNumberOfCells();
+  range.cellCapacity = WithSpare(mesh->GetNumberOfPolys());
+  // inserting past the end grows the arrays geometrically
+  points->InsertPoint(range.firstPoint + range.pointCapacity - 1, mesh->GetPoint(0));
+  vtkCellArray::ArrayType64 *offsets = polys->GetOffsetsArray64();
+  for (vtkIdType cell = range.firstCell + 1; cell <= range.firstCell + range.cellCapacity; ++cell)
+  {
+    offsets->InsertValue(cell, 3 * cell);
+  }
+  polys->GetConnectivityArray64()->InsertValue(3 * (range.firstCell + range.cellCapacity) - 1, 0);
+  WriteBrick(brick);
+}
+
+void BoneMillingEngine::WriteBrick(int brick)
+{
+  // the mesh exists and fits into the range, see PlaceBrick()
+  vtkPolyData *mesh = m_brickMeshes[brick];
+  BrickRange &range = m_brickRanges[brick];
+  vtkPoints *points = m_output->GetPoints();
+  vtkCellArray::ArrayType64 *connectivity = m_output->GetPolys()->GetConnectivityArray64();
+
+  const vtkIdType numberOfPoints = mesh->GetNumberOfPoints();
+  for (vtkIdType point = 0; point < numberOfPoints; ++point)
+  {
+    points->SetPoint(range.firstPoint + point, mesh->GetPoint(point));
+  }
+  // spare points repeat the first one so that they do not widen the bounds
+  double first[3];
+  mesh->GetPoint(0, first);
+  for (vtkIdType point = numberOfPoints; point < range.pointCapacity; ++point)
+  {
+    points->SetPoint(range.firstPoint + point, first);
+  }
+
+  m_numberOfUsedCells -= range.numberOfCells;
+  vtkIdType cell = range.firstCell;
+  vtkIdType cellSize;
+  const vtkIdType *cellPoints;
+  vtkCellArray *polys = mesh->GetPolys();
+  for (polys->InitTraversal(); polys->GetNextCell(cellSize, cellPoints);)
+  {
+    if (cellSize != 3)
+    {
+      continue;
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+      connectivity->SetValue(3 * cell + k, range.firstPoint + cellPoints[k]);
+    }
+    ++cell;
+  }
+  range.numberOfCells = cell - range.firstCell;
+  m_numberOfUsedCells += range.numberOfCells;
+  // spare triangles collapse onto the first point and render nothing
+  for (; cell < range.firstCell + range.cellCapacity; ++cell)
+  {
+    for (int k = 0; k < 3; ++k)
+    {
+      connectivity->SetValue(3 * cell + k, range.firstPoint);
+    }
+  }
+}
+
+void BoneMillingEngine::ReleaseRange(BrickRange &range)
+{
+  m_numberOfUsedCells -= range.numberOfCells;
+  range.numberOfCells = 0;
+  m_parkingDirty = true;
+}
+
+void BoneMillingEngine::ParkDeadRanges()
+{
+  if (!m_parkingDirty)
+  {
+    return;
+  }
+  m_parkingDirty = false;
+  if (m_parkingBrick < 0 || m_brickMeshes[m_parkingBrick] == nullptr)
+  {
+    m_parkingBrick = -1;
+    for (size_t brick = 0; brick < m_brickMeshes.size() && m_parkingBrick < 0; ++brick)
+    {
+      if (m_brickMeshes[brick] != nullptr)
+      {
+        m_parkingBrick = static_cast<int>(brick);
+      }
+    }
+    if (m_parkingBrick < 0)
+    {
+      return;
+    }
+  }
+
+  // stale points would still count for the bounds, both of the points and of the cells
+  const vtkIdType parking = m_brickRanges[m_parkingBrick].firstPoint;
+  double coordinates[3];
+  m_output->GetPoint(parking, coordinates);
+  for (size_t brick = 0; brick < m_brickMeshes.size(); ++brick)
+  {
+    if (m_brickMeshes[brick] == nullptr)
+    {
+      ParkRange(m_brickRanges[brick], parking, coordinates);
+    }
+  }
+  for (const BrickRange &range : m_deadRanges)
+  {
+    ParkRange(range, parking, coordinates);
+  }
+}
+
+void BoneMillingEngine::ParkRange(const BrickRange &range, vtkIdType point, const double coordinates[3])
+{
+  vtkPoints *points = m_output->GetPoints();
+  for (vtkIdType i = range.firstPoint; i < range.firstPoint + range.pointCapacity; ++i)
+  {
+    points->SetPoint(i, coordinates);
+  }
+  vtkCellArray::ArrayType64 *connectivity = m_output->GetPolys()->GetConnectivityArray64();
+  for (vtkIdType i = 3 * range.firstCell; i < 3 * (range.firstCell + range.cellCapacity); ++i)
+  {
+    connectivity->SetValue(i, point);
+  }
+}
+
+mitk::Surface::Pointer BoneMillingEngine::GetSurface() const
+{
+  return m_surface;
+}
+
+mitk::Image::Pointer BoneMillingEngine::GetMaskImage() const
+{
+  return m_maskImage;
+}
+
+void BoneMillingEngine::MarkDirty(int x0, int x1, int y, int z)
+{
+  // a voxel is a corner of the cells starting at it and at its lower neighbours
+  const int low[3] = { x0 - 1, y - 1, z - 1 };
+  const int high[3] = { x1, y, z };
+  int first[3];
+  int last[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    first[i] = std::max(low[i], 0) / BrickSize;
+    last[i] = std::min(high[i] / BrickSize, m_bricks[i] - 1);
+    if (first[i] > last[i])
+    {
+      return;
+    }
+  }
+  for (int bz = first[2]; bz <= last[2]; ++bz)
+  {
+    for (int by = first[1]; by <= last[1]; ++by)
+    {
+      for (int bx = first[0]; bx <= last[0]; ++bx)
+      {
+        const int brick = bx + m_bricks[0] * (by + m_bricks[1] * bz);
+        if (!m_isDirty[brick])
+        {
+          m_isDirty[brick] = 1;
+          m_dirtyBricks.push_back(brick);
+        }
+      }
+    }
+  }
+}
+
+void BoneMillingEngine::ExtractBrick(int brick)
+{
+  const int position[3] = {
+    brick % m_bricks[0], (brick / m_bricks[0]) % m_bricks[1], brick / (m_bricks[0] * m_bricks[1]) };
+  int extent[6];
+  for (int i = 0; i < 3; ++i)
+  {
+    extent[2 * i] = position[i] * BrickSize;
+    extent[2 * i + 1] = std::min(extent[2 * i] + BrickSize, m_dimensions[i] - 1);
+  }
+
+  m_brickImage->SetExtent(extent);
+  m_brickImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char *brickVoxel = static_cast<unsigned char *>(m_brickImage->GetScalarPointer());
+  const int rowLength = extent[1] - extent[0] + 1;
+  unsigned char anyBone = 0;
+  unsigned char allBone = 1;
+  for (int z = extent[4]; z <= extent[5]; ++z)
+  {
+    for (int y = extent[2]; y <= extent[3]; ++y)
+    {
+      const unsigned char *voxel = Voxel(extent[0], y, z);
+      std::memcpy(brickVoxel, voxel, rowLength);
+      for (int x = 0; x < rowLength; ++x)
+      {
+        anyBone |= voxel[x];
+        allBone &= voxel[x];
+      }
+      brickVoxel += rowLength;
+    }
+  }
+  // no bone boundary inside the brick
+  if (anyBone == allBone)
+  {
+    m_brickMeshes[brick] = nullptr;
+    return;
+  }
+
+  m_brickImage->Modified();
+  m_toWorldFilter->Update();
+  vtkPolyData *output = m_toWorldFilter->GetOutput();
+  if (output->GetNumberOfPolys() == 0)
+  {
+    m_brickMeshes[brick] = nullptr;
+    return;
+  }
+  auto mesh = vtkSmartPointer<vtkPolyData>::New();
+  mesh->DeepCopy(output);
+  m_brickMeshes[brick] = mesh;
+}
+
+unsigned long BoneMillingEngine::RasterizeTool(const double toolToIndex[16])
+{
+  m_toolToIndex->SetMatrix(toolToIndex);
+  m_toolFilter->Update();
+
+  // only the voxel centers inside the tool bounds
+  double bounds[6];
+  m_toolFilter->GetOutput()->GetBounds(bounds);
+  int extent[6];
+  for (int i = 0; i < 3; ++i)
+  {
+    const double maximum = m_dimensions[i] - 1;
+    extent[2 * i] = static_cast<int>(std::max(0.0, std::ceil(bounds[2 * i])));
+    extent[2 * i + 1] = static_cast<int>(std::min(maximum, std::floor(bounds[2 * i + 1])));
+    if (!(bounds[2 * i] <= bounds[2 * i + 1]) || bounds[2 * i] > maximum || bounds[2 * i + 1] < 0
+        || extent[2 * i] > extent[2 * i + 1])
+    {
+      return 0;
+    }
+  }
+
+  m_stencilFilter->SetOutputWholeExtent(extent);
+  m_stencilFilter->Update();
+  vtkImageStencilData *stencil = m_stencilFilter->GetOutput();
+
+  unsigned long removed = 0;
+  for (int z = extent[4]; z <= extent[5]; ++z)
+  {
+    for (int y = extent[2]; y <= extent[3]; ++y)
+    {
+      int iter = 0;
+      int r1;
+      int r2;
+      while (stencil->GetNextExtent(r1, r2, extent[0], extent[1], y, z, iter))
+      {
+        unsigned char *voxel = Voxel(r1, y, z);
+        int first = -1;
+        int last = -1;
+        for (int x = r1; x <= r2; ++x, ++voxel)
+        {
+          if (*voxel)
+          {
+            *voxel = 0;
+            ++removed;
+            if (first < 0)
+            {
+              first = x;
+            }
+            last = x;
+          }
+        }
+        if (first >= 0)
+        {
+          MarkDirty(first, last, y, z);
+        }
+      }
+    }
+  }
+  if (removed > 0)
+  {
+    m_mask->Modified();
+    m_maskImage->Modified();
+  }
+  return removed;
+}
+
+unsigned char *BoneMillingEngine::Voxel(int x, int y, int z)
+{
+  return static_cast<unsigned char *>(m_mask->GetScalarPointer())
+    + x + static_cast<vtkIdType>(m_dimensions[0]) * (y + static_cast<vtkIdType>(m_dimensions[1]) * z);
+}
@@ -14,6 +14,29 @@ found in the LICENSE file.
 #include "mitkDataNode.h"
 #include "mitkApplyTransformMatrixOperation.h"
 #include "mitkInteractionConst.h"
+#include "mitkRenderingManager.h"
+
+#include <algorithm>
+
+#include <QTimer>
+#include <vtkMatrix4x4.h>
+
+NodeBinder::NodeBinder()
+	: m_worldToAttachment(vtkSmartPointer<vtkMatrix4x4>::New()),
+	m_trailingTimer(new QTimer())
+{
+	mitk::Point3D ref;
+	ref.Fill(0);
+	m_operation.reset(new mitk::ApplyTransformMatrixOperation(mitk::OpAPPLYTRANSFORMMATRIX, m_worldToAttachment, ref));
+
+	// the connection goes with the timer, which goes with this
+	m_trailingTimer->setSingleShot(true);
+	QObject::connect(m_trailingTimer.get(), &QTimer::timeout, [this]() { Flush(); });
+}
+
+NodeBinder::~NodeBinder()
+{
+}
 
 void NodeBinder::Execute(itk::Object *caller, const itk::EventObject &event)
 {
@@ -23,37 +46,68 @@ void NodeBinder::Execute(itk::Object *caller, const itk::EventObject &event)
 		MITK_ERROR << "Execute nodeBinder Error: caller Geometry null";
 		return;
 	}
-	//auto Tg2ref = basedata_caller->GetGeometry()->GetVtkMatrix();
-
-	const auto Tg2ref = callerGeometry->GetVtkMatrix();
-	// if (m_matrixList.empty())
-	// {
-	//   MITK_ERROR << "Execute nodeBinder Error: matrix null";
-	//   return;
-	// }
-	for (auto& name_node_pair : m_attachmentList)
+	if (m_isApplying)
+	{
+		// a change caused by the running batch
+		return;
+	}
+
+	const auto sinceLastBatch = std::chrono::steady_clock::now() - m_lastBatch;
+	if (m_minimumInterval.count() > 0 && m_numberOfBatches > 0 && sinceLastBatch < m_minimumInterval)
 	{
-		auto Tg2attach = vtkMatrix4x4::New();
-		auto iter = m_matrixList.find(name_node_pair.first);
-		if (iter == m_matrixList.end())
+		// the next batch reads the newest reference pose anyway
+		m_isPending = true;
+		++m_numberOfCoalescedEvents;
+		if (!m_trailingTimer->isActive())
 		{
-			MITK_ERROR << "Execute nodeBinder Error: can not find Matrix match the node";
-			return;
+			const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(m_minimumInterval - sinceLastBatch);
+			m_trailingTimer->start(static_cast<int>(remaining.count()) + 1);
 		}
-		auto Tref2attach = iter->second;
-		vtkMatrix4x4::Multiply4x4(Tg2ref, Tref2attach, Tg2attach);
+		return;
+	}
+	ApplyBinding(callerGeometry);
+}
 
-		double ref[3]{ 0, 0, 0 };
-		auto op = new mitk::ApplyTransformMatrixOperation(mitk::OpAPPLYTRANSFORMMATRIX, Tg2attach, ref);
-		if (name_node_pair.second == nullptr)
+void NodeBinder::ApplyBinding(mitk::BaseGeometry *refGeometry)
+{
+	m_isApplying = true;
+	m_isPending = false;
+	m_trailingTimer->stop();
+
+	//Tg2attach = Tg2ref * Tref2attach
+	const double *Tg2ref = refGeometry->GetVtkMatrix()->GetData();
+	bool isAnyModified = false;
+	for (Attachment &attachment : m_attachments)
+	{
+		if (!attachment.isBound || attachment.node == nullptr || attachment.node->GetData() == nullptr)
 		{
-			MITK_ERROR << "Execute nodeBinder Error: attachmentNode null ";
-			return;
+			continue;
 		}
-		name_node_pair.second->GetData()->GetGeometry()->ExecuteOperation(op);
-		delete op;
+		mitk::BaseGeometry *geometry = attachment.node->GetData()->GetGeometry();
+
+		double Tg2attach[16];
+		vtkMatrix4x4::Multiply4x4(Tg2ref, attachment.refToAttachment, Tg2attach);
+		const double *current = geometry->GetVtkMatrix()->GetData();
+		if (std::equal(Tg2attach, Tg2attach + 16, current))
+		{
+			// already in place, no modified event
+			continue;
+		}
+
+		m_worldToAttachment->DeepCopy(Tg2attach);
+		geometry->ExecuteOperation(m_operation.get());
+		isAnyModified = true;
+	}
+
+	m_isApplying = false;
+	m_lastBatch = std::chrono::steady_clock::now();
+	++m_numberOfBatches;
+
+	if (isAnyModified && m_RequestRenderUpdate)
+	{
+		// one render request for the whole group
+		mitk::RenderingManager::GetInstance()->RequestUpdateAll();
 	}
- 
 }
 
 void NodeBinder::Execute(const itk::Object *caller, const itk::EventObject &event)
@@ -82,7 +136,17 @@ void NodeBinder::AddBindingNode(mitk::DataNode *attachment)
     MITK_ERROR << "binding failed: bind null dataNode";
     return;
   }
-  m_attachmentList.insert_or_assign(attachment->GetName(), attachment);
+  // one attachment per name, a new node replaces the old one
+  const std::string name = attachment->GetName();
+  auto iter = std::find_if(m_attachments.begin(), m_attachments.end(),
+    [&name](const Attachment &item) { return item.name == name; });
+  if (iter == m_attachments.end())
+  {
+    iter = m_attachments.insert(m_attachments.end(), Attachment());
+    iter->name = name;
+  }
+  iter->node = attachment;
+  iter->isBound = false;
 }
 
 void NodeBinder::SetReferenceNode(mitk::DataNode *ref_node)
@@ -99,34 +163,32 @@ void NodeBinder::UpdateBinding()
   }
   MITK_INFO << "[nodeBinder]";
   MITK_INFO << "--------------------------------------------";
-  for (auto &kv : m_attachmentList)
+  //Cal Transform Matrix
+  //get global coords of reference node
+  double Tref2g[16];
+  vtkMatrix4x4::Invert(m_refNode->GetData()->GetGeometry()->GetVtkMatrix()->GetData(), Tref2g);
+  for (Attachment &attachment : m_attachments)
   {
-    MITK_INFO << kv.first << " -> " << m_refNode->GetName();
+    MITK_INFO << attachment.name << " -> " << m_refNode->GetName();
 
-    //Cal Transform Matrix
-    //get global coords of reference node
-    auto Tg2ref = m_refNode->GetData()->GetGeometry()->GetVtkMatrix();
     //get global coords of attachment node
-    auto Tg2attach = kv.second->GetData()->GetGeometry()->GetVtkMatrix();
-
-    vtkMatrix4x4 *Tref2g = vtkMatrix4x4::New();
-    vtkMatrix4x4::Invert(Tg2ref, Tref2g);
-
-    vtkMatrix4x4 *Tref2attach = vtkMatrix4x4::New();
-    vtkMatrix4x4::Multiply4x4(Tref2g, Tg2attach, Tref2attach);
-
-    m_matrixList.insert_or_assign(kv.first, Tref2attach);
+    const double *Tg2attach = attachment.node->GetData()->GetGeometry()->GetVtkMatrix()->GetData();
+    vtkMatrix4x4::Multiply4x4(Tref2g, Tg2attach, attachment.refToAttachment);
+    attachment.isBound = true;
   }
   MITK_INFO << "--------------------------------------------";
 }
 
 void NodeBinder::DisableBind()
 {
-  if (m_refNode == nullptr)
+  if (m_observedGeometry == nullptr)
   {
+    m_isBind = false;
     return;
   }
-  m_refNode->RemoveObserver(m_commandTag);
+  Flush();
+  m_observedGeometry->RemoveObserver(m_commandTag);
+  m_observedGeometry = nullptr;
   m_isBind = false;
 }
 
@@ -137,7 +199,31 @@ void NodeBinder::EnableBind()
       MITK_ERROR << "Node Binder Enable faild: reference node null";
     return;
   }
+  DisableBind();
   UpdateBinding();
-  m_refNode->GetData()->GetGeometry()->AddObserver(itk::ModifiedEvent(), this);
+  m_observedGeometry = m_refNode->GetData()->GetGeometry();
+  m_commandTag = m_observedGeometry->AddObserver(itk::ModifiedEvent(), this);
+  m_numberOfBatches = 0;
+  m_numberOfCoalescedEvents = 0;
   m_isBind = true;
 }
+
+void NodeBinder::SetMaximumUpdateRate(double hz)
+{
+  m_minimumInterval = hz > 0
+    ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / hz))
+    : std::chrono::steady_clock::duration::zero();
+}
+
+double NodeBinder::GetMaximumUpdateRate() const
+{
+  return m_minimumInterval.count() > 0 ? 1.0 / std::chrono::duration<double>(m_minimumInterval).count() : 0.0;
+}
+
+void NodeBinder::Flush()
+{
+  if (m_isPending && m_observedGeometry != nullptr)
+  {
+    ApplyBinding(m_observedGeometry);
+  }
+}
@@ -55,6 +55,7 @@ Polish::Polish()
   m_flyingEdgeFilter = vtkDiscreteFlyingEdges3D::New();
   m_wsFilter = vtkWindowedSincPolyDataFilter::New();
   m_surface2imagefilter = mitk::SurfaceToImageFilter::New();
+  m_millingEngine = BoneMillingEngine::New();
 
   m_MultiThreader = itk::PlatformMultiThreader::New();
   /*m_PolishFinishedMutex = itk::FastMutexLock::New();
@@ -144,10 +145,30 @@ void Polish::doPolish()
 void Polish::run()
 {
   Timer timer{"polish"};
-  //1.use tool surface to cut bone image
-  SurfaceCutImage(m_toolSurface, m_resImage, true, true);
-  //2.turn res image into surface
-  m_resSurface = DiscreteFlyingEdges3D(m_resImage);
+  //1.voxelize the bone and extract its surface once
+  if (!m_millingEngine->IsInitialized())
+  {
+    m_millingEngine->Initialize(m_boneImage);
+  }
+  //2.remove the voxels swept by the tool, re-extract only the changed bricks
+  m_millingEngine->Mill(m_toolSurface);
+  m_millingEngine->UpdateSurface();
+  m_resSurface = m_millingEngine->GetSurface();
+  if (m_boneSurface.IsNotNull())
+  {
+    // the engine edits the same polydata in place, SetVtkPolyData() alone does not notice
+    m_boneSurface->SetVtkPolyData(m_resSurface->GetVtkPolyData());
+    m_boneSurface->Modified();
+  }
+}
+
+mitk::Image::Pointer Polish::GetresImage()
+{
+  if (m_millingEngine->IsInitialized())
+  {
+    m_resImage = m_millingEngine->GetMaskImage();
+  }
+  return m_resImage;
 }
 
 void Polish::run2()
@@ -17,9 +17,14 @@ found in the LICENSE file.
 #include "mitkSurface.h"
 #include "mitkSurfaceOperation.h"
 #include <vtkCleanPolyData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkTransform.h>
+#include <vtkTransformPolyDataFilter.h>
 #include <vtkTriangleFilter.h>
 #include <vtkBooleanOperationPolyDataFilter.h>
 
+#include <algorithm>
+
 void SurfaceBoolean::Execute(itk::Object *caller, const itk::EventObject &event)
 {
   Execute((const itk::Object *)caller, event);
@@ -33,24 +38,49 @@ void SurfaceBoolean::Execute(const itk::Object *caller, const itk::EventObject &
     assert(refsurface);
     auto movesurface = dynamic_cast<mitk::Surface*> (m_MoveNode->GetData());
 
+  auto movePolyData = movesurface->GetVtkPolyData();
+  auto refPolyData = refsurface->GetVtkPolyData();
+  // the cutter in the local frame of the reference, the boolean result is stored there
+  vtkNew<vtkMatrix4x4> worldToRef;
+  vtkMatrix4x4::Invert(refsurface->GetGeometry()->GetVtkMatrix(), worldToRef);
+  vtkNew<vtkMatrix4x4> moveToRef;
+  vtkMatrix4x4::Multiply4x4(worldToRef, movesurface->GetGeometry()->GetVtkMatrix(), moveToRef);
+  // cutting the result of the last boolean again with the same cutter at the same pose is a no-op
+  if (refPolyData == m_LastResult && refPolyData->GetMTime() == m_LastResultTime && m_CleanedMove != nullptr
+      && movePolyData == m_CleanedMoveSource && movePolyData->GetMTime() == m_CleanedMoveTime
+      && std::equal(m_LastMoveToRef, m_LastMoveToRef + 16, moveToRef->GetData()))
+  {
+    return;
+  }
+
   const clock_t cleanPolydata_start  = clock();
-  //clean polydata first
-  vtkNew<vtkTriangleFilter> tri1;
-  tri1->SetInputData(movesurface->GetVtkPolyData());
-  vtkNew<vtkCleanPolyData> clean1;
-  clean1->SetInputConnection(tri1->GetOutputPort());
-  clean1->Update();
-  auto input1 = clean1->GetOutput();
-
-  vtkNew<vtkTriangleFilter> tri2;
-  tri2->SetInputData(refsurface->GetVtkPolyData());
-  vtkNew<vtkCleanPolyData> clean2;
-  clean2->SetInputConnection(tri2->GetOutputPort());
-  clean2->Update();
-  auto input2 = clean2->GetOutput();
+  //clean polydata first, only the inputs that changed since the last event
+  auto cleanedMove = CleanInput(movePolyData, m_CleanedMove, m_CleanedMoveSource, m_CleanedMoveTime);
+  auto input2 = CleanInput(refPolyData, m_CleanedRef, m_CleanedRefSource, m_CleanedRefTime);
+
+  vtkNew<vtkTransform> transform;
+  transform->SetMatrix(moveToRef);
+  vtkNew<vtkTransformPolyDataFilter> transformFilter;
+  transformFilter->SetTransform(transform);
+  transformFilter->SetInputData(cleanedMove);
+  transformFilter->Update();
+  auto input1 = transformFilter->GetOutput();
 
   float cleanPolydata_end = float(clock() - cleanPolydata_start) / CLOCKS_PER_SEC;
   MITK_INFO << "image clean time is " << cleanPolydata_end ;
+
+  // disjoint bounds, the reference minus the cutter is the reference itself
+  double moveBounds[6];
+  double refBounds[6];
+  input1->GetBounds(moveBounds);
+  input2->GetBounds(refBounds);
+  for (int i = 0; i < 3; ++i)
+  {
+    if (moveBounds[2 * i] > refBounds[2 * i + 1] || refBounds[2 * i] > moveBounds[2 * i + 1])
+    {
+      return;
+    }
+  }
   //boolean
   vtkNew<vtkBooleanOperationPolyDataFilter> booleanOperation;
   // if (operation == "union")
@@ -72,8 +102,9 @@ void SurfaceBoolean::Execute(const itk::Object *caller, const itk::EventObject &
   // }
   const clock_t boolean_start = clock();
   booleanOperation->SetOperationToDifference();
-  booleanOperation->SetInputData(0, input1);
-  booleanOperation->SetInputData(1, input2);
+  // reference minus cutter
+  booleanOperation->SetInputData(0, input2);
+  booleanOperation->SetInputData(1, input1);
   booleanOperation->Update();
 
   float boolean_end = float(clock() - boolean_start) / CLOCKS_PER_SEC;
@@ -82,16 +113,39 @@ void SurfaceBoolean::Execute(const itk::Object *caller, const itk::EventObject &
   auto op = new mitk::SurfaceOperation(mitk::OpSURFACECHANGED, booleanOperation->GetOutput(),0);
   refsurface->ExecuteOperation(op);
   delete op;
+  m_LastResult = refsurface->GetVtkPolyData();
+  m_LastResultTime = m_LastResult->GetMTime();
+  std::copy(moveToRef->GetData(), moveToRef->GetData() + 16, m_LastMoveToRef);
+}
+
+vtkPolyData* SurfaceBoolean::CleanInput(vtkPolyData* input, vtkSmartPointer<vtkPolyData>& cleaned, vtkPolyData*& source, vtkMTimeType& sourceTime)
+{
+  if (cleaned != nullptr && source == input && sourceTime == input->GetMTime())
+  {
+    return cleaned;
+  }
+  vtkNew<vtkTriangleFilter> tri;
+  tri->SetInputData(input);
+  vtkNew<vtkCleanPolyData> clean;
+  clean->SetInputConnection(tri->GetOutputPort());
+  clean->Update();
+  cleaned = clean->GetOutput();
+  source = input;
+  sourceTime = input->GetMTime();
+  return cleaned;
 }
 
 void SurfaceBoolean::SetMovingNode(mitk::DataNode *move_node)
 {
     m_MoveNode = move_node;
+    m_CleanedMove = nullptr;
 }
 
 void SurfaceBoolean::SetReferenceNode(mitk::DataNode *ref_node)
 {
   m_RefNode = ref_node;
+  m_CleanedRef = nullptr;
+  m_LastResult = nullptr;
 }
 
 void SurfaceBoolean::Update()
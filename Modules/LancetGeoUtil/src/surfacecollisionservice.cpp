@@ -0,0 +1,198 @@
+#include "surfacecollisionservice.h"
+
+#include <vtkImplicitPolyDataDistance.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPolyData.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+  void TransformPoint(const double matrix[16], const double point[3], double out[3])
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      out[i] = matrix[4 * i] * point[0] + matrix[4 * i + 1] * point[1] + matrix[4 * i + 2] * point[2] + matrix[4 * i + 3];
+    }
+  }
+
+  double Distance(const double a[3], const double b[3])
+  {
+    return std::sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+  }
+}
+
+SurfaceCollisionService::SurfaceCollisionService()
+{
+}
+
+SurfaceCollisionService::~SurfaceCollisionService()
+{
+}
+
+void SurfaceCollisionService::AddSurface(const std::string &name, mitk::Surface *surface, bool closed)
+{
+  if (surface == nullptr)
+  {
+    m_surfaces.erase(name);
+    return;
+  }
+  Entry &entry = m_surfaces[name];
+  if (entry.surface != surface || entry.closed != closed)
+  {
+    entry = Entry();
+    entry.surface = surface;
+    entry.closed = closed;
+  }
+}
+
+void SurfaceCollisionService::RemoveSurface(const std::string &name)
+{
+  m_surfaces.erase(name);
+}
+
+void SurfaceCollisionService::Clear()
+{
+  m_surfaces.clear();
+}
+
+bool SurfaceCollisionService::HasSurface(const std::string &name)
+{
+  return m_surfaces.count(name) > 0;
+}
+
+void SurfaceCollisionService::SetTool(vtkPolyData *tool)
+{
+  m_toolPoints.clear();
+  if (tool == nullptr || tool->GetNumberOfPoints() == 0)
+  {
+    return;
+  }
+
+  const vtkIdType numberOfPoints = tool->GetNumberOfPoints();
+  const vtkIdType numberOfSamples = std::min<vtkIdType>(numberOfPoints, std::max(1u, m_MaximumNumberOfToolPoints));
+  m_toolPoints.reserve(3 * numberOfSamples);
+  for (vtkIdType i = 0; i < numberOfSamples; ++i)
+  {
+    double point[3];
+    tool->GetPoint(i * numberOfPoints / numberOfSamples, point);
+    m_toolPoints.insert(m_toolPoints.end(), point, point + 3);
+  }
+}
+
+bool SurfaceCollisionService::Query(const std::string &name, vtkMatrix4x4 *toolToWorld, Result &result)
+{
+  const auto start = std::chrono::steady_clock::now();
+  result = Result();
+  Entry *entry = Prepare(name);
+  if (entry == nullptr || toolToWorld == nullptr || m_toolPoints.empty())
+  {
+    return false;
+  }
+
+  // tool to surface, so the tool points go straight into the coordinates of the cached locator
+  double toolToSurface[16];
+  vtkMatrix4x4::Multiply4x4(entry->worldToSurface, toolToWorld->GetData(), toolToSurface);
+
+  double nearest = std::numeric_limits<double>::max();
+  for (size_t i = 0; i < m_toolPoints.size(); i += 3)
+  {
+    double surfacePoint[3];
+    double closestPoint[3];
+    TransformPoint(toolToSurface, &m_toolPoints[i], surfacePoint);
+    const double signedDistance = Evaluate(*entry, surfacePoint, closestPoint);
+
+    double toolPointWorld[3];
+    double closestPointWorld[3];
+    TransformPoint(toolToWorld->GetData(), &m_toolPoints[i], toolPointWorld);
+    TransformPoint(entry->surfaceToWorld, closestPoint, closestPointWorld);
+    const double distance = Distance(toolPointWorld, closestPointWorld);
+
+    if (signedDistance < 0)
+    {
+      if (result.numberOfInsidePoints++ == 0 || distance > result.penetrationDepth)
+      {
+        result.penetrationDepth = distance;
+        std::memcpy(result.toolPoint, toolPointWorld, sizeof(toolPointWorld));
+        std::memcpy(result.surfacePoint, closestPointWorld, sizeof(closestPointWorld));
+      }
+    }
+    else if (result.numberOfInsidePoints == 0 && distance < nearest)
+    {
+      nearest = distance;
+      std::memcpy(result.toolPoint, toolPointWorld, sizeof(toolPointWorld));
+      std::memcpy(result.surfacePoint, closestPointWorld, sizeof(closestPointWorld));
+    }
+  }
+  result.distance = result.numberOfInsidePoints > 0 ? 0.0 : nearest;
+  m_lastQueryTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  return true;
+}
+
+bool SurfaceCollisionService::GetSignedDistance(const std::string &name, const double point[3], double &distance, double surfacePoint[3])
+{
+  Entry *entry = Prepare(name);
+  if (entry == nullptr)
+  {
+    return false;
+  }
+
+  double localPoint[3];
+  double closestPoint[3];
+  double closestPointWorld[3];
+  TransformPoint(entry->worldToSurface, point, localPoint);
+  const double signedDistance = Evaluate(*entry, localPoint, closestPoint);
+  TransformPoint(entry->surfaceToWorld, closestPoint, closestPointWorld);
+  distance = std::copysign(Distance(point, closestPointWorld), signedDistance);
+  if (surfacePoint != nullptr)
+  {
+    std::memcpy(surfacePoint, closestPointWorld, sizeof(closestPointWorld));
+  }
+  return true;
+}
+
+bool SurfaceCollisionService::IsInside(const std::string &name, const double point[3])
+{
+  double distance;
+  return GetSignedDistance(name, point, distance) && distance < 0;
+}
+
+SurfaceCollisionService::Entry *SurfaceCollisionService::Prepare(const std::string &name)
+{
+  auto it = m_surfaces.find(name);
+  if (it == m_surfaces.end())
+  {
+    return nullptr;
+  }
+  Entry &entry = it->second;
+  vtkPolyData *polyData = entry.surface->GetVtkPolyData();
+  if (polyData == nullptr || polyData->GetNumberOfCells() == 0)
+  {
+    return nullptr;
+  }
+
+  if (entry.distance == nullptr || entry.polyData != polyData || entry.polyDataTime != polyData->GetMTime())
+  {
+    // normals and locator are computed here once, queries only evaluate
+    entry.distance = vtkSmartPointer<vtkImplicitPolyDataDistance>::New();
+    entry.distance->SetInput(polyData);
+    entry.polyData = polyData;
+    entry.polyDataTime = polyData->GetMTime();
+  }
+
+  // the geometry may move at any time, it is cheap to read
+  std::memcpy(entry.surfaceToWorld, entry.surface->GetGeometry()->GetVtkMatrix()->GetData(), sizeof(entry.surfaceToWorld));
+  vtkMatrix4x4::Invert(entry.surfaceToWorld, entry.worldToSurface);
+  return &entry;
+}
+
+double SurfaceCollisionService::Evaluate(Entry &entry, const double surfacePoint[3], double closestPoint[3]) const
+{
+  double point[3] = { surfacePoint[0], surfacePoint[1], surfacePoint[2] };
+  const double distance = entry.distance->EvaluateFunctionAndGetClosestPoint(point, closestPoint);
+  return entry.closed ? distance : std::abs(distance);
+}
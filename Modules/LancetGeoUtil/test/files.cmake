@@ -0,0 +1,6 @@
+set(MODULE_TESTS
+  lancetBoneMillingEngineTest.cpp
+)
+
+SET(MODULE_CUSTOM_TESTS
+)
@@ -0,0 +1,108 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+// Testing
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include "bonemillingengine.h"
+
+#include <mitkImagePixelReadAccessor.h>
+
+#include <vtkCubeSource.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+
+#include <vector>
+
+class lancetBoneMillingEngineTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(lancetBoneMillingEngineTestSuite);
+
+  MITK_TEST(DirtyBrickRangeUpdateTest);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  static constexpr unsigned int Size = 40;
+
+  // bone box of label 1 in a Size^3 image, index = world coordinates
+  static mitk::Image::Pointer MakeBoneImage(const int bounds[6])
+  {
+    std::vector<unsigned char> voxels(Size * Size * Size, 0);
+    for (int z = bounds[4]; z <= bounds[5]; ++z)
+    {
+      for (int y = bounds[2]; y <= bounds[3]; ++y)
+      {
+        for (int x = bounds[0]; x <= bounds[1]; ++x)
+        {
+          voxels[x + Size * (y + Size * z)] = 1;
+        }
+      }
+    }
+    unsigned int dimensions[3]{ Size, Size, Size };
+    mitk::Image::Pointer image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 3, dimensions);
+    image->SetVolume(voxels.data());
+    return image;
+  }
+
+  static mitk::Surface::Pointer MakeBoxTool(const double bounds[6])
+  {
+    vtkNew<vtkCubeSource> cube;
+    cube->SetBounds(bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]);
+    cube->Update();
+    mitk::Surface::Pointer tool = mitk::Surface::New();
+    tool->SetVtkPolyData(cube->GetOutput());
+    return tool;
+  }
+
+public:
+  void DirtyBrickRangeUpdateTest()
+  {
+    // bone from x 2 to 18: the bricks of the cells 0..15 and 16..31 along x both have surface
+    const int bone[6]{ 2, 18, 2, 12, 2, 12 };
+    BoneMillingEngine::Pointer engine = BoneMillingEngine::New();
+    engine->Initialize(MakeBoneImage(bone));
+    CPPUNIT_ASSERT(engine->IsInitialized());
+
+    vtkPolyData *surface = engine->GetSurface()->GetVtkPolyData();
+    CPPUNIT_ASSERT(surface->GetNumberOfPolys() > 0);
+    CPPUNIT_ASSERT_MESSAGE("The surface reaches the end of the bone.", surface->GetBounds()[1] > 17.0);
+    mitk::Image::Pointer mask = engine->GetMaskImage();
+    CPPUNIT_ASSERT_MESSAGE("The mask is shared, not copied.", mask == engine->GetMaskImage());
+
+    // mill everything from x 14 on, the brick of the cells 16..31 loses its surface
+    const double cut[6]{ 13.5, 22.5, 0.0, 14.0, 0.0, 14.0 };
+    CPPUNIT_ASSERT(engine->Mill(MakeBoxTool(cut)) > 0);
+    const unsigned long dirty = engine->GetNumberOfDirtyBricks();
+    CPPUNIT_ASSERT(dirty > 0);
+
+    engine->UpdateSurface();
+    CPPUNIT_ASSERT_EQUAL(dirty, engine->GetNumberOfUpdatedBricks());
+    CPPUNIT_ASSERT_EQUAL(0ul, engine->GetNumberOfDirtyBricks());
+    CPPUNIT_ASSERT_MESSAGE("Dirty bricks are written into the same polydata.",
+                           surface == engine->GetSurface()->GetVtkPolyData());
+
+    // neither the ranges of the milled brick nor its old points may keep the old extent
+    CPPUNIT_ASSERT_MESSAGE("The cells end at the cut.", surface->GetBounds()[1] < 15.0);
+    CPPUNIT_ASSERT_MESSAGE("The points end at the cut.", surface->GetPoints()->GetBounds()[1] < 15.0);
+    CPPUNIT_ASSERT_MESSAGE("The bone before the cut stays.", surface->GetBounds()[0] < 3.0);
+
+    const itk::Index<3> milled{ { 16, 7, 7 } };
+    const itk::Index<3> kept{ { 5, 7, 7 } };
+    mitk::ImagePixelReadAccessor<unsigned char, 3> accessor(mask);
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(0), accessor.GetPixelByIndex(milled));
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned char>(1), accessor.GetPixelByIndex(kept));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(lancetBoneMillingEngine)
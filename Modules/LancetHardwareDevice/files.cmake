@@ -25,6 +25,8 @@ set(MOC_H_FILES
 set(H_FILES
   include/AbstractRobot.h
   include/AbstractCamera.h
+  include/ToolPoseRingBuffer.h
+  include/RobotMotionMonitor.h
   include/AimCamera.h
   include/DianaRobot.h
   include/LancetHansRobot.h
@@ -12,7 +12,10 @@
 #include <qlabel.h>
 #include <eigen3/Eigen/Dense>
 #include <QObject>
+#include <atomic>
+#include <thread>
 #include "MitkLancetHardwareDeviceExports.h"
+#include "ToolPoseRingBuffer.h"
 class MITKLANCETHARDWAREDEVICE_EXPORT AbstractCamera : public QObject
 {
 	Q_OBJECT
@@ -32,11 +35,40 @@ public:
 
 	virtual void InitToolsName(std::vector<std::string> aToolsName) = 0;
 
-	void ResetTools()
+	/**
+	 * Clears the tools. The acquisition thread reads them, so it is stopped first; returns true if
+	 * it was running, the caller restarts it with StartAcquisition() once the new tools are set.
+	 */
+	bool ResetTools()
 	{
+		const bool acquiring = m_Acquiring.load();
+		StopAcquisition();
 		m_ToolMatrixMap.clear();
 		m_ToolTipMap.clear();
 		m_ToolLabelMap.clear();
+		m_ToolIndexMap.clear();
+		m_PoseBuffer.Clear();
+		return acquiring;
+	}
+
+	/**
+	 * Newest pose of aToolName written by the acquisition thread, callable from any thread.
+	 * False for an unknown tool or before the first frame.
+	 */
+	bool GetLatest(const std::string& aToolName, TrackedToolPose& aPose) const
+	{
+		auto it = m_ToolIndexMap.find(aToolName);
+		return it != m_ToolIndexMap.end() && m_PoseBuffer.GetLatest(it->second, aPose);
+	}
+
+	/**
+	 * Appends all poses acquired after aTimestamp (ToolPoseRingBuffer::Now() clock), oldest first,
+	 * as long as they are still in the buffer. TrackedToolPose::toolIndex is the index of the
+	 * tool in the list given to InitToolsName.
+	 */
+	size_t GetSince(long long aTimestamp, std::vector<TrackedToolPose>& aPoses) const
+	{
+		return m_PoseBuffer.GetSince(aTimestamp, aPoses);
 	}
 public slots:
 	virtual void UpdateData() = 0;
@@ -61,8 +93,49 @@ protected:
 	}
 
 
+	/**
+	 * Acquisition thread: calls AcquireFrame() as fast as the camera delivers frames until
+	 * StopAcquisition(). Tools must not be changed while it runs.
+	 */
+	void StartAcquisition()
+	{
+		if (m_Acquiring.exchange(true))
+		{
+			return;
+		}
+		m_AcquisitionThread = std::thread([this]()
+			{
+				while (m_Acquiring.load(std::memory_order_relaxed))
+				{
+					if (!AcquireFrame())
+					{
+						std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					}
+				}
+			});
+	}
+
+	void StopAcquisition()
+	{
+		m_Acquiring = false;
+		if (m_AcquisitionThread.joinable())
+		{
+			m_AcquisitionThread.join();
+		}
+	}
+
+	/**
+	 * Reads one frame from the hardware on the acquisition thread and pushes the pose of every
+	 * tool into m_PoseBuffer. Returns false if no new frame was available.
+	 */
+	virtual bool AcquireFrame() { return false; }
+
 protected:
 	QTimer* m_CameraUpdateTimer;
+	ToolPoseRingBuffer m_PoseBuffer;
+	std::map<std::string, int> m_ToolIndexMap;
+	std::atomic<bool> m_Acquiring{ false };
+	std::thread m_AcquisitionThread;
 	std::map<std::string, vtkSmartPointer<vtkMatrix4x4>> m_ToolMatrixMap;
 	std::map<std::string, Eigen::Vector3d> m_ToolTipMap;
 	std::map<std::string, QLabel*> m_ToolLabelMap;
@@ -22,7 +22,9 @@ found in the LICENSE file.
 #include <eigen3/Eigen/Dense>
 #include <QApplication>
 #include <QThread>
+#include <mutex>
 #include <MitkLancetHardwareDeviceExports.h>
+#include "RobotMotionMonitor.h"
 class MITKLANCETHARDWAREDEVICE_EXPORT AbstractRobot : public QObject
 {
 public:
@@ -30,6 +32,11 @@ public:
 	{
 		m_initJoints.resize(N);
 	}
+	/** Subclasses that poll in QueryMotionState() must call StopStateMonitor() in their own destructor. */
+	virtual ~AbstractRobot()
+	{
+		StopStateMonitor();
+	}
 	virtual void Connect() = 0;
 	virtual void Disconnect() = 0;
 	virtual void PowerOn() = 0;
@@ -68,6 +75,100 @@ public:
 
 	virtual void WaitMove() = 0;
 
+	/**
+	 * Sends a motion with aMotion (e.g. [&]{ robot->SetJointAngles(angles); } for a call that does not
+	 * wait itself) and returns at once. The handle completes when the state monitor sees the robot
+	 * done, so the caller can e.g. sample the camera meanwhile. Starts the monitor if needed.
+	 * A robot that does not report its motion state is waited for with WaitMove() before returning.
+	 */
+	RobotMotion MoveAsync(const std::function<void()>& aMotion)
+	{
+		if (!HasMotionState())
+		{
+			aMotion();
+			WaitMove();
+			return RobotMotion::Finished(true);
+		}
+		StartStateMonitor();
+		const RobotMotion::Clock::time_point sentAt = RobotMotion::Clock::now();
+		aMotion();
+		return m_MotionMonitor.MotionSentAt(sentAt, m_MotionSettleTime);
+	}
+
+	/**
+	 * Starts the background thread that polls QueryMotionState() every aPeriod while a motion
+	 * sent with MoveAsync() is pending. Waiting for motions only blocks on the published state.
+	 */
+	void StartStateMonitor(std::chrono::milliseconds aPeriod = std::chrono::milliseconds(2))
+	{
+		m_MotionMonitor.Start([this]() { return QueryMotionState(); }, aPeriod);
+	}
+
+	void StopStateMonitor()
+	{
+		m_MotionMonitor.Stop();
+	}
+
+	/** Last state read by the monitor, Unknown before the first motion. */
+	RobotMotionState GetMotionState() const
+	{
+		return m_MotionMonitor.GetState();
+	}
+
+	/** aListener(old, new) is called on the monitor thread for every state transition. */
+	void SetMotionStateListener(RobotMotionMonitor::Listener aListener)
+	{
+		m_MotionMonitor.SetListener(std::move(aListener));
+	}
+
+protected:
+	/**
+	 * Reads the motion state from the robot, called on the monitor thread, and once by
+	 * HasMotionState(). Unknown means the robot does not report it, which is the default.
+	 */
+	virtual RobotMotionState QueryMotionState() { return RobotMotionState::Unknown; }
+
+	/** Whether QueryMotionState() is implemented, asked from the robot on the first call. */
+	bool HasMotionState()
+	{
+		std::call_once(m_MotionStateProbe, [this]()
+			{
+				m_HasMotionState = QueryMotionState() != RobotMotionState::Unknown;
+			});
+		return m_HasMotionState;
+	}
+
+	/**
+	 * Blocks until the motion sent just before the call is done, for WaitMove(). The monitor thread
+	 * does the polling; on the GUI thread pending events are still handled every few ms, as
+	 * WaitMove() always did, other threads simply sleep until the state changes. Returns false
+	 * at once if the robot does not report its motion state.
+	 */
+	bool WaitForMotion()
+	{
+		if (!HasMotionState())
+		{
+			return false;
+		}
+		const RobotMotion motion = MoveAsync([]() {});
+		if (qApp == nullptr || QThread::currentThread() != qApp->thread())
+		{
+			return motion.Wait();
+		}
+		while (!motion.IsDone())
+		{
+			motion.Wait(std::chrono::milliseconds(15));
+			QApplication::processEvents();
+		}
+		return motion.Wait(std::chrono::milliseconds(0));
+	}
+
+	// a state read before the robot accepted the motion would still say idle
+	std::chrono::milliseconds m_MotionSettleTime{ 20 };
+	RobotMotionMonitor m_MotionMonitor;
+	std::once_flag m_MotionStateProbe;
+	bool m_HasMotionState{ false };
+
 protected:
 	//vtkSmartPointer<vtkMatrix4x4> m_InitialPos;
 	const char* m_IpAddress;
@@ -10,6 +10,7 @@ class MITKLANCETHARDWAREDEVICE_EXPORT AimCamera : public AbstractCamera
 {
 	Q_OBJECT
 public:
+	~AimCamera() override;
 	void Connect() override;
 	void Disconnect() override;
 	void Start() override;
@@ -20,18 +21,25 @@ public:
 
 	void InitToolsName(std::vector<std::string> aToolsName) override;
 
+protected:
+	bool AcquireFrame() override;
+
 private:
-	T_AimToolDataResult* GetNewToolData();
-	bool UpdateCameraToToolMatrix(T_AimToolDataResult* aToolData, const std::string aName);
+	bool UpdateCameraToToolMatrix(const TrackedToolPose& aPose, const std::string aName);
 
 protected slots:
 	void UpdateData() override;
 private:
 	AimHandle m_AimHandle = NULL;
 	E_Interface m_EI;
+	E_ReturnValue rlt;
+
+	// used by the acquisition thread only, reused for every frame
+	std::vector<std::string> m_AcquisitionToolsName;
 	T_MarkerInfo markerSt;
 	T_AimPosStatusInfo statusSt;
-	E_ReturnValue rlt;
-	
+	T_AimToolDataResultSingle m_ToolDataSt;
+	UINT m_LastFrameID = 0;
+
 };
 #endif
@@ -13,6 +13,7 @@ class MITKLANCETHARDWAREDEVICE_EXPORT DianaRobot : public AbstractRobot
 {
 public:
 	DianaRobot();
+	~DianaRobot() override;
 	void Connect() override;
 
 	void Disconnect() override;
@@ -76,6 +77,9 @@ public:
 
 	std::vector<double> GetRobotImpeda();
 
+protected:
+	RobotMotionState QueryMotionState() override;
+
 private:
 	double m_InitialPos[6] = { 0,0,0,0,0,0 };
 };
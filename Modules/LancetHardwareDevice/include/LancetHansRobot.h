@@ -12,6 +12,7 @@ class MITKLANCETHARDWAREDEVICE_EXPORT LancetHansRobot : public AbstractRobot
 	//Q_OBJECT
 public:
 	LancetHansRobot();
+	~LancetHansRobot() override;
 	void Connect() override;
 
 	void Disconnect() override;
@@ -61,6 +62,9 @@ public:
 	bool SetVelocity(double aVelocity) override;
 
 	void WaitMove() override;
+
+protected:
+	RobotMotionState QueryMotionState() override;
   
 private:
 	Eigen::Matrix3d GetRotationMatrixByEuler(double rx, double ry, double rz);
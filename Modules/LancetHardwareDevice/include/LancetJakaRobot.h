@@ -25,6 +25,7 @@ class MITKLANCETHARDWAREDEVICE_EXPORT LancetJakaRobot : public AbstractRobot
 	//Q_OBJECT
 public:
 	LancetJakaRobot();
+	~LancetJakaRobot() override;
 	void Connect() override;
 
 	void Disconnect() override;
@@ -75,6 +76,9 @@ public:
 
 	void WaitMove() override;
 
+protected:
+	RobotMotionState QueryMotionState() override;
+
 private:
 	Eigen::Matrix3d GetRotationMatrixByEuler(double rx, double ry, double rz);
 	vtkSmartPointer<vtkMatrix4x4> GetMatrixByRotationAndTranslation(Eigen::Matrix3d aRotation, Eigen::Vector3d aTranslation);
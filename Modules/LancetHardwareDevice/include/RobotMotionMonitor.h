@@ -0,0 +1,256 @@
+#pragma once
+#ifndef ROBOTMOTIONMONITOR_h
+#define ROBOTMOTIONMONITOR_h
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+enum class RobotMotionState
+{
+	Unknown,	// not read yet, or the robot does not report it
+	Idle,		// motion done / in position
+	Moving,
+	Error
+};
+
+/** Idle or Error: the robot answered and is not moving. */
+inline bool IsMotionEnded(RobotMotionState aState)
+{
+	return aState == RobotMotionState::Idle || aState == RobotMotionState::Error;
+}
+
+/**
+ * State of one robot as seen by its monitor thread, shared with the motion handles.
+ */
+struct RobotMotionStatus
+{
+	std::mutex mutex;
+	std::condition_variable changed;
+	RobotMotionState state{ RobotMotionState::Unknown };
+	std::chrono::steady_clock::time_point sampledAt;	// when state was read from the robot
+	bool running{ false };
+	bool pending{ false };	// a motion is not done yet, the monitor polls only meanwhile
+	std::chrono::steady_clock::time_point pendingUntil;	// settle time of the last motion sent
+};
+
+/**
+ * Waitable handle of one motion started by AbstractRobot::MoveAsync().
+ *
+ * The motion is done once the monitor read a state other than Moving from the robot at least
+ * the settle time after the motion was sent, the same criterion WaitMove() always used. A
+ * default constructed handle is done and failed. The robot must outlive its handles.
+ */
+class RobotMotion
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	RobotMotion() = default;
+	RobotMotion(std::shared_ptr<RobotMotionStatus> aStatus, Clock::time_point aSentAt, Clock::duration aSettle)
+		: m_Status(std::move(aStatus)), m_DoneAfter(aSentAt + aSettle)
+	{
+	}
+
+	/** Handle of a motion that already ended, e.g. one that was waited for synchronously. */
+	static RobotMotion Finished(bool aSucceeded)
+	{
+		std::shared_ptr<RobotMotionStatus> status = std::make_shared<RobotMotionStatus>();
+		status->running = true;
+		status->state = aSucceeded ? RobotMotionState::Idle : RobotMotionState::Error;
+		return RobotMotion(status, Clock::time_point(), Clock::duration::zero());
+	}
+
+	/** True once the robot reported the motion done, or the monitor stopped. */
+	bool IsDone() const
+	{
+		if (!m_Status)
+		{
+			return true;
+		}
+		std::lock_guard<std::mutex> lock(m_Status->mutex);
+		return Done();
+	}
+
+	/** Blocks until done or aTimeout expired. True if the motion ended without robot error. */
+	bool Wait(std::chrono::milliseconds aTimeout) const
+	{
+		if (!m_Status)
+		{
+			return false;
+		}
+		std::unique_lock<std::mutex> lock(m_Status->mutex);
+		return m_Status->changed.wait_for(lock, aTimeout, [this] { return Done(); }) && Succeeded();
+	}
+
+	/** Blocks until done. True if the motion ended without robot error. */
+	bool Wait() const
+	{
+		if (!m_Status)
+		{
+			return false;
+		}
+		std::unique_lock<std::mutex> lock(m_Status->mutex);
+		m_Status->changed.wait(lock, [this] { return Done(); });
+		return Succeeded();
+	}
+
+private:
+	// m_Status->mutex held
+	bool Done() const
+	{
+		return !m_Status->running
+			|| (m_Status->sampledAt >= m_DoneAfter && IsMotionEnded(m_Status->state));
+	}
+
+	bool Succeeded() const
+	{
+		return m_Status->running && m_Status->state == RobotMotionState::Idle;
+	}
+
+
+	std::shared_ptr<RobotMotionStatus> m_Status;
+	Clock::time_point m_DoneAfter;
+};
+
+/**
+ * Background thread polling the motion state of one robot and publishing transitions, so
+ * that waiting for a motion neither spins on the caller's thread nor re-enters its event loop.
+ * It only queries the robot while a motion is pending and sleeps in between.
+ */
+class RobotMotionMonitor
+{
+public:
+	using Query = std::function<RobotMotionState()>;
+	using Listener = std::function<void(RobotMotionState aOld, RobotMotionState aNew)>;
+
+	RobotMotionMonitor() : m_Status(std::make_shared<RobotMotionStatus>())
+	{
+	}
+
+	~RobotMotionMonitor()
+	{
+		Stop();
+	}
+
+	/**
+	 * Starts the monitor thread, no-op if already running. It polls aQuery every aPeriod from
+	 * MotionSentAt() until the robot reported that motion done.
+	 */
+	void Start(Query aQuery, std::chrono::milliseconds aPeriod)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Status->mutex);
+			if (m_Status->running)
+			{
+				return;
+			}
+			m_Status->running = true;
+			m_Status->pending = false;
+			m_Status->state = RobotMotionState::Unknown;
+			m_Status->sampledAt = RobotMotion::Clock::time_point();
+		}
+		m_Thread = std::thread([this, aQuery, aPeriod]()
+			{
+				for (;;)
+				{
+					{
+						std::unique_lock<std::mutex> lock(m_Status->mutex);
+						m_Status->changed.wait(lock, [this] { return !m_Status->running || m_Status->pending; });
+						if (!m_Status->running)
+						{
+							break;
+						}
+					}
+					const RobotMotion::Clock::time_point sampledAt = RobotMotion::Clock::now();
+					const RobotMotionState state = aQuery();
+					RobotMotionState old;
+					{
+						std::unique_lock<std::mutex> lock(m_Status->mutex);
+						if (!m_Status->running)
+						{
+							break;
+						}
+						old = m_Status->state;
+						m_Status->state = state;
+						m_Status->sampledAt = sampledAt;
+						if (sampledAt >= m_Status->pendingUntil && IsMotionEnded(state))
+						{
+							m_Status->pending = false;
+						}
+						m_Status->changed.notify_all();
+						if (m_Status->pending)
+						{
+							m_Status->changed.wait_for(lock, aPeriod, [this] { return !m_Status->running; });
+						}
+					}
+					if (old != state)
+					{
+						std::lock_guard<std::mutex> lock(m_ListenerMutex);
+						if (m_Listener)
+						{
+							m_Listener(old, state);
+						}
+					}
+				}
+			});
+	}
+
+	/** Stops the thread; pending waits return as failed. */
+	void Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Status->mutex);
+			m_Status->running = false;
+			m_Status->changed.notify_all();
+		}
+		if (m_Thread.joinable())
+		{
+			m_Thread.join();
+		}
+	}
+
+	bool IsRunning() const
+	{
+		std::lock_guard<std::mutex> lock(m_Status->mutex);
+		return m_Status->running;
+	}
+
+	RobotMotionState GetState() const
+	{
+		std::lock_guard<std::mutex> lock(m_Status->mutex);
+		return m_Status->state;
+	}
+
+	/** Called on the monitor thread for every state transition. */
+	void SetListener(Listener aListener)
+	{
+		std::lock_guard<std::mutex> lock(m_ListenerMutex);
+		m_Listener = std::move(aListener);
+	}
+
+	/** Handle of a motion sent at aSentAt, polls the robot until it is done. */
+	RobotMotion MotionSentAt(RobotMotion::Clock::time_point aSentAt, RobotMotion::Clock::duration aSettle)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Status->mutex);
+			if (!m_Status->pending || aSentAt + aSettle > m_Status->pendingUntil)
+			{
+				m_Status->pendingUntil = aSentAt + aSettle;
+			}
+			m_Status->pending = true;
+			m_Status->changed.notify_all();
+		}
+		return RobotMotion(m_Status, aSentAt, aSettle);
+	}
+
+private:
+	std::shared_ptr<RobotMotionStatus> m_Status;
+	std::mutex m_ListenerMutex;
+	Listener m_Listener;
+	std::thread m_Thread;
+};
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+#ifndef TOOLPOSERINGBUFFER_h
+#define TOOLPOSERINGBUFFER_h
+
+#include "seqlockRingBuffer.h"
+
+/**
+ * One tracked tool pose of one camera frame.
+ */
+struct TrackedToolPose
+{
+	long long timestamp{ 0 };	// steady clock, microseconds, see ToolPoseRingBuffer::Now()
+	unsigned int frame{ 0 };	// camera frame number
+	int toolIndex{ -1 };
+	bool valid{ false };		// tool visible in this frame, otherwise matrix and tip are not set
+	double matrix[16]{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };	// camera to tool, row-major
+	double tip[3]{ 0, 0, 0 };
+};
+
+/**
+ * Ring buffer of the tool poses of the acquisition thread, see lancetAlgorithm::SeqlockRingBuffer:
+ * readers on any thread look up the newest pose of a tool or all poses after a timestamp without
+ * ever blocking the producer.
+ */
+class ToolPoseRingBuffer : public lancetAlgorithm::SeqlockRingBuffer<TrackedToolPose>
+{
+public:
+	explicit ToolPoseRingBuffer(size_t aCapacity = 1024) : SeqlockRingBuffer(aCapacity) {}
+
+	using SeqlockRingBuffer::GetLatest;
+
+	/** Newest pose of aToolIndex, valid or not. False if the buffer holds none. */
+	bool GetLatest(int aToolIndex, TrackedToolPose& aPose) const
+	{
+		return FindLatest([aToolIndex](const TrackedToolPose& pose) { return pose.toolIndex == aToolIndex; }, aPose);
+	}
+};
+#endif
@@ -62,8 +62,14 @@ void AimCamera::Connect()
 	rlt = AIMOOE_OK;
 }
 
+AimCamera::~AimCamera()
+{
+	StopAcquisition();
+}
+
 void AimCamera::Disconnect()
 {
+	StopAcquisition();
 	Aim_API_Close(m_AimHandle);
 }
 
@@ -84,11 +90,15 @@ void AimCamera::Start()
 
 	connect(m_CameraUpdateTimer, &QTimer::timeout, this, &AimCamera::UpdateData);
 
-	m_CameraUpdateTimer->start(100);
+	// the hardware is read at its own frame rate by the acquisition thread, the timer only refreshes the GUI
+	m_LastFrameID = 0;
+	StartAcquisition();
+	m_CameraUpdateTimer->start(33);
 }
 
 void AimCamera::Stop()
 {
+	StopAcquisition();
 	if (m_CameraUpdateTimer && m_CameraUpdateTimer->isActive())
 	{
 		// ֹͣʱ
@@ -103,6 +113,11 @@ Eigen::Vector3d AimCamera::GetToolTipByName(std::string aToolName)
 {
 	if (m_ToolTipMap.count(aToolName) > 0)
 	{
+		TrackedToolPose pose;
+		if (GetLatest(aToolName, pose) && pose.valid)
+		{
+			return Eigen::Vector3d(pose.tip[0], pose.tip[1], pose.tip[2]);
+		}
 		return m_ToolTipMap[aToolName];
 	}
 	std::cout << "No corresponding object can be found as: " << aToolName << std::endl;
@@ -113,7 +128,14 @@ vtkSmartPointer<vtkMatrix4x4> AimCamera::GetToolMatrixByName(std::string aToolNa
 {
 	if (m_ToolTipMap.count(aToolName) > 0)
 	{
-		return m_ToolMatrixMap[aToolName];
+		// the map matrix is shared with the callers, refresh it with the newest frame
+		auto matrix = m_ToolMatrixMap[aToolName];
+		TrackedToolPose pose;
+		if (GetLatest(aToolName, pose) && pose.valid)
+		{
+			matrix->DeepCopy(pose.matrix);
+		}
+		return matrix;
 	}
 	std::cout << "No corresponding object can be found as: " << aToolName << std::endl;
 	return vtkSmartPointer<vtkMatrix4x4>();
@@ -121,7 +143,8 @@ vtkSmartPointer<vtkMatrix4x4> AimCamera::GetToolMatrixByName(std::string aToolNa
 
 void AimCamera::InitToolsName(std::vector<std::string> aToolsName)
 {
-	this->ResetTools();
+	const bool acquiring = this->ResetTools();
+	m_AcquisitionToolsName.clear();
 	for (int i = 0; i < aToolsName.size(); ++i)
 	{
 		if (m_ToolMatrixMap.count(aToolsName[i]) > 0)
@@ -130,101 +153,98 @@ void AimCamera::InitToolsName(std::vector<std::string> aToolsName)
 		Eigen::Vector3d tip(0, 0, 0);
 		m_ToolMatrixMap.emplace(std::pair(aToolsName[i], m));
 		m_ToolTipMap.emplace(std::pair(aToolsName[i], tip));
+		m_ToolIndexMap.emplace(aToolsName[i], static_cast<int>(m_AcquisitionToolsName.size()));
+		m_AcquisitionToolsName.push_back(aToolsName[i]);
+	}
+	// keep tracking if the camera was already started
+	if (acquiring)
+	{
+		m_LastFrameID = 0;
+		StartAcquisition();
 	}
 }
 
-T_AimToolDataResult* AimCamera::GetNewToolData()
+bool AimCamera::AcquireFrame()
 {
-	rlt = Aim_GetMarkerAndStatusFromHardware(m_AimHandle, I_ETHERNET, markerSt, statusSt);
-	if (rlt == AIMOOE_NOT_REFLASH)
+	if (Aim_GetMarkerAndStatusFromHardware(m_AimHandle, I_ETHERNET, markerSt, statusSt) != AIMOOE_OK
+		|| markerSt.ID == m_LastFrameID)
 	{
-		std::cout << "camera get data failed";
+		return false;
 	}
-	T_AimToolDataResult* mtoolsrlt = new T_AimToolDataResult;//½һֵָָڴ
-	mtoolsrlt->next = NULL;
-	mtoolsrlt->validflag = false;
-
-	rlt = Aim_FindToolInfo(m_AimHandle, markerSt, mtoolsrlt, 0);//ȡ
-	T_AimToolDataResult* prlt = mtoolsrlt;//ȡݵĴmtoolsrltprltָ
+	m_LastFrameID = markerSt.ID;
 
-	return prlt;
-}
-
-bool AimCamera::UpdateCameraToToolMatrix(T_AimToolDataResult* aToolData, const std::string aName)
-{
-	QLabel* label = nullptr;
-	if (aToolData->toolname == aName)
+	// one fixed-size result per tool instead of the list allocated by Aim_FindToolInfo
+	const long long timestamp = ToolPoseRingBuffer::Now();
+	for (int i = 0; i < m_AcquisitionToolsName.size(); ++i)
 	{
-		if (m_ToolLabelMap.count(aName) > 0)
-		{
-			 label = m_ToolLabelMap[aName];
-		}
-		if (aToolData->validflag)
+		TrackedToolPose pose;
+		pose.timestamp = timestamp;
+		pose.frame = markerSt.ID;
+		pose.toolIndex = i;
+		m_ToolDataSt.validflag = false;
+		if (Aim_FindSingleToolInfo(m_AimHandle, markerSt, m_AcquisitionToolsName[i].c_str(), m_ToolDataSt, 0) == AIMOOE_OK
+			&& m_ToolDataSt.validflag)
 		{
-			//ȡ
-			Eigen::Vector3d camera2ToolTranslation;
-			Eigen::Matrix3d camera2ToolRotation;
-			camera2ToolTranslation[0] = aToolData->Tto[0];
-			camera2ToolTranslation[1] = aToolData->Tto[1];
-			camera2ToolTranslation[2] = aToolData->Tto[2];
-			for (int i = 0; i < 3; ++i)
+			pose.valid = true;
+			for (int row = 0; row < 3; ++row)
 			{
-				for (int j = 0; j < 3; ++j)
+				for (int col = 0; col < 3; ++col)
 				{
-					camera2ToolRotation(i, j) = (double)aToolData->Rto[i][j];
+					pose.matrix[row * 4 + col] = m_ToolDataSt.Rto[row][col];
 				}
+				pose.matrix[row * 4 + 3] = m_ToolDataSt.Tto[row];
+				pose.tip[row] = m_ToolDataSt.tooltip[row];
 			}
-			//ƴӾ
-			auto matrix = m_ToolMatrixMap[aName];
+		}
+		m_PoseBuffer.Push(pose);
+	}
+	return true;
+}
 
-			matrix->DeepCopy(GetMatrixByRotationAndTranslation(camera2ToolRotation, camera2ToolTranslation));
-			Eigen::Vector3d tip(aToolData->tooltip[0], aToolData->tooltip[1], aToolData->tooltip[2]);
-			m_ToolTipMap[aName] = tip;
+bool AimCamera::UpdateCameraToToolMatrix(const TrackedToolPose& aPose, const std::string aName)
+{
+	QLabel* label = nullptr;
+	if (m_ToolLabelMap.count(aName) > 0)
+	{
+		 label = m_ToolLabelMap[aName];
+	}
+	if (aPose.valid)
+	{
+		m_ToolMatrixMap[aName]->DeepCopy(aPose.matrix);
+		m_ToolTipMap[aName] = Eigen::Vector3d(aPose.tip[0], aPose.tip[1], aPose.tip[2]);
 
-			if (label != nullptr)
-			{
-				QString str = "x:" + QString::number(aToolData->tooltip[0]) + "\n "
-					+ "y:" + QString::number(aToolData->tooltip[1]) + " \n "
-					+ "z:" + QString::number(aToolData->tooltip[2]);
-				label->setText(str);
-				label->setStyleSheet(this->m_GreenLabelStyleSheet);
-			}
-			return true;
+		if (label != nullptr)
+		{
+			QString str = "x:" + QString::number(aPose.tip[0]) + "\n "
+				+ "y:" + QString::number(aPose.tip[1]) + " \n "
+				+ "z:" + QString::number(aPose.tip[2]);
+			label->setText(str);
+			label->setStyleSheet(this->m_GreenLabelStyleSheet);
 		}
-		else
+		return true;
+	}
+	else
+	{
+		if (label != nullptr)
 		{
-			if (label != nullptr)
-			{
-				QString str = "x:nan  y:nan  z:nan";
-				label->setText(str);
-				label->setStyleSheet(this->m_GreenLabelStyleSheet);
-			}
-			return false;
+			QString str = "x:nan  y:nan  z:nan";
+			label->setText(str);
+			label->setStyleSheet(this->m_GreenLabelStyleSheet);
 		}
+		return false;
 	}
-	return false;
 }
 
 void AimCamera::UpdateData()
 {
-	auto prlt = GetNewToolData();
-	if (rlt == AIMOOE_OK)//жǷɼɹ
+	// newest frame of the acquisition thread, GUI side only
+	for (auto it = m_ToolMatrixMap.begin(); it != m_ToolMatrixMap.end(); ++it)
 	{
-		do
+		TrackedToolPose pose;
+		if (GetLatest(it->first, pose))
 		{
-			for (auto it = m_ToolMatrixMap.begin(); it != m_ToolMatrixMap.end(); ++it)
-			{
-				UpdateCameraToToolMatrix(prlt, it->first.c_str());
-			}
-
-			T_AimToolDataResult* pnext = prlt->next;
-			delete prlt;
-			prlt = pnext;
-		} while (prlt != NULL);
-	}
-	else
-	{
-		delete prlt;
+			UpdateCameraToToolMatrix(pose, it->first);
+		}
 	}
 	emit CameraUpdateClock();
 }
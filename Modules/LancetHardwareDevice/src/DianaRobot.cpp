@@ -5,6 +5,11 @@ DianaRobot::DianaRobot()
 	this->SetRobotIpAddress("192.168.10.75");
 }
 
+DianaRobot::~DianaRobot()
+{
+	StopStateMonitor();
+}
+
 void DianaRobot::Connect()
 {
 	srv_net_st* pinfo = new srv_net_st();
@@ -29,6 +34,7 @@ void DianaRobot::Connect()
 
 void DianaRobot::Disconnect()
 {
+	StopStateMonitor();
 	int ret = destroySrv(m_IpAddress);
 	if (ret < 0)
 	{
@@ -155,23 +161,16 @@ std::vector<std::vector<double>> DianaRobot::GetJointAngleLimits()
 
 void DianaRobot::WaitMove()
 {
-	QThread::msleep(20);
-	while (true)
-	{
-		const char state = getRobotState(m_IpAddress);
-		if (state != 0)
-		{
-			break;
-		}
-		else
-		{
-			QThread::msleep(1);
-			QApplication::processEvents();
-		}
-	}
+	WaitForMotion();
 	stop();
 }
 
+RobotMotionState DianaRobot::QueryMotionState()
+{
+	// 0 while a motion is running
+	return getRobotState(m_IpAddress) == 0 ? RobotMotionState::Moving : RobotMotionState::Idle;
+}
+
 void DianaRobot::stopRobot()
 {
 	stop();
@@ -6,6 +6,11 @@ LancetHansRobot::LancetHansRobot()
 	m_FlangeToTCP = vtkSmartPointer<vtkMatrix4x4>::New();
 }
 
+LancetHansRobot::~LancetHansRobot()
+{
+	StopStateMonitor();
+}
+
 void LancetHansRobot::Connect()
 {
 	this->SetRobotIpAddress("192.168.0.10");
@@ -16,6 +21,7 @@ void LancetHansRobot::Connect()
 
 void LancetHansRobot::Disconnect()
 {
+	StopStateMonitor();
 	HRIF_DisConnect(0);
 }
 
@@ -272,22 +278,19 @@ bool LancetHansRobot::SetVelocity(double aVelocity)
 
 void LancetHansRobot::WaitMove()
 {
-	bool status;
-	QThread::msleep(20);
-	while (true)
+	WaitForMotion();
+	HRIF_GrpStop(0, 0);
+}
+
+RobotMotionState LancetHansRobot::QueryMotionState()
+{
+	bool done = false;
+	if (HRIF_IsMotionDone(0, 0, done) != 0)
 	{
-		int nRet = HRIF_IsMotionDone(0, 0, status);
-		if (status != 0)
-		{
-			break;
-		}
-		else
-		{
-			QThread::msleep(1);
-			QApplication::processEvents();
-		}
+		// no answer this time, keep waiting as WaitMove() always did
+		return RobotMotionState::Moving;
 	}
-	HRIF_GrpStop(0, 0);
+	return done ? RobotMotionState::Idle : RobotMotionState::Moving;
 }
 
 
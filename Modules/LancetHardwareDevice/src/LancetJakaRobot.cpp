@@ -9,6 +9,11 @@ LancetJakaRobot::LancetJakaRobot()
 	JAKAZuRobot m_Robot;
 }
 
+LancetJakaRobot::~LancetJakaRobot()
+{
+	StopStateMonitor();
+}
+
 void LancetJakaRobot::Connect()
 {
 	CHECK_ERROR_AND_RETURN(m_Robot.login_in(m_IpAddress));
@@ -16,6 +21,7 @@ void LancetJakaRobot::Connect()
 
 void LancetJakaRobot::Disconnect()
 {
+	StopStateMonitor();
 	//TODO
 	std::cout << "TODO Disconnect" << std::endl;
 }
@@ -257,22 +263,19 @@ bool LancetJakaRobot::SetVelocity(double aVelocity)
 
 void LancetJakaRobot::WaitMove()
 {
-	QThread::msleep(20);
-	while (true)
+	WaitForMotion();
+	m_Robot.motion_abort();
+}
+
+RobotMotionState LancetJakaRobot::QueryMotionState()
+{
+	BOOL inPosition = FALSE;
+	if (m_Robot.is_in_pos(&inPosition) != ERR_SUCC)
 	{
-		BOOL* status{};
-		m_Robot.is_in_pos(status);
-		if (status != 0)
-		{
-			break;
-		}
-		else
-		{
-			QThread::msleep(1);
-			QApplication::processEvents();
-		}
+		// no answer this time, keep waiting as WaitMove() always did
+		return RobotMotionState::Moving;
 	}
-	m_Robot.motion_abort();
+	return inPosition ? RobotMotionState::Idle : RobotMotionState::Moving;
 }
 
 Eigen::Matrix3d LancetJakaRobot::GetRotationMatrixByEuler(double rx, double ry, double rz)
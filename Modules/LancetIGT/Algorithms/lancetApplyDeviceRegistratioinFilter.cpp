@@ -12,6 +12,8 @@ found in the LICENSE file.
 
 #include "lancetApplyDeviceRegistratioinFilter.h"
 
+#include <algorithm>
+
 lancet::ApplyDeviceRegistratioinFilter::ApplyDeviceRegistratioinFilter() : mitk::NavigationDataToNavigationDataFilter()
 {
   m_NavigationDataOfRF = mitk::NavigationData::New();
@@ -25,6 +27,20 @@ lancet::ApplyDeviceRegistratioinFilter::~ApplyDeviceRegistratioinFilter()
   m_RegistrationMatrix = nullptr;
 }
 
+itk::ModifiedTimeType lancet::ApplyDeviceRegistratioinFilter::GetMTime() const
+{
+  itk::ModifiedTimeType mtime = Superclass::GetMTime();
+  if (m_RegistrationMatrix.IsNotNull())
+  {
+    mtime = std::max(mtime, m_RegistrationMatrix->GetMTime());
+  }
+  if (m_NavigationDataOfRF.IsNotNull())
+  {
+    mtime = std::max(mtime, m_NavigationDataOfRF->GetMTime());
+  }
+  return mtime;
+}
+
 void lancet::ApplyDeviceRegistratioinFilter::GenerateData()
 {
   // only update data if m_Transform was set
@@ -45,6 +61,16 @@ void lancet::ApplyDeviceRegistratioinFilter::GenerateData()
 
   this->CreateOutputsForAllInputs();
 
+  if (m_RegistrationSource != m_RegistrationMatrix.GetPointer() || m_RegistrationTime != m_RegistrationMatrix->GetMTime())
+  {
+    m_Registration = NavigationTransform::FromAffineTransform(m_RegistrationMatrix);
+    m_RegistrationSource = m_RegistrationMatrix;
+    m_RegistrationTime = m_RegistrationMatrix->GetMTime();
+  }
+  // same for all tools of this frame
+  const NavigationTransform registrationToRF =
+    NavigationTransform::Compose(m_Registration, NavigationTransform::FromNavigationData(m_NavigationDataOfRF));
+
   // generate output
   for (unsigned int i = 0; i < numberOfInputs; ++i)
   {
@@ -59,18 +85,13 @@ void lancet::ApplyDeviceRegistratioinFilter::GenerateData()
       output->SetDataValid(false);
       continue;
     }
-    //transform nd from move device to reference device coords
-    mitk::AffineTransform3D::Pointer inputTransform = input->GetAffineTransform3D();
-
-    inputTransform->Compose(m_RegistrationMatrix);
-    inputTransform->Compose(m_NavigationDataOfRF->GetAffineTransform3D());
-
-    mitk::NavigationData::Pointer res = mitk::NavigationData::New(inputTransform);
+    //transform nd from move device to reference device coords: RF * Registration * input
+    const NavigationTransform res =
+      NavigationTransform::Compose(NavigationTransform::FromNavigationData(input), registrationToRF);
 
     //copy information to output
     output->Graft(input); // copy all information from input to output
-    output->SetPosition(res->GetPosition());
-    output->SetOrientation(res->GetOrientation());
+    res.CopyTo(output);
     //output->SetDataValid(input->IsDataValid());
   }
 }
@@ -15,6 +15,7 @@ found in the LICENSE file.
 #define LANCETAPPLYDEVICEREGISTRATIOINFILTER_H
 #include "mitkNavigationDataToNavigationDataFilter.h"
 #include "MitkLancetIGTExports.h"
+#include "lancetNavigationTransform.h"
 
 namespace lancet {
 
@@ -53,6 +54,12 @@ namespace lancet {
     itkSetObjectMacro(NavigationDataOfRF, mitk::NavigationData);
     itkGetObjectMacro(NavigationDataOfRF, mitk::NavigationData);
 
+    /**Documentation
+   * \brief Also reports the modified time of the registration matrix and of NavigationDataOfRF,
+   * so that changing either of them in place re-executes the filter on the next Update()
+   */
+    itk::ModifiedTimeType GetMTime() const override;
+
 
   protected:
 
@@ -77,6 +84,11 @@ namespace lancet {
     mitk::NavigationData::Pointer m_NavigationDataOfRF;
     mitk::AffineTransform3D::Pointer m_RegistrationMatrix; ///< The registration matrix between two devices, specifically: T ReferenceDevice to MoveDevice or T RF to MoveDevice
 
+    // m_RegistrationMatrix as rigid transform, converted again only when the matrix changes
+    NavigationTransform m_Registration;
+    const mitk::AffineTransform3D *m_RegistrationSource{nullptr};
+    itk::ModifiedTimeType m_RegistrationTime{0};
+
   };
 } // namespace lancet
 
@@ -38,19 +38,16 @@ void lancet::NavigationDataInReferenceCoordFilter::GenerateData()
 
   this->CreateOutputsForAllInputs();
 
-
-  vtkSmartPointer<vtkMatrix4x4> refMatrix = vtkMatrix4x4::New();
-
+  // inverse of the reference pose, identity without a reference tool
+  NavigationTransform refInverse;
   if (m_RefToolIndex < this->GetNumberOfInputs())
   {
-    // get reference tool matrix according to RefToolIndex
-     const mitk::NavigationData *nd_ref = this->GetInput(m_RefToolIndex);
-     refMatrix = NavigationDataToVtkMatrix4x4(nd_ref);
+    // get reference tool pose according to RefToolIndex
+    const mitk::NavigationData *nd_ref = this->GetInput(m_RefToolIndex);
+    refInverse = NavigationTransform::FromNavigationData(nd_ref).Inverse();
   }
- 
-  
 
-  // generate output
+  // generate output, all transforms on the stack
   for (unsigned int i = 0; i < numberOfInputs; ++i)
   {
     const mitk::NavigationData *nd = this->GetInput(i);
@@ -59,20 +56,11 @@ void lancet::NavigationDataInReferenceCoordFilter::GenerateData()
     mitk::NavigationData *output = this->GetOutput(i);
     assert(output);
 
-    //cal matrix in ref
-    vtkSmartPointer<vtkMatrix4x4> in_matrix = NavigationDataToVtkMatrix4x4(nd);
-    vtkSmartPointer<vtkMatrix4x4> res_matrix = vtkMatrix4x4::New();
-    GetReferenceMatrix4x4(in_matrix, refMatrix, res_matrix);
-    // test ref itself should be i
-    // if (i == m_RefToolIndex && !res_matrix->IsIdentity())
-    // {
-    //   MITK_ERROR << "ref itself not Identity";
-    //
-    // }
+    //cal pose in ref: ref^-1 * in
+    const NavigationTransform inRef = NavigationTransform::Compose(NavigationTransform::FromNavigationData(nd), refInverse);
 
     output->Graft(nd); // copy all information from input to output
-    output->SetPosition(vtkMatrix4x4ToPosition(res_matrix));
-    output->SetOrientation(vtkMatrix4x4ToQuaternion(res_matrix));
+    inRef.CopyTo(output);
     output->SetDataValid(nd->IsDataValid());
   }
 }
@@ -84,7 +72,7 @@ mitk::AffineTransform3D::Pointer lancet::NavigationDataInReferenceCoordFilter::N
   affineTransform->SetIdentity();
 
   // calculate the transform from the quaternions
-  static itk::QuaternionRigidTransform<double>::Pointer quatTransform =
+  itk::QuaternionRigidTransform<double>::Pointer quatTransform =
     itk::QuaternionRigidTransform<double>::New();
 
   mitk::NavigationData::OrientationType orientation = nd->GetOrientation();
@@ -96,7 +84,7 @@ mitk::AffineTransform3D::Pointer lancet::NavigationDataInReferenceCoordFilter::N
 
   /* because of an itk bug, the transform can not be calculated with float data type.
       To use it in the mitk geometry classes, it has to be transfered to mitk::ScalarType which is float */
-  static mitk::AffineTransform3D::MatrixType m;
+  mitk::AffineTransform3D::MatrixType m;
   mitk::TransferMatrix(quatTransform->GetMatrix(), m);
   affineTransform->SetMatrix(m);
 
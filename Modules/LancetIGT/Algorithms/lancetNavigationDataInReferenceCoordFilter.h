@@ -15,6 +15,7 @@ found in the LICENSE file.
 #define LANCETNAVIGATIONDATAINREFERENCECOORDFILTER_H
 #include "mitkNavigationDataToNavigationDataFilter.h"
 #include "MitkLancetIGTExports.h"
+#include "lancetNavigationTransform.h"
 
 namespace lancet {
 
@@ -85,7 +86,7 @@ namespace lancet {
     vtkMatrix4x4 *ref_matrix,
     vtkMatrix4x4 *res_matrix)
   {
-    vtkSmartPointer<vtkMatrix4x4> ref_matrix_invert = vtkMatrix4x4::New();
+    vtkSmartPointer<vtkMatrix4x4> ref_matrix_invert = vtkSmartPointer<vtkMatrix4x4>::New();
     ref_matrix_invert->DeepCopy(ref_matrix);
     ref_matrix_invert->Invert();
     vtkSmartPointer<vtkTransform> transform = vtkSmartPointer<vtkTransform>::New();
@@ -0,0 +1,168 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "lancetNavigationTransform.h"
+
+#include <cmath>
+
+namespace
+{
+  // q * v * q^-1 of a unit quaternion, as vnl_quaternion::rotate()
+  void Rotate(const double q[4], const double v[3], double out[3])
+  {
+    const double ixv[3]{q[1] * v[2] - q[2] * v[1], q[2] * v[0] - q[0] * v[2], q[0] * v[1] - q[1] * v[0]};
+    const double ixvxi[3]{ixv[1] * q[2] - ixv[2] * q[1], ixv[2] * q[0] - ixv[0] * q[2], ixv[0] * q[1] - ixv[1] * q[0]};
+    for (int i = 0; i < 3; ++i)
+    {
+      out[i] = v[i] + 2 * q[3] * ixv[i] - 2 * ixvxi[i];
+    }
+  }
+
+  // a * b, as vnl_quaternion::operator*
+  void Multiply(const double a[4], const double b[4], double out[4])
+  {
+    out[0] = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+    out[1] = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+    out[2] = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+    out[3] = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+  }
+
+}
+
+NavigationTransform NavigationTransform::FromNavigationData(const mitk::NavigationData *nd)
+{
+  NavigationTransform transform;
+  const mitk::NavigationData::OrientationType orientation = nd->GetOrientation();
+  const mitk::NavigationData::PositionType position = nd->GetPosition();
+  transform.orientation[0] = orientation.x();
+  transform.orientation[1] = orientation.y();
+  transform.orientation[2] = orientation.z();
+  transform.orientation[3] = orientation.r();
+  for (int i = 0; i < 3; ++i)
+  {
+    transform.position[i] = position[i];
+  }
+  return transform;
+}
+
+NavigationTransform NavigationTransform::FromAffineTransform(const mitk::AffineTransform3D *transform)
+{
+  NavigationTransform result;
+  const mitk::AffineTransform3D::MatrixType &m = transform->GetMatrix();
+  const mitk::AffineTransform3D::OutputVectorType &offset = transform->GetOffset();
+  for (int i = 0; i < 3; ++i)
+  {
+    result.position[i] = offset[i];
+  }
+
+  // rotation matrix to quaternion, branch on the largest component for accuracy
+  double *q = result.orientation;
+  const double trace = m[0][0] + m[1][1] + m[2][2];
+  if (trace > 0)
+  {
+    const double s = 2 * std::sqrt(trace + 1);
+    q[3] = s / 4;
+    q[0] = (m[2][1] - m[1][2]) / s;
+    q[1] = (m[0][2] - m[2][0]) / s;
+    q[2] = (m[1][0] - m[0][1]) / s;
+  }
+  else if (m[0][0] > m[1][1] && m[0][0] > m[2][2])
+  {
+    const double s = 2 * std::sqrt(1 + m[0][0] - m[1][1] - m[2][2]);
+    q[3] = (m[2][1] - m[1][2]) / s;
+    q[0] = s / 4;
+    q[1] = (m[0][1] + m[1][0]) / s;
+    q[2] = (m[0][2] + m[2][0]) / s;
+  }
+  else if (m[1][1] > m[2][2])
+  {
+    const double s = 2 * std::sqrt(1 + m[1][1] - m[0][0] - m[2][2]);
+    q[3] = (m[0][2] - m[2][0]) / s;
+    q[0] = (m[0][1] + m[1][0]) / s;
+    q[1] = s / 4;
+    q[2] = (m[1][2] + m[2][1]) / s;
+  }
+  else
+  {
+    const double s = 2 * std::sqrt(1 + m[2][2] - m[0][0] - m[1][1]);
+    q[3] = (m[1][0] - m[0][1]) / s;
+    q[0] = (m[0][2] + m[2][0]) / s;
+    q[1] = (m[1][2] + m[2][1]) / s;
+    q[2] = s / 4;
+  }
+  return result;
+}
+
+NavigationTransform NavigationTransform::Compose(const NavigationTransform &first, const NavigationTransform &second)
+{
+  NavigationTransform result;
+  Multiply(second.orientation, first.orientation, result.orientation);
+  Rotate(second.orientation, first.position, result.position);
+  for (int i = 0; i < 3; ++i)
+  {
+    result.position[i] += second.position[i];
+  }
+  return result;
+}
+
+NavigationTransform NavigationTransform::Inverse() const
+{
+  // conjugate / norm^2, as vnl_quaternion::inverse()
+  const double norm2 = orientation[0] * orientation[0] + orientation[1] * orientation[1] +
+                       orientation[2] * orientation[2] + orientation[3] * orientation[3];
+  NavigationTransform inverse;
+  inverse.orientation[0] = -orientation[0] / norm2;
+  inverse.orientation[1] = -orientation[1] / norm2;
+  inverse.orientation[2] = -orientation[2] / norm2;
+  inverse.orientation[3] = orientation[3] / norm2;
+  Rotate(inverse.orientation, position, inverse.position);
+  for (int i = 0; i < 3; ++i)
+  {
+    inverse.position[i] = -inverse.position[i];
+  }
+  return inverse;
+}
+
+void NavigationTransform::ApplyTo(mitk::NavigationData *nd) const
+{
+  Compose(FromNavigationData(nd), *this).CopyTo(nd);
+}
+
+void NavigationTransform::CopyTo(mitk::NavigationData *nd) const
+{
+  nd->SetOrientation(mitk::NavigationData::OrientationType(orientation[0], orientation[1], orientation[2], orientation[3]));
+  mitk::NavigationData::PositionType p;
+  for (int i = 0; i < 3; ++i)
+  {
+    p[i] = position[i];
+  }
+  nd->SetPosition(p);
+}
+
+bool NavigationTransform::operator==(const NavigationTransform &other) const
+{
+  for (int i = 0; i < 4; ++i)
+  {
+    if (orientation[i] != other.orientation[i])
+    {
+      return false;
+    }
+  }
+  for (int i = 0; i < 3; ++i)
+  {
+    if (position[i] != other.position[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,50 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef LANCETNAVIGATIONTRANSFORM_H
+#define LANCETNAVIGATIONTRANSFORM_H
+
+#include "MitkLancetIGTExports.h"
+#include "mitkNavigationData.h"
+
+/**
+ * \brief Rigid transform as quaternion + translation, the pose part of a mitk::NavigationData.
+ *
+ * Plain data, so NavigationTree and the navigation data filters compose transforms in place
+ * without allocating. Composition follows mitk::NavigationData::Compose().
+ */
+struct MITKLANCETIGT_EXPORT NavigationTransform
+{
+  double orientation[4]{0, 0, 0, 1}; // x, y, z, r like mitk::Quaternion
+  double position[3]{0, 0, 0};
+
+  static NavigationTransform FromNavigationData(const mitk::NavigationData *nd);
+
+  /** \brief Rotation and offset of a rigid affine transform, as mitk::NavigationData::New(transform). */
+  static NavigationTransform FromAffineTransform(const mitk::AffineTransform3D *transform);
+
+  /** \brief first, then second; same as first->Compose(second) on NavigationData. */
+  static NavigationTransform Compose(const NavigationTransform &first, const NavigationTransform &second);
+
+  NavigationTransform Inverse() const;
+
+  /** \brief nd->Compose(*this) in place, keeps all other members of nd. */
+  void ApplyTo(mitk::NavigationData *nd) const;
+
+  /** \brief Sets position and orientation of nd to this transform, keeps all other members of nd. */
+  void CopyTo(mitk::NavigationData *nd) const;
+
+  bool operator==(const NavigationTransform &other) const;
+  bool operator!=(const NavigationTransform &other) const { return !(*this == other); }
+};
+
+#endif // LANCETNAVIGATIONTRANSFORM_H
@@ -1,15 +1,24 @@
 #include  "lancetTreeCoords.h"
 
+#include <algorithm>
+
+namespace
+{
+  const NavigationTransform Identity{};
+}
+
 void NavigationTree::Init(NavigationNode::Pointer root)
 {
   this->m_Root = root;
   m_SearchMap.insert_or_assign(root->m_NodeName, root);
+  m_StructureModified = true;
 }
 
 void NavigationTree::AddChild(NavigationNode::Pointer node, NavigationNode::Pointer parent) {
   parent->m_Children.push_back(node);
   node->m_Parent = parent;
   m_SearchMap.insert_or_assign(node->m_NodeName, node);
+  m_StructureModified = true;
 }
 
 void NavigationTree::AddChildren(std::vector<NavigationNode::Pointer> nodes, NavigationNode::Pointer parent) {
@@ -73,33 +82,175 @@ void NavigationTree::ComputeNdFromRootToNode(NavigationNode::Pointer node, mitk:
   {
     return;
   }
-  if (node->m_Parent.IsNotNull())
-  {
-    MITK_DEBUG << node->m_NodeName << " ->";
-    output->Compose(node->m_NavigationData);
-    ComputeNdFromRootToNode(node->m_Parent,output);
-  }
-  else
+  const int index = GetNodeIndex(node.GetPointer());
+  if (index < 0)
   {
-    MITK_DEBUG << node->m_NodeName << std::endl;
-    //output->Compose(node->m_NavigationData);
+    // not added to this tree, walk its own parents
+    for (NavigationNode *current = node.GetPointer(); current->m_Parent.IsNotNull(); current = current->m_Parent)
+    {
+      output->Compose(current->m_NavigationData);
+    }
+    return;
   }
+  Update();
+  GetTransformToRoot(index).ApplyTo(output);
 }
 
 mitk::NavigationData::Pointer NavigationTree::GetNavigationData(mitk::NavigationData::Pointer input,
                                                                 std::string inputName, std::string outputName)
 {
-  mitk::NavigationData::Pointer rootToInput = mitk::NavigationData::New();
-  ComputeNdFromRootToNode(GetNodeByName(inputName), rootToInput);
-
-  mitk::NavigationData::Pointer rootToOutput = mitk::NavigationData::New();
-  ComputeNdFromRootToNode(GetNodeByName(outputName), rootToOutput);
+  const int inputIndex = GetNodeIndex(inputName);
+  const int outputIndex = GetNodeIndex(outputName);
+  Update();
 
   mitk::NavigationData::Pointer res = input->Clone();
-  res->Compose(rootToInput);
-  res->Compose(rootToOutput->GetInverse());
-
+  GetTransform(inputIndex, outputIndex).ApplyTo(res);
   return res;
 }
 
+int NavigationTree::GetNodeIndex(const std::string &nodeName)
+{
+  auto item = m_SearchMap.find(nodeName);
+  return item != m_SearchMap.end() ? GetNodeIndex(item->second.GetPointer()) : -1;
+}
+
+int NavigationTree::GetNodeIndex(const NavigationNode *node)
+{
+  if (m_StructureModified)
+  {
+    Rebuild();
+  }
+  auto item = m_IndexMap.find(node);
+  return item != m_IndexMap.end() ? item->second : -1;
+}
+
+void NavigationTree::Update()
+{
+  if (m_StructureModified)
+  {
+    Rebuild();
+  }
 
+  // parents come first, so one pass propagates a change down its subtree
+  for (size_t i = 0; i < m_Nodes.size(); ++i)
+  {
+    const int parent = m_ParentIndices[i];
+    if (parent < 0)
+    {
+      // the top node defines the root frame, its own pose is not composed
+      m_Dirty[i] = 0;
+      continue;
+    }
+
+    const NavigationTransform toParent = NavigationTransform::FromNavigationData(m_Nodes[i]->m_NavigationData);
+    if (toParent != m_ToParent[i])
+    {
+      m_ToParent[i] = toParent;
+      m_Dirty[i] = 1;
+    }
+    if (m_Dirty[i] || m_Dirty[parent])
+    {
+      m_ToRoot[i] = NavigationTransform::Compose(m_ToParent[i], m_ToRoot[parent]);
+      m_Dirty[i] = 1;
+    }
+  }
+  std::fill(m_Dirty.begin(), m_Dirty.end(), 0);
+}
+
+const NavigationTransform &NavigationTree::GetTransformToRoot(int index) const
+{
+  return index >= 0 && index < static_cast<int>(m_ToRoot.size()) ? m_ToRoot[index] : Identity;
+}
+
+NavigationTransform NavigationTree::GetTransform(int input, int output) const
+{
+  return NavigationTransform::Compose(GetTransformToRoot(input), GetTransformToRoot(output).Inverse());
+}
+
+void NavigationTree::GetTransforms(const std::vector<FramePair> &pairs, std::vector<NavigationTransform> &transforms)
+{
+  Update();
+  transforms.resize(pairs.size());
+  for (size_t i = 0; i < pairs.size(); ++i)
+  {
+    transforms[i] = GetTransform(pairs[i].input, pairs[i].output);
+  }
+}
+
+void NavigationTree::GetNavigationData(const std::vector<mitk::NavigationData::Pointer> &inputs,
+                                       const std::vector<FramePair> &pairs,
+                                       std::vector<mitk::NavigationData::Pointer> &outputs)
+{
+  Update();
+  const size_t count = std::min(inputs.size(), pairs.size());
+  outputs.resize(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (outputs[i].IsNull())
+    {
+      outputs[i] = mitk::NavigationData::New();
+    }
+    outputs[i]->Graft(inputs[i]);
+    GetTransform(pairs[i].input, pairs[i].output).ApplyTo(outputs[i]);
+  }
+}
+
+void NavigationTree::Rebuild()
+{
+  m_Nodes.clear();
+  m_IndexMap.clear();
+  m_ParentIndices.clear();
+
+  // every node reachable from the root or added by AddChild(), each top node spans its own frame
+  if (m_Root.IsNotNull())
+  {
+    AddSubtree(m_Root);
+  }
+  for (auto &item : m_SearchMap)
+  {
+    NavigationNode *top = item.second;
+    while (top->m_Parent.IsNotNull())
+    {
+      top = top->m_Parent;
+    }
+    if (m_IndexMap.find(top) == m_IndexMap.end())
+    {
+      AddSubtree(top);
+    }
+  }
+
+  const size_t count = m_Nodes.size();
+  m_ToParent.assign(count, NavigationTransform());
+  m_ToRoot.assign(count, NavigationTransform());
+  // force a full recomputation
+  m_Dirty.assign(count, 1);
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (m_ParentIndices[i] >= 0)
+    {
+      m_ToParent[i] = NavigationTransform::FromNavigationData(m_Nodes[i]->m_NavigationData);
+    }
+  }
+  m_StructureModified = false;
+}
+
+void NavigationTree::AddSubtree(NavigationNode *top)
+{
+  std::vector<NavigationNode *> stack{top};
+  while (!stack.empty())
+  {
+    NavigationNode *node = stack.back();
+    stack.pop_back();
+    if (!m_IndexMap.emplace(node, static_cast<int>(m_Nodes.size())).second)
+    {
+      continue;
+    }
+    m_Nodes.push_back(node);
+    const auto parent = node == top ? m_IndexMap.end() : m_IndexMap.find(node->m_Parent.GetPointer());
+    m_ParentIndices.push_back(parent != m_IndexMap.end() ? parent->second : -1);
+    for (auto child = node->m_Children.rbegin(); child != node->m_Children.rend(); ++child)
+    {
+      stack.push_back(*child);
+    }
+  }
+}
@@ -1,8 +1,11 @@
 #ifndef LANCETTREECOORDS_H
 #define LANCETTREECOORDS_H
+#include <map>
+#include <unordered_map>
 #include <vector>
 
 #include "MitkLancetIGTExports.h"
+#include "lancetNavigationTransform.h"
 #include "mitkNavigationData.h"
 #include "itkObject.h"
 
@@ -29,9 +32,25 @@ public:
   mitk::NavigationData::Pointer m_NavigationData{mitk::NavigationData::New()};
 };
 
+/**
+ * \brief Tree of coordinate frames, each node holds the transform from its frame into its parent's frame.
+ *
+ * Nodes are flattened into index arrays in depth-first order (parents before children) with the
+ * node to parent transforms and cached node to root transforms. Update() copies changed node
+ * poses and recomputes the cache of every changed node and its subtree in one pass, so a frame
+ * to frame query afterwards is a single composition of two cached transforms, independent of
+ * the tree depth. Adding nodes rebuilds the arrays on the next update.
+ */
 class MITKLANCETIGT_EXPORT NavigationTree : public itk::Object
 {
 public:
+  /** \brief Pair of frames for the batch query, indices from GetNodeIndex(). */
+  struct FramePair
+  {
+    int input{-1};
+    int output{-1};
+  };
+
   mitkClassMacroItkParent(NavigationTree, itk::Object);
   itkFactorylessNewMacro(Self); //New() and CreateAnother()
   //itkCloneMacro(Self); Clone()
@@ -46,9 +65,51 @@ public:
   void PrintPathToRoot(NavigationNode::Pointer node);
   void ComputeNdFromRootToNode(NavigationNode::Pointer node,mitk::NavigationData::Pointer& output);
   mitk::NavigationData::Pointer GetNavigationData(mitk::NavigationData::Pointer input, std::string inputName, std::string outputName);
+
+  /** \brief Index of a node for the index based queries, -1 if it is not in the tree. Valid until nodes are added. */
+  int GetNodeIndex(const std::string &nodeName);
+  int GetNodeIndex(const NavigationNode *node);
+
+  /**
+   * \brief Takes over changed node poses and recomputes the cached transforms that depend on them.
+   *
+   * Call once per tick (e.g. after the tracking update); the index based queries read the cache only.
+   */
+  void Update();
+
+  /** \brief Transform of node index into the root frame, identity for -1. */
+  const NavigationTransform &GetTransformToRoot(int index) const;
+
+  /** \brief Transform from frame input into frame output, the one GetNavigationData() applies. */
+  NavigationTransform GetTransform(int input, int output) const;
+
+  /** \brief Resolves all pairs with one Update(); transforms[i] belongs to pairs[i]. */
+  void GetTransforms(const std::vector<FramePair> &pairs, std::vector<NavigationTransform> &transforms);
+
+  /**
+   * \brief Batch GetNavigationData(): outputs[i] = inputs[i] transformed from pairs[i].input to pairs[i].output.
+   *
+   * Reuses the NavigationData in outputs if it holds enough, so a render loop does not allocate.
+   */
+  void GetNavigationData(const std::vector<mitk::NavigationData::Pointer> &inputs,
+                         const std::vector<FramePair> &pairs,
+                         std::vector<mitk::NavigationData::Pointer> &outputs);
+
 private:
+  void Rebuild();
+  void AddSubtree(NavigationNode *top);
+
   NavigationNode::Pointer m_Root{};
   std::map<std::string, NavigationNode::Pointer> m_SearchMap;
+
+  // flattened tree, depth-first so parents come before their children
+  bool m_StructureModified{true};
+  std::vector<NavigationNode *> m_Nodes;
+  std::unordered_map<const NavigationNode *, int> m_IndexMap;
+  std::vector<int> m_ParentIndices;              // -1 for a top node
+  std::vector<NavigationTransform> m_ToParent;
+  std::vector<NavigationTransform> m_ToRoot;
+  std::vector<char> m_Dirty;
 };
 
 #endif // LANCETTREECOORDS_H
@@ -4,8 +4,35 @@
 
 #include "lancetKukaTrackingDeviceTypeInformation.h"
 
+#include <QTimer>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
 #define d2r 57.2957795130
 
+namespace
+{
+  // time for a real-time reply sent after a command to reach RobotApi::realtime_data
+  const std::chrono::milliseconds FeedbackDelay(2 * DATA_RATE_TIME);
+
+  // how often the realtime_data mirror is refreshed on the robot api thread, well below DATA_RATE_TIME
+  const int MirrorPeriod = 5;
+
+  // the measured values of a real-time reply, they differ between two replies unless the robot
+  // stands still and the force sensor is flat
+  bool SameRealtimeData(const RobotRealtimeData& lhs, const RobotRealtimeData& rhs)
+  {
+    return std::memcmp(&lhs.pose, &rhs.pose, sizeof(CartesianPose)) == 0
+      && std::memcmp(&lhs.joints, &rhs.joints, sizeof(Joints)) == 0
+      && lhs.ati.fx == rhs.ati.fx && lhs.ati.fy == rhs.ati.fy && lhs.ati.fz == rhs.ati.fz
+      && lhs.ati.mx == rhs.ati.mx && lhs.ati.my == rhs.ati.my && lhs.ati.mz == rhs.ati.mz
+      && lhs.wkstate == rhs.wkstate && lhs.errorcode == rhs.errorcode;
+  }
+}
+
 namespace lancet
 {
   bool KukaRobotDevice::OpenConnection()
@@ -31,7 +58,11 @@ namespace lancet
     this->m_StopTracking = false;
     this->m_StopTrackingMutex.unlock();
 
-    m_Thread = std::thread(&KukaRobotDevice::ThreadStartTracking, this);//todo start tracking agine crash here 
+    // the previous tracking thread has finished once StopTracking() returned, join it before starting a new one
+    if (m_Thread.joinable())
+      m_Thread.join();
+    m_SampleBuffer.Clear();
+    m_Thread = std::thread(&KukaRobotDevice::ThreadStartTracking, this);
     // start a new thread that executes the TrackTools() method
     mitk::IGTTimeStamp::GetInstance()->Start(this);
     MITK_INFO << "lancet kuka robot start tracking";
@@ -82,76 +113,230 @@ namespace lancet
 
   void KukaRobotDevice::TrackTools()
   {
-    m_RobotApi.requestrealtimedata();
-    m_TrackingData[0] = m_RobotApi.realtime_data.pose.x;
-    m_TrackingData[1] = m_RobotApi.realtime_data.pose.y;
-    m_TrackingData[2] = m_RobotApi.realtime_data.pose.z;
-
-    m_TrackingData[3] = m_RobotApi.realtime_data.pose.a;
-    m_TrackingData[4] = m_RobotApi.realtime_data.pose.b;
-    m_TrackingData[5] = m_RobotApi.realtime_data.pose.c;
+    // while tracking, the tracking thread is the only producer of the sample buffer
+    if (this->GetState() == Tracking)
+      return;
+    RobotPoseSample sample;
+    AcquireSample(sample);
   }
 
   std::array<double, 6> KukaRobotDevice::GetTrackingData()
   {
-    return m_TrackingData;
+    std::array<double, 6> trackingData = {};
+    RobotPoseSample sample;
+    if (m_SampleBuffer.GetLatest(sample))
+    {
+      std::copy(sample.pose, sample.pose + 6, trackingData.begin());
+    }
+    return trackingData;
+  }
+
+  bool KukaRobotDevice::GetLatestSample(RobotPoseSample& sample) const
+  {
+    return m_SampleBuffer.GetLatest(sample);
+  }
+
+  size_t KukaRobotDevice::GetSamples(long long begin, long long end, std::vector<RobotPoseSample>& samples) const
+  {
+    return m_SampleBuffer.GetWindow(begin, end, samples);
+  }
+
+  RobotSampleStatistics KukaRobotDevice::GetSampleStatistics(long long window) const
+  {
+    return m_SampleBuffer.GetStatistics(window);
+  }
+
+  void KukaRobotDevice::SetSamplePeriod(unsigned int period)
+  {
+    m_SamplePeriod = std::max(1u, period);
+  }
+
+  unsigned int KukaRobotDevice::GetSamplePeriod() const
+  {
+    return m_SamplePeriod;
+  }
+
+  bool KukaRobotDevice::AcquireSample(RobotPoseSample& sample)
+  {
+    // requestrealtimedata() only queues the request, the mirror holds the newest reply the robot api received
+    m_RobotApi.requestrealtimedata();
+    RobotRealtimeData data;
+    unsigned long long sequence;
+    long long receivedAt;
+    {
+      std::lock_guard<std::mutex> lock(m_RealtimeMutex);
+      data = m_RealtimeData;
+      sequence = m_RealtimeSequence;
+      receivedAt = m_RealtimeTime;
+    }
+    // no new reply since the last sample, it is already in the buffer
+    if (sequence == m_SampledSequence)
+      return false;
+    m_SampledSequence = sequence;
+    const CartesianPose& pose = data.pose;
+
+    // replies the loop did not sample leave a gap in the counter
+    sample.timestamp = receivedAt;
+    sample.counter = sequence;
+    sample.pose[0] = pose.x;
+    sample.pose[1] = pose.y;
+    sample.pose[2] = pose.z;
+    sample.pose[3] = pose.a;
+    sample.pose[4] = pose.b;
+    sample.pose[5] = pose.c;
+    for (double value : sample.pose)
+    {
+      if (!std::isfinite(value))
+        return false; // not yet received, the counter gap marks it
+    }
+    m_SampleBuffer.Push(sample);
+    return true;
+  }
+
+  void KukaRobotDevice::UpdateInternalTool(const RobotPoseSample& sample)
+  {
+    Eigen::Quaterniond q;
+    //kuka
+    Eigen::AngleAxisd rx(sample.pose[3] / d2r, Eigen::Vector3d::UnitZ());
+    Eigen::AngleAxisd ry(sample.pose[4] / d2r, Eigen::Vector3d::UnitY());
+    Eigen::AngleAxisd rz(sample.pose[5] / d2r, Eigen::Vector3d::UnitX());
+    //return rz.matrix()*ry.matrix()*rx.matrix(); // kuka
+
+    //Staubli
+    // Eigen::AngleAxisd rx(rxyz(0, 0) / d2r, Eigen::Vector3d::UnitX());
+    // Eigen::AngleAxisd ry(rxyz(1, 0) / d2r, Eigen::Vector3d::UnitY());
+    // Eigen::AngleAxisd rz(rxyz(2, 0) / d2r, Eigen::Vector3d::UnitZ());
+    //return rx.matrix()*ry.matrix()*rz.matrix(); // staubli
+    q = rx * ry * rz;
+
+    mitk::TrackingTool::Pointer tool = GetInternalTool();
+    mitk::Quaternion quaternion{ q.x(),q.y(),q.z(),q.w() };
+    tool->SetOrientation(quaternion);
+    mitk::Point3D position;
+    position[0] = sample.pose[0];
+    position[1] = sample.pose[1];
+    position[2] = sample.pose[2];
+
+    tool->SetPosition(position);
+    tool->SetTrackingError(0);
+    tool->SetErrorMessage("");
+    tool->SetIGTTimeStamp(mitk::IGTTimeStamp::GetInstance()->GetElapsed());
+    tool->SetDataValid(true);
   }
 
   bool KukaRobotDevice::RequestExecOperate(const QString& funname, const QStringList& param)
+  {
+    std::vector<RobotCommandQueue::Command> commands;
+    if (!CreateCommands(funname, param, commands))
+      return false;
+    for (auto& command : commands)
+      m_CommandQueue.Enqueue(std::move(command));
+    return true;
+  }
+
+  std::shared_future<bool> KukaRobotDevice::RequestExecOperateAsync(const QString& funname, const QStringList& param,
+                                                                    RobotCommandQueue::Callback callback)
+  {
+    std::vector<RobotCommandQueue::Command> commands;
+    if (!CreateCommands(funname, param, commands))
+    {
+      std::promise<bool> rejected;
+      rejected.set_value(false);
+      if (callback)
+        callback(false);
+      return rejected.get_future().share();
+    }
+    // a compound operation fails as a whole, so the last command reports it
+    std::shared_future<bool> future;
+    for (size_t i = 0; i < commands.size(); ++i)
+    {
+      future = m_CommandQueue.Enqueue(std::move(commands[i]),
+                                      i + 1 == commands.size() ? callback : RobotCommandQueue::Callback());
+    }
+    return future;
+  }
+
+  void KukaRobotDevice::CancelPendingOperations()
+  {
+    m_CommandQueue.CancelPending();
+  }
+
+  bool KukaRobotDevice::ExecOperateNow(const QString& funname, const QStringList& param)
+  {
+    std::vector<RobotCommandQueue::Command> commands;
+    if (!CreateCommands(funname, param, commands))
+      return false;
+    // nothing queued before may run after it, the motions already sent are what it acts on
+    m_CommandQueue.CancelPending();
+    for (auto& command : commands)
+    {
+      if (!command.send())
+        return false;
+    }
+    return true;
+  }
+
+  bool KukaRobotDevice::WaitForOperations(unsigned int timeout)
+  {
+    return m_CommandQueue.WaitForIdle(std::chrono::milliseconds(timeout));
+  }
+
+  void KukaRobotDevice::SetMotionPipelineDepth(unsigned int depth)
+  {
+    m_CommandQueue.SetMaxInFlight(depth);
+  }
+
+  unsigned int KukaRobotDevice::GetMotionPipelineDepth() const
+  {
+    return static_cast<unsigned int>(m_CommandQueue.GetMaxInFlight());
+  }
+
+  bool KukaRobotDevice::CreateCommands(const QString& funname, const QStringList& param,
+                                       std::vector<RobotCommandQueue::Command>& commands)
   {
     MITK_INFO << "ExecOperateFunc " << funname.toStdString();
     for (auto string : param)
     {
       MITK_INFO << "ParamList " << string.toStdString();
     }
+    double p[6]{ 0 };
+    for (int i = 0; i < param.size() && i < 6; ++i)
+    {
+      p[i] = param.at(i).toDouble();
+    }
     if (funname.indexOf("movep") != -1 && param.size() == 6)
     {
-      QThread::msleep(150);
-      this->m_RobotApi.movep(param.at(0).toDouble(),
-        param.at(1).toDouble(),
-        param.at(2).toDouble(),
-        param.at(3).toDouble(),
-        param.at(4).toDouble(),
-        param.at(5).toDouble());
+      commands.push_back(CreateMotionCommand("movep", [this, p] { m_RobotApi.movep(p[0], p[1], p[2], p[3], p[4], p[5]); }));
       return true;
     }
     if (funname.indexOf("movej") != -1 && param.size() == 6)
     {
-      QThread::msleep(150);
-      this->m_RobotApi.movej(param.at(0).toDouble(),
-        param.at(1).toDouble(),
-        param.at(2).toDouble(),
-        param.at(3).toDouble(),
-        param.at(4).toDouble(),
-        param.at(5).toDouble());
+      commands.push_back(CreateMotionCommand("movej", [this, p] { m_RobotApi.movej(p[0], p[1], p[2], p[3], p[4], p[5]); }));
       return true;
     }
     else if (funname.indexOf("movel") != -1 && param.size() == 6)
     {
-      QThread::msleep(150);
-      this->m_RobotApi.movel(param.at(0).toDouble(),
-        param.at(1).toDouble(),
-        param.at(2).toDouble(),
-        param.at(3).toDouble(),
-        param.at(4).toDouble(),
-        param.at(5).toDouble());
+      commands.push_back(CreateMotionCommand("movel", [this, p] { m_RobotApi.movel(p[0], p[1], p[2], p[3], p[4], p[5]); }));
       return true;
     }
     else if (funname.indexOf("setworkmode") != -1 && param.size() == 1)
     {
-      QThread::msleep(300);
-      this->m_RobotApi.setworkmode(param.at(0).toInt());
+      const int mode = param.at(0).toInt();
+      commands.push_back(CreateSettingCommand("setworkmode", [this, mode] { m_RobotApi.setworkmode(mode); }, true));
       return true;
     }
     else if (funname.indexOf("setTcpNum") != -1 && param.size() == 2)
     {
-      QThread::msleep(300);
-      this->m_RobotApi.setTcpNum(param.at(0).toInt(), param.at(1).toInt());
+      const int joint = param.at(0).toInt();
+      const int direction = param.at(1).toInt();
+      commands.push_back(CreateSettingCommand("setTcpNum", [this, joint, direction] { m_RobotApi.setTcpNum(joint, direction); }, true));
       return true;
     }
     else if (funname.indexOf("setio") != -1 && param.size() == 2)
     {
-      this->m_RobotApi.setio(param.at(0).toInt(), param.at(1).toInt());
+      const int bit = param.at(0).toInt();
+      const int value = param.at(1).toInt();
+      commands.push_back(CreateSettingCommand("setio", [this, bit, value] { m_RobotApi.setio(bit, value); }, false));
       return true;
     }
     else if (funname.indexOf("update") != -1 && param.size() == 0)
@@ -162,17 +347,102 @@ namespace lancet
     }
     else if (funname.toLower().indexOf("applytcpvalue") != -1 && param.size() == 6)
     {
-      qInfo() << "call movel function " << this->RequestExecOperate("movel", param) << " param " << param;
-      QThread::msleep(1000);
-      qInfo() << "call setworkmode 1-11 function " << this->RequestExecOperate("setworkmode", { "11" });
-      QThread::msleep(1000);
-      qInfo() << "call setworkmode 1-5 function " << this->RequestExecOperate("setworkmode", { "5" });
-      QThread::msleep(1000);
-      return true;
+      // movel to the tcp, then work mode 11 and 5 make the robot apply it
+      return CreateCommands("movel", param, commands)
+        && CreateCommands("setworkmode", { "11" }, commands)
+        && CreateCommands("setworkmode", { "5" }, commands);
     }
     return false;
   }
 
+  RobotCommandQueue::Command KukaRobotDevice::CreateMotionCommand(const std::string& name, std::function<void()> call)
+  {
+    // The robot reports RUNNING while it moves. A motion it never starts (e.g. already at the target)
+    // is done once the real-time feedback had time to show the robot is not running.
+    auto sentAt = std::make_shared<std::chrono::steady_clock::time_point>();
+    auto started = std::make_shared<bool>(false);
+    RobotCommandQueue::Command command;
+    command.name = name;
+    command.pipelined = true;
+    command.timeout = std::chrono::seconds(60);
+    command.send = [call, sentAt] {
+      *sentAt = std::chrono::steady_clock::now();
+      call();
+      return true;
+    };
+    command.isDone = [this, sentAt, started] {
+      if (PollWorkState() == ROBOT_STATE_RUNNING)
+      {
+        *started = true;
+        return false;
+      }
+      return *started || std::chrono::steady_clock::now() - *sentAt > FeedbackDelay;
+    };
+    command.hasFailed = [this, sentAt] {
+      return std::chrono::steady_clock::now() - *sentAt > FeedbackDelay
+        && GetRealtimeData().wkstate == ROBOT_STATE_ERROR;
+    };
+    return command;
+  }
+
+  RobotCommandQueue::Command KukaRobotDevice::CreateSettingCommand(const std::string& name, std::function<void()> call,
+                                                                   bool waitForFeedback)
+  {
+    auto sentAt = std::make_shared<std::chrono::steady_clock::time_point>();
+    RobotCommandQueue::Command command;
+    command.name = name;
+    command.timeout = std::chrono::seconds(10);
+    command.send = [call, sentAt] {
+      *sentAt = std::chrono::steady_clock::now();
+      call();
+      return true;
+    };
+    if (waitForFeedback)
+    {
+      // done once a real-time reply sent after the command shows the robot is not busy
+      command.isDone = [this, sentAt] {
+        return std::chrono::steady_clock::now() - *sentAt > FeedbackDelay && PollWorkState() != ROBOT_STATE_RUNNING;
+      };
+      command.hasFailed = [this, sentAt] {
+        return std::chrono::steady_clock::now() - *sentAt > FeedbackDelay
+          && GetRealtimeData().wkstate == ROBOT_STATE_ERROR;
+      };
+    }
+    return command;
+  }
+
+  RobotWorkState KukaRobotDevice::PollWorkState()
+  {
+    // while tracking, the tracking thread keeps the real-time data fresh
+    if (this->GetState() != Tracking)
+      m_RobotApi.requestrealtimedata();
+    return GetRealtimeData().wkstate;
+  }
+
+  RobotRealtimeData KukaRobotDevice::GetRealtimeData() const
+  {
+    std::lock_guard<std::mutex> lock(m_RealtimeMutex);
+    return m_RealtimeData;
+  }
+
+  void KukaRobotDevice::MirrorRealtimeData()
+  {
+    // runs on the robot api thread, the only thread writing realtime_data, so this read does not race it
+    if (this->GetState() == Setup)
+      return;
+    const RobotRealtimeData& data = m_RobotApi.realtime_data;
+    const long long now = RobotSampleBuffer::Now();
+    std::lock_guard<std::mutex> lock(m_RealtimeMutex);
+    // RobotApi has no reply counter. A changed reply is a new one, and since a reply arrives every
+    // DATA_RATE_TIME, an unchanged one is a new reply of a robot standing still once that period passed.
+    if (m_RealtimeSequence != 0 && SameRealtimeData(data, m_RealtimeData)
+        && now - m_RealtimeTime < DATA_RATE_TIME * 1000)
+      return;
+    m_RealtimeData = data;
+    m_RealtimeTime = now;
+    ++m_RealtimeSequence;
+  }
+
   void KukaRobotDevice::RobotMove(vtkMatrix4x4* T_robot)
   {
 
@@ -192,8 +462,8 @@ namespace lancet
 
     QString param = str1 + "," + str2 + "," + str3 + "," + str4 + "," + str5 + "," + str6;
     MITK_INFO << "Robot move to:" << param.toStdString();
+    // queued, setio follows once the robot finished the motion
     RequestExecOperate( "movep", param.split(','));
-    QThread::msleep(1000);
 	RequestExecOperate("setio", { "2","6" });
   }
 
@@ -295,6 +565,7 @@ namespace lancet
   {
     m_Data = lancet::KukaRobotTypeInformation::GetDeviceDataLancetKukaTrackingDevice();
     m_KukaEndEffectors.clear();
+    m_CommandQueue.SetMaxInFlight(1);
     ////udp service
     m_udp.setRepetitiveHeartbeatInterval(500);
     m_udp.setRemoteHostPort(m_RemotePort.toUInt());
@@ -308,11 +579,28 @@ namespace lancet
 
     connect(&m_RobotApi, SIGNAL(signal_api_isRobotConnected(bool)),
       this, SLOT(IsRobotConnected(bool)));
+
+    // realtime_data is written by the robot api's slots, running them on their own thread keeps the
+    // real-time data and the command feedback fresh while the GUI thread is busy
+    auto mirrorTimer = new QTimer(&m_RobotApi);
+    connect(mirrorTimer, &QTimer::timeout, mirrorTimer, [this] { MirrorRealtimeData(); });
+    mirrorTimer->start(MirrorPeriod);
+    m_RobotApi.moveToThread(&m_RobotApiThread);
+    m_RobotApiThread.start();
   }
 
   KukaRobotDevice::~KukaRobotDevice()
   {
+    if (this->GetState() == Tracking)
+      this->StopTracking();
+    if (m_Thread.joinable())
+      m_Thread.join();
 	  m_udp.disconnect();
+    // back to this thread, the robot api is destroyed with this device
+    QThread* thread = QThread::currentThread();
+    QMetaObject::invokeMethod(&m_RobotApi, [this, thread] { m_RobotApi.moveToThread(thread); }, Qt::BlockingQueuedConnection);
+    m_RobotApiThread.quit();
+    m_RobotApiThread.wait();
   }
 
   bool KukaRobotDevice::InternalAddTool(mitk::TrackingTool* tool)
@@ -361,14 +649,9 @@ namespace lancet
       m_Heartbeat->start();
 	  MITK_INFO << "!connect!";
 
-      //must steps for robot working state correct
+      //must steps for robot working state correct, queued so the GUI thread does not wait for the robot
       //set tcp
-	  QThread::msleep(1000);
-	  this->RequestExecOperate("movel", QStringList{ "0.0","0.0","0.0","0.0","0.0","0.0" });
-	  QThread::msleep(1000);
-	  this->RequestExecOperate("setworkmode", { "11" });
-	  QThread::msleep(1000);
-	  this->RequestExecOperate("setworkmode", { "5" });
+	  this->RequestExecOperate("applytcpvalue", QStringList{ "0.0","0.0","0.0","0.0","0.0","0.0" });
 	  //select tcp
 	  this->RequestExecOperate("setTcpNum", { "1", "5" });
 	  this->RequestExecOperate("setworkmode", { "0" });
@@ -408,46 +691,27 @@ namespace lancet
     localStopTracking = this->m_StopTracking;
     this->m_StopTrackingMutex.unlock();
 
+    // fixed rate instead of polling as fast as possible, a late iteration starts the next period right away
+    const std::chrono::milliseconds period(m_SamplePeriod);
+    auto next = std::chrono::steady_clock::now();
+    RobotPoseSample sample;
     while ((this->GetState() == Tracking) && (localStopTracking == false))
     {
-      //MITK_INFO << "tracking";
-      m_RobotApi.requestrealtimedata();
-      m_TrackingData[0] = m_RobotApi.realtime_data.pose.x;
-      m_TrackingData[1] = m_RobotApi.realtime_data.pose.y;
-      m_TrackingData[2] = m_RobotApi.realtime_data.pose.z;
-
-      m_TrackingData[3] = m_RobotApi.realtime_data.pose.a;
-      m_TrackingData[4] = m_RobotApi.realtime_data.pose.b;
-      m_TrackingData[5] = m_RobotApi.realtime_data.pose.c;
-
-      Eigen::Quaterniond q;
-      //kuka
-      Eigen::AngleAxisd rx(m_TrackingData[3] / d2r, Eigen::Vector3d::UnitZ());
-      Eigen::AngleAxisd ry(m_TrackingData[4] / d2r, Eigen::Vector3d::UnitY());
-      Eigen::AngleAxisd rz(m_TrackingData[5] / d2r, Eigen::Vector3d::UnitX());
-      //return rz.matrix()*ry.matrix()*rx.matrix(); // kuka
-
-      //Staubli
-      // Eigen::AngleAxisd rx(rxyz(0, 0) / d2r, Eigen::Vector3d::UnitX());
-      // Eigen::AngleAxisd ry(rxyz(1, 0) / d2r, Eigen::Vector3d::UnitY());
-      // Eigen::AngleAxisd rz(rxyz(2, 0) / d2r, Eigen::Vector3d::UnitZ());
-      //return rx.matrix()*ry.matrix()*rz.matrix(); // staubli
-      q = rx * ry * rz;
-
-      mitk::TrackingTool::Pointer tool = GetInternalTool();
-      mitk::Quaternion quaternion{ q.x(),q.y(),q.z(),q.w() };
-      tool->SetOrientation(quaternion);
-      mitk::Point3D position;
-      position[0] = m_TrackingData[0];
-      position[1] = m_TrackingData[1];
-      position[2] = m_TrackingData[2];
-
-      tool->SetPosition(position);
-      tool->SetTrackingError(0);
-      tool->SetErrorMessage("");
-      //tool->SetFrameNumber(/*toolData.frameNumber*/); //todo add frameNumber in robot data for debug and frame-rate count ;
-      tool->SetDataValid(true);
-
+      if (AcquireSample(sample))
+      {
+        UpdateInternalTool(sample);
+      }
+
+      next += period;
+      const auto now = std::chrono::steady_clock::now();
+      if (next < now)
+      {
+        next = now;
+      }
+      else
+      {
+        std::this_thread::sleep_until(next);
+      }
 
       /* Update the local copy of m_StopTracking */
       this->m_StopTrackingMutex.lock();
@@ -16,12 +16,14 @@
 #include <QString>
 
 #include "mitkTrackingTool.h"
+#include "lancetRobotCommandQueue.h"
 
 //KUKA ROBOT API
 #include <math.h>
 #include <math.h>
 
 #include "robotapi.h"
+#include "robotSampleBuffer.h"
 #include "udpsocketrobotheartbeat.h" //udp
 
 
@@ -74,13 +76,78 @@ namespace lancet
     mitk::TrackingTool* AddTool(const char* toolName, const char* fileName = "");
     unsigned GetToolCount() const override;
 
+    /**
+     * \brief Acquire one sample outside of tracking mode, e.g. to read the pose once.
+     */
     void TrackTools();
 
+    /**
+     * \brief x, y, z, a, b, c of the newest sample, zeros if there is none.
+     */
     std::array<double, 6> GetTrackingData();
 
+    /**
+     * \brief Newest timestamped sample of the acquisition loop, false if there is none yet.
+     */
+    bool GetLatestSample(RobotPoseSample& sample) const;
+
+    /**
+     * \brief Appends all samples with begin <= timestamp < end (RobotSampleBuffer::Now() clock), oldest first.
+     */
+    size_t GetSamples(long long begin, long long end, std::vector<RobotPoseSample>& samples) const;
+
+    /**
+     * \brief Measured rate, jitter and dropped packets of the last window microseconds.
+     * Only new real-time replies are sampled, a repeated reply does not count.
+     */
+    RobotSampleStatistics GetSampleStatistics(long long window = 1000000) const;
+
+    /**
+     * \brief Period of the acquisition loop in ms, takes effect at the next StartTracking().
+     */
+    void SetSamplePeriod(unsigned int period);
+    unsigned int GetSamplePeriod() const;
+
     //todo robotDevice api, move to RobotDevice abstract class later
+    /**
+     * \brief Queue a robot operation: movep, movej, movel, setworkmode, setTcpNum, setio or applytcpvalue.
+     *
+     * Returns immediately, false if the operation or its parameters are unknown. Operations run one after
+     * the other on the command queue, each one once the robot feedback shows the previous one executed.
+     */
     bool RequestExecOperate(const QString& funname, const QStringList& param);
 
+    /**
+     * \brief Same as RequestExecOperate(), the future and callback (called on the queue thread) receive
+     * true once the robot executed the operation, false if it was rejected, failed, timed out or was cancelled.
+     */
+    std::shared_future<bool> RequestExecOperateAsync(const QString& funname, const QStringList& param,
+                                                     RobotCommandQueue::Callback callback = RobotCommandQueue::Callback());
+
+    /**
+     * \brief Drop all queued operations that were not sent to the robot yet.
+     */
+    void CancelPendingOperations();
+
+    /**
+     * \brief Drops all queued operations and sends funname to the robot right away instead of queueing it,
+     * e.g. the emergency brake. Does not wait for the robot feedback; false if the operation or its
+     * parameters are unknown.
+     */
+    bool ExecOperateNow(const QString& funname, const QStringList& param);
+
+    /**
+     * \brief Blocks until all queued operations are done or timeout ms expired, true if done.
+     */
+    bool WaitForOperations(unsigned int timeout);
+
+    /**
+     * \brief Number of consecutive motions sent before the previous one completed, 1 (default) waits
+     * for each motion. Only raise it if the robot controller buffers motions.
+     */
+    void SetMotionPipelineDepth(unsigned int depth);
+    unsigned int GetMotionPipelineDepth() const;
+
     void RobotMove(vtkMatrix4x4* T_robot);
 
     std::vector<double> kukamatrix2angle(const double matrix3x3[3][3]);
@@ -102,11 +169,21 @@ namespace lancet
   private:
     static void heartbeatThreadWorker(KukaRobotDevice* _this);
     void ThreadStartTracking();
+    bool AcquireSample(RobotPoseSample& sample);
+    void UpdateInternalTool(const RobotPoseSample& sample);
+    bool CreateCommands(const QString& funname, const QStringList& param, std::vector<RobotCommandQueue::Command>& commands);
+    RobotCommandQueue::Command CreateMotionCommand(const std::string& name, std::function<void()> call);
+    RobotCommandQueue::Command CreateSettingCommand(const std::string& name, std::function<void()> call, bool waitForFeedback);
+    RobotWorkState PollWorkState();
+    RobotRealtimeData GetRealtimeData() const;
+    void MirrorRealtimeData();
   private:
     //bool m_IsConnected = false;
 
     QPointer<QThread> m_Heartbeat;
-    std::array<double, 6> m_TrackingData = {};
+    RobotSampleBuffer m_SampleBuffer;
+    unsigned long long m_SampledSequence{ 0 }; ///< reply of the newest sample, a reply is sampled once
+    unsigned int m_SamplePeriod{ 10 };
 
     //track
     mutable std::mutex m_ToolsMutex; ///< mutex for coordinated access of tool container
@@ -115,6 +192,11 @@ namespace lancet
     std::thread m_Thread;                            ///< ID of tracking thread
 
     //Robot
+    mutable std::mutex m_RealtimeMutex; ///< guards the mirror of m_RobotApi.realtime_data
+    RobotRealtimeData m_RealtimeData{}; ///< copied on m_RobotApiThread, where realtime_data is written
+    unsigned long long m_RealtimeSequence{ 0 }; ///< counts the replies copied into m_RealtimeData
+    long long m_RealtimeTime{ 0 }; ///< RobotSampleBuffer::Now() when m_RealtimeData was copied
+    QThread m_RobotApiThread; ///< runs the slots of m_RobotApi, declared first so it outlives it
     RobotApi m_RobotApi;
     //Device Configure
     std::string m_IpAddress{ "172.31.1.148" };
@@ -126,6 +208,9 @@ namespace lancet
     //communication
     UdpSocketRobotHeartbeat m_udp;
 
+    //last member, destroyed first: its thread calls m_RobotApi
+    RobotCommandQueue m_CommandQueue;
+
   };
 }
 
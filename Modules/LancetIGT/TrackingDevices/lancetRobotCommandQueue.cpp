@@ -0,0 +1,214 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "lancetRobotCommandQueue.h"
+
+#include <algorithm>
+
+namespace lancet
+{
+  RobotCommandQueue::RobotCommandQueue(std::chrono::milliseconds pollInterval)
+    : m_PollInterval(pollInterval)
+  {
+    m_Thread = std::thread(&RobotCommandQueue::Run, this);
+  }
+
+  RobotCommandQueue::~RobotCommandQueue()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Stop = true;
+    }
+    m_Condition.notify_all();
+    if (m_Thread.joinable())
+      m_Thread.join();
+  }
+
+  std::shared_future<bool> RobotCommandQueue::Enqueue(Command command, Callback callback)
+  {
+    Entry entry;
+    entry.command = std::move(command);
+    entry.callback = std::move(callback);
+    std::shared_future<bool> future = entry.promise.get_future().share();
+    bool stopped;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      stopped = m_Stop;
+      if (!stopped)
+        m_Pending.push_back(std::move(entry));
+    }
+    if (stopped)
+      Finish(entry, false);
+    m_Condition.notify_all();
+    return future;
+  }
+
+  void RobotCommandQueue::CancelPending()
+  {
+    std::deque<Entry> cancelled;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      cancelled.swap(m_Pending);
+    }
+    for (Entry& entry : cancelled)
+      Finish(entry, false);
+    m_Condition.notify_all();
+  }
+
+  bool RobotCommandQueue::WaitForIdle(std::chrono::milliseconds timeout)
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    return m_Condition.wait_for(lock, timeout, [this] { return m_Pending.empty() && m_InFlightCount == 0; });
+  }
+
+  size_t RobotCommandQueue::GetCount() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Pending.size() + m_InFlightCount;
+  }
+
+  void RobotCommandQueue::SetMaxInFlight(size_t maxInFlight)
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_MaxInFlight = std::max<size_t>(1, maxInFlight);
+  }
+
+  size_t RobotCommandQueue::GetMaxInFlight() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_MaxInFlight;
+  }
+
+  void RobotCommandQueue::Run()
+  {
+    for (;;)
+    {
+      Entry next;
+      bool send = false;
+      {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        if (m_InFlight.empty())
+        {
+          // nothing to poll, sleep until there is something to send
+          m_Condition.wait(lock, [this] { return m_Stop || !m_Pending.empty(); });
+        }
+        if (m_Stop)
+          break;
+        if (!m_Pending.empty() && CanSend(m_Pending.front()))
+        {
+          next = std::move(m_Pending.front());
+          m_Pending.pop_front();
+          ++m_InFlightCount;
+          send = true;
+        }
+      }
+
+      if (send)
+      {
+        next.sentAt = std::chrono::steady_clock::now();
+        if (next.command.send && !next.command.send())
+        {
+          m_InFlight.push_back(std::move(next));
+          FailAll();
+          continue;
+        }
+        m_InFlight.push_back(std::move(next));
+      }
+
+      Poll();
+
+      if (!send && !m_InFlight.empty())
+      {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait_for(lock, m_PollInterval, [this] { return m_Stop; });
+      }
+    }
+
+    // shutting down, whatever did not complete is reported as failed
+    FailAll();
+  }
+
+  bool RobotCommandQueue::CanSend(const Entry& next) const
+  {
+    return m_InFlight.empty()
+      || (next.command.pipelined && m_InFlight.back().command.pipelined && m_InFlight.size() < m_MaxInFlight);
+  }
+
+  void RobotCommandQueue::Poll()
+  {
+    if (m_InFlight.empty())
+      return;
+
+    for (const Entry& entry : m_InFlight)
+    {
+      if (entry.command.hasFailed && entry.command.hasFailed())
+      {
+        FailAll();
+        return;
+      }
+    }
+
+    // commands execute in order, the newest done one completes all older ones
+    size_t done = 0;
+    for (size_t i = m_InFlight.size(); i > 0; --i)
+    {
+      const Command& command = m_InFlight[i - 1].command;
+      if (!command.isDone || command.isDone())
+      {
+        done = i;
+        break;
+      }
+    }
+    for (size_t i = 0; i < done; ++i)
+      Finish(m_InFlight[i], true);
+    m_InFlight.erase(m_InFlight.begin(), m_InFlight.begin() + done);
+
+    if (!m_InFlight.empty()
+        && std::chrono::steady_clock::now() - m_InFlight.front().sentAt > m_InFlight.front().command.timeout)
+    {
+      FailAll();
+      return;
+    }
+
+    if (done > 0)
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_InFlightCount = m_InFlight.size();
+      }
+      m_Condition.notify_all();
+    }
+  }
+
+  void RobotCommandQueue::Finish(Entry& entry, bool success)
+  {
+    entry.promise.set_value(success);
+    if (entry.callback)
+      entry.callback(success);
+  }
+
+  void RobotCommandQueue::FailAll()
+  {
+    std::deque<Entry> failed;
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      failed.swap(m_InFlight);
+      for (Entry& entry : m_Pending)
+        failed.push_back(std::move(entry));
+      m_Pending.clear();
+      m_InFlightCount = 0;
+    }
+    for (Entry& entry : failed)
+      Finish(entry, false);
+    m_Condition.notify_all();
+  }
+}
@@ -0,0 +1,113 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef LANCETROBOTCOMMANDQUEUE_H
+#define LANCETROBOTCOMMANDQUEUE_H
+
+#include "MitkLancetIGTExports.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace lancet
+{
+  /** Documentation
+  * \brief Executes robot commands one after the other on a worker thread.
+  *
+  * A command is sent by its send function and is complete once its isDone predicate, polled
+  * on the worker thread, reports that the robot feedback shows the command executed. Callers get
+  * a future and optionally a callback instead of sleeping a fixed time between commands.
+  *
+  * Consecutive pipelined commands (e.g. motions) are sent without waiting for the previous
+  * one to complete, up to MaxInFlight at a time; they complete in order, so a later pipelined
+  * command being done completes all earlier ones.
+  *
+  * A command that cannot be sent, fails or does not complete within its timeout resolves to false and
+  * cancels all commands queued after it, since the robot state is unknown then.
+  *
+  * Callbacks run on the worker thread (or on the thread calling CancelPending()), Qt code has
+  * to forward them to the GUI thread.
+  *
+  * \ingroup Robot
+  */
+  class MITKLANCETIGT_EXPORT RobotCommandQueue
+  {
+  public:
+    using Callback = std::function<void(bool)>;
+
+    struct Command
+    {
+      std::string name;
+      std::function<bool()> send;   ///< sends the command, false if it could not be sent
+      std::function<bool()> isDone; ///< polled after sending, empty: done once sent
+      std::function<bool()> hasFailed; ///< polled before isDone, true fails like a timeout, e.g. robot error
+      std::chrono::milliseconds timeout{ 30000 };
+      bool pipelined{ false };
+    };
+
+    explicit RobotCommandQueue(std::chrono::milliseconds pollInterval = std::chrono::milliseconds(20));
+    /** \brief Cancels all pending commands and waits for the worker thread. */
+    ~RobotCommandQueue();
+
+    RobotCommandQueue(const RobotCommandQueue&) = delete;
+    RobotCommandQueue& operator=(const RobotCommandQueue&) = delete;
+
+    /** \brief Queues command, the future and callback receive true once it is done. */
+    std::shared_future<bool> Enqueue(Command command, Callback callback = Callback());
+
+    /** \brief Resolves all commands not sent yet to false; commands already sent keep running. */
+    void CancelPending();
+
+    /** \brief Blocks until all queued commands are complete or timeout expired, true if idle. */
+    bool WaitForIdle(std::chrono::milliseconds timeout);
+
+    /** \brief Number of commands queued or in flight. */
+    size_t GetCount() const;
+
+    void SetMaxInFlight(size_t maxInFlight);
+    size_t GetMaxInFlight() const;
+
+  private:
+    struct Entry
+    {
+      Command command;
+      Callback callback;
+      std::promise<bool> promise;
+      std::chrono::steady_clock::time_point sentAt;
+    };
+
+    void Run();
+    bool CanSend(const Entry& next) const;
+    void Poll();
+    static void Finish(Entry& entry, bool success);
+    void FailAll();
+
+    const std::chrono::milliseconds m_PollInterval;
+    size_t m_MaxInFlight{ 2 };
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::deque<Entry> m_Pending;  ///< guarded by m_Mutex
+    std::deque<Entry> m_InFlight; ///< sent, not complete; worker thread only
+    size_t m_InFlightCount{ 0 };  ///< guarded by m_Mutex
+    bool m_Stop{ false };
+    std::thread m_Thread;
+  };
+}
+
+#endif // LANCETROBOTCOMMANDQUEUE_H
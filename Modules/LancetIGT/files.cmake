@@ -19,12 +19,14 @@ set(H_FILES
   Algorithms/lancetApplySurfaceRegistratioinFilter.h
   Algorithms/lancetApplySurfaceRegistratioinStaticImageFilter.h
   Algorithms/lancetTreeCoords.h
+  Algorithms/lancetNavigationTransform.h
   
   Rendering/lancetNavigationObjectVisualizationFilter.h
 
   TrackingDevices/lancetRobotTrackingTool.h
   TrackingDevices/lancetKukaTrackingDeviceTypeInformation.h
   TrackingDevices/kukaRobotDevice.h
+  TrackingDevices/lancetRobotCommandQueue.h
 
   #UI/QmitkLancetKukaWidget.cpp
 )
@@ -50,12 +52,14 @@ set(CPP_FILES
   Algorithms/lancetApplySurfaceRegistratioinFilter.cpp
   Algorithms/lancetApplySurfaceRegistratioinStaticImageFilter.cpp
   Algorithms/lancetTreeCoords.cpp
+  Algorithms/lancetNavigationTransform.cpp
 
   Rendering/lancetNavigationObjectVisualizationFilter.cpp
 
   TrackingDevices/lancetRobotTrackingTool.cpp
   TrackingDevices/lancetKukaTrackingDeviceTypeInformation.cpp
   TrackingDevices/kukaRobotDevice.cpp
+  TrackingDevices/lancetRobotCommandQueue.cpp
 
   #UI/QmitkLancetKukaWidget.cpp
 )
@@ -1,5 +1,7 @@
 set(MODULE_TESTS
   lancetTreeCoordTest.cpp
+  lancetRobotCommandQueueTest.cpp
+  lancetNavigationDataFilterTest.cpp
 )
 
 SET(MODULE_CUSTOM_TESTS
@@ -0,0 +1,200 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+// Testing
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+// MITK includes
+#include "lancetApplyDeviceRegistratioinFilter.h"
+#include "lancetNavigationDataInReferenceCoordFilter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+class lancetNavigationDataFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(lancetNavigationDataFilterTestSuite);
+
+    MITK_TEST(InReferenceCoordFilter_SameAsComposedNavigationData);
+    MITK_TEST(ApplyDeviceRegistratioinFilter_SameAsComposedAffineTransform);
+    MITK_TEST(FilterChain_16ToolsAt1kHz_WithinBudget);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  static const unsigned int ToolCount = 16;
+
+  std::vector<mitk::NavigationData::Pointer> m_Tools;
+  mitk::AffineTransform3D::Pointer m_Registration;
+  mitk::NavigationData::Pointer m_ndRF;
+
+  static mitk::NavigationData::Pointer MakeNavigationData(double angle, double offset)
+  {
+    double axis[3]{1, angle, 0.5};
+    double trans[3]{offset, -2 * offset, 0.5 * offset};
+    mitk::AffineTransform3D::Pointer tmp = mitk::AffineTransform3D::New();
+    tmp->Rotate3D(axis, angle);
+    tmp->Translate(trans);
+    mitk::NavigationData::Pointer nd = mitk::NavigationData::New(tmp);
+    nd->SetDataValid(true);
+    return nd;
+  }
+
+  static bool SamePose(const mitk::NavigationData *a, const mitk::NavigationData *b)
+  {
+    // q and -q are the same rotation
+    const mitk::Quaternion qa = a->GetOrientation();
+    const mitk::Quaternion qb = b->GetOrientation();
+    const mitk::Quaternion minusQb(-qb.x(), -qb.y(), -qb.z(), -qb.r());
+    return mitk::Equal(a->GetPosition(), b->GetPosition(), 1e-6) &&
+           (mitk::Equal(qa, qb, 1e-6) || mitk::Equal(qa, minusQb, 1e-6));
+  }
+
+  lancet::NavigationDataInReferenceCoordFilter::Pointer MakeReferenceFilter()
+  {
+    lancet::NavigationDataInReferenceCoordFilter::Pointer filter = lancet::NavigationDataInReferenceCoordFilter::New();
+    for (unsigned int i = 0; i < ToolCount; ++i)
+    {
+      filter->SetInput(i, m_Tools[i]);
+    }
+    filter->SetRefToolIndex(3);
+    return filter;
+  }
+
+  lancet::ApplyDeviceRegistratioinFilter::Pointer MakeRegistrationFilter()
+  {
+    lancet::ApplyDeviceRegistratioinFilter::Pointer filter = lancet::ApplyDeviceRegistratioinFilter::New();
+    filter->SetRegistrationMatrix(m_Registration);
+    filter->SetNavigationDataOfRF(m_ndRF);
+    return filter;
+  }
+
+public:
+  void setUp() override
+  {
+    m_Tools.clear();
+    for (unsigned int i = 0; i < ToolCount; ++i)
+    {
+      m_Tools.push_back(MakeNavigationData(0.1 * i, 10.0 * i));
+    }
+    m_Registration = MakeNavigationData(0.7, 120)->GetAffineTransform3D();
+    m_ndRF = MakeNavigationData(-0.4, 35);
+  }
+
+  void tearDown() override
+  {
+    m_Tools.clear();
+    m_Registration = nullptr;
+    m_ndRF = nullptr;
+  }
+
+  void InReferenceCoordFilter_SameAsComposedNavigationData()
+  {
+    lancet::NavigationDataInReferenceCoordFilter::Pointer filter = MakeReferenceFilter();
+    filter->Update();
+
+    for (unsigned int i = 0; i < ToolCount; ++i)
+    {
+      //Tref2tool = Tref^-1 * Ttool
+      mitk::NavigationData::Pointer correct = m_Tools[i]->Clone();
+      correct->Compose(m_Tools[3]->GetInverse());
+      CPPUNIT_ASSERT_MESSAGE("Pose in reference not equal", SamePose(filter->GetOutput(i), correct));
+    }
+  }
+
+  void ApplyDeviceRegistratioinFilter_SameAsComposedAffineTransform()
+  {
+    lancet::ApplyDeviceRegistratioinFilter::Pointer filter = MakeRegistrationFilter();
+    for (unsigned int i = 0; i < ToolCount; ++i)
+    {
+      filter->SetInput(i, m_Tools[i]);
+    }
+    filter->Update();
+
+    for (unsigned int i = 0; i < ToolCount; ++i)
+    {
+      mitk::AffineTransform3D::Pointer transform = m_Tools[i]->GetAffineTransform3D();
+      transform->Compose(m_Registration);
+      transform->Compose(m_ndRF->GetAffineTransform3D());
+      mitk::NavigationData::Pointer correct = mitk::NavigationData::New(transform);
+      CPPUNIT_ASSERT_MESSAGE("Registered pose not equal", SamePose(filter->GetOutput(i), correct));
+    }
+
+    //a changed registration matrix is picked up
+    double trans[3]{5, 0, 0};
+    m_Registration->Translate(trans);
+    filter->Update();
+    mitk::AffineTransform3D::Pointer transform = m_Tools[0]->GetAffineTransform3D();
+    transform->Compose(m_Registration);
+    transform->Compose(m_ndRF->GetAffineTransform3D());
+    CPPUNIT_ASSERT_MESSAGE("Changed registration not applied",
+                           SamePose(filter->GetOutput(0), mitk::NavigationData::New(transform)));
+  }
+
+  void FilterChain_16ToolsAt1kHz_WithinBudget()
+  {
+    MITK_TEST_OUTPUT(<< "---- Benchmark: reference + device registration filter, 16 tools, 1 kHz ----");
+    lancet::NavigationDataInReferenceCoordFilter::Pointer referenceFilter = MakeReferenceFilter();
+    lancet::ApplyDeviceRegistratioinFilter::Pointer registrationFilter = MakeRegistrationFilter();
+    registrationFilter->ConnectTo(referenceFilter);
+
+    using Clock = std::chrono::steady_clock;
+    const int cycles = 1000;
+    const Clock::duration period = std::chrono::milliseconds(1);
+    double totalMicroseconds = 0;
+    double maxMicroseconds = 0;
+    int overruns = 0;
+
+    Clock::time_point next = Clock::now();
+    for (int cycle = 0; cycle < cycles; ++cycle)
+    {
+      // new poses every frame, as a tracking device would deliver them
+      for (unsigned int i = 0; i < ToolCount; ++i)
+      {
+        mitk::NavigationData::PositionType position = m_Tools[i]->GetPosition();
+        position[0] += 0.01;
+        m_Tools[i]->SetPosition(position);
+      }
+
+      const Clock::time_point start = Clock::now();
+      registrationFilter->Update();
+      const double microseconds = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+      totalMicroseconds += microseconds;
+      maxMicroseconds = std::max(maxMicroseconds, microseconds);
+
+      next += period;
+      if (Clock::now() > next)
+      {
+        ++overruns;
+        next = Clock::now();
+      }
+      std::this_thread::sleep_until(next);
+    }
+
+    const double meanMicroseconds = totalMicroseconds / cycles;
+    MITK_TEST_OUTPUT(<< "filter chain update: mean " << meanMicroseconds << " us, max " << maxMicroseconds
+                     << " us, missed 1 ms deadlines " << overruns << " of " << cycles);
+
+    //the last frame must still be right
+    mitk::NavigationData::Pointer correct = m_Tools[5]->Clone();
+    correct->Compose(m_Tools[3]->GetInverse());
+    mitk::AffineTransform3D::Pointer transform = correct->GetAffineTransform3D();
+    transform->Compose(m_Registration);
+    transform->Compose(m_ndRF->GetAffineTransform3D());
+    CPPUNIT_ASSERT_MESSAGE("Chain output not equal", SamePose(registrationFilter->GetOutput(5), mitk::NavigationData::New(transform)));
+
+    CPPUNIT_ASSERT_MESSAGE("Filter chain does not fit into the 1 ms frame budget", meanMicroseconds < 1000.0);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(lancetNavigationDataFilter)
@@ -0,0 +1,129 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+// Testing
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+// MITK includes
+#include "lancetRobotCommandQueue.h"
+
+#include <atomic>
+#include <vector>
+
+class lancetRobotCommandQueueTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(lancetRobotCommandQueueTestSuite);
+
+    MITK_TEST(Enqueue_CommandsCompleteInOrder);
+    MITK_TEST(Enqueue_WaitsForFeedback);
+    MITK_TEST(Enqueue_PipelinedCommandsOverlap);
+    MITK_TEST(Enqueue_TimeoutCancelsFollowingCommands);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  using Queue = lancet::RobotCommandQueue;
+
+  static Queue::Command MakeCommand(const std::string& name, std::function<bool()> send,
+                                    std::function<bool()> isDone = std::function<bool()>(), bool pipelined = false)
+  {
+    Queue::Command command;
+    command.name = name;
+    command.send = send;
+    command.isDone = isDone;
+    command.pipelined = pipelined;
+    command.timeout = std::chrono::milliseconds(2000);
+    return command;
+  }
+
+public:
+  void Enqueue_CommandsCompleteInOrder()
+  {
+    Queue queue(std::chrono::milliseconds(1));
+    std::mutex mutex;
+    std::vector<int> sent;
+    std::vector<int> completed;
+    std::vector<std::shared_future<bool>> futures;
+    for (int i = 0; i < 5; ++i)
+    {
+      futures.push_back(queue.Enqueue(
+        MakeCommand("setio", [&, i] { std::lock_guard<std::mutex> lock(mutex); sent.push_back(i); return true; }),
+        [&, i](bool success) { std::lock_guard<std::mutex> lock(mutex); if (success) completed.push_back(i); }));
+    }
+    for (auto& future : futures)
+      CPPUNIT_ASSERT(future.get());
+    CPPUNIT_ASSERT(queue.WaitForIdle(std::chrono::milliseconds(1000)));
+    CPPUNIT_ASSERT(sent == std::vector<int>({ 0, 1, 2, 3, 4 }));
+    CPPUNIT_ASSERT(completed == std::vector<int>({ 0, 1, 2, 3, 4 }));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), queue.GetCount());
+  }
+
+  void Enqueue_WaitsForFeedback()
+  {
+    Queue queue(std::chrono::milliseconds(1));
+    std::atomic<bool> robotIdle{ false };
+    std::atomic<bool> secondSent{ false };
+    auto first = queue.Enqueue(MakeCommand("movep", [] { return true; }, [&] { return robotIdle.load(); }));
+    auto second = queue.Enqueue(MakeCommand("setworkmode", [&] { secondSent = true; return true; }));
+
+    CPPUNIT_ASSERT(first.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+    CPPUNIT_ASSERT_MESSAGE("A command is not sent before the previous one completed.", !secondSent);
+    robotIdle = true;
+    CPPUNIT_ASSERT(first.get());
+    CPPUNIT_ASSERT(second.get());
+    CPPUNIT_ASSERT(secondSent);
+  }
+
+  void Enqueue_PipelinedCommandsOverlap()
+  {
+    Queue queue(std::chrono::milliseconds(1));
+    queue.SetMaxInFlight(2);
+    std::atomic<int> sent{ 0 };
+    std::atomic<bool> secondDone{ false };
+    auto first = queue.Enqueue(MakeCommand("movep", [&] { ++sent; return true; }, [] { return false; }, true));
+    auto second = queue.Enqueue(
+      MakeCommand("movep", [&] { ++sent; return true; }, [&] { return secondDone.load(); }, true));
+    auto third = queue.Enqueue(MakeCommand("movep", [&] { ++sent; return true; }, {}, true));
+
+    // the first two are sent at once, the third waits for a free slot
+    for (int i = 0; i < 100 && sent < 2; ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CPPUNIT_ASSERT_EQUAL(2, sent.load());
+
+    // the robot finished the second motion, so it also finished the first one
+    secondDone = true;
+    CPPUNIT_ASSERT(first.get());
+    CPPUNIT_ASSERT(second.get());
+    CPPUNIT_ASSERT(third.get());
+    CPPUNIT_ASSERT_EQUAL(3, sent.load());
+  }
+
+  void Enqueue_TimeoutCancelsFollowingCommands()
+  {
+    Queue queue(std::chrono::milliseconds(1));
+    std::atomic<bool> followingSent{ false };
+    Queue::Command stuck = MakeCommand("movej", [] { return true; }, [] { return false; });
+    stuck.timeout = std::chrono::milliseconds(30);
+    auto first = queue.Enqueue(stuck);
+    auto second = queue.Enqueue(MakeCommand("setio", [&] { followingSent = true; return true; }));
+
+    CPPUNIT_ASSERT(!first.get());
+    CPPUNIT_ASSERT(!second.get());
+    CPPUNIT_ASSERT(!followingSent);
+
+    // the queue keeps working afterwards
+    CPPUNIT_ASSERT(queue.Enqueue(MakeCommand("setio", [] { return true; })).get());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(lancetRobotCommandQueue)
@@ -28,6 +28,8 @@ class lancetTreeCoordTestSuite : public mitk::TestFixture
     MITK_TEST(GetNavigationData_SameBranch);
     MITK_TEST(GetNavigationData_DiffBranch);
     MITK_TEST(GetNavigationData_FromRootToChild);
+    MITK_TEST(GetNavigationData_NodeModified_CacheUpdated);
+    MITK_TEST(GetNavigationData_Batch_SameAsSingleQueries);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -228,6 +230,55 @@ public:
     MITK_TEST_OUTPUT(<< res);
     MITK_TEST_OUTPUT(<< correct);
   }
+
+  void GetNavigationData_NodeModified_CacheUpdated()
+  {
+    MITK_TEST_OUTPUT(<< "---- Testing method GetNavigationData() after a node changed ----");
+    //fill the cache, then move C: D hangs below C and has to follow
+    m_NavigationTree->GetNavigationData(m_ndInput, "B", "D");
+    mitk::NavigationData::PositionType position = m_ndC->GetPosition();
+    position[0] += 10;
+    m_NodeC->m_NavigationData->SetPosition(position);
+
+    mitk::NavigationData::Pointer res = m_NavigationTree->GetNavigationData(m_ndInput, "B", "D");
+    mitk::NavigationData::Pointer correct = m_ndInput->Clone();
+    correct->Compose(m_ndB);
+    correct->Compose(m_ndC->GetInverse());
+    correct->Compose(m_ndD->GetInverse());
+    CPPUNIT_ASSERT_MESSAGE("Orientation not equal", mitk::Equal(res->GetOrientation(), correct->GetOrientation()));
+    CPPUNIT_ASSERT_MESSAGE("Position not equal", mitk::Equal(res->GetPosition(), correct->GetPosition()));
+  }
+
+  void GetNavigationData_Batch_SameAsSingleQueries()
+  {
+    MITK_TEST_OUTPUT(<< "---- Testing batch method GetNavigationData() ----");
+    const char *names[]{"A", "B", "C", "D"};
+    std::vector<mitk::NavigationData::Pointer> inputs;
+    std::vector<NavigationTree::FramePair> pairs;
+    for (const char *input : names)
+    {
+      for (const char *output : names)
+      {
+        inputs.push_back(m_ndInput);
+        pairs.push_back({m_NavigationTree->GetNodeIndex(input), m_NavigationTree->GetNodeIndex(output)});
+      }
+    }
+    std::vector<mitk::NavigationData::Pointer> outputs;
+    m_NavigationTree->GetNavigationData(inputs, pairs, outputs);
+    CPPUNIT_ASSERT_EQUAL(inputs.size(), outputs.size());
+
+    for (size_t i = 0; i < outputs.size(); ++i)
+    {
+      mitk::NavigationData::Pointer correct = m_NavigationTree->GetNavigationData(m_ndInput, names[i / 4], names[i % 4]);
+      CPPUNIT_ASSERT_MESSAGE("Orientation not equal", mitk::Equal(outputs[i]->GetOrientation(), correct->GetOrientation()));
+      CPPUNIT_ASSERT_MESSAGE("Position not equal", mitk::Equal(outputs[i]->GetPosition(), correct->GetPosition()));
+    }
+
+    //a second call reuses the output objects
+    mitk::NavigationData *first = outputs[0];
+    m_NavigationTree->GetNavigationData(inputs, pairs, outputs);
+    CPPUNIT_ASSERT(first == outputs[0].GetPointer());
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(lancetTreeCoord)
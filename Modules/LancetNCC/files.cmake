@@ -1,9 +1,11 @@
 set(H_FILES
   include/lancetNCC.h
+  include/lancetGeoMatchEngine.h
 )
 
 set(CPP_FILES
   lancetNCC.cpp
+  lancetGeoMatchEngine.cpp
 )
 
 
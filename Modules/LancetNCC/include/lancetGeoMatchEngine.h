@@ -0,0 +1,109 @@
+#ifndef LANCETGEOMATCHENGINE_H
+#define LANCETGEOMATCHENGINE_H
+#include "MitkLANCETNCCExports.h"
+#include "lancetNCC.h"
+
+#include <memory>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+/*
+ * Parallel coarse-to-fine edge based template matching.
+ *
+ * Same score as GeoMatch: the mean over the model edge points of the dot product of the
+ * normalized template gradient and the normalized search image gradient. Differences:
+ * - the normalized Sobel gradients of the search image are computed once by SetSearchImage()
+ *   into contiguous, 64 byte aligned float rows and reused by every search;
+ * - a model is built for every level of an image pyramid; candidates are found on the
+ *   coarsest level and refined in a small window on every finer level;
+ * - a score row is accumulated model point by model point over contiguous columns, which
+ *   vectorizes, and rows are split across threads.
+ * Positions use the GeoMatch convention: CvPoint::x is the row, CvPoint::y the column.
+ */
+class MITKLANCETNCC_EXPORT GeoMatchEngine
+{
+public:
+	GeoMatchEngine();
+	~GeoMatchEngine();
+
+	// Use the model of an existing GeoMatch as single (finest) level, no pyramid
+	bool SetModel(const GeoMatch& geoMatch);
+
+	// Build the model of every pyramid level from an 8 bit template (see GeoMatch::CreateGeoMatchModel).
+	// Coarse levels are dropped while the downsampled template has no edge left.
+	bool CreateModel(const void* templateArr, double maxContrast, double minContrast, int pyramidLevels = 3);
+
+	// Compute the search image pyramid and its normalized gradients, 8 bit images only
+	bool SetSearchImage(const void* srcarr);
+
+	// Best match on the finest level, 0 if no candidate reached minScore on the coarse levels
+	double FindBestMatch(double minScore, CvPoint* resultPoint) const;
+
+	// Single pass multi-target search: the score map is built once (densely on a single level,
+	// coarse-to-fine otherwise), then the best peaks above minScore are taken in decreasing order,
+	// suppressing every peak inside the ellipse of radii (radiusRows, radiusColumns) around a kept one.
+	// foundPoints (x = row, y = column) are matches from earlier searches: they suppress their
+	// surroundings but are not returned again.
+	// Returns the number of new matches, at most matchNum.
+	int FindAllMatches(double minScore, int matchNum, double radiusRows, double radiusColumns,
+		const std::vector<CvPoint>& foundPoints, std::vector<CvPoint>& resultPoints,
+		std::vector<double>* resultScores = nullptr) const;
+
+	// Full score map of a pyramid level (CV_32F, size of that level)
+	void ComputeScoreMap(int level, cv::Mat& scores) const;
+
+	int GetNumberOfLevels() const { return static_cast<int>(m_Models.size()); }
+
+	// number of worker threads, 0 means std::thread::hardware_concurrency()
+	void SetNumberOfThreads(unsigned int n) { m_NumberOfThreads = n; }
+	unsigned int GetNumberOfThreads() const;
+
+	// coarse levels accept candidates scoring at least ratio * minScore (downsampling blurs edges)
+	void SetCoarseScoreRatio(double ratio) { m_CoarseScoreRatio = ratio; }
+	// maximum number of coarse candidates refined down to the finest level
+	void SetMaxCandidates(int n) { m_MaxCandidates = n; }
+
+protected:
+	struct LevelModel
+	{
+		std::vector<int> row;		// offsets relative to the center of gravity, sorted by row
+		std::vector<int> column;
+		std::vector<float> gx;		// normalized template gradient
+		std::vector<float> gy;
+	};
+
+	struct LevelImage
+	{
+		int rows{ 0 };
+		int cols{ 0 };
+		cv::Mat gx;					// normalized gradient, CV_32F, columns padded to 16 floats
+		cv::Mat gy;
+	};
+
+	struct Candidate
+	{
+		int row;
+		int column;
+		float score;
+	};
+
+	float ScoreAt(int level, int row, int column) const;
+	void ScoreRows(int level, int rowBegin, int rowEnd, cv::Mat& scores) const;
+	// local maxima of a score map above minScore, best first, at most maxCount
+	std::vector<Candidate> FindPeaks(const cv::Mat& scores, float minScore, int maxCount) const;
+	// refine candidates found on level + 1 in a window on level
+	std::vector<Candidate> Refine(int level, const std::vector<Candidate>& coarse, float minScore) const;
+	// coarse-to-fine search down to the finest level
+	std::vector<Candidate> Search(double minScore, int maxCandidates) const;
+	void AppendModel(const GeoMatch& geoMatch);
+
+	std::vector<LevelModel> m_Models;
+	std::vector<LevelImage> m_Images;
+
+	unsigned int m_NumberOfThreads{ 0 };
+	double m_CoarseScoreRatio{ 0.7 };
+	int m_MaxCandidates{ 64 };
+};
+
+#endif // LANCETGEOMATCHENGINE_H
@@ -53,8 +53,26 @@ public:
 		double pixelSize_y, double steelballSize /*mm*/, 
 		mitk::PointSet::Pointer resultPointSet);
 
+	// Single pass version of FindAllGeoMatchModel: the score map is built once, then the
+	// best matchNum peaks above minScore are taken, suppressing the peaks closer than
+	// 3 * steelballSize (mm) to a kept one. Points already in resultPointSet suppress the same
+	// way; up to matchNum new points are added, as in the multi-pass search. The gradients
+	// and the score are the ones of GeoMatchEngine (exact score, no greediness).
+	bool FindAllGeoMatchModelSinglePass(const void* srcarr, double minScore,
+		int matchNum, double pixelSize_x,
+		double pixelSize_y, double steelballSize /*mm*/,
+		mitk::PointSet::Pointer resultPointSet);
+
 	void DrawContours(IplImage* pImage, CvPoint COG, CvScalar, int);
 	void DrawContours(IplImage* pImage, CvScalar, int);
+
+	// Read access to the model, used by GeoMatchEngine
+	bool IsModelDefined() const { return modelDefined; }
+	int GetNumberOfCoordinates() const { return noOfCordinates; }
+	const CvPoint* GetCoordinates() const { return cordinates; }		// x: row, y: column relative to the center of gravity
+	const double* GetEdgeDerivativeX() const { return edgeDerivativeX; }
+	const double* GetEdgeDerivativeY() const { return edgeDerivativeY; }
+	const double* GetEdgeMagnitude() const { return edgeMagnitude; }	// 1 / gradient magnitude
 };
 
 #endif // LANCETNCC_H
\ No newline at end of file
@@ -0,0 +1,448 @@
+#include "lancetGeoMatchEngine.h"
+
+#include "parallelForBlocks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+
+#include <opencv2/imgproc.hpp>
+
+namespace
+{
+	// rows of a score map handed to a worker at once
+	const int ROW_BLOCK = 8;
+	// search window radius on a finer level around a coarse candidate (in pixels of the finer level)
+	const int REFINE_RADIUS = 2;
+}
+
+GeoMatchEngine::GeoMatchEngine() = default;
+
+GeoMatchEngine::~GeoMatchEngine() = default;
+
+unsigned int GeoMatchEngine::GetNumberOfThreads() const
+{
+	return lancetAlgorithm::ResolveThreadCount(m_NumberOfThreads);
+}
+
+void GeoMatchEngine::AppendModel(const GeoMatch& geoMatch)
+{
+	const int count = geoMatch.GetNumberOfCoordinates();
+	const CvPoint* coordinates = geoMatch.GetCoordinates();
+	const double* derivativeX = geoMatch.GetEdgeDerivativeX();
+	const double* derivativeY = geoMatch.GetEdgeDerivativeY();
+	const double* magnitude = geoMatch.GetEdgeMagnitude();
+
+	// sort the edge points by row so that consecutive points read the same gradient rows
+	std::vector<int> order(count);
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [coordinates](int a, int b) {
+		return coordinates[a].x != coordinates[b].x ? coordinates[a].x < coordinates[b].x : coordinates[a].y < coordinates[b].y;
+	});
+
+	LevelModel model;
+	model.row.reserve(count);
+	model.column.reserve(count);
+	model.gx.reserve(count);
+	model.gy.reserve(count);
+	for (int index : order)
+	{
+		model.row.push_back(coordinates[index].x);
+		model.column.push_back(coordinates[index].y);
+		model.gx.push_back(static_cast<float>(derivativeX[index] * magnitude[index]));
+		model.gy.push_back(static_cast<float>(derivativeY[index] * magnitude[index]));
+	}
+	m_Models.push_back(std::move(model));
+}
+
+bool GeoMatchEngine::SetModel(const GeoMatch& geoMatch)
+{
+	m_Models.clear();
+	m_Images.clear();
+	if (!geoMatch.IsModelDefined() || geoMatch.GetNumberOfCoordinates() == 0)
+	{
+		return false;
+	}
+	this->AppendModel(geoMatch);
+	return true;
+}
+
+bool GeoMatchEngine::CreateModel(const void* templateArr, double maxContrast, double minContrast, int pyramidLevels)
+{
+	m_Models.clear();
+	m_Images.clear();
+
+	cv::Mat level = cv::cvarrToMat(templateArr);
+	if (level.type() != CV_8UC1)
+	{
+		return false;
+	}
+
+	for (int l = 0; l < std::max(pyramidLevels, 1); ++l)
+	{
+		if (l > 0)
+		{
+			// stop before the template gets too small to carry an edge model
+			if (level.rows < 16 || level.cols < 16)
+			{
+				break;
+			}
+			cv::Mat down;
+			cv::pyrDown(level, down);
+			level = down;
+		}
+
+		GeoMatch geoMatch;
+		IplImage iplLevel = cvIplImage(level);
+		if (!geoMatch.CreateGeoMatchModel(&iplLevel, maxContrast, minContrast))
+		{
+			break;
+		}
+
+		this->AppendModel(geoMatch);
+	}
+
+	return !m_Models.empty();
+}
+
+bool GeoMatchEngine::SetSearchImage(const void* srcarr)
+{
+	m_Images.clear();
+
+	cv::Mat level = cv::cvarrToMat(srcarr);
+	if (level.type() != CV_8UC1 || m_Models.empty())
+	{
+		return false;
+	}
+
+	for (size_t l = 0; l < m_Models.size(); ++l)
+	{
+		if (l > 0)
+		{
+			cv::Mat down;
+			cv::pyrDown(level, down);
+			level = down;
+		}
+
+		cv::Mat sobelX, sobelY;
+		cv::Sobel(level, sobelX, CV_16S, 1, 0, 3);
+		cv::Sobel(level, sobelY, CV_16S, 0, 1, 3);
+
+		LevelImage image;
+		image.rows = level.rows;
+		image.cols = level.cols;
+		// 16 floats per row padding keeps every row 64 byte aligned (cv::Mat data is 64 byte aligned)
+		const int paddedCols = (level.cols + 15) & ~15;
+		image.gx = cv::Mat::zeros(level.rows, paddedCols, CV_32F);
+		image.gy = cv::Mat::zeros(level.rows, paddedCols, CV_32F);
+
+		lancetAlgorithm::ParallelForBlocks(level.rows, this->GetNumberOfThreads(), ROW_BLOCK * 4, [&](int rowBegin, int rowEnd) {
+			for (int i = rowBegin; i < rowEnd; ++i)
+			{
+				const short* sx = sobelX.ptr<short>(i);
+				const short* sy = sobelY.ptr<short>(i);
+				float* gx = image.gx.ptr<float>(i);
+				float* gy = image.gy.ptr<float>(i);
+				for (int j = 0; j < level.cols; ++j)
+				{
+					const float fx = sx[j];
+					const float fy = sy[j];
+					const float magnitude = std::sqrt(fx * fx + fy * fy);
+					const float inverse = magnitude > 0.000001f ? 1.0f / magnitude : 0.0f;
+					gx[j] = fx * inverse;
+					gy[j] = fy * inverse;
+				}
+			}
+		});
+
+		m_Images.push_back(std::move(image));
+	}
+	return true;
+}
+
+float GeoMatchEngine::ScoreAt(int level, int row, int column) const
+{
+	const LevelModel& model = m_Models[level];
+	const LevelImage& image = m_Images[level];
+
+	float sum = 0.0f;
+	const size_t count = model.row.size();
+	for (size_t m = 0; m < count; ++m)
+	{
+		const int r = row + model.row[m];
+		const int c = column + model.column[m];
+		if (r < 0 || c < 0 || r >= image.rows || c >= image.cols)
+		{
+			continue;
+		}
+		sum += model.gx[m] * image.gx.ptr<float>(r)[c] + model.gy[m] * image.gy.ptr<float>(r)[c];
+	}
+	return count > 0 ? sum / count : 0.0f;
+}
+
+void GeoMatchEngine::ScoreRows(int level, int rowBegin, int rowEnd, cv::Mat& scores) const
+{
+	const LevelModel& model = m_Models[level];
+	const LevelImage& image = m_Images[level];
+	const size_t count = model.row.size();
+	const float normalization = count > 0 ? 1.0f / count : 0.0f;
+
+	for (int i = rowBegin; i < rowEnd; ++i)
+	{
+		float* score = scores.ptr<float>(i);
+		std::fill(score, score + image.cols, 0.0f);
+
+		// score[j] += t . s(i + row, j + column) for every model point, over contiguous columns
+		for (size_t m = 0; m < count; ++m)
+		{
+			const int r = i + model.row[m];
+			if (r < 0 || r >= image.rows)
+			{
+				continue;
+			}
+			const int dc = model.column[m];
+			const int jBegin = std::max(0, -dc);
+			const int jEnd = std::min(image.cols, image.cols - dc);
+			const float tx = model.gx[m];
+			const float ty = model.gy[m];
+			const float* sx = image.gx.ptr<float>(r) + jBegin + dc;
+			const float* sy = image.gy.ptr<float>(r) + jBegin + dc;
+			float* out = score + jBegin;
+			const int length = jEnd - jBegin;
+			for (int j = 0; j < length; ++j)
+			{
+				out[j] += tx * sx[j] + ty * sy[j];
+			}
+		}
+
+		for (int j = 0; j < image.cols; ++j)
+		{
+			score[j] *= normalization;
+		}
+	}
+}
+
+void GeoMatchEngine::ComputeScoreMap(int level, cv::Mat& scores) const
+{
+	if (level < 0 || level >= static_cast<int>(m_Images.size()))
+	{
+		scores.release();
+		return;
+	}
+	const LevelImage& image = m_Images[level];
+	scores.create(image.rows, image.cols, CV_32F);
+	lancetAlgorithm::ParallelForBlocks(image.rows, this->GetNumberOfThreads(), ROW_BLOCK, [&](int rowBegin, int rowEnd) {
+		this->ScoreRows(level, rowBegin, rowEnd, scores);
+	});
+}
+
+std::vector<GeoMatchEngine::Candidate> GeoMatchEngine::FindPeaks(const cv::Mat& scores, float minScore, int maxCount) const
+{
+	std::vector<Candidate> peaks;
+	for (int i = 0; i < scores.rows; ++i)
+	{
+		const float* row = scores.ptr<float>(i);
+		for (int j = 0; j < scores.cols; ++j)
+		{
+			const float value = row[j];
+			if (value < minScore)
+			{
+				continue;
+			}
+			// 3x3 local maximum, ties go to the first position
+			bool isPeak = true;
+			for (int di = -1; di <= 1 && isPeak; ++di)
+			{
+				const int r = i + di;
+				if (r < 0 || r >= scores.rows)
+				{
+					continue;
+				}
+				const float* neighbours = scores.ptr<float>(r);
+				for (int dj = -1; dj <= 1; ++dj)
+				{
+					const int c = j + dj;
+					if ((di == 0 && dj == 0) || c < 0 || c >= scores.cols)
+					{
+						continue;
+					}
+					const bool before = di < 0 || (di == 0 && dj < 0);
+					if (neighbours[c] > value || (before && neighbours[c] == value))
+					{
+						isPeak = false;
+						break;
+					}
+				}
+			}
+			if (isPeak)
+			{
+				peaks.push_back({ i, j, value });
+			}
+		}
+	}
+
+	auto byScore = [](const Candidate& a, const Candidate& b) { return a.score > b.score; };
+	if (maxCount > 0 && static_cast<int>(peaks.size()) > maxCount)
+	{
+		std::partial_sort(peaks.begin(), peaks.begin() + maxCount, peaks.end(), byScore);
+		peaks.resize(maxCount);
+	}
+	else
+	{
+		std::sort(peaks.begin(), peaks.end(), byScore);
+	}
+	return peaks;
+}
+
+std::vector<GeoMatchEngine::Candidate> GeoMatchEngine::Refine(int level, const std::vector<Candidate>& coarse, float minScore) const
+{
+	const LevelImage& image = m_Images[level];
+	std::vector<Candidate> refined(coarse.size(), Candidate{ 0, 0, -1.0f });
+
+	lancetAlgorithm::ParallelForBlocks(coarse.size(), this->GetNumberOfThreads(), 1, [&](int begin, int end) {
+		for (int c = begin; c < end; ++c)
+		{
+			const int centerRow = coarse[c].row * 2;
+			const int centerColumn = coarse[c].column * 2;
+			Candidate& best = refined[c];
+			for (int i = std::max(0, centerRow - REFINE_RADIUS); i <= std::min(image.rows - 1, centerRow + REFINE_RADIUS); ++i)
+			{
+				for (int j = std::max(0, centerColumn - REFINE_RADIUS); j <= std::min(image.cols - 1, centerColumn + REFINE_RADIUS); ++j)
+				{
+					const float score = this->ScoreAt(level, i, j);
+					if (score > best.score)
+					{
+						best = { i, j, score };
+					}
+				}
+			}
+		}
+	});
+
+	// drop weak candidates and the ones that converged onto the same position
+	std::sort(refined.begin(), refined.end(), [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+	std::vector<Candidate> result;
+	for (const auto& candidate : refined)
+	{
+		if (candidate.score < minScore)
+		{
+			break;
+		}
+		const bool duplicate = std::any_of(result.begin(), result.end(), [&candidate](const Candidate& kept) {
+			return std::abs(kept.row - candidate.row) <= 1 && std::abs(kept.column - candidate.column) <= 1;
+		});
+		if (!duplicate)
+		{
+			result.push_back(candidate);
+		}
+	}
+	return result;
+}
+
+std::vector<GeoMatchEngine::Candidate> GeoMatchEngine::Search(double minScore, int maxCandidates) const
+{
+	if (m_Images.empty() || m_Images.size() != m_Models.size())
+	{
+		return {};
+	}
+
+	const int coarsest = static_cast<int>(m_Images.size()) - 1;
+	auto levelMinScore = [&](int level) {
+		return static_cast<float>(level > 0 ? minScore * m_CoarseScoreRatio : minScore);
+	};
+
+	cv::Mat scores;
+	this->ComputeScoreMap(coarsest, scores);
+	std::vector<Candidate> candidates = this->FindPeaks(scores, levelMinScore(coarsest), maxCandidates);
+
+	for (int level = coarsest - 1; level >= 0 && !candidates.empty(); --level)
+	{
+		candidates = this->Refine(level, candidates, levelMinScore(level));
+	}
+	return candidates;
+}
+
+double GeoMatchEngine::FindBestMatch(double minScore, CvPoint* resultPoint) const
+{
+	const std::vector<Candidate> candidates = this->Search(minScore, m_MaxCandidates);
+	if (candidates.empty())
+	{
+		return 0.0;
+	}
+	resultPoint->x = candidates.front().row;
+	resultPoint->y = candidates.front().column;
+	return candidates.front().score;
+}
+
+int GeoMatchEngine::FindAllMatches(double minScore, int matchNum, double radiusRows, double radiusColumns,
+	const std::vector<CvPoint>& foundPoints, std::vector<CvPoint>& resultPoints, std::vector<double>* resultScores) const
+{
+	resultPoints.clear();
+	if (resultScores)
+	{
+		resultScores->clear();
+	}
+	if (matchNum <= 0 || m_Images.empty() || m_Images.size() != m_Models.size())
+	{
+		return 0;
+	}
+
+	std::vector<Candidate> candidates;
+	if (m_Images.size() == 1)
+	{
+		cv::Mat scores;
+		this->ComputeScoreMap(0, scores);
+		candidates = this->FindPeaks(scores, static_cast<float>(minScore), 0);
+	}
+	else
+	{
+		candidates = this->Search(minScore, std::max(m_MaxCandidates, 4 * matchNum));
+	}
+
+	// candidates are sorted by decreasing score: greedy non-maximum suppression
+	const double inverseRows = radiusRows > 0.0 ? 1.0 / radiusRows : 0.0;
+	const double inverseColumns = radiusColumns > 0.0 ? 1.0 / radiusColumns : 0.0;
+	// the earlier matches suppress like kept ones
+	std::vector<Candidate> kept;
+	for (const auto& point : foundPoints)
+	{
+		kept.push_back(Candidate{ point.x, point.y, 0.0f });
+	}
+	const size_t firstNew = kept.size();
+	for (const auto& candidate : candidates)
+	{
+		if (candidate.score <= minScore)
+		{
+			break;
+		}
+		const bool suppressed = std::any_of(kept.begin(), kept.end(), [&](const Candidate& other) {
+			const double dr = (candidate.row - other.row) * inverseRows;
+			const double dc = (candidate.column - other.column) * inverseColumns;
+			return dr * dr + dc * dc < 1.0;
+		});
+		if (suppressed)
+		{
+			continue;
+		}
+		kept.push_back(candidate);
+		if (static_cast<int>(kept.size() - firstNew) == matchNum)
+		{
+			break;
+		}
+	}
+
+	for (size_t i = firstNew; i < kept.size(); ++i)
+	{
+		const Candidate& candidate = kept[i];
+		CvPoint point;
+		point.x = candidate.row;
+		point.y = candidate.column;
+		resultPoints.push_back(point);
+		if (resultScores)
+		{
+			resultScores->push_back(candidate.score);
+		}
+	}
+	return static_cast<int>(kept.size() - firstNew);
+}
@@ -1,4 +1,5 @@
 ﻿#include "lancetNCC.h"
+#include "lancetGeoMatchEngine.h"
 #include <stdio.h>
 #include <tchar.h>
 
@@ -6,6 +7,10 @@ GeoMatch::GeoMatch(void)
 {
 	noOfCordinates = 0;  // Initilize  no of cppodinates in model points
 	modelDefined = false;
+	cordinates = nullptr;
+	edgeMagnitude = nullptr;
+	edgeDerivativeX = nullptr;
+	edgeDerivativeY = nullptr;
 }
 
 
@@ -219,6 +224,16 @@ int GeoMatch::CreateGeoMatchModel(const void* templateArr, double maxContrast, d
 		}
 	}
 	// cout << "noOfCordinates: " << noOfCordinates;
+	if (noOfCordinates == 0)
+	{
+		// no edge survived the contrast thresholds, e.g. a too small template
+		delete[] orients;
+		cvReleaseMat(&gx);
+		cvReleaseMat(&gy);
+		cvReleaseMat(&nmsEdges);
+		ReleaseDoubleMatrix(magMat, Ssize.height);
+		return 0;
+	}
 	centerOfGravity.x = RSum / noOfCordinates; // center of gravity
 	centerOfGravity.y = CSum / noOfCordinates;	// center of gravity
 
@@ -548,6 +563,48 @@ bool GeoMatch::FindAllGeoMatchModel(const void* srcarr, double minScore, double
 	return false;
 }
 
+bool GeoMatch::FindAllGeoMatchModelSinglePass(const void* srcarr, double minScore,
+	int matchNum, double pixelSize_x, double pixelSize_y,
+	double steelballSize /*mm*/, mitk::PointSet::Pointer resultPointSet)
+{
+	GeoMatchEngine engine;
+	if (!engine.SetModel(*this) || !engine.SetSearchImage(srcarr))
+	{
+		return false;
+	}
+
+	// suppression radius in pixels along rows (y) and columns (x), 3 steel balls as in
+	// FindGeoMatchModelEnhanced
+	const double radius = 3 * steelballSize;
+	double radiusRows = pixelSize_y > 0 ? radius / pixelSize_y : radius;
+	double radiusColumns = pixelSize_x > 0 ? radius / pixelSize_x : radius;
+
+	// points already in resultPointSet suppress their surroundings, matchNum new points are searched
+	std::vector<CvPoint> foundPoints;
+	for (int k{0}; k < resultPointSet->GetSize(); k++)
+	{
+		CvPoint point;
+		point.x = cvRound(resultPointSet->GetPoint(k)[1] / (pixelSize_y > 0 ? pixelSize_y : 1.0));
+		point.y = cvRound(resultPointSet->GetPoint(k)[0] / (pixelSize_x > 0 ? pixelSize_x : 1.0));
+		foundPoints.push_back(point);
+	}
+
+	std::vector<CvPoint> newPoints;
+	engine.FindAllMatches(minScore, matchNum, radiusRows, radiusColumns, foundPoints, newPoints);
+
+	for (const auto& point : newPoints)
+	{
+		mitk::Point3D newPoint;
+		newPoint[0] = point.y * pixelSize_x;
+		newPoint[1] = point.x * pixelSize_y;
+		newPoint[2] = 0;
+
+		resultPointSet->InsertPoint(newPoint);
+	}
+
+	return resultPointSet->GetSize() == matchNum;
+}
+
 // destructor
 GeoMatch::~GeoMatch(void)
 {
@@ -1,9 +1,23 @@
 set(H_FILES
   include/surfaceregistraion.h
+  include/pointKdTree.h
+  include/surfaceKdTree.h
+  include/icpEngine.h
+  include/triangleBvh.h
+  include/surfaceDistanceCache.h
+  include/pointSetMatcher.h
+  include/landmarkSolver.h
 )
 
 set(CPP_FILES
   surfaceregistraion.cpp
+  pointKdTree.cpp
+  surfaceKdTree.cpp
+  icpEngine.cpp
+  triangleBvh.cpp
+  surfaceDistanceCache.cpp
+  pointSetMatcher.cpp
+  landmarkSolver.cpp
 )
 
 
@@ -0,0 +1,108 @@
+#ifndef ICPENGINE_H
+#define ICPENGINE_H
+
+#include "MitkLancetRegistrationExports.h"
+#include "pointKdTree.h"
+
+#include <vector>
+
+namespace mitk
+{
+  /**Documentation
+  * \brief Rigid ICP of a point set onto a target stored in a PointKdTree.
+  *
+  * Every iteration looks the correspondences up in parallel, rejects pairs farther than
+  * MaxCorrespondenceDistance and keeps the TrimFraction closest ones, then solves the
+  * linearized point-to-plane problem (6x6 normal equations) or, without target normals,
+  * the closed-form point-to-point problem. The RMS of the kept pairs is recorded per iteration.
+  *
+  * Matrices are row-major 4x4 arrays (vtkMatrix4x4::GetData() layout). The target points are
+  * given in the target's local frame, TargetToWorld maps them into the frame of the source points.
+  * The result maps the source points onto the target in that frame.
+  * \ingroup IGT
+  */
+  class MITKLANCETREGISTRATION_EXPORT IcpEngine
+  {
+  public:
+    IcpEngine();
+
+    /** @brief Target tree and optional per-point unit normals (x,y,z triplets in tree order, may be null).
+      * Both must stay alive while the engine is used.
+      */
+    void SetTarget(const PointKdTree* tree, const double* normals, const double targetToWorld[16] = nullptr);
+    /** @brief Source points as x,y,z triplets, copied.
+      */
+    void SetSource(const double* points, size_t count);
+    void SetInitialTransform(const double matrix[16]);
+
+    void SetMaximumNumberOfIterations(int n) { m_MaximumNumberOfIterations = n; }
+    /** @brief Stop when the RMS changes less than this between two iterations (mm).
+      */
+    void SetRmsTolerance(double tolerance) { m_RmsTolerance = tolerance; }
+    /** @brief Fraction (0,1] of the closest correspondences used by every iteration.
+      */
+    void SetTrimFraction(double fraction) { m_TrimFraction = fraction; }
+    /** @brief Pairs farther apart are rejected, 0 disables the test.
+      */
+    void SetMaxCorrespondenceDistance(double distance) { m_MaxCorrespondenceDistance = distance; }
+    void SetPointToPlane(bool on) { m_PointToPlane = on; }
+    /** @brief Source points are uniformly subsampled down to this count, 0 keeps them all.
+      */
+    void SetMaximumNumberOfSourcePoints(size_t n) { m_MaximumNumberOfSourcePoints = n; }
+    /** @brief number of worker threads, 0 means std::thread::hardware_concurrency()
+      */
+    void SetNumberOfThreads(unsigned int n) { m_NumberOfThreads = n; }
+
+    bool Run();
+
+    void GetTransform(double matrix[16]) const;
+    const std::vector<double>& GetRmsHistory() const { return m_RmsHistory; }
+    /** @brief RMS of the kept correspondences at the final transform.
+      */
+    double GetFinalRms() const { return m_FinalRms; }
+    int GetNumberOfIterations() const { return static_cast<int>(m_RmsHistory.size()); }
+    /** @brief Duration of the last Run() in ms.
+      */
+    double GetElapsedTime() const { return m_ElapsedTime; }
+
+    /** @brief Distance of every given point (in the source frame, moved by the result) to the target:
+      * point-to-plane distance to the nearest target point when normals are known, else point distance.
+      */
+    void ComputeResiduals(const double* points, size_t count, std::vector<double>& distances) const;
+
+  private:
+    struct Correspondence
+    {
+      double source[3];   // moved source point, target frame
+      double target[3];
+      const double* normal;
+      double squaredDistance;
+      bool valid;
+    };
+
+    void FindCorrespondences(const double sourceToTarget[16]);
+    double SelectCorrespondences();
+
+    const PointKdTree* m_Tree{ nullptr };
+    const double* m_Normals{ nullptr };
+    double m_TargetToWorld[16];
+    double m_InitialTransform[16];
+    double m_Transform[16];
+    std::vector<double> m_Source;
+    std::vector<Correspondence> m_Correspondences;
+
+    int m_MaximumNumberOfIterations{ 100 };
+    double m_RmsTolerance{ 1e-5 };
+    double m_TrimFraction{ 1.0 };
+    double m_MaxCorrespondenceDistance{ 0.0 };
+    bool m_PointToPlane{ true };
+    size_t m_MaximumNumberOfSourcePoints{ 0 };
+    unsigned int m_NumberOfThreads{ 0 };
+
+    std::vector<double> m_RmsHistory;
+    double m_FinalRms{ 0.0 };
+    double m_ElapsedTime{ 0.0 };
+  };
+} // namespace mitk
+
+#endif // ICPENGINE_H
@@ -0,0 +1,56 @@
+#ifndef LANDMARKSOLVER_H
+#define LANDMARKSOLVER_H
+
+#include "MitkLancetRegistrationExports.h"
+#include <mitkPointSet.h>
+
+#include <cstddef>
+
+namespace mitk
+{
+  /**Documentation
+  * \brief Closed-form rigid landmark registration (Horn / Umeyama, no scaling).
+  *
+  * Equivalent to vtkLandmarkTransform in rigid body mode. Only the centroids and the 3x3
+  * cross-covariance of the paired points are accumulated, so solving never allocates, whatever
+  * the number of landmarks; the residual errors are evaluated in the same call.
+  * All methods are static and thread-safe.
+  * \ingroup IGT
+  */
+  class MITKLANCETREGISTRATION_EXPORT LandmarkSolver
+  {
+  public:
+    struct Result
+    {
+      bool valid{ false };
+      double matrix[16]{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 }; // source to target, row-major
+      double maxError{ 0.0 };   // distance of a transformed source point to its target, mm
+      double avgError{ 0.0 };
+    };
+
+    /** @brief Rigid transform mapping source[i] onto target[i], count x,y,z triplets each.
+      * Returns false (identity result) for no points or a non finite solution.
+      */
+    static bool Solve(const double* source, const double* target, size_t count, Result& result);
+
+    /** @brief Same on the first min(source size, target size) points of two point sets, by position.
+      */
+    static bool Solve(const mitk::PointSet* source, const mitk::PointSet* target, Result& result);
+
+    /** @brief Fixed number of landmarks known at compile time, e.g. the 3 points of a base triangle.
+      */
+    template <size_t N>
+    static bool Solve(const double (&source)[N][3], const double (&target)[N][3], Result& result)
+    {
+      return Solve(&source[0][0], &target[0][0], N, result);
+    }
+
+    /** @brief Solve numberOfSets independent landmark sets of count pairs each, set k starting at
+      * sources + 3 * count * k and targets + 3 * count * k, in parallel. Returns the number of valid results.
+      */
+    static size_t SolveBatch(const double* sources, const double* targets, size_t count, size_t numberOfSets,
+                             Result* results, unsigned int numberOfThreads = 0);
+  };
+} // namespace mitk
+
+#endif // LANDMARKSOLVER_H
@@ -0,0 +1,59 @@
+#ifndef POINTKDTREE_H
+#define POINTKDTREE_H
+
+#include "MitkLancetRegistrationExports.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace mitk
+{
+  /**Documentation
+  * \brief Static 3D k-d tree for nearest neighbour queries.
+  *
+  * The points are copied and reordered into leaf buckets on Build(); queries are const and
+  * can run concurrently from any number of threads.
+  * \ingroup IGT
+  */
+  class MITKLANCETREGISTRATION_EXPORT PointKdTree
+  {
+  public:
+    /** @brief Build the tree over count points stored as x,y,z triplets.
+      */
+    void Build(const double* points, size_t count);
+
+    /** @brief Index (in the array given to Build) of the point nearest to query.
+     *@return -1 if the tree is empty or no point is closer than sqrt(maxSquaredDistance).
+      */
+    long long FindNearest(const double query[3], double& squaredDistance,
+                          double maxSquaredDistance = 1e300) const;
+
+    size_t GetNumberOfPoints() const { return m_Indices.size(); }
+    /** @brief Point i in the order given to Build.
+      */
+    const double* GetPoint(size_t i) const { return &m_OriginalPoints[3 * i]; }
+    void GetBounds(double bounds[6]) const;
+
+  private:
+    struct Node
+    {
+      double split;     // split coordinate, inner nodes only
+      int axis;         // split axis, -1 for a leaf
+      int left;         // child nodes, inner nodes only
+      int right;
+      unsigned int begin; // bucket of a leaf in m_Points / m_Indices
+      unsigned int end;
+    };
+
+    int BuildNode(unsigned int begin, unsigned int end);
+    void Search(int node, const double query[3], long long& best, double& bestDistance) const;
+
+    std::vector<Node> m_Nodes;
+    std::vector<double> m_Points;         // reordered into leaf buckets
+    std::vector<unsigned int> m_Indices;  // original index of every reordered point
+    std::vector<double> m_OriginalPoints;
+    double m_Bounds[6]{ 0, 0, 0, 0, 0, 0 };
+  };
+} // namespace mitk
+
+#endif // POINTKDTREE_H
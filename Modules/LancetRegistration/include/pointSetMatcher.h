@@ -0,0 +1,86 @@
+#ifndef POINTSETMATCHER_H
+#define POINTSETMATCHER_H
+
+#include "MitkLancetRegistrationExports.h"
+#include <mitkPointSet.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace mitk
+{
+  /**Documentation
+  * \brief Correspondence-free rigid matching of two small point sets.
+  *
+  * Finds the rigid transform mapping the source points onto the target points without knowing
+  * which point corresponds to which; the smaller set may be any subset of the larger one and
+  * may contain outliers. Triangles of the smaller set are matched against all point triples of
+  * the larger set having the same side lengths (distances are invariant under rigid motion),
+  * every candidate pose is verified by counting the points landing within Tolerance of a distinct
+  * point of the other set, and the best pose is refined on all its matches.
+  *
+  * Replaces enumerating all subsets and running a landmark registration on each.
+  * \ingroup IGT
+  */
+  class MITKLANCETREGISTRATION_EXPORT PointSetMatcher
+  {
+  public:
+    struct Result
+    {
+      bool success{ false };
+      double matrix[16]{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 }; // source to target, row-major
+      std::vector<int> correspondences;   // target index of every source point, -1 if unmatched
+      int numberOfMatches{ 0 };
+      double maxError{ 0.0 };             // over the matched pairs, mm
+      double avgError{ 0.0 };
+      double elapsedTime{ 0.0 };          // ms
+    };
+
+    void SetSourcePoints(const double* points, size_t count);
+    void SetSourcePoints(const mitk::PointSet* pointSet);
+    void SetTargetPoints(const double* points, size_t count);
+    void SetTargetPoints(const mitk::PointSet* pointSet);
+
+    /** @brief Maximal deviation of a distance or of a matched point (mm), default 1.5
+      */
+    void SetTolerance(double tolerance) { m_Tolerance = tolerance; }
+    /** @brief Matches required for success, 0 (default) means every point of the smaller set
+      */
+    void SetMinimumNumberOfMatches(int n) { m_MinimumNumberOfMatches = n; }
+    /** @brief Base triangles of the smaller set tried before giving up, largest first
+      */
+    void SetMaximumNumberOfBaseTriangles(int n) { m_MaximumNumberOfBaseTriangles = n; }
+
+    bool Match();
+    const Result& GetResult() const { return m_Result; }
+
+    /** @brief Distance of every point to every other point, row by row without the diagonal:
+      * count * (count - 1) values, the distance fingerprint of point i starts at i * (count - 1).
+      */
+    static void ComputeDistanceFingerprints(const double* points, size_t count, std::vector<double>& fingerprints);
+    static void ComputeDistanceFingerprints(const mitk::PointSet* pointSet, std::vector<double>& fingerprints);
+
+  private:
+    struct Candidate
+    {
+      double matrix[16];            // smaller set to larger set
+      std::vector<int> matches;     // larger set index of every point of the smaller set, -1 if none
+      int numberOfMatches{ 0 };
+      double sumSquaredError{ 0.0 };
+    };
+
+    // matches of the smaller set points under the pose in candidate.matrix, one-to-one
+    void Verify(const std::vector<double>& small, const std::vector<double>& large, Candidate& candidate) const;
+    // least-squares rigid pose from the current matches of candidate
+    static bool FitMatches(const std::vector<double>& small, const std::vector<double>& large, Candidate& candidate);
+
+    std::vector<double> m_Source;
+    std::vector<double> m_Target;
+    double m_Tolerance{ 1.5 };
+    int m_MinimumNumberOfMatches{ 0 };
+    int m_MaximumNumberOfBaseTriangles{ 64 };
+    Result m_Result;
+  };
+} // namespace mitk
+
+#endif // POINTSETMATCHER_H
@@ -0,0 +1,69 @@
+#ifndef SURFACEDISTANCECACHE_H
+#define SURFACEDISTANCECACHE_H
+
+#include "MitkLancetRegistrationExports.h"
+#include "triangleBvh.h"
+#include "mitkSurface.h"
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+#include <vtkType.h>
+
+class vtkMatrix4x4;
+class vtkPolyData;
+
+namespace mitk
+{
+  /**Documentation
+  * \brief Signed distance queries on a surface, cached on the surface.
+  *
+  * Replaces vtkImplicitPolyDataDistance for repeated queries: the triangle BVH is built once in
+  * the local frame of the polydata and stored as a SmartPointerProperty of the surface, so ICP
+  * error metrics, probe checks etc. on the same surface share it. It is rebuilt when the polydata
+  * is modified. Distances are positive outside (along the triangle normals).
+  * \ingroup IGT
+  */
+  class MITKLANCETREGISTRATION_EXPORT SurfaceDistanceCache : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(SurfaceDistanceCache, itk::Object);
+    itkNewMacro(Self);
+
+    /** @brief name of the surface property holding the cache
+      */
+    static const char* GetPropertyName() { return "Registration.DistanceCache"; }
+
+    /** @brief cached distance query of surface, built if missing or outdated
+     *@return nullptr if the surface has no polygons
+      */
+    static SurfaceDistanceCache::Pointer GetOrCreate(const mitk::Surface* surface);
+
+    /** @brief signed distance of a point given in the local frame of the polydata
+      */
+    double EvaluateSignedDistance(const double point[3], double closestPoint[3] = nullptr) const;
+    /** @brief signed distances of count points (x,y,z triplets) in parallel;
+      * pointsToLocal maps the points into the local frame of the polydata, null for identity
+      */
+    void EvaluateSignedDistances(const double* points, size_t count, double* distances,
+                                 vtkMatrix4x4* pointsToLocal = nullptr) const;
+
+    const TriangleBvh& GetBvh() const { return m_Bvh; }
+    /** @brief milliseconds spent building the BVH
+      */
+    itkGetMacro(BuildTime, double);
+
+  protected:
+    SurfaceDistanceCache();
+    ~SurfaceDistanceCache() override;
+
+    bool IsValidFor(const vtkPolyData* polyData) const;
+    void Build(vtkPolyData* polyData);
+
+  private:
+    TriangleBvh m_Bvh;
+    const vtkPolyData* m_PolyData{ nullptr };
+    vtkMTimeType m_PolyDataTime{ 0 };
+    double m_BuildTime{ 0.0 };
+  };
+} // namespace mitk
+
+#endif // SURFACEDISTANCECACHE_H
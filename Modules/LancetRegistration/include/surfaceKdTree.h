@@ -0,0 +1,65 @@
+#ifndef SURFACEKDTREE_H
+#define SURFACEKDTREE_H
+
+#include "MitkLancetRegistrationExports.h"
+#include "pointKdTree.h"
+#include "mitkSurface.h"
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+#include <vtkType.h>
+
+class vtkPolyData;
+
+namespace mitk
+{
+  /**Documentation
+  * \brief k-d tree and area weighted vertex normals of a surface, cached on the surface.
+  *
+  * The tree is built over the vertices in the local frame of the polydata (the geometry of the
+  * surface is not applied) and stored as a SmartPointerProperty of the surface, so every
+  * registration on the same surface shares it. It is rebuilt when the polydata is modified.
+  * \ingroup IGT
+  */
+  class MITKLANCETREGISTRATION_EXPORT SurfaceKdTree : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(SurfaceKdTree, itk::Object);
+    itkNewMacro(Self);
+
+    /** @brief name of the surface property holding the cache
+      */
+    static const char* GetPropertyName() { return "Registration.KdTree"; }
+
+    /** @brief cached tree of surface, built if missing or outdated
+     *@return nullptr if the surface has no points
+      */
+    static SurfaceKdTree::Pointer GetOrCreate(const mitk::Surface* surface);
+
+    const PointKdTree& GetTree() const { return m_Tree; }
+    /** @brief unit vertex normals as x,y,z triplets, zero for vertices without a polygon
+      */
+    const double* GetNormals() const { return m_Normals.data(); }
+    const double* GetPoints() const { return m_Tree.GetPoint(0); }
+    size_t GetNumberOfPoints() const { return m_Tree.GetNumberOfPoints(); }
+
+    /** @brief milliseconds spent building the tree and normals
+      */
+    itkGetMacro(BuildTime, double);
+
+  protected:
+    SurfaceKdTree();
+    ~SurfaceKdTree() override;
+
+    bool IsValidFor(const vtkPolyData* polyData) const;
+    void Build(vtkPolyData* polyData);
+
+  private:
+    PointKdTree m_Tree;
+    std::vector<double> m_Normals;
+    const vtkPolyData* m_PolyData{ nullptr };
+    vtkMTimeType m_PolyDataTime{ 0 };
+    double m_BuildTime{ 0.0 };
+  };
+} // namespace mitk
+
+#endif // SURFACEKDTREE_H
@@ -26,6 +26,21 @@ namespace mitk
     itkSetMacro(SurfaceSrc, mitk::Surface::Pointer);
 	itkSetMacro(SurfaceTarget, mitk::Surface::Pointer);
 
+    /** @brief Use the k-d tree ICP engine (default) instead of vtkIterativeClosestPointTransform
+      */
+    itkSetMacro(UseNativeIcp, bool);
+    itkGetMacro(UseNativeIcp, bool);
+    itkBooleanMacro(UseNativeIcp);
+    /** @brief Fraction of the closest correspondences kept by every ICP iteration (trimmed ICP),
+      * 1.0 (default) keeps all of them
+      */
+    itkSetMacro(IcpTrimFraction, double);
+    itkGetMacro(IcpTrimFraction, double);
+    itkSetMacro(SurfaceIcpTrimFraction, double);
+    itkGetMacro(SurfaceIcpTrimFraction, double);
+    itkSetMacro(IcpMaximumNumberOfIterations, int);
+    itkGetMacro(IcpMaximumNumberOfIterations, int);
+
     /** @brief add target landmark to LandmarkTarget pointSet
       */
     void AddLandMark(mitk::Point3D point);
@@ -71,6 +86,12 @@ namespace mitk
 	itkGetMacro(avgLandmarkError, double);
 	itkGetMacro(maxIcpError, double);
 	itkGetMacro(avgIcpError, double);
+    /** @brief RMS of the kept correspondences per iteration of the last native ICP
+      */
+    const std::vector<double>& GetIcpRmsHistory() const { return m_IcpRmsHistory; }
+    /** @brief Duration of the last native ICP in ms
+      */
+    itkGetMacro(IcpTime, double);
     //itkGetMacro(MatrixICP, vtkMatrix4x4*);
 
         
@@ -98,6 +119,13 @@ namespace mitk
 	// Surface-surface ICP
 	mitk::Surface::Pointer m_SurfaceTarget;
 
+    bool m_UseNativeIcp{ true };
+    double m_IcpTrimFraction{ 1.0 };
+    double m_SurfaceIcpTrimFraction{ 1.0 };
+    int m_IcpMaximumNumberOfIterations{ 100 };
+    std::vector<double> m_IcpRmsHistory;
+    double m_IcpTime{ 0 };
+
 
     bool m_ContinuesRegist{ false };
   };
@@ -0,0 +1,66 @@
+#ifndef TRIANGLEBVH_H
+#define TRIANGLEBVH_H
+
+#include "MitkLancetRegistrationExports.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace mitk
+{
+  /**Documentation
+  * \brief Bounding volume hierarchy over a triangle mesh for exact signed distance queries.
+  *
+  * The sign is taken from the angle weighted pseudo normal of the closest feature (face, edge
+  * or vertex), so it is consistent for closed, consistently oriented meshes: positive outside,
+  * i.e. on the side the triangle normals point to, like vtkImplicitPolyDataDistance.
+  * Queries are const and can run concurrently from any number of threads.
+  * \ingroup IGT
+  */
+  class MITKLANCETREGISTRATION_EXPORT TriangleBvh
+  {
+  public:
+    /** @brief Build over pointCount points (x,y,z triplets) and triangleCount triangles
+      * (three point indices each). The data is copied.
+      */
+    void Build(const double* points, size_t pointCount, const unsigned int* triangles, size_t triangleCount);
+
+    size_t GetNumberOfTriangles() const { return m_Triangles.size() / 3; }
+
+    /** @brief Signed distance of point to the mesh, closest surface point optionally returned.
+      * Returns 0 for an empty mesh.
+      */
+    double EvaluateSignedDistance(const double point[3], double closestPoint[3] = nullptr) const;
+
+    /** @brief Signed distances of count points (x,y,z triplets), computed in parallel.
+      * pointsToMesh (row-major 4x4, may be null) maps the points into the frame of the mesh.
+      */
+    void EvaluateSignedDistances(const double* points, size_t count, double* distances,
+                                 const double pointsToMesh[16] = nullptr, unsigned int numberOfThreads = 0) const;
+
+  private:
+    struct Node
+    {
+      double bounds[6];
+      int left;            // -1 for a leaf
+      int right;
+      unsigned int begin;  // triangles of a leaf in m_Order
+      unsigned int end;
+    };
+
+    int BuildNode(unsigned int begin, unsigned int end, std::vector<double>& centers);
+    double BoxSquaredDistance(const Node& node, const double point[3]) const;
+    // squared distance, closest point and pseudo normal of the closest feature of triangle t
+    double ClosestPointOnTriangle(unsigned int t, const double point[3], double closest[3], const double*& normal) const;
+
+    std::vector<double> m_Points;
+    std::vector<unsigned int> m_Triangles;
+    std::vector<unsigned int> m_Order;          // triangle indices in leaf order
+    std::vector<double> m_FaceNormals;          // 3 per triangle
+    std::vector<double> m_EdgeNormals;          // 9 per triangle: edges ab, bc, ca
+    std::vector<double> m_VertexNormals;        // 3 per point, angle weighted
+    std::vector<Node> m_Nodes;
+  };
+} // namespace mitk
+
+#endif // TRIANGLEBVH_H
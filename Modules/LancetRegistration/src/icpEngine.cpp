@@ -0,0 +1,353 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "icpEngine.h"
+#include "parallelForBlocks.h"
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+  using RowMatrix4d = Eigen::Matrix<double, 4, 4, Eigen::RowMajor>;
+
+  const size_t BLOCK_SIZE = 1024;
+
+  RowMatrix4d ToMatrix(const double matrix[16])
+  {
+    return Eigen::Map<const RowMatrix4d>(matrix);
+  }
+
+  void FromMatrix(const RowMatrix4d& matrix, double out[16])
+  {
+    Eigen::Map<RowMatrix4d> map(out);
+    map = matrix;
+  }
+}
+
+mitk::IcpEngine::IcpEngine()
+{
+  FromMatrix(RowMatrix4d::Identity(), m_TargetToWorld);
+  FromMatrix(RowMatrix4d::Identity(), m_InitialTransform);
+  FromMatrix(RowMatrix4d::Identity(), m_Transform);
+}
+
+void mitk::IcpEngine::SetTarget(const PointKdTree* tree, const double* normals, const double targetToWorld[16])
+{
+  m_Tree = tree;
+  m_Normals = normals;
+  if (targetToWorld != nullptr)
+  {
+    std::copy_n(targetToWorld, 16, m_TargetToWorld);
+  }
+  else
+  {
+    FromMatrix(RowMatrix4d::Identity(), m_TargetToWorld);
+  }
+}
+
+void mitk::IcpEngine::SetSource(const double* points, size_t count)
+{
+  m_Source.assign(points, points + 3 * count);
+}
+
+void mitk::IcpEngine::SetInitialTransform(const double matrix[16])
+{
+  std::copy_n(matrix, 16, m_InitialTransform);
+}
+
+void mitk::IcpEngine::GetTransform(double matrix[16]) const
+{
+  std::copy_n(m_Transform, 16, matrix);
+}
+
+void mitk::IcpEngine::FindCorrespondences(const double sourceToTarget[16])
+{
+  const RowMatrix4d matrix = ToMatrix(sourceToTarget);
+  const Eigen::Matrix3d rotation = matrix.topLeftCorner<3, 3>();
+  const Eigen::Vector3d translation = matrix.topRightCorner<3, 1>();
+
+  lancetAlgorithm::ParallelForBlocks(m_Correspondences.size(), m_NumberOfThreads, BLOCK_SIZE,
+    [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i)
+      {
+        Correspondence& c = m_Correspondences[i];
+        const Eigen::Vector3d p = rotation * Eigen::Vector3d::Map(&m_Source[3 * i]) + translation;
+        Eigen::Vector3d::Map(c.source) = p;
+
+        const long long index = m_Tree->FindNearest(c.source, c.squaredDistance);
+        c.valid = index >= 0;
+        if (c.valid)
+        {
+          std::copy_n(m_Tree->GetPoint(index), 3, c.target);
+          c.normal = m_Normals != nullptr ? m_Normals + 3 * index : nullptr;
+        }
+      }
+    });
+}
+
+double mitk::IcpEngine::SelectCorrespondences()
+{
+  const double maxSquaredDistance =
+    m_MaxCorrespondenceDistance > 0.0 ? m_MaxCorrespondenceDistance * m_MaxCorrespondenceDistance : 1e300;
+
+  std::vector<double> distances;
+  distances.reserve(m_Correspondences.size());
+  for (auto& c : m_Correspondences)
+  {
+    c.valid = c.valid && c.squaredDistance <= maxSquaredDistance;
+    if (c.valid)
+    {
+      distances.push_back(c.squaredDistance);
+    }
+  }
+  if (distances.empty())
+  {
+    return -1.0;
+  }
+
+  // trimmed ICP: keep the closest TrimFraction of the pairs
+  if (m_TrimFraction < 1.0)
+  {
+    const size_t keep = std::max<size_t>(3, static_cast<size_t>(std::ceil(m_TrimFraction * distances.size())));
+    if (keep < distances.size())
+    {
+      std::nth_element(distances.begin(), distances.begin() + (keep - 1), distances.end());
+      const double threshold = distances[keep - 1];
+      for (auto& c : m_Correspondences)
+      {
+        c.valid = c.valid && c.squaredDistance <= threshold;
+      }
+    }
+  }
+
+  double sum = 0.0;
+  size_t count = 0;
+  for (const auto& c : m_Correspondences)
+  {
+    if (c.valid)
+    {
+      sum += c.squaredDistance;
+      ++count;
+    }
+  }
+  return count >= 3 ? std::sqrt(sum / count) : -1.0;
+}
+
+bool mitk::IcpEngine::Run()
+{
+  const auto start = std::chrono::steady_clock::now();
+  m_RmsHistory.clear();
+  m_FinalRms = 0.0;
+  std::copy_n(m_InitialTransform, 16, m_Transform);
+
+  if (m_Tree == nullptr || m_Tree->GetNumberOfPoints() == 0 || m_Source.size() < 9)
+  {
+    return false;
+  }
+
+  // uniform subsampling of large sources, the full set is restored before returning
+  std::vector<double> fullSource;
+  const size_t sourceCount = m_Source.size() / 3;
+  if (m_MaximumNumberOfSourcePoints >= 3 && sourceCount > m_MaximumNumberOfSourcePoints)
+  {
+    fullSource.swap(m_Source);
+    m_Source.reserve(3 * m_MaximumNumberOfSourcePoints);
+    const double stride = static_cast<double>(sourceCount) / m_MaximumNumberOfSourcePoints;
+    for (size_t i = 0; i < m_MaximumNumberOfSourcePoints; ++i)
+    {
+      const size_t index = static_cast<size_t>(i * stride);
+      m_Source.insert(m_Source.end(), &fullSource[3 * index], &fullSource[3 * index + 3]);
+    }
+  }
+  m_Correspondences.resize(m_Source.size() / 3);
+
+  const RowMatrix4d targetToWorld = ToMatrix(m_TargetToWorld);
+  const RowMatrix4d worldToTarget = targetToWorld.inverse();
+  RowMatrix4d transform = ToMatrix(m_InitialTransform);
+
+  // true when the last recorded RMS belongs to the final transform
+  bool rmsIsCurrent = false;
+  // point-to-plane falls back to point-to-point for good once it stops decreasing the RMS (poor normals)
+  bool pointToPlane = m_PointToPlane;
+  double rms = -1.0;
+  for (int iteration = 0; iteration < m_MaximumNumberOfIterations; ++iteration)
+  {
+    double sourceToTarget[16];
+    FromMatrix(worldToTarget * transform, sourceToTarget);
+    this->FindCorrespondences(sourceToTarget);
+    rms = this->SelectCorrespondences();
+    if (rms < 0.0)
+    {
+      break;
+    }
+    if (!m_RmsHistory.empty() && std::abs(m_RmsHistory.back() - rms) < m_RmsTolerance)
+    {
+      m_RmsHistory.push_back(rms);
+      rmsIsCurrent = true;
+      break;
+    }
+    if (pointToPlane && !m_RmsHistory.empty() && rms > m_RmsHistory.back())
+    {
+      pointToPlane = false;
+    }
+    m_RmsHistory.push_back(rms);
+
+    // all pairs in the target frame, centered on the kept source points for conditioning
+    Eigen::Vector3d center = Eigen::Vector3d::Zero();
+    size_t count = 0;
+    for (const auto& c : m_Correspondences)
+    {
+      if (c.valid)
+      {
+        center += Eigen::Vector3d::Map(c.source);
+        ++count;
+      }
+    }
+    center /= static_cast<double>(count);
+
+    Eigen::Matrix4d increment = Eigen::Matrix4d::Identity();
+    bool solved = false;
+    if (pointToPlane && count >= 6)
+    {
+      // r(x) = n.(p - q) + (p x n).w + n.t, linearized around the current pose
+      Eigen::Matrix<double, 6, 6> a = Eigen::Matrix<double, 6, 6>::Zero();
+      Eigen::Matrix<double, 6, 1> b = Eigen::Matrix<double, 6, 1>::Zero();
+      auto addRow = [&](const Eigen::Vector3d& p, const Eigen::Vector3d& n, double residual) {
+        Eigen::Matrix<double, 6, 1> j;
+        j << p.cross(n), n;
+        a.selfadjointView<Eigen::Lower>().rankUpdate(j);
+        b += j * residual;
+      };
+
+      for (const auto& c : m_Correspondences)
+      {
+        if (!c.valid)
+        {
+          continue;
+        }
+        const Eigen::Vector3d p = Eigen::Vector3d::Map(c.source) - center;
+        const Eigen::Vector3d d = Eigen::Vector3d::Map(c.source) - Eigen::Vector3d::Map(c.target);
+        if (c.normal != nullptr && Eigen::Vector3d::Map(c.normal).squaredNorm() > 0.5)
+        {
+          const Eigen::Vector3d n = Eigen::Vector3d::Map(c.normal);
+          addRow(p, n, n.dot(d));
+        }
+        else
+        {
+          // no normal: the three point-to-point rows
+          for (int axis = 0; axis < 3; ++axis)
+          {
+            addRow(p, Eigen::Vector3d::Unit(axis), d[axis]);
+          }
+        }
+      }
+
+      const auto ldlt = a.selfadjointView<Eigen::Lower>().ldlt();
+      if (ldlt.info() == Eigen::Success && ldlt.isPositive())
+      {
+        const Eigen::Matrix<double, 6, 1> x = ldlt.solve(-b);
+        const Eigen::Vector3d omega = x.head<3>();
+        Eigen::Matrix3d rotation = Eigen::Matrix3d::Identity();
+        if (omega.norm() > 0.0)
+        {
+          rotation = Eigen::AngleAxisd(omega.norm(), omega.normalized()).toRotationMatrix();
+        }
+        increment.topLeftCorner<3, 3>() = rotation;
+        increment.topRightCorner<3, 1>() = center - rotation * center + x.tail<3>();
+        solved = x.allFinite();
+      }
+    }
+
+    if (!solved)
+    {
+      Eigen::Matrix3Xd source(3, count);
+      Eigen::Matrix3Xd target(3, count);
+      size_t column = 0;
+      for (const auto& c : m_Correspondences)
+      {
+        if (c.valid)
+        {
+          source.col(column) = Eigen::Vector3d::Map(c.source);
+          target.col(column) = Eigen::Vector3d::Map(c.target);
+          ++column;
+        }
+      }
+      increment = Eigen::umeyama(source, target, false);
+    }
+
+    transform = targetToWorld * RowMatrix4d(increment) * worldToTarget * transform;
+
+    const double step = (increment - Eigen::Matrix4d::Identity()).cwiseAbs().maxCoeff();
+    if (step < 1e-10)
+    {
+      break;
+    }
+  }
+  FromMatrix(transform, m_Transform);
+
+  if (!m_RmsHistory.empty())
+  {
+    if (rmsIsCurrent)
+    {
+      m_FinalRms = rms;
+    }
+    else
+    {
+      double sourceToTarget[16];
+      FromMatrix(worldToTarget * transform, sourceToTarget);
+      this->FindCorrespondences(sourceToTarget);
+      m_FinalRms = this->SelectCorrespondences();
+    }
+  }
+
+  if (!fullSource.empty())
+  {
+    m_Source.swap(fullSource);
+  }
+  m_Correspondences.clear();
+  m_Correspondences.shrink_to_fit();
+  m_ElapsedTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  return !m_RmsHistory.empty() && m_FinalRms >= 0.0;
+}
+
+void mitk::IcpEngine::ComputeResiduals(const double* points, size_t count, std::vector<double>& distances) const
+{
+  distances.assign(count, 0.0);
+  if (m_Tree == nullptr || m_Tree->GetNumberOfPoints() == 0)
+  {
+    return;
+  }
+
+  const RowMatrix4d matrix = ToMatrix(m_TargetToWorld).inverse() * ToMatrix(m_Transform);
+  const Eigen::Matrix3d rotation = matrix.topLeftCorner<3, 3>();
+  const Eigen::Vector3d translation = matrix.topRightCorner<3, 1>();
+
+  lancetAlgorithm::ParallelForBlocks(count, m_NumberOfThreads, BLOCK_SIZE, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+    {
+      const Eigen::Vector3d p = rotation * Eigen::Vector3d::Map(points + 3 * i) + translation;
+      double squaredDistance;
+      const long long index = m_Tree->FindNearest(p.data(), squaredDistance);
+      distances[i] = std::sqrt(squaredDistance);
+      if (m_Normals != nullptr && Eigen::Vector3d::Map(m_Normals + 3 * index).squaredNorm() > 0.5)
+      {
+        const Eigen::Vector3d q = Eigen::Vector3d::Map(m_Tree->GetPoint(index));
+        distances[i] = std::abs(Eigen::Vector3d::Map(m_Normals + 3 * index).dot(p - q));
+      }
+    }
+  });
+}
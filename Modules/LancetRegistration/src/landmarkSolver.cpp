@@ -0,0 +1,124 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "landmarkSolver.h"
+#include "parallelForBlocks.h"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+  using RowMatrix4d = Eigen::Matrix<double, 4, 4, Eigen::RowMajor>;
+
+  // sourceAt(i) / targetAt(i) return the i-th landmark as Eigen::Vector3d
+  template <typename SourceAt, typename TargetAt>
+  bool SolveLandmarks(size_t count, SourceAt sourceAt, TargetAt targetAt, mitk::LandmarkSolver::Result& result)
+  {
+    result = mitk::LandmarkSolver::Result();
+    if (count == 0)
+    {
+      return false;
+    }
+
+    Eigen::Vector3d sourceCenter = Eigen::Vector3d::Zero();
+    Eigen::Vector3d targetCenter = Eigen::Vector3d::Zero();
+    for (size_t i = 0; i < count; ++i)
+    {
+      sourceCenter += sourceAt(i);
+      targetCenter += targetAt(i);
+    }
+    sourceCenter /= static_cast<double>(count);
+    targetCenter /= static_cast<double>(count);
+
+    Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+    for (size_t i = 0; i < count; ++i)
+    {
+      covariance += (sourceAt(i) - sourceCenter) * (targetAt(i) - targetCenter).transpose();
+    }
+
+    // rotation = V * diag(1, 1, det(V * U^T)) * U^T, the sign keeps it a proper rotation
+    const Eigen::JacobiSVD<Eigen::Matrix3d> svd(covariance, Eigen::ComputeFullU | Eigen::ComputeFullV);
+    Eigen::Matrix3d v = svd.matrixV();
+    if ((v * svd.matrixU().transpose()).determinant() < 0.0)
+    {
+      v.col(2) = -v.col(2);
+    }
+    const Eigen::Matrix3d rotation = v * svd.matrixU().transpose();
+    const Eigen::Vector3d translation = targetCenter - rotation * sourceCenter;
+    if (!rotation.allFinite() || !translation.allFinite())
+    {
+      return false;
+    }
+
+    Eigen::Map<RowMatrix4d> matrix(result.matrix);
+    matrix.setIdentity();
+    matrix.topLeftCorner<3, 3>() = rotation;
+    matrix.topRightCorner<3, 1>() = translation;
+
+    double sumError = 0.0;
+    for (size_t i = 0; i < count; ++i)
+    {
+      const double error = (rotation * sourceAt(i) + translation - targetAt(i)).norm();
+      sumError += error;
+      result.maxError = std::max(result.maxError, error);
+    }
+    result.avgError = sumError / static_cast<double>(count);
+    result.valid = true;
+    return true;
+  }
+}
+
+bool mitk::LandmarkSolver::Solve(const double* source, const double* target, size_t count, Result& result)
+{
+  return SolveLandmarks(
+    count,
+    [source](size_t i) { return Eigen::Vector3d(Eigen::Vector3d::Map(source + 3 * i)); },
+    [target](size_t i) { return Eigen::Vector3d(Eigen::Vector3d::Map(target + 3 * i)); },
+    result);
+}
+
+bool mitk::LandmarkSolver::Solve(const mitk::PointSet* source, const mitk::PointSet* target, Result& result)
+{
+  if (source == nullptr || target == nullptr)
+  {
+    result = Result();
+    return false;
+  }
+  const int count = std::min(source->GetSize(), target->GetSize());
+  auto pointAt = [](const mitk::PointSet* pointSet) {
+    return [pointSet](size_t i) {
+      const mitk::Point3D point = pointSet->GetPoint(static_cast<mitk::PointSet::PointIdentifier>(i));
+      return Eigen::Vector3d(point[0], point[1], point[2]);
+    };
+  };
+  return SolveLandmarks(count > 0 ? static_cast<size_t>(count) : 0, pointAt(source), pointAt(target), result);
+}
+
+size_t mitk::LandmarkSolver::SolveBatch(const double* sources, const double* targets, size_t count,
+                                        size_t numberOfSets, Result* results, unsigned int numberOfThreads)
+{
+  constexpr size_t blockSize = 256;
+  std::atomic<size_t> numberOfValid{ 0 };
+  lancetAlgorithm::ParallelForBlocks(numberOfSets, numberOfThreads, blockSize,
+    [&](size_t begin, size_t end) {
+      size_t valid = 0;
+      for (size_t k = begin; k < end; ++k)
+      {
+        valid += Solve(sources + 3 * count * k, targets + 3 * count * k, count, results[k]) ? 1 : 0;
+      }
+      numberOfValid += valid;
+    });
+  return numberOfValid;
+}
@@ -0,0 +1,154 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "pointKdTree.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+  const unsigned int LEAF_SIZE = 8;
+}
+
+void mitk::PointKdTree::Build(const double* points, size_t count)
+{
+  m_Nodes.clear();
+  m_OriginalPoints.assign(points, points + 3 * count);
+  m_Indices.resize(count);
+  std::iota(m_Indices.begin(), m_Indices.end(), 0u);
+
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    m_Bounds[2 * axis] = count > 0 ? points[axis] : 0.0;
+    m_Bounds[2 * axis + 1] = m_Bounds[2 * axis];
+  }
+  for (size_t i = 0; i < count; ++i)
+  {
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      m_Bounds[2 * axis] = std::min(m_Bounds[2 * axis], points[3 * i + axis]);
+      m_Bounds[2 * axis + 1] = std::max(m_Bounds[2 * axis + 1], points[3 * i + axis]);
+    }
+  }
+
+  if (count == 0)
+  {
+    m_Points.clear();
+    return;
+  }
+
+  m_Nodes.reserve(2 * count / LEAF_SIZE + 1);
+  this->BuildNode(0, static_cast<unsigned int>(count));
+
+  // store the points in bucket order so that a leaf is scanned contiguously
+  m_Points.resize(3 * count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    std::copy_n(&m_OriginalPoints[3 * m_Indices[i]], 3, &m_Points[3 * i]);
+  }
+}
+
+int mitk::PointKdTree::BuildNode(unsigned int begin, unsigned int end)
+{
+  const int index = static_cast<int>(m_Nodes.size());
+  m_Nodes.push_back(Node{ 0.0, -1, -1, -1, begin, end });
+
+  if (end - begin <= LEAF_SIZE)
+  {
+    return index;
+  }
+
+  // split the widest extent at the median
+  double lower[3] = { 1e300, 1e300, 1e300 };
+  double upper[3] = { -1e300, -1e300, -1e300 };
+  for (unsigned int i = begin; i < end; ++i)
+  {
+    const double* p = &m_OriginalPoints[3 * m_Indices[i]];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      lower[axis] = std::min(lower[axis], p[axis]);
+      upper[axis] = std::max(upper[axis], p[axis]);
+    }
+  }
+  int axis = 0;
+  for (int a = 1; a < 3; ++a)
+  {
+    if (upper[a] - lower[a] > upper[axis] - lower[axis])
+    {
+      axis = a;
+    }
+  }
+
+  const unsigned int middle = begin + (end - begin) / 2;
+  const double* points = m_OriginalPoints.data();
+  std::nth_element(m_Indices.begin() + begin, m_Indices.begin() + middle, m_Indices.begin() + end,
+    [points, axis](unsigned int a, unsigned int b) { return points[3 * a + axis] < points[3 * b + axis]; });
+
+  const double split = m_OriginalPoints[3 * m_Indices[middle] + axis];
+  const int left = this->BuildNode(begin, middle);
+  const int right = this->BuildNode(middle, end);
+
+  Node& node = m_Nodes[index];
+  node.split = split;
+  node.axis = axis;
+  node.left = left;
+  node.right = right;
+  return index;
+}
+
+void mitk::PointKdTree::Search(int nodeIndex, const double query[3], long long& best, double& bestDistance) const
+{
+  const Node& node = m_Nodes[nodeIndex];
+  if (node.axis < 0)
+  {
+    for (unsigned int i = node.begin; i < node.end; ++i)
+    {
+      const double* p = &m_Points[3 * i];
+      const double dx = p[0] - query[0];
+      const double dy = p[1] - query[1];
+      const double dz = p[2] - query[2];
+      const double distance = dx * dx + dy * dy + dz * dz;
+      if (distance < bestDistance)
+      {
+        bestDistance = distance;
+        best = m_Indices[i];
+      }
+    }
+    return;
+  }
+
+  const double delta = query[node.axis] - node.split;
+  const int nearChild = delta < 0.0 ? node.left : node.right;
+  const int farChild = delta < 0.0 ? node.right : node.left;
+  this->Search(nearChild, query, best, bestDistance);
+  if (delta * delta < bestDistance)
+  {
+    this->Search(farChild, query, best, bestDistance);
+  }
+}
+
+long long mitk::PointKdTree::FindNearest(const double query[3], double& squaredDistance, double maxSquaredDistance) const
+{
+  long long best = -1;
+  squaredDistance = maxSquaredDistance;
+  if (!m_Nodes.empty())
+  {
+    this->Search(0, query, best, squaredDistance);
+  }
+  return best;
+}
+
+void mitk::PointKdTree::GetBounds(double bounds[6]) const
+{
+  std::copy_n(m_Bounds, 6, bounds);
+}
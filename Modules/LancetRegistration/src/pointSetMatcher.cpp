@@ -0,0 +1,357 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "pointSetMatcher.h"
+#include "landmarkSolver.h"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+  using RowMatrix4d = Eigen::Matrix<double, 4, 4, Eigen::RowMajor>;
+
+  void CopyPoints(const mitk::PointSet* pointSet, std::vector<double>& points)
+  {
+    points.clear();
+    if (pointSet == nullptr)
+    {
+      return;
+    }
+    for (auto it = pointSet->Begin(); it != pointSet->End(); ++it)
+    {
+      const mitk::Point3D point = pointSet->GetPoint(it->Index());
+      points.insert(points.end(), { point[0], point[1], point[2] });
+    }
+  }
+
+  double Distance(const double* a, const double* b)
+  {
+    return std::sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+  }
+
+  void DistanceMatrix(const std::vector<double>& points, std::vector<double>& distances)
+  {
+    const size_t count = points.size() / 3;
+    distances.assign(count * count, 0.0);
+    for (size_t i = 0; i < count; ++i)
+    {
+      for (size_t j = i + 1; j < count; ++j)
+      {
+        distances[i * count + j] = distances[j * count + i] = Distance(&points[3 * i], &points[3 * j]);
+      }
+    }
+  }
+
+  struct BaseTriangle
+  {
+    int i, j, k;
+    double area;
+  };
+}
+
+void mitk::PointSetMatcher::SetSourcePoints(const double* points, size_t count)
+{
+  m_Source.assign(points, points + 3 * count);
+}
+
+void mitk::PointSetMatcher::SetSourcePoints(const mitk::PointSet* pointSet)
+{
+  CopyPoints(pointSet, m_Source);
+}
+
+void mitk::PointSetMatcher::SetTargetPoints(const double* points, size_t count)
+{
+  m_Target.assign(points, points + 3 * count);
+}
+
+void mitk::PointSetMatcher::SetTargetPoints(const mitk::PointSet* pointSet)
+{
+  CopyPoints(pointSet, m_Target);
+}
+
+void mitk::PointSetMatcher::ComputeDistanceFingerprints(const double* points, size_t count, std::vector<double>& fingerprints)
+{
+  fingerprints.resize(count > 1 ? count * (count - 1) : 0);
+  size_t index = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    for (size_t j = 0; j < count; ++j)
+    {
+      if (i != j)
+      {
+        fingerprints[index++] = Distance(points + 3 * i, points + 3 * j);
+      }
+    }
+  }
+}
+
+void mitk::PointSetMatcher::ComputeDistanceFingerprints(const mitk::PointSet* pointSet, std::vector<double>& fingerprints)
+{
+  std::vector<double> points;
+  CopyPoints(pointSet, points);
+  ComputeDistanceFingerprints(points.data(), points.size() / 3, fingerprints);
+}
+
+void mitk::PointSetMatcher::Verify(const std::vector<double>& small, const std::vector<double>& large, Candidate& candidate) const
+{
+  const size_t smallCount = small.size() / 3;
+  const size_t largeCount = large.size() / 3;
+  const RowMatrix4d matrix = Eigen::Map<const RowMatrix4d>(candidate.matrix);
+  const Eigen::Matrix3d rotation = matrix.topLeftCorner<3, 3>();
+  const Eigen::Vector3d translation = matrix.topRightCorner<3, 1>();
+  const double squaredTolerance = m_Tolerance * m_Tolerance;
+
+  // all pairs within the tolerance, assigned greedily from the closest one
+  struct Pair
+  {
+    double squaredDistance;
+    int small;
+    int large;
+  };
+  std::vector<Pair> pairs;
+  for (size_t i = 0; i < smallCount; ++i)
+  {
+    const Eigen::Vector3d p = rotation * Eigen::Vector3d::Map(&small[3 * i]) + translation;
+    for (size_t j = 0; j < largeCount; ++j)
+    {
+      const double squaredDistance = (p - Eigen::Vector3d::Map(&large[3 * j])).squaredNorm();
+      if (squaredDistance <= squaredTolerance)
+      {
+        pairs.push_back({ squaredDistance, static_cast<int>(i), static_cast<int>(j) });
+      }
+    }
+  }
+  std::sort(pairs.begin(), pairs.end(), [](const Pair& a, const Pair& b) { return a.squaredDistance < b.squaredDistance; });
+
+  candidate.matches.assign(smallCount, -1);
+  std::vector<bool> largeUsed(largeCount, false);
+  candidate.numberOfMatches = 0;
+  candidate.sumSquaredError = 0.0;
+  for (const auto& pair : pairs)
+  {
+    if (candidate.matches[pair.small] < 0 && !largeUsed[pair.large])
+    {
+      candidate.matches[pair.small] = pair.large;
+      largeUsed[pair.large] = true;
+      ++candidate.numberOfMatches;
+      candidate.sumSquaredError += pair.squaredDistance;
+    }
+  }
+}
+
+bool mitk::PointSetMatcher::FitMatches(const std::vector<double>& small, const std::vector<double>& large, Candidate& candidate)
+{
+  if (candidate.numberOfMatches < 3)
+  {
+    return false;
+  }
+  std::vector<double> from;
+  std::vector<double> to;
+  from.reserve(3 * candidate.numberOfMatches);
+  to.reserve(3 * candidate.numberOfMatches);
+  for (size_t i = 0; i < candidate.matches.size(); ++i)
+  {
+    if (candidate.matches[i] >= 0)
+    {
+      from.insert(from.end(), &small[3 * i], &small[3 * i] + 3);
+      to.insert(to.end(), &large[3 * candidate.matches[i]], &large[3 * candidate.matches[i]] + 3);
+    }
+  }
+  LandmarkSolver::Result fit;
+  if (!LandmarkSolver::Solve(from.data(), to.data(), from.size() / 3, fit))
+  {
+    return false;
+  }
+  std::copy(fit.matrix, fit.matrix + 16, candidate.matrix);
+  return true;
+}
+
+bool mitk::PointSetMatcher::Match()
+{
+  const auto start = std::chrono::steady_clock::now();
+  m_Result = Result();
+  m_Result.correspondences.assign(m_Source.size() / 3, -1);
+
+  // triangles of the smaller set are looked up among the triples of the larger one
+  const bool sourceIsSmall = m_Source.size() <= m_Target.size();
+  const std::vector<double>& small = sourceIsSmall ? m_Source : m_Target;
+  const std::vector<double>& large = sourceIsSmall ? m_Target : m_Source;
+  const int smallCount = static_cast<int>(small.size() / 3);
+  const int largeCount = static_cast<int>(large.size() / 3);
+  const int requiredMatches = m_MinimumNumberOfMatches > 0 ? std::min(m_MinimumNumberOfMatches, smallCount) : smallCount;
+  if (smallCount < 3 || requiredMatches < 3)
+  {
+    return false;
+  }
+
+  std::vector<double> smallDistances;
+  std::vector<double> largeDistances;
+  DistanceMatrix(small, smallDistances);
+  DistanceMatrix(large, largeDistances);
+
+  // well conditioned base triangles first: sides clearly longer than the tolerance, largest area
+  std::vector<BaseTriangle> bases;
+  for (int i = 0; i < smallCount; ++i)
+  {
+    for (int j = i + 1; j < smallCount; ++j)
+    {
+      for (int k = j + 1; k < smallCount; ++k)
+      {
+        const double minimumSide = std::min({ smallDistances[i * smallCount + j], smallDistances[i * smallCount + k],
+          smallDistances[j * smallCount + k] });
+        if (minimumSide <= 2.0 * m_Tolerance)
+        {
+          continue;
+        }
+        const Eigen::Vector3d a = Eigen::Vector3d::Map(&small[3 * i]);
+        const Eigen::Vector3d b = Eigen::Vector3d::Map(&small[3 * j]);
+        const Eigen::Vector3d c = Eigen::Vector3d::Map(&small[3 * k]);
+        bases.push_back({ i, j, k, 0.5 * (b - a).cross(c - a).norm() });
+      }
+    }
+  }
+  std::sort(bases.begin(), bases.end(), [](const BaseTriangle& a, const BaseTriangle& b) { return a.area > b.area; });
+  if (static_cast<int>(bases.size()) > m_MaximumNumberOfBaseTriangles)
+  {
+    bases.resize(m_MaximumNumberOfBaseTriangles);
+  }
+
+  Candidate best;
+  best.numberOfMatches = 0;
+  Candidate candidate;
+  for (const auto& base : bases)
+  {
+    const double dij = smallDistances[base.i * smallCount + base.j];
+    const double dik = smallDistances[base.i * smallCount + base.k];
+    const double djk = smallDistances[base.j * smallCount + base.k];
+
+    double from[3][3];
+    std::copy_n(&small[3 * base.i], 3, from[0]);
+    std::copy_n(&small[3 * base.j], 3, from[1]);
+    std::copy_n(&small[3 * base.k], 3, from[2]);
+    LandmarkSolver::Result baseFit;
+
+    for (int a = 0; a < largeCount; ++a)
+    {
+      for (int b = 0; b < largeCount; ++b)
+      {
+        if (b == a || std::abs(largeDistances[a * largeCount + b] - dij) > m_Tolerance)
+        {
+          continue;
+        }
+        for (int c = 0; c < largeCount; ++c)
+        {
+          if (c == a || c == b || std::abs(largeDistances[a * largeCount + c] - dik) > m_Tolerance
+            || std::abs(largeDistances[b * largeCount + c] - djk) > m_Tolerance)
+          {
+            continue;
+          }
+
+          double to[3][3];
+          std::copy_n(&large[3 * a], 3, to[0]);
+          std::copy_n(&large[3 * b], 3, to[1]);
+          std::copy_n(&large[3 * c], 3, to[2]);
+          if (!LandmarkSolver::Solve(from, to, baseFit))
+          {
+            continue;
+          }
+          std::copy(baseFit.matrix, baseFit.matrix + 16, candidate.matrix);
+
+          this->Verify(small, large, candidate);
+          if (candidate.numberOfMatches > best.numberOfMatches
+            || (candidate.numberOfMatches == best.numberOfMatches && candidate.sumSquaredError < best.sumSquaredError))
+          {
+            best = candidate;
+          }
+        }
+      }
+    }
+
+    // every point of the smaller set found a partner, other bases can only find the same pose
+    if (best.numberOfMatches == smallCount)
+    {
+      break;
+    }
+  }
+
+  if (best.numberOfMatches < 3)
+  {
+    m_Result.elapsedTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return false;
+  }
+
+  // least-squares refinement on all matches; the matches may change once the pose improves
+  for (int iteration = 0; iteration < 3; ++iteration)
+  {
+    const std::vector<int> previousMatches = best.matches;
+    Candidate refined = best;
+    if (!FitMatches(small, large, refined))
+    {
+      break;
+    }
+    this->Verify(small, large, refined);
+    if (refined.numberOfMatches < best.numberOfMatches)
+    {
+      break;
+    }
+    best = refined;
+    if (best.matches == previousMatches)
+    {
+      break;
+    }
+  }
+  FitMatches(small, large, best);
+
+  // errors of the matched pairs under the refined pose
+  const RowMatrix4d smallToLarge = Eigen::Map<const RowMatrix4d>(best.matrix);
+  double sumError = 0.0;
+  for (int i = 0; i < smallCount; ++i)
+  {
+    if (best.matches[i] < 0)
+    {
+      continue;
+    }
+    const Eigen::Vector4d p = smallToLarge * Eigen::Vector3d::Map(&small[3 * i]).homogeneous();
+    const double error = (p.head<3>() - Eigen::Vector3d::Map(&large[3 * best.matches[i]])).norm();
+    sumError += error;
+    m_Result.maxError = std::max(m_Result.maxError, error);
+  }
+  m_Result.numberOfMatches = best.numberOfMatches;
+  m_Result.avgError = sumError / best.numberOfMatches;
+
+  Eigen::Map<RowMatrix4d> result(m_Result.matrix);
+  if (sourceIsSmall)
+  {
+    result = smallToLarge;
+    m_Result.correspondences = best.matches;
+  }
+  else
+  {
+    result = smallToLarge.inverse();
+    for (int i = 0; i < smallCount; ++i)
+    {
+      if (best.matches[i] >= 0)
+      {
+        m_Result.correspondences[best.matches[i]] = i;
+      }
+    }
+  }
+
+  m_Result.success = best.numberOfMatches >= requiredMatches;
+  m_Result.elapsedTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  return m_Result.success;
+}
@@ -0,0 +1,93 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "surfaceDistanceCache.h"
+
+#include "dataPropertyCache.h"
+
+#include <vtkCellArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+#include <chrono>
+
+mitk::SurfaceDistanceCache::SurfaceDistanceCache() = default;
+
+mitk::SurfaceDistanceCache::~SurfaceDistanceCache() = default;
+
+bool mitk::SurfaceDistanceCache::IsValidFor(const vtkPolyData* polyData) const
+{
+  return m_PolyData == polyData && m_PolyDataTime == const_cast<vtkPolyData*>(polyData)->GetMTime();
+}
+
+void mitk::SurfaceDistanceCache::Build(vtkPolyData* polyData)
+{
+  const vtkIdType numberOfPoints = polyData->GetNumberOfPoints();
+  std::vector<double> points(3 * numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    polyData->GetPoint(i, &points[3 * i]);
+  }
+
+  // polygons are split into triangle fans
+  std::vector<unsigned int> triangles;
+  triangles.reserve(3 * polyData->GetNumberOfPolys());
+  vtkIdType cellSize;
+  const vtkIdType* cell;
+  vtkCellArray* polys = polyData->GetPolys();
+  for (polys->InitTraversal(); polys->GetNextCell(cellSize, cell);)
+  {
+    for (vtkIdType k = 1; k + 1 < cellSize; ++k)
+    {
+      triangles.push_back(static_cast<unsigned int>(cell[0]));
+      triangles.push_back(static_cast<unsigned int>(cell[k]));
+      triangles.push_back(static_cast<unsigned int>(cell[k + 1]));
+    }
+  }
+
+  m_Bvh.Build(points.data(), numberOfPoints, triangles.data(), triangles.size() / 3);
+}
+
+double mitk::SurfaceDistanceCache::EvaluateSignedDistance(const double point[3], double closestPoint[3]) const
+{
+  return m_Bvh.EvaluateSignedDistance(point, closestPoint);
+}
+
+void mitk::SurfaceDistanceCache::EvaluateSignedDistances(const double* points, size_t count, double* distances,
+  vtkMatrix4x4* pointsToLocal) const
+{
+  m_Bvh.EvaluateSignedDistances(points, count, distances, pointsToLocal != nullptr ? pointsToLocal->GetData() : nullptr);
+}
+
+mitk::SurfaceDistanceCache::Pointer mitk::SurfaceDistanceCache::GetOrCreate(const mitk::Surface* surface)
+{
+  if (surface == nullptr)
+  {
+    return nullptr;
+  }
+  vtkPolyData* polyData = const_cast<mitk::Surface*>(surface)->GetVtkPolyData();
+  if (polyData == nullptr || polyData->GetNumberOfPolys() == 0)
+  {
+    return nullptr;
+  }
+
+  return lancetAlgorithm::GetOrCreateDataPropertyCache<SurfaceDistanceCache>(surface, GetPropertyName(),
+    [&](const SurfaceDistanceCache& cached) { return cached.IsValidFor(polyData); },
+    [&](SurfaceDistanceCache& created) {
+      const auto start = std::chrono::steady_clock::now();
+      created.Build(polyData);
+      created.m_BuildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      created.m_PolyData = polyData;
+      created.m_PolyDataTime = polyData->GetMTime();
+    });
+}
@@ -0,0 +1,104 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "surfaceKdTree.h"
+
+#include "dataPropertyCache.h"
+
+#include <vtkCellArray.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+#include <chrono>
+#include <cmath>
+
+mitk::SurfaceKdTree::SurfaceKdTree() = default;
+
+mitk::SurfaceKdTree::~SurfaceKdTree() = default;
+
+bool mitk::SurfaceKdTree::IsValidFor(const vtkPolyData* polyData) const
+{
+  return m_PolyData == polyData && m_PolyDataTime == const_cast<vtkPolyData*>(polyData)->GetMTime();
+}
+
+void mitk::SurfaceKdTree::Build(vtkPolyData* polyData)
+{
+  const vtkIdType numberOfPoints = polyData->GetNumberOfPoints();
+  std::vector<double> points(3 * numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    polyData->GetPoint(i, &points[3 * i]);
+  }
+  m_Tree.Build(points.data(), numberOfPoints);
+
+  // area weighted vertex normals: sum of the (unnormalized) fan triangle normals of every polygon
+  m_Normals.assign(3 * numberOfPoints, 0.0);
+  vtkCellArray* polys = polyData->GetPolys();
+  if (polys != nullptr)
+  {
+    vtkIdType cellSize;
+    const vtkIdType* cell;
+    for (polys->InitTraversal(); polys->GetNextCell(cellSize, cell);)
+    {
+      for (vtkIdType k = 1; k + 1 < cellSize; ++k)
+      {
+        const double* a = &points[3 * cell[0]];
+        const double* b = &points[3 * cell[k]];
+        const double* c = &points[3 * cell[k + 1]];
+        const double u[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        const double v[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        const double n[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+        for (const vtkIdType id : { cell[0], cell[k], cell[k + 1] })
+        {
+          m_Normals[3 * id] += n[0];
+          m_Normals[3 * id + 1] += n[1];
+          m_Normals[3 * id + 2] += n[2];
+        }
+      }
+    }
+  }
+
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    double* n = &m_Normals[3 * i];
+    const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (length > 0.0)
+    {
+      n[0] /= length;
+      n[1] /= length;
+      n[2] /= length;
+    }
+  }
+}
+
+mitk::SurfaceKdTree::Pointer mitk::SurfaceKdTree::GetOrCreate(const mitk::Surface* surface)
+{
+  if (surface == nullptr)
+  {
+    return nullptr;
+  }
+  vtkPolyData* polyData = const_cast<mitk::Surface*>(surface)->GetVtkPolyData();
+  if (polyData == nullptr || polyData->GetNumberOfPoints() == 0)
+  {
+    return nullptr;
+  }
+
+  return lancetAlgorithm::GetOrCreateDataPropertyCache<SurfaceKdTree>(surface, GetPropertyName(),
+    [&](const SurfaceKdTree& cached) { return cached.IsValidFor(polyData); },
+    [&](SurfaceKdTree& created) {
+      const auto start = std::chrono::steady_clock::now();
+      created.Build(polyData);
+      created.m_BuildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      created.m_PolyData = polyData;
+      created.m_PolyDataTime = polyData->GetMTime();
+    });
+}
@@ -11,6 +11,10 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "surfaceregistraion.h"
+#include "icpEngine.h"
+#include "landmarkSolver.h"
+#include "surfaceDistanceCache.h"
+#include "surfaceKdTree.h"
 
 #include "vtkLandmarkTransform.h"
 #include "vtkIterativeClosestPointTransform.h"
@@ -19,6 +23,24 @@ found in the LICENSE file.
 #include <vtkPolyData.h>
 #include <vtkTransformFilter.h>
 
+#include <algorithm>
+
+namespace
+{
+  // Surface-surface ICP registers at most this many (uniformly subsampled) source vertices
+  const size_t MAXIMUM_SURFACE_ICP_POINTS = 20000;
+
+  void GetLocalPoints(mitk::Surface* surface, std::vector<double>& points)
+  {
+    vtkPolyData* polyData = surface->GetVtkPolyData();
+    points.resize(3 * polyData->GetNumberOfPoints());
+    for (vtkIdType i = 0; i < polyData->GetNumberOfPoints(); ++i)
+    {
+      polyData->GetPoint(i, &points[3 * i]);
+    }
+  }
+}
+
 
 mitk::SurfaceRegistration::SurfaceRegistration()
   : m_MatrixLandMark(vtkMatrix4x4::New()), m_ResultMatrix(vtkMatrix4x4::New())
@@ -71,67 +93,17 @@ bool mitk::SurfaceRegistration::ComputeLandMarkResult()
 	if (m_LandmarksTarget->GetSize() >= 3 && m_LandmarksTarget->GetSize() == m_LandmarksSrc->GetSize())
 	{
 
-		vtkSmartPointer<vtkPoints> pSource = vtkSmartPointer<vtkPoints>::New();
-		vtkSmartPointer<vtkPoints> pTarget = vtkSmartPointer<vtkPoints>::New();
-
-		for (int i = 0; i < m_LandmarksSrc->GetSize(); i++)
+		LandmarkSolver::Result landmarkResult;
+		if (!LandmarkSolver::Solve(m_LandmarksSrc, m_LandmarksTarget, landmarkResult))
 		{
-			pSource->InsertNextPoint(m_LandmarksSrc->GetPoint(i).GetDataPointer());
-			pTarget->InsertNextPoint(m_LandmarksTarget->GetPoint(i).GetDataPointer());
+			MITK_ERROR << "SurfaceRegistration Error: degenerate landmarks";
+			return false;
 		}
-
-		vtkSmartPointer<vtkLandmarkTransform> landmarkTransform = vtkSmartPointer<vtkLandmarkTransform>::New();
-		landmarkTransform->SetSourceLandmarks(pSource);
-		landmarkTransform->SetTargetLandmarks(pTarget);
-		landmarkTransform->SetMode(VTK_LANDMARK_RIGIDBODY); // rigid: 6, similarity: 7, affine: 12
-
-		landmarkTransform->Update();
-		m_MatrixLandMark->DeepCopy(landmarkTransform->GetMatrix());
-
+		m_MatrixLandMark->DeepCopy(landmarkResult.matrix);
 
 		// Compute the landmark registration final metric
-		int pointNum = m_LandmarksSrc->GetSize();
-		double maxLandmarkError{ 0 };
-		double sumLandmarkError{ 0 };
-		for (int i = 0; i < pointNum; i++)
-		{
-			auto sourcePoint = m_LandmarksSrc->GetPoint(i);
-			auto targetPoint = m_LandmarksTarget->GetPoint(i);
-			auto sourcePointMatrix = vtkMatrix4x4::New();
-			sourcePointMatrix->Identity();
-			sourcePointMatrix->SetElement(0, 3, sourcePoint[0]);
-			sourcePointMatrix->SetElement(1, 3, sourcePoint[1]);
-			sourcePointMatrix->SetElement(2, 3, sourcePoint[2]);
-
-			auto tmpTransform = vtkTransform::New();
-			tmpTransform->Identity();
-			tmpTransform->PostMultiply();
-			tmpTransform->SetMatrix(sourcePointMatrix);
-			tmpTransform->Concatenate(m_MatrixLandMark);
-
-			auto transformedSourcePointMatrix = tmpTransform->GetMatrix();
-
-
-			double transformedSourcePointArray[3]
-			{
-				transformedSourcePointMatrix->GetElement(0,3),
-				transformedSourcePointMatrix->GetElement(1,3),
-				transformedSourcePointMatrix->GetElement(2,3)
-			};
-
-			double currentError = sqrt(pow(targetPoint[0] - transformedSourcePointArray[0], 2) +
-				pow(targetPoint[1] - transformedSourcePointArray[1], 2) +
-				pow(targetPoint[2] - transformedSourcePointArray[2], 2));
-
-			sumLandmarkError = sumLandmarkError + currentError;
-			if (currentError > maxLandmarkError)
-			{
-				maxLandmarkError = currentError;
-			}
-		}
-
-		m_maxLandmarkError = maxLandmarkError;
-		m_avgLandmarkError = sumLandmarkError / pointNum;
+		m_maxLandmarkError = landmarkResult.maxError;
+		m_avgLandmarkError = landmarkResult.avgError;
 
 		return true;
 	}
@@ -165,34 +137,71 @@ bool mitk::SurfaceRegistration::ComputeIcpResult()
 	pTransform->Inverse();
 	pTransform->TransformPoints(icpPoints, icpPoints_transed);
 	
-	auto pSource = vtkSmartPointer<vtkPolyData>::New();
-	pSource->SetPoints(icpPoints_transed);
-
-  // In case m_SurfaceSrc does not have an identity geometry matrix
-  vtkTransform *tmpTrans = vtkTransform::New();
-  tmpTrans->Identity();
-  tmpTrans->PostMultiply();
-  tmpTrans->SetMatrix(m_SurfaceSrc->GetGeometry()->GetVtkMatrix());
-  vtkNew<vtkTransformFilter> transformFilter;
-  transformFilter->SetInputData(m_SurfaceSrc->GetVtkPolyData());
-  transformFilter->SetTransform(tmpTrans);
-  transformFilter->Update();
-
-	vtkSmartPointer<vtkIterativeClosestPointTransform> pIcp =
-		vtkSmartPointer<vtkIterativeClosestPointTransform>::New();
-	pIcp->SetSource(pSource);
-	// pIcp->SetTarget(m_SurfaceSrc->GetVtkPolyData()); // the PolyData here must have an identity geometry matrix !
-  pIcp->SetTarget(transformFilter->GetPolyDataOutput());
-
-	pIcp->GetLandmarkTransform()->SetModeToRigidBody();
-	pIcp->SetMaximumNumberOfIterations(1000);
-	pIcp->SetCheckMeanDistance(true);
-	pIcp->SetMaximumMeanDistance(0.0001);
-	pIcp->Update();
-	
-
   auto matrixIcp = vtkMatrix4x4::New();
-	matrixIcp->DeepCopy(pIcp->GetMatrix());
+  if (m_UseNativeIcp)
+  {
+    auto kdTree = mitk::SurfaceKdTree::GetOrCreate(m_SurfaceSrc);
+    if (kdTree.IsNull())
+    {
+      MITK_ERROR << "SurfaceRegistration Error: surface has no points";
+      matrixIcp->Delete();
+      return false;
+    }
+
+    std::vector<double> points(3 * icpPoints_transed->GetNumberOfPoints());
+    for (vtkIdType i = 0; i < icpPoints_transed->GetNumberOfPoints(); ++i)
+    {
+      icpPoints_transed->GetPoint(i, &points[3 * i]);
+    }
+
+    mitk::IcpEngine icp;
+    icp.SetTarget(&kdTree->GetTree(), kdTree->GetNormals(), m_SurfaceSrc->GetGeometry()->GetVtkMatrix()->GetData());
+    icp.SetSource(points.data(), icpPoints_transed->GetNumberOfPoints());
+    icp.SetTrimFraction(m_IcpTrimFraction);
+    icp.SetMaximumNumberOfIterations(m_IcpMaximumNumberOfIterations);
+    if (!icp.Run())
+    {
+      MITK_ERROR << "SurfaceRegistration Error: ICP found no correspondences";
+      matrixIcp->Delete();
+      return false;
+    }
+    m_IcpRmsHistory = icp.GetRmsHistory();
+    m_IcpTime = icp.GetElapsedTime();
+    MITK_INFO << "ICP converged in " << icp.GetNumberOfIterations() << " iterations, " << m_IcpTime
+      << " ms, rms " << icp.GetFinalRms();
+
+    double matrix[16];
+    icp.GetTransform(matrix);
+    matrixIcp->DeepCopy(matrix);
+  }
+  else
+  {
+		auto pSource = vtkSmartPointer<vtkPolyData>::New();
+		pSource->SetPoints(icpPoints_transed);
+
+    // In case m_SurfaceSrc does not have an identity geometry matrix
+    vtkTransform *tmpTrans = vtkTransform::New();
+    tmpTrans->Identity();
+    tmpTrans->PostMultiply();
+    tmpTrans->SetMatrix(m_SurfaceSrc->GetGeometry()->GetVtkMatrix());
+    vtkNew<vtkTransformFilter> transformFilter;
+    transformFilter->SetInputData(m_SurfaceSrc->GetVtkPolyData());
+    transformFilter->SetTransform(tmpTrans);
+    transformFilter->Update();
+
+		vtkSmartPointer<vtkIterativeClosestPointTransform> pIcp =
+			vtkSmartPointer<vtkIterativeClosestPointTransform>::New();
+		pIcp->SetSource(pSource);
+		// pIcp->SetTarget(m_SurfaceSrc->GetVtkPolyData()); // the PolyData here must have an identity geometry matrix !
+    pIcp->SetTarget(transformFilter->GetPolyDataOutput());
+
+		pIcp->GetLandmarkTransform()->SetModeToRigidBody();
+		pIcp->SetMaximumNumberOfIterations(1000);
+		pIcp->SetCheckMeanDistance(true);
+		pIcp->SetMaximumMeanDistance(0.0001);
+		pIcp->Update();
+		matrixIcp->DeepCopy(pIcp->GetMatrix());
+  }
 	matrixIcp->Invert();
 
 	m_MatrixList.push_back(matrixIcp);
@@ -200,35 +209,35 @@ bool mitk::SurfaceRegistration::ComputeIcpResult()
 
 	//------------- Calculate the ICP registration metric--------------------
 
-	vtkNew<vtkImplicitPolyDataDistance> implicitPolyDataDistance;
-	
-
-	vtkTransform* tmpTrans1 = vtkTransform::New();
-	tmpTrans1->Identity();
-	tmpTrans1->PostMultiply();
-	tmpTrans1->Concatenate(m_SurfaceSrc->GetGeometry()->GetVtkMatrix());
-	//tmpTrans1->SetMatrix(GetResult()->in);
-	auto tmpMatrix = vtkMatrix4x4::New();
-	//vtkMatrix4x4::Invert(GetResult(), tmpMatrix);
-	//tmpTrans1->Concatenate(tmpMatrix);
-	tmpTrans1->Concatenate(GetResult());
+	// signed distance of every icp point to the source surface placed by its geometry and the result
+	auto distanceCache = mitk::SurfaceDistanceCache::GetOrCreate(m_SurfaceSrc);
+	if (distanceCache.IsNull())
+	{
+		MITK_WARN << "SurfaceRegistration: source surface has no polygons, ICP error not computed";
+		return true;
+	}
 
-	vtkNew<vtkTransformFilter> transformFilter1;
-	transformFilter1->SetInputData(m_SurfaceSrc->GetVtkPolyData());
-	transformFilter1->SetTransform(tmpTrans1);
-	transformFilter1->Update();
+	auto pointsToSurface = vtkSmartPointer<vtkMatrix4x4>::New();
+	vtkMatrix4x4::Multiply4x4(GetResult(), m_SurfaceSrc->GetGeometry()->GetVtkMatrix(), pointsToSurface);
+	pointsToSurface->Invert();
 
 	int pointNum = m_IcpPoints->GetSize();
-	double maxIcpError{ 0 };
-	double sumIcpError = 0;
+	std::vector<double> points(3 * pointNum);
 	for (int i = 0; i < pointNum; i++)
 	{
 		auto currentPoint = m_IcpPoints->GetPoint(i);
-		double tmpPoint[3]{ currentPoint[0],currentPoint[1],currentPoint[2] };
-
-		implicitPolyDataDistance->SetInput(transformFilter1->GetPolyDataOutput());
+		points[3 * i] = currentPoint[0];
+		points[3 * i + 1] = currentPoint[1];
+		points[3 * i + 2] = currentPoint[2];
+	}
+	std::vector<double> errors(pointNum);
+	distanceCache->EvaluateSignedDistances(points.data(), pointNum, errors.data(), pointsToSurface);
 
-		double currentError = implicitPolyDataDistance->EvaluateFunction(tmpPoint);
+	double maxIcpError{ 0 };
+	double sumIcpError = 0;
+	for (int i = 0; i < pointNum; i++)
+	{
+		double currentError = errors[i];
 
 		MITK_INFO << "ICP point error: " << currentError;
 		sumIcpError = sumIcpError + fabs(currentError);
@@ -253,6 +262,88 @@ bool mitk::SurfaceRegistration::ComputeSurfaceIcpResult()
 		MITK_ERROR << "SurfaceRegistration Error: icp src or target surface null";
 		return false;
 	}
+
+	if (m_UseNativeIcp)
+	{
+		// the surface with fewer vertices is registered onto the k-d tree of the other one
+		const bool targetIsLarger = m_SurfaceTarget->GetVtkPolyData()->GetNumberOfPoints() >=
+			m_SurfaceSrc->GetVtkPolyData()->GetNumberOfPoints();
+		mitk::Surface* moving = targetIsLarger ? m_SurfaceSrc.GetPointer() : m_SurfaceTarget.GetPointer();
+		mitk::Surface* fixed = targetIsLarger ? m_SurfaceTarget.GetPointer() : m_SurfaceSrc.GetPointer();
+
+		auto kdTree = mitk::SurfaceKdTree::GetOrCreate(fixed);
+		if (kdTree.IsNull() || moving->GetVtkPolyData()->GetNumberOfPoints() < 3)
+		{
+			MITK_ERROR << "SurfaceRegistration Error: icp src or target surface has no points";
+			return false;
+		}
+
+		std::vector<double> points;
+		GetLocalPoints(moving, points);
+		vtkMatrix4x4* movingMatrix = moving->GetGeometry()->GetVtkMatrix();
+
+		mitk::IcpEngine icp;
+		icp.SetTarget(&kdTree->GetTree(), kdTree->GetNormals(), fixed->GetGeometry()->GetVtkMatrix()->GetData());
+		icp.SetSource(points.data(), points.size() / 3);
+		icp.SetInitialTransform(movingMatrix->GetData());
+		icp.SetTrimFraction(m_SurfaceIcpTrimFraction);
+		icp.SetMaximumNumberOfIterations(m_IcpMaximumNumberOfIterations);
+		icp.SetMaximumNumberOfSourcePoints(MAXIMUM_SURFACE_ICP_POINTS);
+		if (!icp.Run())
+		{
+			MITK_ERROR << "SurfaceRegistration Error: ICP found no correspondences";
+			return false;
+		}
+		m_IcpRmsHistory = icp.GetRmsHistory();
+		m_IcpTime = icp.GetElapsedTime();
+
+		// distance of every vertex of the moving surface to the fixed one after registration,
+		// point-to-plane approximation when the fixed surface has no polygons
+		double matrix[16];
+		icp.GetTransform(matrix);
+		std::vector<double> distances(points.size() / 3);
+		auto distanceCache = mitk::SurfaceDistanceCache::GetOrCreate(fixed);
+		if (distanceCache.IsNotNull())
+		{
+			auto movingToWorld = vtkSmartPointer<vtkMatrix4x4>::New();
+			movingToWorld->DeepCopy(matrix);
+			auto worldToFixed = vtkSmartPointer<vtkMatrix4x4>::New();
+			vtkMatrix4x4::Invert(fixed->GetGeometry()->GetVtkMatrix(), worldToFixed);
+			auto movingToFixed = vtkSmartPointer<vtkMatrix4x4>::New();
+			vtkMatrix4x4::Multiply4x4(worldToFixed, movingToWorld, movingToFixed);
+			distanceCache->EvaluateSignedDistances(points.data(), distances.size(), distances.data(), movingToFixed);
+		}
+		else
+		{
+			icp.ComputeResiduals(points.data(), distances.size(), distances);
+		}
+		double maxIcpError{ 0 };
+		double sumIcpError{ 0 };
+		for (const double distance : distances)
+		{
+			sumIcpError += fabs(distance);
+			maxIcpError = std::max(maxIcpError, fabs(distance));
+		}
+		m_maxIcpError = maxIcpError;
+		m_avgIcpError = sumIcpError / distances.size();
+		MITK_INFO << "Surface ICP converged in " << icp.GetNumberOfIterations() << " iterations, " << m_IcpTime
+			<< " ms, rms " << icp.GetFinalRms();
+
+		// the engine result includes the geometry of the moving surface
+		auto movingInverse = vtkSmartPointer<vtkMatrix4x4>::New();
+		vtkMatrix4x4::Invert(movingMatrix, movingInverse);
+		auto registration = vtkSmartPointer<vtkMatrix4x4>::New();
+		registration->DeepCopy(matrix);
+
+		auto matrixIcp = vtkMatrix4x4::New();
+		vtkMatrix4x4::Multiply4x4(registration, movingInverse, matrixIcp);
+		if (!targetIsLarger)
+		{
+			matrixIcp->Invert();
+		}
+		m_MatrixList.push_back(matrixIcp);
+		return true;
+	}
 	
 
 	// In case m_SurfaceSrc does not have an identity geometry matrix
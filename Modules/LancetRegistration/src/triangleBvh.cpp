@@ -0,0 +1,366 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "triangleBvh.h"
+#include "parallelForBlocks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+namespace
+{
+  const unsigned int LEAF_SIZE = 4;
+  const size_t BLOCK_SIZE = 256;
+
+  inline double Dot(const double* a, const double* b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+  inline void Sub(const double* a, const double* b, double* out)
+  {
+    out[0] = a[0] - b[0];
+    out[1] = a[1] - b[1];
+    out[2] = a[2] - b[2];
+  }
+
+  inline void Cross(const double* a, const double* b, double* out)
+  {
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+  }
+
+  inline void Normalize(double* v)
+  {
+    const double length = std::sqrt(Dot(v, v));
+    if (length > 0.0)
+    {
+      v[0] /= length;
+      v[1] /= length;
+      v[2] /= length;
+    }
+  }
+
+  // angle between the edges (a - p) and (b - p)
+  inline double Angle(const double* p, const double* a, const double* b)
+  {
+    double u[3], v[3], c[3];
+    Sub(a, p, u);
+    Sub(b, p, v);
+    Cross(u, v, c);
+    return std::atan2(std::sqrt(Dot(c, c)), Dot(u, v));
+  }
+}
+
+void mitk::TriangleBvh::Build(const double* points, size_t pointCount, const unsigned int* triangles, size_t triangleCount)
+{
+  m_Points.assign(points, points + 3 * pointCount);
+  m_Triangles.assign(triangles, triangles + 3 * triangleCount);
+  m_FaceNormals.assign(3 * triangleCount, 0.0);
+  m_EdgeNormals.assign(9 * triangleCount, 0.0);
+  m_VertexNormals.assign(3 * pointCount, 0.0);
+  m_Nodes.clear();
+
+  // face normals, angle weighted vertex normals and edge normals (sum of the adjacent face normals)
+  std::unordered_map<unsigned long long, unsigned int> edgeIndex;
+  std::vector<double> edgeSums;
+  std::vector<unsigned int> triangleEdges(3 * triangleCount);
+  for (size_t t = 0; t < triangleCount; ++t)
+  {
+    const unsigned int* ids = &m_Triangles[3 * t];
+    const double* a = &m_Points[3 * ids[0]];
+    const double* b = &m_Points[3 * ids[1]];
+    const double* c = &m_Points[3 * ids[2]];
+    double ab[3], ac[3];
+    Sub(b, a, ab);
+    Sub(c, a, ac);
+    double* n = &m_FaceNormals[3 * t];
+    Cross(ab, ac, n);
+    Normalize(n);
+
+    const double angles[3] = { Angle(a, b, c), Angle(b, c, a), Angle(c, a, b) };
+    for (int k = 0; k < 3; ++k)
+    {
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        m_VertexNormals[3 * ids[k] + axis] += angles[k] * n[axis];
+      }
+
+      const unsigned int first = std::min(ids[k], ids[(k + 1) % 3]);
+      const unsigned int second = std::max(ids[k], ids[(k + 1) % 3]);
+      const unsigned long long key = (static_cast<unsigned long long>(first) << 32) | second;
+      auto inserted = edgeIndex.emplace(key, static_cast<unsigned int>(edgeSums.size() / 3));
+      if (inserted.second)
+      {
+        edgeSums.insert(edgeSums.end(), { 0.0, 0.0, 0.0 });
+      }
+      const unsigned int edge = inserted.first->second;
+      triangleEdges[3 * t + k] = edge;
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        edgeSums[3 * edge + axis] += n[axis];
+      }
+    }
+  }
+  for (size_t t = 0; t < triangleCount; ++t)
+  {
+    for (int k = 0; k < 3; ++k)
+    {
+      std::copy_n(&edgeSums[3 * triangleEdges[3 * t + k]], 3, &m_EdgeNormals[9 * t + 3 * k]);
+    }
+  }
+
+  if (triangleCount == 0)
+  {
+    m_Order.clear();
+    return;
+  }
+
+  std::vector<double> centers(3 * triangleCount);
+  for (size_t t = 0; t < triangleCount; ++t)
+  {
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      centers[3 * t + axis] = (m_Points[3 * m_Triangles[3 * t] + axis] + m_Points[3 * m_Triangles[3 * t + 1] + axis]
+        + m_Points[3 * m_Triangles[3 * t + 2] + axis]) / 3.0;
+    }
+  }
+  m_Order.resize(triangleCount);
+  std::iota(m_Order.begin(), m_Order.end(), 0u);
+  m_Nodes.reserve(2 * triangleCount / LEAF_SIZE + 1);
+  this->BuildNode(0, static_cast<unsigned int>(triangleCount), centers);
+}
+
+int mitk::TriangleBvh::BuildNode(unsigned int begin, unsigned int end, std::vector<double>& centers)
+{
+  const int index = static_cast<int>(m_Nodes.size());
+  Node node{ { 1e300, -1e300, 1e300, -1e300, 1e300, -1e300 }, -1, -1, begin, end };
+  double centerBounds[6] = { 1e300, -1e300, 1e300, -1e300, 1e300, -1e300 };
+  for (unsigned int i = begin; i < end; ++i)
+  {
+    const unsigned int t = m_Order[i];
+    for (int k = 0; k < 3; ++k)
+    {
+      const double* p = &m_Points[3 * m_Triangles[3 * t + k]];
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        node.bounds[2 * axis] = std::min(node.bounds[2 * axis], p[axis]);
+        node.bounds[2 * axis + 1] = std::max(node.bounds[2 * axis + 1], p[axis]);
+      }
+    }
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      centerBounds[2 * axis] = std::min(centerBounds[2 * axis], centers[3 * t + axis]);
+      centerBounds[2 * axis + 1] = std::max(centerBounds[2 * axis + 1], centers[3 * t + axis]);
+    }
+  }
+  m_Nodes.push_back(node);
+
+  if (end - begin <= LEAF_SIZE)
+  {
+    return index;
+  }
+
+  // median split of the triangle centers along their widest extent
+  int axis = 0;
+  for (int a = 1; a < 3; ++a)
+  {
+    if (centerBounds[2 * a + 1] - centerBounds[2 * a] > centerBounds[2 * axis + 1] - centerBounds[2 * axis])
+    {
+      axis = a;
+    }
+  }
+  const unsigned int middle = begin + (end - begin) / 2;
+  std::nth_element(m_Order.begin() + begin, m_Order.begin() + middle, m_Order.begin() + end,
+    [&centers, axis](unsigned int a, unsigned int b) { return centers[3 * a + axis] < centers[3 * b + axis]; });
+
+  const int left = this->BuildNode(begin, middle, centers);
+  const int right = this->BuildNode(middle, end, centers);
+  m_Nodes[index].left = left;
+  m_Nodes[index].right = right;
+  return index;
+}
+
+double mitk::TriangleBvh::BoxSquaredDistance(const Node& node, const double point[3]) const
+{
+  double distance = 0.0;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    const double below = node.bounds[2 * axis] - point[axis];
+    const double above = point[axis] - node.bounds[2 * axis + 1];
+    const double d = std::max(0.0, std::max(below, above));
+    distance += d * d;
+  }
+  return distance;
+}
+
+double mitk::TriangleBvh::ClosestPointOnTriangle(unsigned int t, const double point[3], double closest[3],
+  const double*& normal) const
+{
+  // Ericson, Real-Time Collision Detection, 5.1.5, with the Voronoi region of the result
+  const unsigned int* ids = &m_Triangles[3 * t];
+  const double* a = &m_Points[3 * ids[0]];
+  const double* b = &m_Points[3 * ids[1]];
+  const double* c = &m_Points[3 * ids[2]];
+
+  double ab[3], ac[3], ap[3];
+  Sub(b, a, ab);
+  Sub(c, a, ac);
+  Sub(point, a, ap);
+
+  double u = 0.0; // closest = a + u * ab + v * ac
+  double v = 0.0;
+  const double d1 = Dot(ab, ap);
+  const double d2 = Dot(ac, ap);
+  double bp[3], cp[3];
+  Sub(point, b, bp);
+  Sub(point, c, cp);
+  const double d3 = Dot(ab, bp);
+  const double d4 = Dot(ac, bp);
+  const double d5 = Dot(ab, cp);
+  const double d6 = Dot(ac, cp);
+  const double vc = d1 * d4 - d3 * d2;
+  const double vb = d5 * d2 - d1 * d6;
+  const double va = d3 * d6 - d5 * d4;
+
+  if (d1 <= 0.0 && d2 <= 0.0)
+  {
+    normal = &m_VertexNormals[3 * ids[0]];
+  }
+  else if (d3 >= 0.0 && d4 <= d3)
+  {
+    u = 1.0;
+    normal = &m_VertexNormals[3 * ids[1]];
+  }
+  else if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+  {
+    u = d1 / (d1 - d3);
+    normal = &m_EdgeNormals[9 * t];
+  }
+  else if (d6 >= 0.0 && d5 <= d6)
+  {
+    v = 1.0;
+    normal = &m_VertexNormals[3 * ids[2]];
+  }
+  else if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+  {
+    v = d2 / (d2 - d6);
+    normal = &m_EdgeNormals[9 * t + 6];
+  }
+  else if (va <= 0.0 && d4 - d3 >= 0.0 && d5 - d6 >= 0.0)
+  {
+    const double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+    u = 1.0 - w;
+    v = w;
+    normal = &m_EdgeNormals[9 * t + 3];
+  }
+  else
+  {
+    const double denominator = 1.0 / (va + vb + vc);
+    u = vb * denominator;
+    v = vc * denominator;
+    normal = &m_FaceNormals[3 * t];
+  }
+
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    closest[axis] = a[axis] + u * ab[axis] + v * ac[axis];
+  }
+  double d[3];
+  Sub(point, closest, d);
+  return Dot(d, d);
+}
+
+double mitk::TriangleBvh::EvaluateSignedDistance(const double point[3], double closestPoint[3]) const
+{
+  if (m_Nodes.empty())
+  {
+    return 0.0;
+  }
+
+  double bestDistance = 1e300;
+  double bestPoint[3] = { 0.0, 0.0, 0.0 };
+  const double* bestNormal = nullptr;
+
+  int stack[128];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0)
+  {
+    const Node& node = m_Nodes[stack[--top]];
+    if (this->BoxSquaredDistance(node, point) >= bestDistance)
+    {
+      continue;
+    }
+    if (node.left < 0)
+    {
+      for (unsigned int i = node.begin; i < node.end; ++i)
+      {
+        double closest[3];
+        const double* normal;
+        const double distance = this->ClosestPointOnTriangle(m_Order[i], point, closest, normal);
+        if (distance < bestDistance)
+        {
+          bestDistance = distance;
+          std::copy_n(closest, 3, bestPoint);
+          bestNormal = normal;
+        }
+      }
+      continue;
+    }
+
+    // visit the nearer child first
+    const double leftDistance = this->BoxSquaredDistance(m_Nodes[node.left], point);
+    const double rightDistance = this->BoxSquaredDistance(m_Nodes[node.right], point);
+    if (leftDistance < rightDistance)
+    {
+      stack[top++] = node.right;
+      stack[top++] = node.left;
+    }
+    else
+    {
+      stack[top++] = node.left;
+      stack[top++] = node.right;
+    }
+  }
+
+  if (closestPoint != nullptr)
+  {
+    std::copy_n(bestPoint, 3, closestPoint);
+  }
+  double d[3];
+  Sub(point, bestPoint, d);
+  const double distance = std::sqrt(bestDistance);
+  return Dot(d, bestNormal) < 0.0 ? -distance : distance;
+}
+
+void mitk::TriangleBvh::EvaluateSignedDistances(const double* points, size_t count, double* distances,
+  const double pointsToMesh[16], unsigned int numberOfThreads) const
+{
+  lancetAlgorithm::ParallelForBlocks(count, numberOfThreads, BLOCK_SIZE,
+    [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i)
+      {
+        const double* p = points + 3 * i;
+        if (pointsToMesh == nullptr)
+        {
+          distances[i] = this->EvaluateSignedDistance(p);
+          continue;
+        }
+        const double* m = pointsToMesh;
+        const double q[3] = { m[0] * p[0] + m[1] * p[1] + m[2] * p[2] + m[3],
+                              m[4] * p[0] + m[5] * p[1] + m[6] * p[2] + m[7],
+                              m[8] * p[0] + m[9] * p[1] + m[10] * p[2] + m[11] };
+        distances[i] = this->EvaluateSignedDistance(q);
+      }
+    });
+}
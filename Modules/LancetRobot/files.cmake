@@ -2,7 +2,9 @@
 set(H_FILES
   include/robotUtil.h
   include/robotRegistration.h
+  include/robotSampleBuffer.h
   include/udpmessage.h
+  include/udpstatuscodec.h
   include/udpsocketrobotheartbeat.h
 )
 
@@ -14,6 +16,7 @@ set(CPP_FILES
   robotUtil.cpp
   robotRegistration.cpp
   udpmessage.cpp
+  udpstatuscodec.cpp
   udpsocketrobotheartbeat.cpp
 #  robotcontroler.cpp
 #  robotsocket.cpp
@@ -0,0 +1,74 @@
+#ifndef ROBOTSAMPLEBUFFER_H
+#define ROBOTSAMPLEBUFFER_H
+
+#include "seqlockRingBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * One cartesian robot sample of the real-time acquisition loop.
+ */
+struct RobotPoseSample
+{
+	long long timestamp{ 0 };		// steady clock, microseconds, see RobotSampleBuffer::Now()
+	unsigned long long counter{ 0 };	// packet counter of the acquisition loop, gaps mean dropped packets
+	double pose[6]{ 0, 0, 0, 0, 0, 0 };	// x, y, z (mm), a, b, c (deg) of the robot flange / tcp
+};
+
+/**
+ * Rate and jitter of the samples in a time window.
+ */
+struct RobotSampleStatistics
+{
+	size_t samples{ 0 };
+	unsigned long long dropped{ 0 };	// counter gaps in the window
+	double rate{ 0.0 };			// Hz
+	double meanPeriod{ 0.0 };		// ms
+	double jitter{ 0.0 };			// standard deviation of the period, ms
+	double maxPeriod{ 0.0 };		// ms
+};
+
+/**
+ * Ring buffer of the robot pose samples of the real-time acquisition loop, see
+ * lancetAlgorithm::SeqlockRingBuffer: readers never block the acquisition loop and samples
+ * older than the capacity are overwritten.
+ */
+class RobotSampleBuffer : public lancetAlgorithm::SeqlockRingBuffer<RobotPoseSample>
+{
+public:
+	explicit RobotSampleBuffer(size_t aCapacity = 4096) : SeqlockRingBuffer(aCapacity) {}
+
+	/** Measured rate, jitter and dropped packets over the samples of the last aWindow microseconds. */
+	RobotSampleStatistics GetStatistics(long long aWindow = 1000000) const
+	{
+		std::vector<RobotPoseSample> samples;
+		samples.reserve(256);
+		GetSince(Now() - aWindow, samples);
+
+		RobotSampleStatistics statistics;
+		statistics.samples = samples.size();
+		if (samples.size() < 2)
+		{
+			return statistics;
+		}
+		double sum = 0.0;
+		double sumSquares = 0.0;
+		for (size_t i = 1; i < samples.size(); ++i)
+		{
+			const double period = (samples[i].timestamp - samples[i - 1].timestamp) / 1000.0;
+			sum += period;
+			sumSquares += period * period;
+			statistics.maxPeriod = std::max(statistics.maxPeriod, period);
+			statistics.dropped += samples[i].counter - samples[i - 1].counter - 1;
+		}
+		const double periods = static_cast<double>(samples.size() - 1);
+		statistics.meanPeriod = sum / periods;
+		statistics.jitter = std::sqrt(std::max(0.0, sumSquares / periods - statistics.meanPeriod * statistics.meanPeriod));
+		statistics.rate = statistics.meanPeriod > 0.0 ? 1000.0 / statistics.meanPeriod : 0.0;
+		return statistics;
+	}
+};
+
+#endif // ROBOTSAMPLEBUFFER_H
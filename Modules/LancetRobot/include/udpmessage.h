@@ -5,6 +5,7 @@
 
 #include <QByteArray>
 #include "MitkLancetRobotExports.h"
+#include "udpstatuscodec.h"
 class MITKLANCETROBOT_EXPORT RobotUDPMessage
 {
     struct RobotUDPMessagePrivateImp;
@@ -34,10 +35,17 @@ public:
     RobotUDPMessage();
     RobotUDPMessage(const QByteArray&);
     RobotUDPMessage(const RobotUDPMessage&);
+    RobotUDPMessage(const RobotUDPStatus&);
 
     void operator=(const QByteArray&);
     void operator=(const RobotUDPMessage&);
 public:
+    /**
+     * \brief All fields as plain struct, see \c RobotUDPStatusCodec.
+     */
+    const RobotUDPStatus& status() const;
+    void setStatus(const RobotUDPStatus&);
+
     /**
      * \brief Time stamp
      *
@@ -169,7 +177,10 @@ public:
      */
     static RobotUDPMessage translateRobotUDPMessage(const char* stream, int lenght);
 
-    static QByteArray toUDPStream(const RobotUDPMessage&);
+    /**
+     * \brief Message body character stream, \c RobotUDPStatusCodec::Text unless format says otherwise.
+     */
+    static QByteArray toUDPStream(const RobotUDPMessage&, RobotUDPStatusCodec::Format format = RobotUDPStatusCodec::Text);
 
     static ApplicationState applicationStateToKey(const QString&);
     static QString applicationStateToValue(const ApplicationState&);
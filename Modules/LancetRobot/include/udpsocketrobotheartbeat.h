@@ -3,6 +3,7 @@
 
 #include <QUdpSocket>
 #include "MitkLancetRobotExports.h"
+#include "udpstatuscodec.h"
 
 class RobotUDPMessage;
 class MITKLANCETROBOT_EXPORT UdpSocketRobotHeartbeat
@@ -43,17 +44,51 @@ public:
     virtual int repetitiveHeartbeatInterval() const;
     virtual void setRepetitiveHeartbeatInterval(int msec);
 
+    /**
+     * \brief Time in ms without any status message after which the remote robot counts as lost.
+     */
     virtual int deathTimeout() const;
     virtual void setDeathTimeout(int);
 
+    /**
+     * \brief False once no status message arrived for deathTimeout(), see \c remoteAliveChanged().
+     */
+    virtual bool isRemoteAlive() const;
+
+    /**
+     * \brief Format of the sent controller messages, received messages are accepted in both.
+     *
+     * \note Default is \c RobotUDPStatusCodec::Text, the format of the robot controller.
+     */
+    virtual RobotUDPStatusCodec::Format wireFormat() const;
+    virtual void setWireFormat(RobotUDPStatusCodec::Format);
+
     virtual RobotUDPMessage lastRobotUDPMessage() const;
     virtual void setLastRobotUDPMessage(const RobotUDPMessage&);
+
+    /**
+     * \brief Copy of the last status message without allocation, for the heartbeat thread.
+     */
+    virtual RobotUDPStatus lastRobotUDPStatus() const;
+
+    /**
+     * \brief Received, lost, reordered and undecodable status messages since the last reset.
+     */
+    virtual RobotUDPFrameStatistics frameStatistics() const;
+    virtual void resetFrameStatistics();
+signals:
+    /**
+     * \brief Emitted from the heartbeat when the remote robot is lost or answers again.
+     */
+    void remoteAliveChanged(bool alive);
 protected slots:
     virtual void updateRobotHeartbeat() final;
     virtual void onReadyRead() final;
     virtual void onSendDataStream() final;
 protected:
     bool tryRepairErrorCodeOf(int);
+    void checkRemoteAlive();
+    bool sendCommand(int count, RobotUDPStatusCodec::Signal signal, bool value);
     static void onThreadHandle(UdpSocketRobotHeartbeat*);
 protected:
     std::shared_ptr<UdpSocketRobotHeartbeatPrivateImp> m_imp;
@@ -0,0 +1,133 @@
+﻿#ifndef LROBOTUDPSTATUSCODEC_H
+#define LROBOTUDPSTATUSCODEC_H
+
+#include <cstdint>
+
+#include "MitkLancetRobotExports.h"
+
+/**
+ * \brief Plain copy of one robot status message, see \c RobotUDPMessage for the fields.
+ *
+ * Trivially copyable, so the heartbeat can keep and hand out the last status without
+ * allocating.
+ */
+struct RobotUDPStatus
+{
+    long long time = 0;
+    int frames = 0;
+    int validFrames = 0;
+    int errorCode = 0;
+
+    bool isConnectedUDP = false;
+    bool isApplicationReadyToStart = false;
+    bool isApplicationError = false;
+    bool isLowerMachineSignalError = false;
+
+    int applicationState = 0;     ///< RobotUDPMessage::ApplicationState
+
+    bool isApplicationStart = false;
+    bool isApplicationEnable = false;
+};
+
+/**
+ * \brief Counts lost, duplicated and reordered status messages from their frame counter.
+ */
+struct RobotUDPFrameStatistics
+{
+    /// a message at most this many frames older than the last one is late, an older one means the counter restarted
+    static constexpr int ReorderWindow = 64;
+
+    unsigned long long received = 0;
+    unsigned long long lost = 0;        ///< counter gaps not filled by late messages
+    unsigned long long reordered = 0;   ///< messages older than one already received
+    unsigned long long duplicated = 0;  ///< messages with the frame counter of the last one
+    unsigned long long resynced = 0;    ///< counter restarts, e.g. of the robot application
+    unsigned long long invalid = 0;     ///< datagrams that could not be decoded
+    int lastFrame = 0;
+
+    /**
+     * \brief Accounts the frame counter of a received message.
+     *
+     * \return false if the message is a duplicate or older than the last one and should be dropped.
+     */
+    bool update(int frame);
+};
+
+/**
+ * \brief Encoder / decoder of the robot UDP messages.
+ *
+ * Two wire formats:
+ * - \c Text: the semicolon separated format of the robot controller,
+ *   "time;frames;validFrames;errorCode;true;false;...;RUNNING;true;true".
+ * - \c Binary: a fixed 32 byte little endian frame, see \c BinaryLayout.
+ *
+ * Everything works in place on caller buffers; nothing allocates, so the heartbeat thread
+ * can use it every cycle. \c decodeStatus() detects the format by the binary magic.
+ */
+class MITKLANCETROBOT_EXPORT RobotUDPStatusCodec
+{
+public:
+    enum Format
+    {
+        Text,
+        Binary
+    };
+
+    /**
+     * \brief Binary frame layout, all values little endian.
+     *
+     * | offset | size | field                                    |
+     * |--------|------|------------------------------------------|
+     * | 0      | 4    | magic "LRS1" (status) / "LRC1" (command) |
+     * | 4      | 8    | time, ms since epoch                     |
+     * | 12     | 4    | frames / command counter                 |
+     * | 16     | 4    | validFrames                              |
+     * | 20     | 4    | errorCode                                |
+     * | 24     | 1    | applicationState                         |
+     * | 25     | 1    | flags, bit 0..5 in \c RobotUDPStatus order |
+     * | 26     | 2    | signal id of a command, 0 for a status   |
+     * | 28     | 4    | reserved, 0                              |
+     */
+    enum BinaryLayout
+    {
+        BinaryFrameSize = 32
+    };
+
+    /** \brief Signals of a controller message, \c Text spells them as "App_Start" etc. */
+    enum Signal
+    {
+        AppStart = 1,
+        GetState = 2
+    };
+
+    /**
+     * \brief Decodes a status message of either format into status.
+     *
+     * \return false if the datagram is neither a complete binary frame nor has all eleven
+     * text fields; status is undefined then.
+     */
+    static bool decodeStatus(const char* data, int length, RobotUDPStatus& status);
+    static bool decodeTextStatus(const char* data, int length, RobotUDPStatus& status);
+    static bool decodeBinaryStatus(const char* data, int length, RobotUDPStatus& status);
+
+    /**
+     * \brief Encodes status into buffer.
+     *
+     * \return The number of bytes written, -1 if size is too small.
+     */
+    static int encodeStatus(Format format, const RobotUDPStatus& status, char* buffer, int size);
+
+    /**
+     * \brief Encodes a controller message "time;count;signal;value" into buffer.
+     *
+     * \return The number of bytes written, -1 if size is too small.
+     */
+    static int encodeCommand(Format format, long long time, int count, Signal signal, bool value, char* buffer, int size);
+
+    /** \brief Upper case name of an application state, "UNKNOWN" if out of range. */
+    static const char* applicationStateName(int state);
+    /** \brief Application state of a case insensitive name, 0 (UNKNOWN) if it is none. */
+    static int applicationStateOf(const char* name, int length);
+};
+
+#endif // LROBOTUDPSTATUSCODEC_H
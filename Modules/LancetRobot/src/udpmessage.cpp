@@ -1,23 +1,9 @@
 ﻿#include "udpmessage.h"
 
-#include <QList>
 
 struct RobotUDPMessage::RobotUDPMessagePrivateImp
 {
-    long time;
-    int frames;
-    int validFrames;
-    int errorCode;
-
-    bool isConnectedUDP;
-    bool isApplicationReadyToStart;
-    bool isApplicationError;
-    bool isLowerMachineSignalError;
-
-    ApplicationState applicationState;
-
-    bool isApplicationStart;
-    bool isApplicationEnable;
+    RobotUDPStatus status;
 };
 
 RobotUDPMessage::RobotUDPMessage()
@@ -38,6 +24,12 @@ RobotUDPMessage::RobotUDPMessage(const RobotUDPMessage& msg)
     *this = msg;
 }
 
+RobotUDPMessage::RobotUDPMessage(const RobotUDPStatus& status)
+    : m_imp(std::make_shared<RobotUDPMessagePrivateImp>())
+{
+    this->m_imp->status = status;
+}
+
 void RobotUDPMessage::operator=(const QByteArray& stream)
 {
     *this = translateRobotUDPMessage(stream.data(), stream.length());
@@ -48,89 +40,99 @@ void RobotUDPMessage::operator=(const RobotUDPMessage& msg)
     *this->m_imp = *msg.m_imp;
 }
 
+const RobotUDPStatus& RobotUDPMessage::status() const
+{
+    return this->m_imp->status;
+}
+
+void RobotUDPMessage::setStatus(const RobotUDPStatus& status)
+{
+    this->m_imp->status = status;
+}
+
 long RobotUDPMessage::time() const
 {
-    return this->m_imp->time;
+    return static_cast<long>(this->m_imp->status.time);
 }
 
 void RobotUDPMessage::setTime(long tm)
 {
-    this->m_imp->time = tm;
+    this->m_imp->status.time = tm;
 }
 
 int RobotUDPMessage::frames() const
 {
-    return this->m_imp->frames;
+    return this->m_imp->status.frames;
 }
 
 void RobotUDPMessage::setFrames(int f)
 {
-    this->m_imp->frames = f;
+    this->m_imp->status.frames = f;
 }
 
 int RobotUDPMessage::validFrames() const
 {
-    return this->m_imp->validFrames;
+    return this->m_imp->status.validFrames;
 }
 
 void RobotUDPMessage::setValidFrames(int f)
 {
-    this->m_imp->validFrames = f;
+    this->m_imp->status.validFrames = f;
 }
 
 int RobotUDPMessage::errorCode() const
 {
-    return this->m_imp->errorCode;
+    return this->m_imp->status.errorCode;
 }
 
 void RobotUDPMessage::setErrorCode(int e)
 {
-    this->m_imp->errorCode = e;
+    this->m_imp->status.errorCode = e;
 }
 
 bool RobotUDPMessage::isConnectedUDP() const
 {
-    return this->m_imp->isConnectedUDP;
+    return this->m_imp->status.isConnectedUDP;
 }
 
 void RobotUDPMessage::setConnectedUDP(bool c)
 {
-    this->m_imp->isConnectedUDP = c;
+    this->m_imp->status.isConnectedUDP = c;
 }
 
 bool RobotUDPMessage::isApplicationReadyToStart() const
 {
-    return this->m_imp->isApplicationReadyToStart;
+    return this->m_imp->status.isApplicationReadyToStart;
 }
 
 void RobotUDPMessage::setApplicationReadyToStart(bool b)
 {
-    this->m_imp->isApplicationReadyToStart = b;
+    this->m_imp->status.isApplicationReadyToStart = b;
 }
 
 bool RobotUDPMessage::isApplicationError() const
 {
-    return this->m_imp->isApplicationError;
+    return this->m_imp->status.isApplicationError;
 }
 
 void RobotUDPMessage::setApplicationError(bool b)
 {
-    this->m_imp->isApplicationError = b;
+    this->m_imp->status.isApplicationError = b;
 }
 
 bool RobotUDPMessage::isLowerMachineSignalError() const
 {
-    return this->m_imp->isLowerMachineSignalError;
+    return this->m_imp->status.isLowerMachineSignalError;
 }
 
 void RobotUDPMessage::setLowerMachineSignalError(bool b)
 {
-    this->m_imp->isLowerMachineSignalError = b;
+    this->m_imp->status.isLowerMachineSignalError = b;
 }
 
 RobotUDPMessage::ApplicationState RobotUDPMessage::applicationState() const
 {
-    return this->m_imp->applicationState;
+    return static_cast<ApplicationState>(this->m_imp->status.applicationState);
 }
 
 void RobotUDPMessage::setApplicationState(const QString& state)
@@ -140,129 +142,55 @@ void RobotUDPMessage::setApplicationState(const QString& state)
 
 void RobotUDPMessage::setApplicationState(const RobotUDPMessage::ApplicationState& as)
 {
-    this->m_imp->applicationState = as;
+    this->m_imp->status.applicationState = as;
 }
 
 bool RobotUDPMessage::isApplicationStart() const
 {
-    return this->m_imp->isApplicationStart;
+    return this->m_imp->status.isApplicationStart;
 }
 
 void RobotUDPMessage::setApplicationStart(bool b)
 {
-    this->m_imp->isApplicationStart = b;
+    this->m_imp->status.isApplicationStart = b;
 }
 
 bool RobotUDPMessage::isApplicationEnable() const
 {
-    return this->m_imp->isApplicationEnable;
+    return this->m_imp->status.isApplicationEnable;
 }
 
 void RobotUDPMessage::setApplicationEnable(bool b)
 {
-    this->m_imp->isApplicationEnable = b;
+    this->m_imp->status.isApplicationEnable = b;
 }
 
 RobotUDPMessage RobotUDPMessage::translateRobotUDPMessage(const char* stream, int lenght)
 {
     RobotUDPMessage tmpMessage;
-
-    QByteArray qstream = QByteArray(stream, lenght);
-
-    auto results = qstream.split(';');
-
-    if(results.size() >= 11)
+    RobotUDPStatus status;
+    if(RobotUDPStatusCodec::decodeStatus(stream, lenght, status))
     {
-        tmpMessage.setTime(results[0].toLong());
-        tmpMessage.setFrames(results[1].toInt());
-        tmpMessage.setValidFrames(results[2].toInt());
-        tmpMessage.setErrorCode(results[3].toInt());
-        tmpMessage.setConnectedUDP(results[4].toLower() == "true" ? true : false);
-        tmpMessage.setApplicationReadyToStart(results[5].toLower() == "true" ? true : false);
-        tmpMessage.setApplicationError(results[6].toLower() == "true" ? true : false);
-        tmpMessage.setLowerMachineSignalError(results[7].toLower() == "true" ? true : false);
-        tmpMessage.setApplicationState(applicationStateToKey(results[8]));
-        tmpMessage.setApplicationStart(results[9].toLower() == "true" ? true : false);
-        tmpMessage.setApplicationEnable(results[10].toLower() == "true" ? true : false);
+        tmpMessage.setStatus(status);
     }
 
     return tmpMessage;
 }
 
-QByteArray RobotUDPMessage::toUDPStream(const RobotUDPMessage& msg)
+QByteArray RobotUDPMessage::toUDPStream(const RobotUDPMessage& msg, RobotUDPStatusCodec::Format format)
 {
-    QByteArray qstream;
-    qstream += QString("%1;").arg(QString::asprintf("%ld", msg.time()));
-    qstream += QString("%1;").arg(QString::number(msg.frames()));
-    qstream += QString("%1;").arg(QString::number(msg.validFrames()));
-    qstream += QString("%1;").arg(QString::number(msg.errorCode()));
-
-    qstream += QString("%1;").arg(msg.isConnectedUDP() ? "true" : "false");
-    qstream += QString("%1;").arg(msg.isApplicationReadyToStart() ? "true" : "false");
-    qstream += QString("%1;").arg(msg.isApplicationError() ? "true" : "false");
-    qstream += QString("%1;").arg(msg.isLowerMachineSignalError() ? "true" : "false");
-    qstream += QString("%1;").arg(applicationStateToValue(msg.applicationState()));
-    qstream += QString("%1;").arg(msg.isApplicationStart() ? "true" : "false");
-    qstream += QString("%1").arg(msg.isApplicationEnable() ? "true" : "false");
-    return qstream;
+    char stream[256];
+    const int length = RobotUDPStatusCodec::encodeStatus(format, msg.status(), stream, sizeof(stream));
+    return length < 0 ? QByteArray() : QByteArray(stream, length);
 }
 
-// TODO: Post optimization.
-#define EM_ApplicationStateToKey(x) #x
 RobotUDPMessage::ApplicationState RobotUDPMessage::applicationStateToKey(const QString& state)
 {
-    if(EM_ApplicationStateToKey(IDLE) == state.toUpper())
-    {
-        return IDLE;
-    }
-    else if(EM_ApplicationStateToKey(RUNNING) == state.toUpper())
-    {
-        return RUNNING;
-    }
-    else if(EM_ApplicationStateToKey(MOTIONPAUSED) == state.toUpper())
-    {
-        return MOTIONPAUSED;
-    }
-    else if(EM_ApplicationStateToKey(REPOSITIONING) == state.toUpper())
-    {
-        return REPOSITIONING;
-    }
-    else if(EM_ApplicationStateToKey(ERROR) == state.toUpper())
-    {
-        return ERROR;
-    }
-    else if(EM_ApplicationStateToKey(STARTING) == state.toUpper())
-    {
-        return STARTING;
-    }
-    else if(EM_ApplicationStateToKey(STOPPING) == state.toUpper())
-    {
-        return STOPPING;
-    }
-
-    return UNKNOWN;
+    const QByteArray name = state.toLatin1();
+    return static_cast<ApplicationState>(RobotUDPStatusCodec::applicationStateOf(name.constData(), name.length()));
 }
 
 QString RobotUDPMessage::applicationStateToValue(const RobotUDPMessage::ApplicationState& state)
 {
-    switch (state)
-    {
-        case ApplicationState::UNKNOWN:
-            return "UNKNOWN";
-        case ApplicationState::IDLE:
-            return "IDLE";
-        case ApplicationState::RUNNING:
-            return "RUNNING";
-        case ApplicationState::MOTIONPAUSED:
-            return "MOTIONPAUSED";
-        case ApplicationState::REPOSITIONING:
-            return "REPOSITIONING";
-        case ApplicationState::ERROR:
-            return "ERROR";
-        case ApplicationState::STARTING:
-            return "STARTING";
-        case ApplicationState::STOPPING:
-            return "STOPPING";
-    }
-    return "UNKNOWN";
+    return QString::fromLatin1(RobotUDPStatusCodec::applicationStateName(state));
 }
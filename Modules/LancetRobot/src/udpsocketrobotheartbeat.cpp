@@ -2,25 +2,46 @@
 
 #include <sys/timeb.h>
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
 #include <QDebug>
 #include <QTimer>
 #include <QThread>
 #include <QPointer>
-#include <QNetworkDatagram>
 
 #include "udpmessage.h"
 #include "mitkLog.h"
 #include "mitkLogMacros.h"
+namespace
+{
+    long long steadyMilliseconds()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
 struct UdpSocketRobotHeartbeat::UdpSocketRobotHeartbeatPrivateImp
 {
-    uint remoteHostPort;
-    int deathTimeout;
-    RunningModel runningModel;
+    uint remoteHostPort = 0;
+    std::atomic<int> deathTimeout{ 1000 };
+    RunningModel runningModel = RunningModel::Thread;
     QString remoteHostAddress;
+    QHostAddress remoteAddress;     // parsed once, not for every datagram
     QTimer repetitiveHeartbeatInterval;
     static long int frameRate;
-    RobotUDPMessage lastRobotUDPMessage;
-    QVector<QByteArray> sendDataStream;
+    std::atomic<RobotUDPStatusCodec::Format> wireFormat{ RobotUDPStatusCodec::Text };
+
+    // written by onReadyRead(), read by the heartbeat thread
+    mutable std::mutex statusMutex;
+    RobotUDPStatus lastStatus;
+    RobotUDPFrameStatistics frameStatistics;
+    std::atomic<long long> lastReceived{ 0 };   // steady clock, ms
+    std::atomic<bool> isRemoteAlive{ false };
+    char receiveBuffer[2048];
 
     QPointer<QThread> thread;
     QAtomicInteger<bool> isStartRepetitiveHeartbeat;
@@ -52,7 +73,7 @@ long UdpSocketRobotHeartbeat::timeStamp() const
 
 bool UdpSocketRobotHeartbeat::routineHeartbeat()
 {
-    int frame_count = this->lastRobotUDPMessage().validFrames();
+    int frame_count = this->lastRobotUDPStatus().validFrames;
     if(false == this->simulateSpecialAction(frame_count + 1, false))
     {
         return false;
@@ -72,6 +93,8 @@ bool UdpSocketRobotHeartbeat::initializeRemoteRobot()
 {
     //%ld;0;App_Start;false
     //%ld;1;App_Start;true
+    // the robot application counts its frames from the start again
+    this->resetFrameStatistics();
     if(false == this->simulateSpecialAction(0, false))
     {
         return false;
@@ -89,34 +112,31 @@ bool UdpSocketRobotHeartbeat::initializeRemoteRobot()
 
 bool UdpSocketRobotHeartbeat::simulateSpecialAction(int count, bool isTrue)
 {
-    QString dataStream;
-    long requestTime = this->timeStamp();
-    dataStream.sprintf("%ld;%d;App_Start;%s", requestTime, count, (isTrue ? "true" : "false"));
-    MITK_DEBUG << "try sent data: " << dataStream;
-    //this->m_imp->sendDataStream.push_back(dataStream.toLatin1().data());
-
-    if(-1 == this->writeDatagram(dataStream.toLatin1().data(), QHostAddress(this->remoteHostAddress()), this->remoteHostPort()))
-    {
-        return false;
-    }
-    MITK_DEBUG << "try sent data: " << dataStream << " OK";
-    return true;
+    //%ld;%d;App_Start;%s
+    return this->sendCommand(count, RobotUDPStatusCodec::AppStart, isTrue);
 }
 
 bool UdpSocketRobotHeartbeat::simulateSpecialActionOfAppGetState(int count, bool isTrue)
 {
-    MITK_DEBUG << "log";
-    QString dataStream;
-    long requestTime = this->timeStamp();
-    dataStream.sprintf("%d;%d;Get_State;%s", requestTime, count, (isTrue ? "true" : "false"));
-    MITK_DEBUG << "try sent data: " << dataStream;
-    //this->m_imp->sendDataStream.push_back(dataStream.toLatin1().data());
+    //%ld;%d;Get_State;%s
+    return this->sendCommand(count, RobotUDPStatusCodec::GetState, isTrue);
+}
+
+bool UdpSocketRobotHeartbeat::sendCommand(int count, RobotUDPStatusCodec::Signal signal, bool value)
+{
+    char dataStream[64];
+    const int length = RobotUDPStatusCodec::encodeCommand(this->wireFormat(), this->timeStamp(), count, signal, value,
+                                                          dataStream, sizeof(dataStream));
+    if(length < 0)
+    {
+        return false;
+    }
 
-    if(-1 == this->writeDatagram(dataStream.toLatin1().data(), QHostAddress(this->remoteHostAddress()), this->remoteHostPort()))
+    if(-1 == this->writeDatagram(dataStream, length, this->m_imp->remoteAddress, static_cast<quint16>(this->remoteHostPort())))
     {
+        MITK_DEBUG << "sent data failed: " << count;
         return false;
     }
-    MITK_DEBUG << "try sent data: " << dataStream << " OK";
     return true;
 }
 void UdpSocketRobotHeartbeat::stopRepetitiveHeartbeat()
@@ -127,19 +147,11 @@ void UdpSocketRobotHeartbeat::stopRepetitiveHeartbeat()
         // thread
         MITK_INFO << "log.stop.thread";
         this->m_imp->isStartRepetitiveHeartbeat = false;
-        while(true)
+        if(this->m_imp->thread)
         {
-            if(this->m_imp->thread->isRunning())
-            {
-                MITK_INFO << "The thread did not stop, waiting for the thread to stop";
-                QThread::msleep(1);
-            }
-            else
-            {
-                MITK_INFO << "UDP worker exited";
-                break;
-            }
+            this->m_imp->thread->wait();
         }
+        MITK_INFO << "UDP worker exited";
     }
     else
     {
@@ -154,7 +166,7 @@ bool UdpSocketRobotHeartbeat::isRepetitiveHeartbeatRunning() const
     {
         case RunningModel::Thread:
             {
-                return this->m_imp->thread->isRunning();
+                return this->m_imp->thread && this->m_imp->thread->isRunning();
             }
         case RunningModel::Timer:
             return this->m_imp->repetitiveHeartbeatInterval.isActive();
@@ -166,13 +178,18 @@ void UdpSocketRobotHeartbeat::startRepetitiveHeartbeat(int runningModel)
 {
     MITK_DEBUG << "log";
 
+    // the remote gets one death timeout to answer the first heartbeat
+    this->resetFrameStatistics();
+    this->m_imp->lastReceived = steadyMilliseconds();
+    this->m_imp->isRemoteAlive = true;
+
     switch (runningModel)
     {
         case RunningModel::Thread:
             {
                 MITK_INFO << "log.start.thread";
-                this->m_imp->thread = QThread::create(&UdpSocketRobotHeartbeat::onThreadHandle, this);
                 this->stopRepetitiveHeartbeat();
+                this->m_imp->thread = QThread::create(&UdpSocketRobotHeartbeat::onThreadHandle, this);
                 MITK_INFO << "log.thread.object " << this->m_imp->thread;
                 this->m_imp->isStartRepetitiveHeartbeat = true;
                 this->m_imp->thread->start();
@@ -194,6 +211,7 @@ QString UdpSocketRobotHeartbeat::remoteHostAddress() const
 void UdpSocketRobotHeartbeat::setRemoteHostAddress(const QString& address)
 {
     this->m_imp->remoteHostAddress = address;
+    this->m_imp->remoteAddress = QHostAddress(address);
 }
 
 uint UdpSocketRobotHeartbeat::remoteHostPort() const
@@ -231,25 +249,57 @@ void UdpSocketRobotHeartbeat::setDeathTimeout(int t)
     this->m_imp->deathTimeout = t;
 }
 
+bool UdpSocketRobotHeartbeat::isRemoteAlive() const
+{
+    return this->m_imp->isRemoteAlive;
+}
+
+RobotUDPStatusCodec::Format UdpSocketRobotHeartbeat::wireFormat() const
+{
+    return this->m_imp->wireFormat;
+}
+
+void UdpSocketRobotHeartbeat::setWireFormat(RobotUDPStatusCodec::Format format)
+{
+    this->m_imp->wireFormat = format;
+}
+
 RobotUDPMessage UdpSocketRobotHeartbeat::lastRobotUDPMessage() const
 {
-    return this->m_imp->lastRobotUDPMessage;
+    return RobotUDPMessage(this->lastRobotUDPStatus());
 }
 
 void UdpSocketRobotHeartbeat::setLastRobotUDPMessage(const RobotUDPMessage& o)
 {
-    this->m_imp->lastRobotUDPMessage = o;
+    std::lock_guard<std::mutex> lock(this->m_imp->statusMutex);
+    this->m_imp->lastStatus = o.status();
 }
 
-void UdpSocketRobotHeartbeat::updateRobotHeartbeat()
+RobotUDPStatus UdpSocketRobotHeartbeat::lastRobotUDPStatus() const
 {
-    MITK_DEBUG << "log";
+    std::lock_guard<std::mutex> lock(this->m_imp->statusMutex);
+    return this->m_imp->lastStatus;
+}
+
+RobotUDPFrameStatistics UdpSocketRobotHeartbeat::frameStatistics() const
+{
+    std::lock_guard<std::mutex> lock(this->m_imp->statusMutex);
+    return this->m_imp->frameStatistics;
+}
+
+void UdpSocketRobotHeartbeat::resetFrameStatistics()
+{
+    std::lock_guard<std::mutex> lock(this->m_imp->statusMutex);
+    this->m_imp->frameStatistics = RobotUDPFrameStatistics();
+}
 
-    MITK_DEBUG << "info.fream " << this->lastRobotUDPMessage().errorCode();
-    if(this->lastRobotUDPMessage().errorCode() != 0)
+void UdpSocketRobotHeartbeat::updateRobotHeartbeat()
+{
+    const int errorCode = this->lastRobotUDPStatus().errorCode;
+    if(errorCode != 0)
     {
-        MITK_DEBUG << "try repair error code " << this->lastRobotUDPMessage().errorCode();
-        if(this->tryRepairErrorCodeOf(this->lastRobotUDPMessage().errorCode()))
+        MITK_DEBUG << "try repair error code " << errorCode;
+        if(this->tryRepairErrorCodeOf(errorCode))
         {
             MITK_INFO << "repair error code sucess.";
         }
@@ -259,28 +309,34 @@ void UdpSocketRobotHeartbeat::updateRobotHeartbeat()
         }
     }
 
-    static clock_t deathClock = 0;
-    if(false == this->routineHeartbeat())
-    {
-        if((clock() - deathClock) > this->deathTimeout())
-        {
-            // 通信中断
-        }
-    }
-    else
-    {
-        deathClock = clock();
-    }
+    this->routineHeartbeat();
+    this->checkRemoteAlive();
 }
 
 void UdpSocketRobotHeartbeat::onReadyRead()
 {
-    MITK_DEBUG << __func__ << ": log";
+    char* buffer = this->m_imp->receiveBuffer;
     while (this->hasPendingDatagrams())
     {
-        QByteArray stream;
-        QNetworkDatagram datagram = this->receiveDatagram();
-        this->setLastRobotUDPMessage(datagram.data());
+        // read straight into the fixed buffer, no QNetworkDatagram / QByteArray per packet
+        const qint64 length = this->readDatagram(buffer, sizeof(this->m_imp->receiveBuffer));
+        RobotUDPStatus status;
+        const bool decoded = length > 0
+            && length < static_cast<qint64>(sizeof(this->m_imp->receiveBuffer))
+            && RobotUDPStatusCodec::decodeStatus(buffer, static_cast<int>(length), status);
+
+        std::lock_guard<std::mutex> lock(this->m_imp->statusMutex);
+        if(!decoded)
+        {
+            ++this->m_imp->frameStatistics.invalid;
+            continue;
+        }
+        // a late message must not replace a newer one
+        if(this->m_imp->frameStatistics.update(status.frames))
+        {
+            this->m_imp->lastStatus = status;
+        }
+        this->m_imp->lastReceived = steadyMilliseconds();
     }
 }
 
@@ -296,7 +352,7 @@ bool UdpSocketRobotHeartbeat::tryRepairErrorCodeOf(int error)
     {
         case -3:
             {
-                int frame_count = this->lastRobotUDPMessage().validFrames();
+                int frame_count = this->lastRobotUDPStatus().validFrames;
                 MITK_DEBUG << "log.count.value.App_Strat.false " << frame_count + 1;
                 if(false == this->simulateSpecialAction(frame_count + 1, false))
                 {
@@ -322,34 +378,70 @@ bool UdpSocketRobotHeartbeat::tryRepairErrorCodeOf(int error)
     return false;
 }
 
+void UdpSocketRobotHeartbeat::checkRemoteAlive()
+{
+    const bool alive = steadyMilliseconds() - this->m_imp->lastReceived <= this->deathTimeout();
+    if(alive != this->m_imp->isRemoteAlive.exchange(alive))
+    {
+        if(alive)
+        {
+            MITK_INFO << "remote robot answers again.";
+        }
+        else
+        {
+            MITK_WARN << "no robot status for " << this->deathTimeout() << " ms, communication lost.";
+        }
+        emit this->remoteAliveChanged(alive);
+    }
+}
+
 void UdpSocketRobotHeartbeat::onThreadHandle(UdpSocketRobotHeartbeat* __this)
 {
-    clock_t tclock_tab = clock();
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point nextHeartbeat = Clock::now();
     while (__this->m_imp->isStartRepetitiveHeartbeat)
     {
-        // security restore
-        MITK_DEBUG << "info.fream " << __this->lastRobotUDPMessage().errorCode();
-        if(__this->lastRobotUDPMessage().errorCode() != 0)
+        const Clock::time_point now = Clock::now();
+        if(now >= nextHeartbeat)
         {
-            MITK_DEBUG << "try repair error code " << __this->lastRobotUDPMessage().errorCode();
-            if(__this->tryRepairErrorCodeOf(__this->lastRobotUDPMessage().errorCode()))
+            // security restore
+            const int errorCode = __this->lastRobotUDPStatus().errorCode;
+            if(errorCode != 0)
             {
-                MITK_INFO << "repair error code sucess.";
+                MITK_DEBUG << "try repair error code " << errorCode;
+                if(__this->tryRepairErrorCodeOf(errorCode))
+                {
+                    MITK_INFO << "repair error code sucess.";
+                }
+                else
+                {
+                    MITK_WARN << "repair error code faild.";
+                }
             }
-            else
+            __this->routineHeartbeat();
+
+            // fixed rate, without drifting by the time the heartbeat took
+            nextHeartbeat += std::chrono::milliseconds(__this->repetitiveHeartbeatInterval());
+            if(nextHeartbeat < now)
             {
-                MITK_WARN << "repair error code faild.";
+                nextHeartbeat = now + std::chrono::milliseconds(__this->repetitiveHeartbeatInterval());
             }
         }
 
-        // sleep ms
-        if((clock() - tclock_tab) < __this->repetitiveHeartbeatInterval())
+        __this->checkRemoteAlive();
+
+        // wake up at the death deadline too, so a lost robot is reported within a few ms
+        Clock::time_point wakeUp = nextHeartbeat;
+        if(__this->m_imp->isRemoteAlive)
         {
-            MITK_DEBUG << "wait fream update " << (__this->repetitiveHeartbeatInterval() - (clock() - tclock_tab));
-            QThread::msleep((__this->repetitiveHeartbeatInterval() - (clock() - tclock_tab)));
-            tclock_tab = clock();
+            const Clock::time_point deadline = Clock::time_point(std::chrono::milliseconds(
+                __this->m_imp->lastReceived + __this->deathTimeout() + 1));
+            if(deadline > Clock::now() && deadline < wakeUp)
+            {
+                wakeUp = deadline;
+            }
         }
-        __this->routineHeartbeat();
+        std::this_thread::sleep_until(wakeUp);
     }
     MITK_INFO << "log.thread.close";
 }
@@ -0,0 +1,288 @@
+﻿#include "udpstatuscodec.h"
+
+#include <cstdio>
+
+namespace
+{
+    const char* const ApplicationStateNames[] = {
+        "UNKNOWN", "IDLE", "RUNNING", "MOTIONPAUSED", "REPOSITIONING", "ERROR", "STARTING", "STOPPING"
+    };
+    const int ApplicationStateCount = sizeof(ApplicationStateNames) / sizeof(ApplicationStateNames[0]);
+
+    const char StatusMagic[4] = { 'L', 'R', 'S', '1' };
+    const char CommandMagic[4] = { 'L', 'R', 'C', '1' };
+
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    char toUpper(char c)
+    {
+        return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+    }
+
+    bool equalsIgnoreCase(const char* begin, const char* end, const char* upper)
+    {
+        for (; begin != end; ++begin, ++upper)
+        {
+            if (*upper == '\0' || toUpper(*begin) != *upper)
+            {
+                return false;
+            }
+        }
+        return *upper == '\0';
+    }
+
+    // like QByteArray::toLongLong(), 0 if the field is not a number
+    long long parseInteger(const char* begin, const char* end)
+    {
+        bool negative = false;
+        if (begin != end && (*begin == '-' || *begin == '+'))
+        {
+            negative = *begin++ == '-';
+        }
+        if (begin == end)
+        {
+            return 0;
+        }
+        long long value = 0;
+        for (; begin != end; ++begin)
+        {
+            if (*begin < '0' || *begin > '9')
+            {
+                return 0;
+            }
+            value = value * 10 + (*begin - '0');
+        }
+        return negative ? -value : value;
+    }
+
+    void putUInt(char* p, unsigned long long value, int bytes)
+    {
+        for (int i = 0; i < bytes; ++i)
+        {
+            p[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    unsigned long long getUInt(const char* p, int bytes)
+    {
+        unsigned long long value = 0;
+        for (int i = 0; i < bytes; ++i)
+        {
+            value |= static_cast<unsigned long long>(static_cast<unsigned char>(p[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    bool hasMagic(const char* data, const char (&magic)[4])
+    {
+        return data[0] == magic[0] && data[1] == magic[1] && data[2] == magic[2] && data[3] == magic[3];
+    }
+
+    int writeBinaryFrame(const char (&magic)[4], long long time, int frames, int validFrames, int errorCode,
+                         int state, unsigned flags, int signal, char* buffer, int size)
+    {
+        if (size < RobotUDPStatusCodec::BinaryFrameSize)
+        {
+            return -1;
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            buffer[i] = magic[i];
+        }
+        putUInt(buffer + 4, static_cast<unsigned long long>(time), 8);
+        putUInt(buffer + 12, static_cast<unsigned int>(frames), 4);
+        putUInt(buffer + 16, static_cast<unsigned int>(validFrames), 4);
+        putUInt(buffer + 20, static_cast<unsigned int>(errorCode), 4);
+        putUInt(buffer + 24, static_cast<unsigned int>(state), 1);
+        putUInt(buffer + 25, flags, 1);
+        putUInt(buffer + 26, static_cast<unsigned int>(signal), 2);
+        putUInt(buffer + 28, 0, 4);
+        return RobotUDPStatusCodec::BinaryFrameSize;
+    }
+
+    const char* boolName(bool value)
+    {
+        return value ? "true" : "false";
+    }
+
+    int checkedLength(int written, int size)
+    {
+        return (written < 0 || written >= size) ? -1 : written;
+    }
+}
+
+bool RobotUDPFrameStatistics::update(int frame)
+{
+    ++this->received;
+    if (this->received == 1)
+    {
+        this->lastFrame = frame;
+        return true;
+    }
+
+    // unsigned difference, so the counter may wrap around
+    const int delta = static_cast<int>(static_cast<unsigned int>(frame) - static_cast<unsigned int>(this->lastFrame));
+    if (delta > 0)
+    {
+        this->lost += static_cast<unsigned long long>(delta - 1);
+        this->lastFrame = frame;
+        return true;
+    }
+    if (delta == 0)
+    {
+        ++this->duplicated;
+        return false;
+    }
+    if (delta < -ReorderWindow)
+    {
+        // too old to be late, the sender started counting again
+        ++this->resynced;
+        this->lastFrame = frame;
+        return true;
+    }
+
+    // a late message fills a gap counted as lost before
+    ++this->reordered;
+    if (this->lost > 0)
+    {
+        --this->lost;
+    }
+    return false;
+}
+
+bool RobotUDPStatusCodec::decodeStatus(const char* data, int length, RobotUDPStatus& status)
+{
+    if (length >= 4 && hasMagic(data, StatusMagic))
+    {
+        return decodeBinaryStatus(data, length, status);
+    }
+    return decodeTextStatus(data, length, status);
+}
+
+bool RobotUDPStatusCodec::decodeTextStatus(const char* data, int length, RobotUDPStatus& status)
+{
+    const char* const end = data + length;
+    const char* begin = data;
+    int field = 0;
+    for (; field < 11 && begin <= end; ++field)
+    {
+        const char* separator = begin;
+        while (separator != end && *separator != ';')
+        {
+            ++separator;
+        }
+
+        const char* valueBegin = begin;
+        const char* valueEnd = separator;
+        while (valueBegin != valueEnd && isSpace(*valueBegin))
+        {
+            ++valueBegin;
+        }
+        while (valueEnd != valueBegin && isSpace(valueEnd[-1]))
+        {
+            --valueEnd;
+        }
+
+        const bool flag = equalsIgnoreCase(valueBegin, valueEnd, "TRUE");
+        switch (field)
+        {
+            case 0: status.time = parseInteger(valueBegin, valueEnd); break;
+            case 1: status.frames = static_cast<int>(parseInteger(valueBegin, valueEnd)); break;
+            case 2: status.validFrames = static_cast<int>(parseInteger(valueBegin, valueEnd)); break;
+            case 3: status.errorCode = static_cast<int>(parseInteger(valueBegin, valueEnd)); break;
+            case 4: status.isConnectedUDP = flag; break;
+            case 5: status.isApplicationReadyToStart = flag; break;
+            case 6: status.isApplicationError = flag; break;
+            case 7: status.isLowerMachineSignalError = flag; break;
+            case 8: status.applicationState = applicationStateOf(valueBegin, static_cast<int>(valueEnd - valueBegin)); break;
+            case 9: status.isApplicationStart = flag; break;
+            case 10: status.isApplicationEnable = flag; break;
+        }
+
+        if (separator == end)
+        {
+            ++field;
+            break;
+        }
+        begin = separator + 1;
+    }
+    return field >= 11;
+}
+
+bool RobotUDPStatusCodec::decodeBinaryStatus(const char* data, int length, RobotUDPStatus& status)
+{
+    if (length < BinaryFrameSize || !hasMagic(data, StatusMagic))
+    {
+        return false;
+    }
+    status.time = static_cast<long long>(getUInt(data + 4, 8));
+    status.frames = static_cast<int>(getUInt(data + 12, 4));
+    status.validFrames = static_cast<int>(getUInt(data + 16, 4));
+    status.errorCode = static_cast<int>(getUInt(data + 20, 4));
+    const int state = static_cast<int>(getUInt(data + 24, 1));
+    status.applicationState = state < ApplicationStateCount ? state : 0;
+
+    const unsigned flags = static_cast<unsigned>(getUInt(data + 25, 1));
+    status.isConnectedUDP = (flags & 0x01) != 0;
+    status.isApplicationReadyToStart = (flags & 0x02) != 0;
+    status.isApplicationError = (flags & 0x04) != 0;
+    status.isLowerMachineSignalError = (flags & 0x08) != 0;
+    status.isApplicationStart = (flags & 0x10) != 0;
+    status.isApplicationEnable = (flags & 0x20) != 0;
+    return true;
+}
+
+int RobotUDPStatusCodec::encodeStatus(Format format, const RobotUDPStatus& status, char* buffer, int size)
+{
+    if (format == Binary)
+    {
+        const unsigned flags = (status.isConnectedUDP ? 0x01u : 0u)
+            | (status.isApplicationReadyToStart ? 0x02u : 0u)
+            | (status.isApplicationError ? 0x04u : 0u)
+            | (status.isLowerMachineSignalError ? 0x08u : 0u)
+            | (status.isApplicationStart ? 0x10u : 0u)
+            | (status.isApplicationEnable ? 0x20u : 0u);
+        return writeBinaryFrame(StatusMagic, status.time, status.frames, status.validFrames, status.errorCode,
+                                status.applicationState, flags, 0, buffer, size);
+    }
+
+    const int written = std::snprintf(buffer, size, "%lld;%d;%d;%d;%s;%s;%s;%s;%s;%s;%s",
+        status.time, status.frames, status.validFrames, status.errorCode,
+        boolName(status.isConnectedUDP), boolName(status.isApplicationReadyToStart),
+        boolName(status.isApplicationError), boolName(status.isLowerMachineSignalError),
+        applicationStateName(status.applicationState),
+        boolName(status.isApplicationStart), boolName(status.isApplicationEnable));
+    return checkedLength(written, size);
+}
+
+int RobotUDPStatusCodec::encodeCommand(Format format, long long time, int count, Signal signal, bool value, char* buffer, int size)
+{
+    if (format == Binary)
+    {
+        return writeBinaryFrame(CommandMagic, time, count, 0, 0, 0, value ? 0x01u : 0u, signal, buffer, size);
+    }
+
+    const char* signalName = signal == GetState ? "Get_State" : "App_Start";
+    const int written = std::snprintf(buffer, size, "%lld;%d;%s;%s", time, count, signalName, boolName(value));
+    return checkedLength(written, size);
+}
+
+const char* RobotUDPStatusCodec::applicationStateName(int state)
+{
+    return (state >= 0 && state < ApplicationStateCount) ? ApplicationStateNames[state] : ApplicationStateNames[0];
+}
+
+int RobotUDPStatusCodec::applicationStateOf(const char* name, int length)
+{
+    for (int state = 1; state < ApplicationStateCount; ++state)
+    {
+        if (equalsIgnoreCase(name, name + length, ApplicationStateNames[state]))
+        {
+            return state;
+        }
+    }
+    return 0;
+}
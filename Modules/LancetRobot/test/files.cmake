@@ -1,5 +1,7 @@
 set(MODULE_TESTS
 lancetRobotRegistrationTest.cpp
+lancetRobotSampleBufferTest.cpp
+lancetRobotUDPStatusCodecTest.cpp
 )
 
 SET(MODULE_CUSTOM_TESTS
@@ -0,0 +1,137 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+// Testing
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include "robotSampleBuffer.h"
+
+#include <thread>
+
+class lancetRobotSampleBufferTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(lancetRobotSampleBufferTestSuite);
+
+  MITK_TEST(LatestAndWindowTest);
+  MITK_TEST(OverwriteTest);
+  MITK_TEST(StatisticsTest);
+  MITK_TEST(ConcurrentReadTest);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  static RobotPoseSample MakeSample(long long timestamp, unsigned long long counter)
+  {
+    RobotPoseSample sample;
+    sample.timestamp = timestamp;
+    sample.counter = counter;
+    for (int i = 0; i < 6; ++i)
+    {
+      sample.pose[i] = static_cast<double>(counter) + i;
+    }
+    return sample;
+  }
+
+public:
+  void LatestAndWindowTest()
+  {
+    RobotSampleBuffer buffer(16);
+    RobotPoseSample sample;
+    CPPUNIT_ASSERT_MESSAGE("An empty buffer has no latest sample.", !buffer.GetLatest(sample));
+
+    for (unsigned long long i = 1; i <= 10; ++i)
+    {
+      buffer.Push(MakeSample(1000 * i, i));
+    }
+    CPPUNIT_ASSERT(buffer.GetLatest(sample));
+    CPPUNIT_ASSERT_EQUAL(10ull, sample.counter);
+    CPPUNIT_ASSERT_EQUAL(15.0, sample.pose[5]);
+
+    std::vector<RobotPoseSample> samples;
+    CPPUNIT_ASSERT_EQUAL(size_t(3), buffer.GetWindow(4000, 7000, samples));
+    CPPUNIT_ASSERT_EQUAL(4ull, samples.front().counter);
+    CPPUNIT_ASSERT_EQUAL(6ull, samples.back().counter);
+
+    samples.clear();
+    CPPUNIT_ASSERT_EQUAL(size_t(2), buffer.GetSince(8000, samples));
+    CPPUNIT_ASSERT_EQUAL(9ull, samples.front().counter);
+  }
+
+  void OverwriteTest()
+  {
+    RobotSampleBuffer buffer(8);
+    for (unsigned long long i = 1; i <= 20; ++i)
+    {
+      buffer.Push(MakeSample(1000 * i, i));
+    }
+    std::vector<RobotPoseSample> samples;
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Only the newest capacity samples are kept.", size_t(8), buffer.GetSince(0, samples));
+    CPPUNIT_ASSERT_EQUAL(13ull, samples.front().counter);
+
+    buffer.Clear();
+    RobotPoseSample sample;
+    CPPUNIT_ASSERT(!buffer.GetLatest(sample));
+  }
+
+  void StatisticsTest()
+  {
+    RobotSampleBuffer buffer(64);
+    const long long now = RobotSampleBuffer::Now();
+    // 10 ms period, every other period 2 ms late, counter 6 missing
+    unsigned long long counter = 1;
+    for (long long i = 0; i < 11; ++i, ++counter)
+    {
+      if (counter == 6)
+      {
+        ++counter;
+      }
+      buffer.Push(MakeSample(now - 200000 + 10000 * i + (i % 2) * 2000, counter));
+    }
+    const RobotSampleStatistics statistics = buffer.GetStatistics(1000000);
+    CPPUNIT_ASSERT_EQUAL(size_t(11), statistics.samples);
+    CPPUNIT_ASSERT_EQUAL(1ull, statistics.dropped);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0, statistics.meanPeriod, 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0, statistics.rate, 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, statistics.jitter, 1e-6);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(12.0, statistics.maxPeriod, 1e-9);
+  }
+
+  void ConcurrentReadTest()
+  {
+    RobotSampleBuffer buffer(32);
+    const unsigned long long count = 200000;
+    std::thread producer([&buffer, count]() {
+      for (unsigned long long i = 1; i <= count; ++i)
+      {
+        buffer.Push(MakeSample(static_cast<long long>(i), i));
+      }
+    });
+
+    // every sample a reader sees must be consistent, never half written
+    bool consistent = true;
+    unsigned long long last = 0;
+    RobotPoseSample sample;
+    while (last < count)
+    {
+      if (buffer.GetLatest(sample))
+      {
+        consistent = consistent && sample.counter >= last && sample.pose[5] == sample.counter + 5.0
+          && sample.timestamp == static_cast<long long>(sample.counter);
+        last = sample.counter;
+      }
+    }
+    producer.join();
+    CPPUNIT_ASSERT_MESSAGE("Readers only see complete samples.", consistent);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(lancetRobotSampleBuffer)
@@ -0,0 +1,173 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+// Testing
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include "udpstatuscodec.h"
+
+#include <cstring>
+#include <string>
+
+class lancetRobotUDPStatusCodecTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(lancetRobotUDPStatusCodecTestSuite);
+
+  MITK_TEST(DecodeTextTest);
+  MITK_TEST(TextRoundTripTest);
+  MITK_TEST(BinaryRoundTripTest);
+  MITK_TEST(CommandTest);
+  MITK_TEST(FrameStatisticsTest);
+  MITK_TEST(FrameStatisticsCounterResetTest);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  static RobotUDPStatus MakeStatus()
+  {
+    RobotUDPStatus status;
+    status.time = 1650000000123LL;
+    status.frames = 4711;
+    status.validFrames = 12;
+    status.errorCode = -3;
+    status.isConnectedUDP = true;
+    status.isApplicationError = true;
+    status.applicationState = 3; // MOTIONPAUSED
+    status.isApplicationEnable = true;
+    return status;
+  }
+
+  static void AssertEqual(const RobotUDPStatus& expected, const RobotUDPStatus& actual)
+  {
+    CPPUNIT_ASSERT_EQUAL(expected.time, actual.time);
+    CPPUNIT_ASSERT_EQUAL(expected.frames, actual.frames);
+    CPPUNIT_ASSERT_EQUAL(expected.validFrames, actual.validFrames);
+    CPPUNIT_ASSERT_EQUAL(expected.errorCode, actual.errorCode);
+    CPPUNIT_ASSERT_EQUAL(expected.isConnectedUDP, actual.isConnectedUDP);
+    CPPUNIT_ASSERT_EQUAL(expected.isApplicationReadyToStart, actual.isApplicationReadyToStart);
+    CPPUNIT_ASSERT_EQUAL(expected.isApplicationError, actual.isApplicationError);
+    CPPUNIT_ASSERT_EQUAL(expected.isLowerMachineSignalError, actual.isLowerMachineSignalError);
+    CPPUNIT_ASSERT_EQUAL(expected.applicationState, actual.applicationState);
+    CPPUNIT_ASSERT_EQUAL(expected.isApplicationStart, actual.isApplicationStart);
+    CPPUNIT_ASSERT_EQUAL(expected.isApplicationEnable, actual.isApplicationEnable);
+  }
+
+public:
+  void DecodeTextTest()
+  {
+    const std::string stream = "1650000000123;4711;12;-3;TRUE;false;true;false;motionpaused;false;True";
+    RobotUDPStatus status;
+    CPPUNIT_ASSERT(RobotUDPStatusCodec::decodeStatus(stream.data(), static_cast<int>(stream.size()), status));
+    AssertEqual(MakeStatus(), status);
+
+    const std::string shortStream = "1650000000123;4711;12;-3;true";
+    CPPUNIT_ASSERT_MESSAGE("A message with less than eleven fields is rejected.",
+      !RobotUDPStatusCodec::decodeStatus(shortStream.data(), static_cast<int>(shortStream.size()), status));
+
+    const std::string unknownState = "1;2;3;0;true;true;false;false;SOMETHING;true;true";
+    CPPUNIT_ASSERT(RobotUDPStatusCodec::decodeStatus(unknownState.data(), static_cast<int>(unknownState.size()), status));
+    CPPUNIT_ASSERT_EQUAL(0, status.applicationState);
+  }
+
+  void TextRoundTripTest()
+  {
+    char buffer[256];
+    const int length = RobotUDPStatusCodec::encodeStatus(RobotUDPStatusCodec::Text, MakeStatus(), buffer, sizeof(buffer));
+    CPPUNIT_ASSERT_EQUAL(std::string("1650000000123;4711;12;-3;true;false;true;false;MOTIONPAUSED;false;true"),
+      std::string(buffer, length));
+
+    RobotUDPStatus status;
+    CPPUNIT_ASSERT(RobotUDPStatusCodec::decodeStatus(buffer, length, status));
+    AssertEqual(MakeStatus(), status);
+
+    CPPUNIT_ASSERT_MESSAGE("A too small buffer is reported.",
+      RobotUDPStatusCodec::encodeStatus(RobotUDPStatusCodec::Text, MakeStatus(), buffer, 16) < 0);
+  }
+
+  void BinaryRoundTripTest()
+  {
+    char buffer[64];
+    const int length = RobotUDPStatusCodec::encodeStatus(RobotUDPStatusCodec::Binary, MakeStatus(), buffer, sizeof(buffer));
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(RobotUDPStatusCodec::BinaryFrameSize), length);
+    CPPUNIT_ASSERT_EQUAL(0, std::memcmp(buffer, "LRS1", 4));
+
+    RobotUDPStatus status;
+    CPPUNIT_ASSERT(RobotUDPStatusCodec::decodeStatus(buffer, length, status));
+    AssertEqual(MakeStatus(), status);
+
+    CPPUNIT_ASSERT_MESSAGE("A truncated binary frame is rejected.",
+      !RobotUDPStatusCodec::decodeStatus(buffer, length - 1, status));
+  }
+
+  void CommandTest()
+  {
+    char buffer[64];
+    int length = RobotUDPStatusCodec::encodeCommand(RobotUDPStatusCodec::Text, 1234, 7, RobotUDPStatusCodec::AppStart, true, buffer, sizeof(buffer));
+    CPPUNIT_ASSERT_EQUAL(std::string("1234;7;App_Start;true"), std::string(buffer, length));
+
+    length = RobotUDPStatusCodec::encodeCommand(RobotUDPStatusCodec::Text, 1234, 8, RobotUDPStatusCodec::GetState, false, buffer, sizeof(buffer));
+    CPPUNIT_ASSERT_EQUAL(std::string("1234;8;Get_State;false"), std::string(buffer, length));
+
+    length = RobotUDPStatusCodec::encodeCommand(RobotUDPStatusCodec::Binary, 1234, 9, RobotUDPStatusCodec::AppStart, true, buffer, sizeof(buffer));
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(RobotUDPStatusCodec::BinaryFrameSize), length);
+    CPPUNIT_ASSERT_EQUAL(0, std::memcmp(buffer, "LRC1", 4));
+  }
+
+  void FrameStatisticsTest()
+  {
+    RobotUDPFrameStatistics statistics;
+    CPPUNIT_ASSERT(statistics.update(10));
+    CPPUNIT_ASSERT(statistics.update(11));
+    CPPUNIT_ASSERT(statistics.update(14));
+    CPPUNIT_ASSERT_EQUAL(2ull, statistics.lost);
+
+    CPPUNIT_ASSERT_MESSAGE("A late message is not taken as newest.", !statistics.update(12));
+    CPPUNIT_ASSERT_EQUAL(1ull, statistics.reordered);
+    CPPUNIT_ASSERT_EQUAL(1ull, statistics.lost);
+    CPPUNIT_ASSERT_EQUAL(14, statistics.lastFrame);
+
+    RobotUDPFrameStatistics wrapping;
+    wrapping.update(2147483647);
+    CPPUNIT_ASSERT_MESSAGE("The counter may wrap around.", wrapping.update(-2147483647 - 1));
+    CPPUNIT_ASSERT_EQUAL(0ull, wrapping.lost);
+    CPPUNIT_ASSERT_EQUAL(2ull, wrapping.received);
+
+    RobotUDPFrameStatistics duplicates;
+    duplicates.update(5);
+    duplicates.update(7);
+    CPPUNIT_ASSERT_MESSAGE("A duplicate is dropped.", !duplicates.update(7));
+    CPPUNIT_ASSERT_EQUAL(1ull, duplicates.duplicated);
+    CPPUNIT_ASSERT_EQUAL(0ull, duplicates.reordered);
+    CPPUNIT_ASSERT_MESSAGE("A duplicate does not fill a gap.", 1ull == duplicates.lost);
+  }
+
+  void FrameStatisticsCounterResetTest()
+  {
+    RobotUDPFrameStatistics statistics;
+    statistics.update(5000);
+    statistics.update(5001);
+    CPPUNIT_ASSERT_MESSAGE("The first message after a counter reset is taken.", statistics.update(0));
+    CPPUNIT_ASSERT_EQUAL(1ull, statistics.resynced);
+    CPPUNIT_ASSERT_EQUAL(0, statistics.lastFrame);
+    CPPUNIT_ASSERT_MESSAGE("The messages after a counter reset are taken.", statistics.update(1));
+    CPPUNIT_ASSERT(statistics.update(2));
+    CPPUNIT_ASSERT_EQUAL(0ull, statistics.lost);
+    CPPUNIT_ASSERT_EQUAL(0ull, statistics.reordered);
+
+    CPPUNIT_ASSERT_MESSAGE("A message within the reorder window is late, not a reset.",
+                           !statistics.update(2 - RobotUDPFrameStatistics::ReorderWindow));
+    CPPUNIT_ASSERT_EQUAL(1ull, statistics.reordered);
+    CPPUNIT_ASSERT_EQUAL(2, statistics.lastFrame);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(lancetRobotUDPStatusCodec)
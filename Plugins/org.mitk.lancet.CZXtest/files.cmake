@@ -20,6 +20,8 @@ set(INTERNAL_CPP_FILES
   PKADianaAimHardwareDevice.cpp
   ToolDisplayHelper.cpp
   IntraOsteotomy.cpp
+  DrillZoneMesh.cpp
+  DrillSweptVolume.cpp
   PreoPreparation.cpp
   RobotJoint.cpp
   JointPartDescription.cpp
@@ -3011,6 +3011,12 @@ void CzxTest::UpdateBoneIntraDisplay()
 	m_Controls.IntraVaAngleDisplayLabel->setText(QString::number(PKAData::m_LimbVaAngle));
 	double distance = m_AngleCalculationHelper->CalculateCutPlaneDistance();
 	m_Controls.IntraBoneCutDistanceDispalyLabel->setText(QString::number(distance));
+
+	// safety checks on every tracking frame, whether the drill cuts or not
+	if (m_IntraOsteotomy)
+	{
+		m_IntraOsteotomy->CheckDrillSafety(m_IntraDrillPlane);
+	}
 }
 
 void CzxTest::OnBoxModified(vtkObject* caller, long unsigned int evetnId, void* clientData, void* callData)
@@ -3118,6 +3124,7 @@ void CzxTest::Drill()
 		return;
 	}
 
+	m_IntraOsteotomy->CheckDrillSafety(m_IntraDrillPlane);
 	m_IntraOsteotomy->Drill(m_IntraDrillPlane);
 }
 
@@ -415,7 +415,7 @@ private:
   Ui::CzxTestControls m_Controls;
   mitk::BoundingShapeInteractor::Pointer m_BoundingShapeInteractor;
   PKAKukaVegaHardwareDevice* m_PKAHardwareDevice;
-  IntraOsteotomy* m_IntraOsteotomy;
+  IntraOsteotomy* m_IntraOsteotomy{ nullptr };
   QTimer* m_RequestRenderTimer{ nullptr };
   bool m_IsRotateTibia = false;
   QTimer* m_TibiaRotateTimer{ nullptr };
@@ -0,0 +1,259 @@
+#include "DrillSweptVolume.h"
+
+#include <MRMesh/MRConvexHull.h>
+#include <MRMesh/MRMeshBoolean.h>
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+void lancetAlgorithm::DrillSweptVolume::SetTool(const MR::Mesh& aTool)
+{
+	m_HullPoints.clear();
+	m_Probes.clear();
+	Reset();
+
+	// only the hull vertices can end up on the hull of the swept drill
+	MR::Mesh hull = MR::makeConvexHull(aTool.points, aTool.topology.getValidVerts());
+	for (auto v : hull.topology.getValidVerts())
+	{
+		m_HullPoints.push_back(hull.points[v]);
+	}
+
+	MR::Box3f box = aTool.computeBoundingBox();
+	if (!box.valid())
+	{
+		return;
+	}
+	for (int i = 0; i < 8; ++i)
+	{
+		m_Probes.emplace_back(i & 1 ? box.max.x : box.min.x, i & 2 ? box.max.y : box.min.y, i & 4 ? box.max.z : box.min.z);
+	}
+}
+
+void lancetAlgorithm::DrillSweptVolume::Reset()
+{
+	m_Poses.clear();
+	m_HasLastPose = false;
+	m_Meshes.clear();
+	m_Boxes.clear();
+	m_NumberOfSegments = 0;
+}
+
+bool lancetAlgorithm::DrillSweptVolume::Update(const std::vector<MR::AffineXf3f>& aPoses, const std::vector<size_t>& aRunStarts)
+{
+	if (m_HullPoints.empty() || aPoses.empty())
+	{
+		return false;
+	}
+
+	// first pose of every run in m_Poses, followed by the end of the last run
+	std::vector<size_t> runs{ 0 };
+	m_Poses.clear();
+	if (m_HasLastPose)
+	{
+		m_Poses.push_back(m_LastPose);
+	}
+	bool moved = false;
+	for (size_t i = 0; i < aPoses.size(); ++i)
+	{
+		const MR::AffineXf3f& pose = aPoses[i];
+		if (m_Poses.empty())
+		{
+			m_Poses.push_back(pose);
+			continue;
+		}
+		const float distance = Distance(m_Poses.back(), pose);
+		if (std::binary_search(aRunStarts.begin(), aRunStarts.end(), i) || distance > m_MaxStep)
+		{
+			if (m_HasLastPose && m_Poses.size() == 1)
+			{
+				// nothing is swept from the last pose, it was cut already
+				m_Poses.back() = pose;
+			}
+			else
+			{
+				runs.push_back(m_Poses.size());
+				m_Poses.push_back(pose);
+			}
+			moved = true;
+		}
+		else if (distance >= m_MinStep)
+		{
+			m_Poses.push_back(pose);
+			moved = true;
+		}
+	}
+	if (m_HasLastPose && !moved)
+	{
+		return false;
+	}
+	m_LastPose = m_Poses.back();
+	m_HasLastPose = true;
+	runs.push_back(m_Poses.size());
+
+	// runs of almost straight motion, the tolerance grows a little while there are too many of them
+	std::vector<std::pair<size_t, size_t>> segments;
+	float tolerance = m_Tolerance;
+	for (int doublings = 0;; ++doublings)
+	{
+		segments.clear();
+		for (size_t run = 0; run + 1 < runs.size(); ++run)
+		{
+			const size_t end = runs[run + 1];
+			size_t first = runs[run];
+			do
+			{
+				size_t last = std::min(first + 1, end - 1);
+				while (last + 1 < end && IsStraight(first, last + 1, tolerance))
+				{
+					++last;
+				}
+				segments.emplace_back(first, last);
+				first = last;
+			} while (first + 1 < end);
+		}
+		if (segments.size() <= MaxSegments || doublings == MaxToleranceDoublings)
+		{
+			break;
+		}
+		tolerance *= 2;
+	}
+
+	m_Meshes.clear();
+	for (const auto& segment : segments)
+	{
+		m_Meshes.push_back(BuildHull(segment.first, segment.second));
+	}
+	// unite neighbours pairwise, so that every union works on pieces of similar size
+	while (m_Meshes.size() > 1)
+	{
+		std::vector<MR::Mesh> united;
+		for (size_t i = 0; i < m_Meshes.size(); i += 2)
+		{
+			if (i + 1 == m_Meshes.size())
+			{
+				united.push_back(std::move(m_Meshes[i]));
+				continue;
+			}
+			auto result = MR::boolean(m_Meshes[i], m_Meshes[i + 1], MR::BooleanOperation::Union);
+			if (!result.valid())
+			{
+				// both pieces are cut separately instead
+				std::cout << "Swept volume union failed: " << result.errorString << std::endl;
+				united.push_back(std::move(m_Meshes[i]));
+				united.push_back(std::move(m_Meshes[i + 1]));
+				continue;
+			}
+			united.push_back(std::move(*result));
+		}
+		const bool reduced = united.size() < m_Meshes.size();
+		m_Meshes = std::move(united);
+		if (!reduced)
+		{
+			break;
+		}
+	}
+	m_Boxes.clear();
+	for (const auto& mesh : m_Meshes)
+	{
+		m_Boxes.push_back(mesh.computeBoundingBox());
+	}
+	m_NumberOfSegments = static_cast<int>(segments.size());
+	return true;
+}
+
+int lancetAlgorithm::DrillSweptVolume::GetNumberOfMeshes() const
+{
+	return static_cast<int>(m_Meshes.size());
+}
+
+const MR::Mesh& lancetAlgorithm::DrillSweptVolume::GetMesh(int aIndex) const
+{
+	return m_Meshes[aIndex];
+}
+
+const MR::Box3f& lancetAlgorithm::DrillSweptVolume::GetBox(int aIndex) const
+{
+	return m_Boxes[aIndex];
+}
+
+void lancetAlgorithm::DrillSweptVolume::SetMinStep(float aMinStep)
+{
+	m_MinStep = aMinStep;
+}
+
+void lancetAlgorithm::DrillSweptVolume::SetMaxStep(float aMaxStep)
+{
+	m_MaxStep = aMaxStep;
+}
+
+void lancetAlgorithm::DrillSweptVolume::SetTolerance(float aTolerance)
+{
+	m_Tolerance = aTolerance;
+}
+
+int lancetAlgorithm::DrillSweptVolume::GetNumberOfPoses() const
+{
+	return static_cast<int>(m_Poses.size());
+}
+
+int lancetAlgorithm::DrillSweptVolume::GetNumberOfSegments() const
+{
+	return m_NumberOfSegments;
+}
+
+float lancetAlgorithm::DrillSweptVolume::Distance(const MR::AffineXf3f& a, const MR::AffineXf3f& b) const
+{
+	float distance = 0;
+	for (const auto& probe : m_Probes)
+	{
+		distance = std::max(distance, (a(probe) - b(probe)).length());
+	}
+	return distance;
+}
+
+float lancetAlgorithm::DrillSweptVolume::Deviation(const MR::AffineXf3f& aFirst, const MR::AffineXf3f& aLast,
+	const MR::AffineXf3f& aPose) const
+{
+	float deviation = 0;
+	for (const auto& probe : m_Probes)
+	{
+		// distance of the probe from the segment between its first and last position
+		const MR::Vector3f a = aFirst(probe);
+		const MR::Vector3f ab = aLast(probe) - a;
+		const MR::Vector3f ap = aPose(probe) - a;
+		const float lengthSq = MR::dot(ab, ab);
+		const float t = lengthSq > 0 ? std::clamp(MR::dot(ap, ab) / lengthSq, 0.0f, 1.0f) : 0.0f;
+		deviation = std::max(deviation, (ap - t * ab).length());
+	}
+	return deviation;
+}
+
+bool lancetAlgorithm::DrillSweptVolume::IsStraight(size_t aFirst, size_t aLast, float aTolerance) const
+{
+	for (size_t i = aFirst + 1; i < aLast; ++i)
+	{
+		if (Deviation(m_Poses[aFirst], m_Poses[aLast], m_Poses[i]) > aTolerance)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+MR::Mesh lancetAlgorithm::DrillSweptVolume::BuildHull(size_t aFirst, size_t aLast) const
+{
+	MR::VertCoords points;
+	points.reserve((aLast - aFirst + 1) * m_HullPoints.size());
+	for (size_t i = aFirst; i <= aLast; ++i)
+	{
+		for (const auto& point : m_HullPoints)
+		{
+			points.push_back(m_Poses[i](point));
+		}
+	}
+	MR::VertBitSet valid(points.size());
+	valid.set();
+	return MR::makeConvexHull(points, valid);
+}
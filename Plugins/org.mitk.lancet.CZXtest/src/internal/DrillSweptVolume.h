@@ -0,0 +1,93 @@
+#pragma once
+#include <vector>
+
+//meshlib
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRAffineXf3.h>
+#include <MRMesh/MRBox.h>
+
+namespace lancetAlgorithm
+{
+	/// <summary>
+	/// Volume swept by the drill between two cuts, so that one boolean per zone removes everything the drill
+	/// passed through, however far it moved since the last cut.
+	///
+	/// The poses of one update are split into runs along which the drill moves almost straight; the convex
+	/// hull of the drill at all poses of a run is the volume swept by the (convex) drill burr along it, and
+	/// neighbouring hulls are united pairwise. A hull whose union fails stays a separate piece, so the volume
+	/// may consist of several meshes. The last pose is kept as the start of the next update, so poses closer
+	/// than the minimum step are accumulated instead of lost.
+	/// </summary>
+	class DrillSweptVolume
+	{
+	public:
+		/// <summary>
+		/// Sets the drill in its own coordinates and forgets the last pose.
+		/// </summary>
+		void SetTool(const MR::Mesh& aTool);
+
+		/// <summary>
+		/// Forgets the last pose, the next update starts at its first pose (e.g. after the drill was lifted).
+		/// </summary>
+		void Reset();
+
+		/// <summary>
+		/// Builds the volume swept from the last pose through aPoses (drill to zone, oldest first, the current
+		/// pose last). aRunStarts (ascending) are the indices of the poses the drill is not swept to from the pose
+		/// before, e.g. the first one after the tracking lost the drill; a pose farther than the maximum step from
+		/// the one before starts a new run as well. Returns false if the drill did not move by the minimum step,
+		/// the mesh is then unchanged.
+		/// </summary>
+		bool Update(const std::vector<MR::AffineXf3f>& aPoses, const std::vector<size_t>& aRunStarts = std::vector<size_t>());
+
+		/// <summary>
+		/// Pieces of the swept volume in zone coordinates, each to be cut separately.
+		/// </summary>
+		int GetNumberOfMeshes() const;
+		const MR::Mesh& GetMesh(int aIndex) const;
+		const MR::Box3f& GetBox(int aIndex) const;
+
+		/// <summary>
+		/// Smallest movement of any point of the drill that counts as a new pose, 0.01 by default.
+		/// </summary>
+		void SetMinStep(float aMinStep);
+
+		/// <summary>
+		/// Largest movement of any point of the drill between two poses that is still swept, 20 by default.
+		/// A larger one is a tracking jump, not a motion of the drill.
+		/// </summary>
+		void SetMaxStep(float aMaxStep);
+
+		/// <summary>
+		/// Largest distance of the drill from the straight line of its run, 0.1 by default. It is doubled at
+		/// most MaxToleranceDoublings times while there are more than MaxSegments runs.
+		/// </summary>
+		void SetTolerance(float aTolerance);
+
+		int GetNumberOfPoses() const;
+		int GetNumberOfSegments() const;
+
+	private:
+		static constexpr int MaxSegments = 8;
+		static constexpr int MaxToleranceDoublings = 2;
+
+		float Distance(const MR::AffineXf3f& a, const MR::AffineXf3f& b) const;
+		float Deviation(const MR::AffineXf3f& aFirst, const MR::AffineXf3f& aLast, const MR::AffineXf3f& aPose) const;
+		bool IsStraight(size_t aFirst, size_t aLast, float aTolerance) const;
+		MR::Mesh BuildHull(size_t aFirst, size_t aLast) const;
+
+		std::vector<MR::Vector3f> m_HullPoints;	// vertices of the convex hull of the drill
+		std::vector<MR::Vector3f> m_Probes;		// corners of the bounding box of the drill
+
+		std::vector<MR::AffineXf3f> m_Poses;
+		MR::AffineXf3f m_LastPose;
+		bool m_HasLastPose{ false };
+
+		std::vector<MR::Mesh> m_Meshes;
+		std::vector<MR::Box3f> m_Boxes;
+		float m_MinStep{ 0.01f };
+		float m_MaxStep{ 20.0f };
+		float m_Tolerance{ 0.1f };
+		int m_NumberOfSegments{ 0 };
+	};
+}
@@ -0,0 +1,499 @@
+#include "DrillZoneMesh.h"
+
+#include <vtkPointData.h>
+#include <mitkLogMacros.h>
+
+#include <MRMesh/MRMeshCollide.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+	// triangles just touching the swept box still go into the patch, so no cut contour reaches its border
+	constexpr float patchMargin = 0.05f;
+
+	// position of a vertex, bit exact, to find the patch vertices again in the boolean result
+	struct PositionKey
+	{
+		uint32_t x;
+		uint32_t y;
+		uint32_t z;
+
+		bool operator==(const PositionKey& aKey) const
+		{
+			return x == aKey.x && y == aKey.y && z == aKey.z;
+		}
+	};
+
+	struct PositionKeyHash
+	{
+		size_t operator()(const PositionKey& aKey) const
+		{
+			return (size_t(aKey.x) * 73856093u) ^ (size_t(aKey.y) * 19349663u) ^ (size_t(aKey.z) * 83492791u);
+		}
+	};
+
+	PositionKey KeyOf(const float* aPoint)
+	{
+		PositionKey key;
+		std::memcpy(&key.x, aPoint, sizeof(float));
+		std::memcpy(&key.y, aPoint + 1, sizeof(float));
+		std::memcpy(&key.z, aPoint + 2, sizeof(float));
+		return key;
+	}
+
+	// area weighted normal of a triangle
+	void AddFaceNormal(const float* aPoints, const vtkIdType* aTriangle, double* aSum)
+	{
+		const float* a = aPoints + 3 * aTriangle[0];
+		const float* b = aPoints + 3 * aTriangle[1];
+		const float* c = aPoints + 3 * aTriangle[2];
+		const double u[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		const double v[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		aSum[0] += u[1] * v[2] - u[2] * v[1];
+		aSum[1] += u[2] * v[0] - u[0] * v[2];
+		aSum[2] += u[0] * v[1] - u[1] * v[0];
+	}
+
+	void Normalize(const double* aSum, float* aNormal)
+	{
+		const double length = std::sqrt(aSum[0] * aSum[0] + aSum[1] * aSum[1] + aSum[2] * aSum[2]);
+		for (int i = 0; i < 3; ++i)
+		{
+			aNormal[i] = length > 0 ? static_cast<float>(aSum[i] / length) : 0.0f;
+		}
+	}
+
+	MR::Mesh ToMRMesh(const std::vector<float>& aPoints, const std::vector<vtkIdType>& aTriangles)
+	{
+		MR::VertCoords coordinates;
+		coordinates.reserve(aPoints.size() / 3);
+		for (size_t i = 0; i < aPoints.size(); i += 3)
+		{
+			coordinates.push_back(MR::Vector3f(aPoints[i], aPoints[i + 1], aPoints[i + 2]));
+		}
+		MR::Triangulation triangulation;
+		triangulation.reserve(aTriangles.size() / 3);
+		for (size_t i = 0; i < aTriangles.size(); i += 3)
+		{
+			triangulation.push_back({ MR::VertId(static_cast<int>(aTriangles[i])),
+				MR::VertId(static_cast<int>(aTriangles[i + 1])), MR::VertId(static_cast<int>(aTriangles[i + 2])) });
+		}
+		return MR::Mesh::fromTriangles(std::move(coordinates), triangulation);
+	}
+}
+
+lancetAlgorithm::DrillZoneMesh::DrillZoneMesh()
+{
+	m_PointArray = vtkSmartPointer<vtkFloatArray>::New();
+	m_PointArray->SetNumberOfComponents(3);
+	m_Points = vtkSmartPointer<vtkPoints>::New();
+	m_Points->SetData(m_PointArray);
+
+	m_Normals = vtkSmartPointer<vtkFloatArray>::New();
+	m_Normals->SetNumberOfComponents(3);
+	m_Normals->SetName("Normals");
+
+	m_Offsets = vtkSmartPointer<vtkIdTypeArray>::New();
+	m_Offsets->InsertNextValue(0);
+	m_Connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+	m_Polys = vtkSmartPointer<vtkCellArray>::New();
+	m_Polys->SetData(m_Offsets, m_Connectivity);
+
+	m_PolyData = vtkSmartPointer<vtkPolyData>::New();
+	m_PolyData->SetPoints(m_Points);
+	m_PolyData->SetPolys(m_Polys);
+	m_PolyData->GetPointData()->SetNormals(m_Normals);
+}
+
+void lancetAlgorithm::DrillZoneMesh::SetMesh(const MR::Mesh& aMesh)
+{
+	// MR::Vector3f is three packed floats, as in TurnMRMeshIntoPolyData
+	const std::vector<MR::Vector3f>& mrPoints = aMesh.points.vec_;
+	std::vector<float> points(3 * mrPoints.size());
+	if (!mrPoints.empty())
+	{
+		std::memcpy(points.data(), mrPoints.data(), points.size() * sizeof(float));
+	}
+
+	const std::vector<std::array<MR::VertId, 3>> mrTriangles = aMesh.topology.getAllTriVerts();
+	std::vector<vtkIdType> triangles;
+	triangles.reserve(3 * mrTriangles.size());
+	for (const auto& triangle : mrTriangles)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			triangles.push_back(static_cast<int>(triangle[k]));
+		}
+	}
+	Rebuild(points, triangles);
+}
+
+vtkPolyData* lancetAlgorithm::DrillZoneMesh::GetPolyData() const
+{
+	return m_PolyData;
+}
+
+bool lancetAlgorithm::DrillZoneMesh::IsEmpty() const
+{
+	return m_NumberOfTriangles == 0;
+}
+
+int lancetAlgorithm::DrillZoneMesh::GetNumberOfTriangles() const
+{
+	return m_NumberOfTriangles;
+}
+
+int lancetAlgorithm::DrillZoneMesh::GetLastPatchSize() const
+{
+	return m_LastPatchSize;
+}
+
+int lancetAlgorithm::DrillZoneMesh::GetLastResultSize() const
+{
+	return m_LastResultSize;
+}
+
+bool lancetAlgorithm::DrillZoneMesh::Cut(const MR::Mesh& aTool, const MR::AffineXf3f& aToolToZone,
+	const MR::Box3f& aSweptBox, MR::BooleanOperation aOperation, int aCompareSize)
+{
+	m_LastPatchSize = 0;
+	m_LastResultSize = 0;
+	if (IsEmpty() || !aSweptBox.valid())
+	{
+		return false;
+	}
+
+	//------------ Patch: the triangles in the swept box, from the persistent tree ----------------
+	TriangleBox sweptBox;
+	const float sweptMin[3] = { aSweptBox.min.x, aSweptBox.min.y, aSweptBox.min.z };
+	const float sweptMax[3] = { aSweptBox.max.x, aSweptBox.max.y, aSweptBox.max.z };
+	sweptBox.Include(sweptMin);
+	sweptBox.Include(sweptMax);
+	sweptBox.Expand(patchMargin);
+	m_Candidates.clear();
+	m_Tree.Query(sweptBox, m_Candidates);
+
+	const float* points = m_PointArray->GetPointer(0);
+	std::vector<int> patch;
+	patch.reserve(m_Candidates.size());
+	std::unordered_map<vtkIdType, int> patchVertexOf;
+	std::vector<vtkIdType> zoneVertexOf;
+	MR::VertCoords coordinates;
+	MR::Triangulation triangulation;
+	for (int triangle : m_Candidates)
+	{
+		if (m_IsRemoved[triangle])
+		{
+			continue;
+		}
+		patch.push_back(triangle);
+		const vtkIdType* ids = m_Connectivity->GetPointer(3 * triangle);
+		MR::ThreeVertIds vertices;
+		for (int k = 0; k < 3; ++k)
+		{
+			const auto inserted = patchVertexOf.emplace(ids[k], static_cast<int>(zoneVertexOf.size()));
+			if (inserted.second)
+			{
+				zoneVertexOf.push_back(ids[k]);
+				const float* point = points + 3 * ids[k];
+				coordinates.push_back(MR::Vector3f(point[0], point[1], point[2]));
+			}
+			vertices[k] = MR::VertId(inserted.first->second);
+		}
+		triangulation.push_back(vertices);
+	}
+	if (patch.empty())
+	{
+		return false;
+	}
+	const MR::Mesh patchMesh = MR::Mesh::fromTriangles(std::move(coordinates), triangulation);
+
+	//------------ Boolean on the patch only ----------------
+	// the tool is placed by aToolToZone instead of being copied, so its tree is built once per tool mesh
+	if (MR::findCollidingTriangles(patchMesh, aTool, &aToolToZone, true).empty())
+	{
+		return false;
+	}
+	auto result = MR::boolean(patchMesh, aTool, aOperation, &aToolToZone);
+	if (!result.valid())
+	{
+		MITK_WARN << "Local drill cut failed: " << result.errorString << ", cutting the whole zone";
+		return CutWhole(aTool, aToolToZone, aOperation, aCompareSize);
+	}
+	const MR::Mesh& cutMesh = *result;
+	const std::vector<std::array<MR::VertId, 3>> cutTriangles = cutMesh.topology.getAllTriVerts();
+	const size_t numberOfTriangles = static_cast<size_t>(m_NumberOfTriangles) - patch.size() + cutTriangles.size();
+	if (aCompareSize > 0 && numberOfTriangles > static_cast<size_t>(aCompareSize) * m_NumberOfTriangles)
+	{
+		MITK_DEBUG << "Drill cut rejected, " << numberOfTriangles << " > " << aCompareSize << " * " << m_NumberOfTriangles;
+		return false;
+	}
+
+	//------------ Splice the result in place of the patch ----------------
+	// vertices the boolean did not touch keep their coordinates, and so their zone ids, which stitches
+	// the result to the triangles around the patch
+	std::unordered_map<PositionKey, vtkIdType, PositionKeyHash> zoneVertexAt;
+	for (vtkIdType vertex : zoneVertexOf)
+	{
+		zoneVertexAt.emplace(KeyOf(points + 3 * vertex), vertex);
+	}
+	for (int triangle : patch)
+	{
+		RemoveTriangle(triangle);
+	}
+
+	std::vector<vtkIdType> zoneVertexOfResult(cutMesh.points.size(), -1);
+	std::vector<vtkIdType> changedVertices;
+	for (const auto& triangle : cutTriangles)
+	{
+		vtkIdType ids[3];
+		for (int k = 0; k < 3; ++k)
+		{
+			vtkIdType& vertex = zoneVertexOfResult[static_cast<int>(triangle[k])];
+			if (vertex < 0)
+			{
+				const MR::Vector3f& point = cutMesh.points[triangle[k]];
+				const float position[3] = { point.x, point.y, point.z };
+				const auto found = zoneVertexAt.find(KeyOf(position));
+				vertex = found != zoneVertexAt.end() ? found->second : AddPoint(point);
+				changedVertices.push_back(vertex);
+			}
+			ids[k] = vertex;
+		}
+		AddTriangle(ids[0], ids[1], ids[2]);
+	}
+	UpdateNormals(changedVertices);
+
+	m_LastPatchSize = static_cast<int>(patch.size());
+	m_LastResultSize = static_cast<int>(cutTriangles.size());
+
+	// the pending triangles are searched linearly and removed ones stay in the arrays, both only up to a limit
+	if (m_Tree.GetNumberOfPending() > std::max<size_t>(4096, m_Tree.GetNumberOfBuilt() / 4)
+		|| m_NumberOfRemoved > m_NumberOfTriangles)
+	{
+		Compact();
+	}
+	else
+	{
+		Publish();
+	}
+	return true;
+}
+
+bool lancetAlgorithm::DrillZoneMesh::CutWhole(const MR::Mesh& aTool, const MR::AffineXf3f& aToolToZone,
+	MR::BooleanOperation aOperation, int aCompareSize)
+{
+	std::vector<float> points;
+	std::vector<vtkIdType> triangles;
+	Gather(points, triangles);
+	auto result = MR::boolean(ToMRMesh(points, triangles), aTool, aOperation, &aToolToZone);
+	if (!result.valid())
+	{
+		MITK_WARN << "Drill cut failed: " << result.errorString;
+		return false;
+	}
+	const MR::Mesh& cutMesh = *result;
+	if (aCompareSize > 0 && cutMesh.topology.numValidFaces() > aCompareSize * m_NumberOfTriangles)
+	{
+		return false;
+	}
+	m_LastPatchSize = m_NumberOfTriangles;
+	SetMesh(cutMesh);
+	m_LastResultSize = m_NumberOfTriangles;
+	return true;
+}
+
+void lancetAlgorithm::DrillZoneMesh::Gather(std::vector<float>& aPoints, std::vector<vtkIdType>& aTriangles) const
+{
+	const float* points = m_PointArray->GetPointer(0);
+	const vtkIdType* connectivity = m_Connectivity->GetPointer(0);
+	std::vector<vtkIdType> newIdOf(m_PointArray->GetNumberOfTuples(), -1);
+	aPoints.reserve(3 * newIdOf.size());
+	aTriangles.reserve(3 * m_NumberOfTriangles);
+	for (size_t triangle = 0; triangle < m_IsRemoved.size(); ++triangle)
+	{
+		if (m_IsRemoved[triangle])
+		{
+			continue;
+		}
+		for (int k = 0; k < 3; ++k)
+		{
+			const vtkIdType vertex = connectivity[3 * triangle + k];
+			if (newIdOf[vertex] < 0)
+			{
+				newIdOf[vertex] = static_cast<vtkIdType>(aPoints.size() / 3);
+				aPoints.insert(aPoints.end(), points + 3 * vertex, points + 3 * vertex + 3);
+			}
+			aTriangles.push_back(newIdOf[vertex]);
+		}
+	}
+}
+
+void lancetAlgorithm::DrillZoneMesh::Compact()
+{
+	std::vector<float> points;
+	std::vector<vtkIdType> triangles;
+	Gather(points, triangles);
+	Rebuild(points, triangles);
+}
+
+void lancetAlgorithm::DrillZoneMesh::Rebuild(const std::vector<float>& aPoints, const std::vector<vtkIdType>& aTriangles)
+{
+	const vtkIdType numberOfPoints = static_cast<vtkIdType>(aPoints.size() / 3);
+	const vtkIdType numberOfTriangles = static_cast<vtkIdType>(aTriangles.size() / 3);
+
+	m_PointArray->SetNumberOfTuples(numberOfPoints);
+	m_Normals->SetNumberOfTuples(numberOfPoints);
+	m_Connectivity->SetNumberOfValues(3 * numberOfTriangles);
+	m_Offsets->SetNumberOfValues(numberOfTriangles + 1);
+	if (numberOfPoints > 0)
+	{
+		std::memcpy(m_PointArray->GetPointer(0), aPoints.data(), aPoints.size() * sizeof(float));
+	}
+	if (numberOfTriangles > 0)
+	{
+		std::memcpy(m_Connectivity->GetPointer(0), aTriangles.data(), aTriangles.size() * sizeof(vtkIdType));
+	}
+	vtkIdType* offsets = m_Offsets->GetPointer(0);
+	for (vtkIdType triangle = 0; triangle <= numberOfTriangles; ++triangle)
+	{
+		offsets[triangle] = 3 * triangle;
+	}
+
+	m_IsRemoved.assign(numberOfTriangles, 0);
+	m_NumberOfTriangles = static_cast<int>(numberOfTriangles);
+	m_NumberOfRemoved = 0;
+
+	std::vector<TriangleBox> boxes(numberOfTriangles);
+	std::vector<double> sums(3 * numberOfPoints, 0.0);
+	for (vtkIdType triangle = 0; triangle < numberOfTriangles; ++triangle)
+	{
+		boxes[triangle] = GetTriangleBox(static_cast<int>(triangle));
+		const vtkIdType* ids = aTriangles.data() + 3 * triangle;
+		double normal[3] = { 0, 0, 0 };
+		AddFaceNormal(aPoints.data(), ids, normal);
+		for (int k = 0; k < 3; ++k)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				sums[3 * ids[k] + i] += normal[i];
+			}
+		}
+	}
+	for (vtkIdType vertex = 0; vertex < numberOfPoints; ++vertex)
+	{
+		Normalize(sums.data() + 3 * vertex, m_Normals->GetPointer(3 * vertex));
+	}
+	m_Tree.Build(std::move(boxes));
+	Publish();
+}
+
+vtkIdType lancetAlgorithm::DrillZoneMesh::AddPoint(const MR::Vector3f& aPoint)
+{
+	const float point[3] = { aPoint.x, aPoint.y, aPoint.z };
+	const float normal[3] = { 0, 0, 0 };
+	m_Normals->InsertNextTypedTuple(normal);
+	return m_PointArray->InsertNextTypedTuple(point);
+}
+
+void lancetAlgorithm::DrillZoneMesh::AddTriangle(vtkIdType a, vtkIdType b, vtkIdType c)
+{
+	const int triangle = static_cast<int>(m_IsRemoved.size());
+	m_Connectivity->InsertNextValue(a);
+	m_Connectivity->InsertNextValue(b);
+	m_Connectivity->InsertNextValue(c);
+	m_Offsets->InsertNextValue(3 * (static_cast<vtkIdType>(triangle) + 1));
+	m_IsRemoved.push_back(0);
+	++m_NumberOfTriangles;
+	m_Tree.Add(triangle, GetTriangleBox(triangle));
+}
+
+void lancetAlgorithm::DrillZoneMesh::RemoveTriangle(int aTriangle)
+{
+	// a degenerate triangle renders nothing and keeps all other slots where they are
+	vtkIdType* ids = m_Connectivity->GetPointer(3 * static_cast<vtkIdType>(aTriangle));
+	ids[1] = ids[0];
+	ids[2] = ids[0];
+	m_IsRemoved[aTriangle] = 1;
+	--m_NumberOfTriangles;
+	++m_NumberOfRemoved;
+}
+
+lancetAlgorithm::TriangleBox lancetAlgorithm::DrillZoneMesh::GetTriangleBox(int aTriangle) const
+{
+	const float* points = m_PointArray->GetPointer(0);
+	const vtkIdType* ids = m_Connectivity->GetPointer(3 * static_cast<vtkIdType>(aTriangle));
+	TriangleBox box;
+	for (int k = 0; k < 3; ++k)
+	{
+		box.Include(points + 3 * ids[k]);
+	}
+	return box;
+}
+
+void lancetAlgorithm::DrillZoneMesh::UpdateNormals(const std::vector<vtkIdType>& aVertices)
+{
+	if (aVertices.empty())
+	{
+		return;
+	}
+	// every triangle around a vertex overlaps the box of the vertices
+	const float* points = m_PointArray->GetPointer(0);
+	TriangleBox box;
+	std::unordered_map<vtkIdType, size_t> indexOf;
+	for (vtkIdType vertex : aVertices)
+	{
+		box.Include(points + 3 * vertex);
+		indexOf.emplace(vertex, indexOf.size());
+	}
+	std::vector<double> sums(3 * indexOf.size(), 0.0);
+	m_Candidates.clear();
+	m_Tree.Query(box, m_Candidates);
+	for (int triangle : m_Candidates)
+	{
+		if (m_IsRemoved[triangle])
+		{
+			continue;
+		}
+		const vtkIdType* ids = m_Connectivity->GetPointer(3 * static_cast<vtkIdType>(triangle));
+		double normal[3] = { 0, 0, 0 };
+		bool isNormalComputed = false;
+		for (int k = 0; k < 3; ++k)
+		{
+			const auto found = indexOf.find(ids[k]);
+			if (found == indexOf.end())
+			{
+				continue;
+			}
+			if (!isNormalComputed)
+			{
+				AddFaceNormal(points, ids, normal);
+				isNormalComputed = true;
+			}
+			for (int i = 0; i < 3; ++i)
+			{
+				sums[3 * found->second + i] += normal[i];
+			}
+		}
+	}
+	for (const auto& vertex : indexOf)
+	{
+		Normalize(sums.data() + 3 * vertex.second, m_Normals->GetPointer(3 * vertex.first));
+	}
+}
+
+void lancetAlgorithm::DrillZoneMesh::Publish()
+{
+	m_PointArray->Modified();
+	m_Normals->Modified();
+	m_Offsets->Modified();
+	m_Connectivity->Modified();
+	// appending may have moved the arrays to new memory, hand them to the cell array again (no copy)
+	m_Polys->SetData(m_Offsets, m_Connectivity);
+	m_Points->Modified();
+	m_PolyData->Modified();
+}
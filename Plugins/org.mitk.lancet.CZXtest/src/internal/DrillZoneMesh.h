@@ -0,0 +1,90 @@
+#pragma once
+#include <vtkSmartPointer.h>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include "TriangleBoxTree.h"
+
+//meshlib
+#include <MRMesh/MRMesh.h>
+#include <MRMesh/MRMeshBoolean.h>
+
+namespace lancetAlgorithm
+{
+	/// <summary>
+	/// One cutting zone of the intra-operative osteotomy (green, buffer, red or shell) that is cut by the
+	/// drill locally instead of as a whole.
+	///
+	/// The zone lives in a VTK polydata that stays the same object, with the same point, normal and
+	/// connectivity arrays, for the whole cutting. A cut only takes the triangles whose boxes intersect
+	/// the swept box of the drill, found with a persistent box tree, runs the boolean on that patch and
+	/// writes back just the removed and added triangles and the normals of their vertices. Removed
+	/// triangles are left degenerate in place; once enough garbage piled up the zone is compacted and the
+	/// tree rebuilt, so the cost of a cut depends on the drill, not on the bone mesh size.
+	/// </summary>
+	class DrillZoneMesh
+	{
+	public:
+		DrillZoneMesh();
+
+		/// <summary>
+		/// Replaces the zone with aMesh.
+		/// </summary>
+		void SetMesh(const MR::Mesh& aMesh);
+
+		/// <summary>
+		/// The zone for display, the same object across all cuts.
+		/// </summary>
+		vtkPolyData* GetPolyData() const;
+
+		bool IsEmpty() const;
+
+		/// <summary>
+		/// Applies aOperation (DifferenceAB or OutsideA) with the drill aTool at aToolToZone to the triangles
+		/// inside aSweptBox. A result with more than aCompareSize times the triangles of the zone is
+		/// rejected, 0 accepts any. Returns true if the zone changed.
+		/// </summary>
+		bool Cut(const MR::Mesh& aTool, const MR::AffineXf3f& aToolToZone, const MR::Box3f& aSweptBox,
+			MR::BooleanOperation aOperation, int aCompareSize);
+
+		int GetNumberOfTriangles() const;
+
+		/// <summary>
+		/// Triangles removed and added by the last cut.
+		/// </summary>
+		int GetLastPatchSize() const;
+		int GetLastResultSize() const;
+
+	private:
+		void Rebuild(const std::vector<float>& aPoints, const std::vector<vtkIdType>& aTriangles);
+		void Gather(std::vector<float>& aPoints, std::vector<vtkIdType>& aTriangles) const;
+		void Compact();
+		bool CutWhole(const MR::Mesh& aTool, const MR::AffineXf3f& aToolToZone, MR::BooleanOperation aOperation, int aCompareSize);
+
+		vtkIdType AddPoint(const MR::Vector3f& aPoint);
+		void AddTriangle(vtkIdType a, vtkIdType b, vtkIdType c);
+		void RemoveTriangle(int aTriangle);
+		TriangleBox GetTriangleBox(int aTriangle) const;
+		void UpdateNormals(const std::vector<vtkIdType>& aVertices);
+		void Publish();
+
+		vtkSmartPointer<vtkPolyData> m_PolyData;
+		vtkSmartPointer<vtkPoints> m_Points;
+		vtkSmartPointer<vtkFloatArray> m_PointArray;
+		vtkSmartPointer<vtkFloatArray> m_Normals;
+		vtkSmartPointer<vtkCellArray> m_Polys;
+		vtkSmartPointer<vtkIdTypeArray> m_Offsets;
+		vtkSmartPointer<vtkIdTypeArray> m_Connectivity;
+
+		TriangleBoxTree m_Tree;
+		std::vector<unsigned char> m_IsRemoved;
+		int m_NumberOfTriangles{ 0 };	// not removed
+		int m_NumberOfRemoved{ 0 };
+
+		std::vector<int> m_Candidates;
+		int m_LastPatchSize{ 0 };
+		int m_LastResultSize{ 0 };
+	};
+}
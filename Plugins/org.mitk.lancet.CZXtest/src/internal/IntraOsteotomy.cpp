@@ -1,11 +1,24 @@
 #include "IntraOsteotomy.h"
 
+/// <summary>
+/// Drill end in the drill reference frame, the translation of TDrillEnd2Drill.
+/// </summary>
+static const double DrillEndInDrill[3] = { 230.492, -85, -49.800 };
+
+// collision service name of the red zone as set up; the red node itself is cut, so it is not queried
+static const std::string RedZoneSafetyName = "RedZoneSafety";
+
+// tracked drill poses swept since the last cut reach back at most this far, microseconds
+static const long long MaxDrillSweepWindow = 1000000;
+// a longer time without a tracked drill pose starts a new sweep, microseconds
+static const long long MaxDrillSampleGap = 200000;
+
 lancetAlgorithm::IntraOsteotomy::IntraOsteotomy(mitk::DataStorage* dataStorage, AimCamera* aCamera,
 	ChunLiXGImplant* aChunLiXGImplant, ChunLiTray* aChunLITray)
 {
 	m_DataStorage = dataStorage;
 	m_Camera = aCamera;
-	m_LastRoundMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+	m_CollisionService = SurfaceCollisionService::New();
 	m_ChunLiTray = aChunLITray;
 	m_ChunLiXGImplant = aChunLiXGImplant;
 }
@@ -47,9 +60,10 @@ vtkSmartPointer<vtkMatrix4x4> lancetAlgorithm::IntraOsteotomy::CalculateTDrillEn
 {
 	vtkSmartPointer<vtkMatrix4x4> TDrillEnd2Drill = vtkSmartPointer<vtkMatrix4x4>::New();
 	TDrillEnd2Drill->Identity();
-	TDrillEnd2Drill->SetElement(0, 3, 230.492);
-	TDrillEnd2Drill->SetElement(1, 3, -85);
-	TDrillEnd2Drill->SetElement(2, 3, -49.800);
+	for (int i = 0; i < 3; ++i)
+	{
+		TDrillEnd2Drill->SetElement(i, 3, DrillEndInDrill[i]);
+	}
 	TDrillEnd2Drill->Invert();
 	vtkSmartPointer<vtkMatrix4x4> TDrill2Camera = vtkSmartPointer<vtkMatrix4x4>::New();
 	TDrill2Camera->DeepCopy(PKAData::m_TCamera2Drill);
@@ -71,9 +85,10 @@ vtkSmartPointer<vtkMatrix4x4> lancetAlgorithm::IntraOsteotomy::CalculateTDrillEn
 {
 	vtkSmartPointer<vtkMatrix4x4> TDrillEnd2Drill = vtkSmartPointer<vtkMatrix4x4>::New();
 	TDrillEnd2Drill->Identity();
-	TDrillEnd2Drill->SetElement(0, 3, 230.492);
-	TDrillEnd2Drill->SetElement(1, 3, -85);
-	TDrillEnd2Drill->SetElement(2, 3, -49.800);
+	for (int i = 0; i < 3; ++i)
+	{
+		TDrillEnd2Drill->SetElement(i, 3, DrillEndInDrill[i]);
+	}
 	TDrillEnd2Drill->Invert();
 	vtkSmartPointer<vtkMatrix4x4> TDrill2Camera = vtkSmartPointer<vtkMatrix4x4>::New();
 	TDrill2Camera->DeepCopy(PKAData::m_TCamera2Drill);
@@ -106,9 +121,10 @@ vtkSmartPointer<vtkMatrix4x4> lancetAlgorithm::IntraOsteotomy::CalculateTBase2Dr
 
 	vtkSmartPointer<vtkMatrix4x4> TEndRF2DrillEnd = vtkSmartPointer<vtkMatrix4x4>::New();
 	TEndRF2DrillEnd->Identity();
-	TEndRF2DrillEnd->SetElement(0, 3, 230.492);
-	TEndRF2DrillEnd->SetElement(1, 3, -85);
-	TEndRF2DrillEnd->SetElement(2, 3, -49.800);
+	for (int i = 0; i < 3; ++i)
+	{
+		TEndRF2DrillEnd->SetElement(i, 3, DrillEndInDrill[i]);
+	}
 	vtkSmartPointer<vtkTransform> transform = vtkSmartPointer<vtkTransform>::New();
 
 	transform->PreMultiply();
@@ -260,68 +276,6 @@ vtkSmartPointer<vtkMatrix4x4> lancetAlgorithm::IntraOsteotomy::CalculateFemurDri
 	return localCoordinateSystem;
 }
 
-void lancetAlgorithm::IntraOsteotomy::CalculateBoolean(std::string nodeNameA, MR::Mesh& MeshA,
-	MR::Mesh& MeshB, MR::BooleanOperation operationOne, std::string nodeNameB, MR::Mesh& MeshC,
-	MR::Mesh& MeshD, MR::BooleanOperation operationTwo, MR::BooleanOperation operationThree)
-{
-	if (m_DataStorage->GetNamedObject<mitk::Surface>(nodeNameA)->GetVtkPolyData()->GetPoints()->GetNumberOfPoints() <= 0)
-		return;
-
-	auto intersectResult = (MR::boolean(MeshA, MeshB, operationOne));
-
-	MR::Mesh intersectMesh = *intersectResult;
-	std::cout << "CalculateBoolean:" << intersectMesh.points.vec_.size() << std::endl;
-	if (intersectMesh.points.vec_.size() > 0)
-	{
-		auto diffResult = (MR::boolean(MeshC, MeshD, operationTwo));
-		MR::Mesh testMesh = *diffResult;
-
-		if (testMesh.points.vec_.size() > 0)
-		{
-			auto cutResult = (MR::boolean(MeshC, MeshD, operationThree));
-			MR::Mesh shellMesh = *cutResult;
-			MeshC = shellMesh;
-			MeshC.invalidateCaches();
-			MeshD.invalidateCaches();
-
-			vtkSmartPointer<vtkPolyData> ShellPolyData = vtkSmartPointer<vtkPolyData>::New();
-			TurnMRMeshIntoPolyData(MeshC, ShellPolyData);
-			m_DataStorage->GetNamedObject<mitk::Surface>(nodeNameB)->ReleaseData();
-			m_DataStorage->GetNamedObject<mitk::Surface>(nodeNameB)->SetVtkPolyData(ShellPolyData);
-		}
-	}
-}
-
-void lancetAlgorithm::IntraOsteotomy::CalculateBoolean(std::string nodeName, MR::Mesh& MeshA,
-	MR::Mesh& MeshB, MR::BooleanOperation operationOne, MR::BooleanOperation operationTwo, int compareSize)
-{
-	if (m_DataStorage->GetNamedObject<mitk::Surface>(nodeName)->GetVtkPolyData()->GetPoints()->GetNumberOfPoints() <= 0)
-		return;
-
-	auto intersectResult = (MR::boolean(MeshA, MeshB, operationOne));
-
-	MR::Mesh intersectMesh = *intersectResult;
-	std::cout << "CalculateBoolean:" << intersectMesh.points.vec_.size() << std::endl;
-	if (intersectMesh.points.vec_.size() > 0)
-	{
-		auto diffResult = (MR::boolean(MeshA, MeshB, operationTwo));
-
-		MR::Mesh diffMesh = *diffResult;
-		std::cout << "diffMesh points: " << diffMesh.points.vec_.size() << " MeshA points: " << MeshA.points.vec_.size() << std::endl;
-		if (diffMesh.points.vec_.size() <= compareSize * MeshA.points.vec_.size())
-		{
-			std::cout << "diffMesh.points.vec_.size() <= " << compareSize << " * MeshA.points.vec_.size()" << std::endl;
-			MeshA = diffMesh;
-			MeshA.invalidateCaches();
-			MeshB.invalidateCaches();
-			vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
-			TurnMRMeshIntoPolyData(MeshA, polyData);
-			m_DataStorage->GetNamedObject<mitk::Surface>(nodeName)->ReleaseData();
-			m_DataStorage->GetNamedObject<mitk::Surface>(nodeName)->SetVtkPolyData(polyData);
-		}
-	}
-}
-
 void lancetAlgorithm::IntraOsteotomy::TurnMRMeshIntoPolyData(MR::Mesh MRMesh, vtkSmartPointer<vtkPolyData> PolyData)
 {
 	clock_t t_start = clock();
@@ -410,6 +364,16 @@ void lancetAlgorithm::IntraOsteotomy::SaveIntialNodePolyDataWithTransform(std::s
 	FileIO::WritePolyDataAsSTL(transformedPolyData, path);
 }
 
+/// <summary>
+/// Row-major 4x4 matrix, as in vtkMatrix4x4 and TrackedToolPose, to a MeshLib transform (Matrix3f takes rows).
+/// </summary>
+static MR::AffineXf3f ToAffineXf(const double* m)
+{
+	return MR::AffineXf3f(
+		MR::Matrix3f(MR::Vector3f(m[0], m[1], m[2]), MR::Vector3f(m[4], m[5], m[6]), MR::Vector3f(m[8], m[9], m[10])),
+		MR::Vector3f(m[3], m[7], m[11]));
+}
+
 void lancetAlgorithm::IntraOsteotomy::Drill(CutPlane aCutPlane)
 {
 	if (!ValidateRequiredNodes("green", "buffer", "shell", "red", "DrillEndTip"))
@@ -424,55 +388,151 @@ void lancetAlgorithm::IntraOsteotomy::Drill(CutPlane aCutPlane)
 	auto cutterMatrix = m_DataStorage->GetNamedNode(PKAData::m_DrillEndTipNodeName.toStdString())
 		->GetData()->GetGeometry()->GetVtkMatrix();
 
-	double matrixDiff{ 0 };
+	MR::AffineXf3f T = ToAffineXf(cutterMatrix->GetData());
 
-	for (int i{ 0 }; i < 4; i++)
+	//------------ Swept volume: drill at all poses since the last cut -----------
+	std::vector<MR::AffineXf3f> poses;
+	std::vector<size_t> runStarts;
+	const PKAMarker bone = aCutPlane == CutPlane::ProximalCut ? PKAMarker::PKATibiaRF : PKAMarker::PKAFemurRF;
+	if (!CollectDrillPoses(to_string(bone), T, poses, runStarts) || !m_SweptVolume.Update(poses, runStarts))
 	{
-		for (int j{ 3 }; j < 4; j++)
-		{
-			if (abs(m_LastRoundMatrix->GetElement(i, j) - cutterMatrix->GetElement(i, j)) > matrixDiff)
-			{
-				matrixDiff = abs(m_LastRoundMatrix->GetElement(i, j) - cutterMatrix->GetElement(i, j));
-			}
-		}
+		return;
 	}
+	const MR::AffineXf3f sweptToZone;
 
-	m_LastRoundMatrix->DeepCopy(cutterMatrix);
-	if (matrixDiff < 0.01)
+	// pieces whose union failed are cut one after another
+	for (int piece = 0; piece < m_SweptVolume.GetNumberOfMeshes(); ++piece)
 	{
-		clock_t end = clock();
-		std::cout << "Cutting time: " << end - start << std::endl;
-		return;
+		const MR::Mesh& sweptMesh = m_SweptVolume.GetMesh(piece);
+		const MR::Box3f& sweptBox = m_SweptVolume.GetBox(piece);
+
+		//------------ MeshLib Boolean, local to the swept box -------------------
+		//------------ Green -----------
+		CutZone("green", m_GreenZone, sweptMesh, sweptToZone, sweptBox, MR::BooleanOperation::DifferenceAB, 2);
+
+		//------------ buffer -----------
+		CutZone("buffer", m_BufferZone, sweptMesh, sweptToZone, sweptBox, MR::BooleanOperation::DifferenceAB, 2);
+
+		//------------- Shell and Red should be considered together ----------------------
+		if (CutZone("red", m_RedZone, sweptMesh, sweptToZone, sweptBox, MR::BooleanOperation::DifferenceAB, 5))
+		{
+			CutZone("shell", m_ShellZone, sweptMesh, sweptToZone, sweptBox, MR::BooleanOperation::OutsideA, 0);
+		}
 	}
 
-	MR::Vector3f x(cutterMatrix->GetElement(0, 0), cutterMatrix->GetElement(1, 0), cutterMatrix->GetElement(2, 0));
-	MR::Vector3f y(cutterMatrix->GetElement(0, 1), cutterMatrix->GetElement(1, 1), cutterMatrix->GetElement(2, 1));
-	MR::Vector3f z(cutterMatrix->GetElement(0, 2), cutterMatrix->GetElement(1, 2), cutterMatrix->GetElement(2, 2));
-	MR::Vector3f t(cutterMatrix->GetElement(0, 3), cutterMatrix->GetElement(1, 3), cutterMatrix->GetElement(2, 3));
-	MR::Matrix3f r(x, y, z);
-	MR::AffineXf3f T(r, t);
+	MITK_DEBUG << "Cutting time: " << clock() - start;
+}
 
-	m_DrillTipMesh.transform(T);
+bool lancetAlgorithm::IntraOsteotomy::CutZone(const std::string& nodeName, DrillZoneMesh& zone, const MR::Mesh& tool,
+	const MR::AffineXf3f& toolToZone, const MR::Box3f& sweptBox, MR::BooleanOperation operation, int compareSize)
+{
+	if (!zone.Cut(tool, toolToZone, sweptBox, operation, compareSize))
+	{
+		return false;
+	}
+	MITK_DEBUG << nodeName << " cut: " << zone.GetLastPatchSize() << " -> " << zone.GetLastResultSize()
+		<< " triangles of " << zone.GetNumberOfTriangles();
 
-	//------------ MeshLib Boolean -------------------
-	//------------ Green -----------
-	CalculateBoolean("green", m_GreenMesh, m_DrillTipMesh, MR::BooleanOperation::Intersection, MR::BooleanOperation::DifferenceAB, 2);
+	auto surface = m_DataStorage->GetNamedObject<mitk::Surface>(nodeName);
+	if (surface->GetVtkPolyData() != zone.GetPolyData())
+	{
+		surface->SetVtkPolyData(zone.GetPolyData());
+	}
+	surface->Modified();
+	return true;
+}
 
-	//------------ buffer -----------
-	CalculateBoolean("buffer", m_BufferMesh, m_DrillTipMesh, MR::BooleanOperation::Intersection, MR::BooleanOperation::DifferenceAB, 2);
+bool lancetAlgorithm::IntraOsteotomy::CollectDrillPoses(const std::string& aBoneName, const MR::AffineXf3f& currentPose,
+	std::vector<MR::AffineXf3f>& poses, std::vector<size_t>& runStarts)
+{
+	TrackedToolPose latestDrill;
+	if (!m_Camera || !m_Camera->GetLatest(to_string(PKAMarker::PKADrill), latestDrill))
+	{
+		// not tracked, e.g. the simulation moves the drill end node
+		poses.push_back(currentPose);
+		return true;
+	}
+	TrackedToolPose latestBone;
+	if (!latestDrill.valid || !m_Camera->GetLatest(aBoneName, latestBone))
+	{
+		// the drill end node shows a stale pose, the drill is swept anew once it is tracked again
+		m_SweptVolume.Reset();
+		m_LastDrillPoseTimestamp = 0;
+		return false;
+	}
 
-	//------------- Shell and Red should be considered together ----------------------
-	CalculateBoolean("red", m_RedMesh, m_DrillTipMesh, MR::BooleanOperation::Intersection, MR::BooleanOperation::DifferenceAB, 5);
-	CalculateBoolean("red", m_RedMesh, m_DrillTipMesh, MR::BooleanOperation::Intersection,
-		"shell", m_ShellMesh, m_DrillTipMesh, MR::BooleanOperation::InsideA, MR::BooleanOperation::OutsideA);
-	//------------- Move the cutter back to initial --------------
-	MR::AffineXf3f T_invert = T.inverse();
-	m_DrillTipMesh.transform(T_invert);
+	// drill and bone of the same camera frame, oldest first
+	struct FramePoses
+	{
+		unsigned int frame;
+		long long timestamp;
+		const TrackedToolPose* drill;
+		const TrackedToolPose* bone;
+	};
+	std::vector<FramePoses> frames;
+	m_DrillPoseHistory.clear();
+	// the first sweep starts at the newest frame
+	const long long since = m_LastDrillPoseTimestamp > 0
+		? std::max(m_LastDrillPoseTimestamp, latestDrill.timestamp - MaxDrillSweepWindow) : latestDrill.timestamp - 1;
+	m_Camera->GetSince(since, m_DrillPoseHistory);
+	for (const auto& pose : m_DrillPoseHistory)
+	{
+		if (pose.toolIndex != latestDrill.toolIndex && pose.toolIndex != latestBone.toolIndex)
+		{
+			continue;
+		}
+		if (frames.empty() || frames.back().frame != pose.frame)
+		{
+			frames.push_back({ pose.frame, pose.timestamp, nullptr, nullptr });
+		}
+		(pose.toolIndex == latestDrill.toolIndex ? frames.back().drill : frames.back().bone) = &pose;
+	}
+	auto isTracked = [](const FramePoses& frame) {
+		return frame.drill && frame.drill->valid && frame.bone && frame.bone->valid;
+	};
+	while (!frames.empty() && !frames.back().drill)
+	{
+		frames.pop_back(); // the bone of a frame whose drill is not in the buffer yet
+	}
+	if (frames.empty() || !isTracked(frames.back()))
+	{
+		m_SweptVolume.Reset();
+		m_LastDrillPoseTimestamp = 0;
+		return false;
+	}
 
-	clock_t end = clock();
-	std::cout << "Cutting time: " << end - start << std::endl;
-	IsDrillInSecurityBoundary(aCutPlane);
-	IsDrillInSecurityDepth(aCutPlane);
+	// every drill pose is mapped with the bone pose of its own frame, the newest one is currentPose
+	const MR::AffineXf3f drillEndToDrill(MR::Matrix3f(),
+		MR::Vector3f(float(DrillEndInDrill[0]), float(DrillEndInDrill[1]), float(DrillEndInDrill[2])));
+	const FramePoses& newest = frames.back();
+	const MR::AffineXf3f boneToZone = currentPose * drillEndToDrill.inverse() * ToAffineXf(newest.drill->matrix).inverse()
+		* ToAffineXf(newest.bone->matrix);
+	long long previous = m_LastDrillPoseTimestamp;
+	bool lost = false;
+	for (const auto& frame : frames)
+	{
+		if (!isTracked(frame))
+		{
+			lost = true;
+			continue;
+		}
+		if (lost || previous == 0 || frame.timestamp - previous > MaxDrillSampleGap)
+		{
+			runStarts.push_back(poses.size());
+		}
+		lost = false;
+		previous = frame.timestamp;
+		if (&frame == &newest)
+		{
+			poses.push_back(currentPose);
+		}
+		else
+		{
+			poses.push_back(boneToZone * ToAffineXf(frame.bone->matrix).inverse() * ToAffineXf(frame.drill->matrix) * drillEndToDrill);
+		}
+	}
+	m_LastDrillPoseTimestamp = newest.timestamp;
+	return true;
 }
 
 double lancetAlgorithm::IntraOsteotomy::GetDrillTip2FemurDrillPlaneDistance(Eigen::Vector3d planePoint, Eigen::Vector3d planeNormal, vtkMatrix4x4* TFemur2Tibia)
@@ -542,51 +602,59 @@ bool lancetAlgorithm::IntraOsteotomy::IsDrillInSecurityBoundary(CutPlane aCutPla
 {
 	Eigen::Vector3d planeNormal;
 	Eigen::Vector3d planePoint;
-	auto drillEndMatrix = m_DataStorage->GetNamedNode(PKAData::m_DrillEndTipNodeName.toStdString())
-		->GetData()->GetGeometry()->GetVtkMatrix()->GetData();;
+	auto drillEndNode = m_DataStorage->GetNamedNode(PKAData::m_DrillEndTipNodeName.toStdString());
+	// the boundary is an open patch; its locator is cached and follows the node geometry
+	if (!drillEndNode || !GetCutPlane(aCutPlane, planePoint, planeNormal) || !RegisterCollisionSurface("SecurityBoundary", false))
+	{
+		return false;
+	}
+	auto drillEndMatrix = drillEndNode->GetData()->GetGeometry()->GetVtkMatrix()->GetData();
 	Eigen::Vector3d drillPos(drillEndMatrix[3], drillEndMatrix[7], drillEndMatrix[11]);
-	auto securityBoundaryData = m_DataStorage->GetNamedNode("SecurityBoundary")->GetData();
-	auto cutPlanePolyData = dynamic_cast<mitk::Surface*>(m_DataStorage->GetNamedNode("SecurityBoundary")->GetData())->GetVtkPolyData();
-	vtkSmartPointer<vtkTransformPolyDataFilter> transFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-	if (!cutPlanePolyData)
+	Eigen::Vector3d projectedPoint = CalculationHelper::ProjectPointOntoPlane(drillPos, planePoint, planeNormal);
+
+	double closestPoint[3];
+	double distance{ 0 };
+	if (!m_CollisionService->GetSignedDistance("SecurityBoundary", projectedPoint.data(), distance, closestPoint))
 	{
-		std::cout << "cutPlane is nullptr" << std::endl;
 		return false;
 	}
-	auto securityBoundaryMatrix = securityBoundaryData->GetGeometry()->GetVtkMatrix();
-	vtkSmartPointer<vtkTransform> trans = vtkSmartPointer<vtkTransform>::New();
-	trans->SetMatrix(securityBoundaryMatrix);
-	transFilter->SetInputData(cutPlanePolyData);
-	transFilter->SetTransform(trans);
-	transFilter->Update();
-	vtkSmartPointer<vtkPolyData> transformedPolyData = vtkSmartPointer<vtkPolyData>::New();
-	transformedPolyData->DeepCopy(transFilter->GetOutput());
-	vtkSmartPointer<vtkCellLocator> cellLocator = vtkSmartPointer<vtkCellLocator>::New();
-	cellLocator->SetDataSet(transformedPolyData);
-	cellLocator->BuildLocator();
+	const double epsilon = 1e-2;
+	return distance * distance < epsilon;
+}
 
+bool lancetAlgorithm::IntraOsteotomy::GetCutPlane(CutPlane aCutPlane, Eigen::Vector3d& planePoint, Eigen::Vector3d& planeNormal)
+{
+	// the implant and the tray are loaded after this object is created
 	switch (aCutPlane)
 	{
 	case lancetAlgorithm::CutPlane::DistalCut:
 	{
+		if (!m_ChunLiXGImplant)
+			return false;
 		planePoint = m_ChunLiXGImplant->GetDistalCut();
 		planeNormal = planePoint - m_ChunLiXGImplant->GetDistalCutNormal();
 		break;
 	}
 	case lancetAlgorithm::CutPlane::PosteriorCut:
 	{
+		if (!m_ChunLiXGImplant)
+			return false;
 		planePoint = m_ChunLiXGImplant->GetPosteriorCut();
 		planeNormal = planePoint - m_ChunLiXGImplant->GetPosteriorCutNormal();
 		break;
 	}
 	case lancetAlgorithm::CutPlane::PosteriorChamferCut:
 	{
+		if (!m_ChunLiXGImplant)
+			return false;
 		planePoint = m_ChunLiXGImplant->GetPosteriorChamferCut();
 		planeNormal = planePoint - m_ChunLiXGImplant->GetPosteriorChamferCutNormal();
 		break;
 	}
 	case lancetAlgorithm::CutPlane::ProximalCut:
 	{
+		if (!m_ChunLiTray)
+			return false;
 		planePoint = m_ChunLiTray->GetProximal();
 		planeNormal = m_ChunLiTray->GetProximalDirection();
 		break;
@@ -594,77 +662,65 @@ bool lancetAlgorithm::IntraOsteotomy::IsDrillInSecurityBoundary(CutPlane aCutPla
 	default:
 		return false;
 	}
-	Eigen::Vector3d projectedPoint = CalculationHelper::ProjectPointOntoPlane(drillPos, planePoint, planeNormal);
-
-	PrintDataHelper::CoutArray(projectedPoint, "projectedPoint");
-
-	double closestPoint[3];  // 
-	double dist2;             // ƽ
-	vtkIdType cellId;         // Ԫ ID
-	int subId;                // ӵԪ ID
-	cellLocator->FindClosestPoint(projectedPoint.data(), closestPoint, cellId, subId, dist2);
-	const double epsilon = 1e-2;
-	if (dist2 < epsilon) {
-		std::cout <<std::setprecision(6) << "IsDrillInSecurityBoundary True dist2: "<< dist2 << std::endl;
-		PrintDataHelper::CoutArray(closestPoint, 3, "closestPoint");
-		return true;
-	}
-	else {
-		std::cout << std::setprecision(6) << "IsDrillInSecurityBoundary True dist2: " << dist2 << std::endl;
-		PrintDataHelper::CoutArray(closestPoint, 3, "closestPoint");
-		return false;
-	}
+	return true;
 }
 
-bool lancetAlgorithm::IntraOsteotomy::IsDrillInSecurityDepth(CutPlane aCutPlane)
+bool lancetAlgorithm::IntraOsteotomy::CheckDrillSafety(CutPlane aCutPlane)
 {
 	Eigen::Vector3d planeNormal;
 	Eigen::Vector3d planePoint;
-	auto drillEndMatrix = m_DataStorage->GetNamedNode(PKAData::m_DrillEndTipNodeName.toStdString())
-		->GetData()->GetGeometry()->GetVtkMatrix()->GetData();;
-	Eigen::Vector3d drillPos(drillEndMatrix[3], drillEndMatrix[7], drillEndMatrix[11]);
-	switch (aCutPlane)
-	{
-	case lancetAlgorithm::CutPlane::DistalCut:
+	if (!ValidateRequiredNodes(PKAData::m_DrillEndTipNodeName.toStdString()) || !GetCutPlane(aCutPlane, planePoint, planeNormal))
 	{
-		planePoint = m_ChunLiXGImplant->GetDistalCut();
-		planeNormal = planePoint - m_ChunLiXGImplant->GetDistalCutNormal();
-		break;
-	}
-	case lancetAlgorithm::CutPlane::PosteriorCut:
-	{
-		planePoint = m_ChunLiXGImplant->GetPosteriorCut();
-		planeNormal = planePoint - m_ChunLiXGImplant->GetPosteriorCutNormal();
-		break;
+		return false;
 	}
-	case lancetAlgorithm::CutPlane::PosteriorChamferCut:
+	bool safe = IsDrillInSecurityBoundary(aCutPlane);
+	safe = IsDrillInSecurityDepth(aCutPlane) && safe;
+
+	SurfaceCollisionService::Result result;
+	if (QueryDrillCollision(RedZoneSafetyName, result) && result.numberOfInsidePoints > 0)
 	{
-		planePoint = m_ChunLiXGImplant->GetPosteriorChamferCut();
-		planeNormal = planePoint - m_ChunLiXGImplant->GetPosteriorChamferCutNormal();
-		break;
+		safe = false;
 	}
-	case lancetAlgorithm::CutPlane::ProximalCut:
+	return safe;
+}
+
+bool lancetAlgorithm::IntraOsteotomy::QueryDrillCollision(const std::string& surfaceName, SurfaceCollisionService::Result& result)
+{
+	auto drillEndNode = m_DataStorage->GetNamedNode(PKAData::m_DrillEndTipNodeName.toStdString());
+	if (!drillEndNode)
 	{
-		planePoint = m_ChunLiTray->GetProximal();
-		planeNormal = m_ChunLiTray->GetProximalDirection();
-		break;
-	}
-	default:
 		return false;
 	}
+	return m_CollisionService->Query(surfaceName, drillEndNode->GetData()->GetGeometry()->GetVtkMatrix(), result);
+}
 
-	double normalLength = planeNormal.norm();
-	double distance = CalculationHelper::DistanceFromPointToPlane(drillPos, planeNormal, planePoint);
-	if (distance < -1.0)
+bool lancetAlgorithm::IntraOsteotomy::RegisterCollisionSurface(const std::string& nodeName, bool closed)
+{
+	auto surface = m_DataStorage->GetNamedObject<mitk::Surface>(nodeName);
+	if (!surface || !surface->GetVtkPolyData())
 	{
-		std::cout << "IsDrillInSecurityDepth FALSE: "<<distance << std::endl;
+		m_CollisionService->RemoveSurface(nodeName);
 		return false;
 	}
-	else
+	// a no-op for the registered surface, its locator is rebuilt only when its polydata changes
+	m_CollisionService->AddSurface(nodeName, surface, closed);
+	return true;
+}
+
+bool lancetAlgorithm::IntraOsteotomy::IsDrillInSecurityDepth(CutPlane aCutPlane)
+{
+	Eigen::Vector3d planeNormal;
+	Eigen::Vector3d planePoint;
+	auto drillEndNode = m_DataStorage->GetNamedNode(PKAData::m_DrillEndTipNodeName.toStdString());
+	if (!drillEndNode || !GetCutPlane(aCutPlane, planePoint, planeNormal))
 	{
-		std::cout << "IsDrillInSecurityDepth TRUE: " << distance << std::endl;
-		return true;
+		return false;
 	}
+	auto drillEndMatrix = drillEndNode->GetData()->GetGeometry()->GetVtkMatrix()->GetData();
+	Eigen::Vector3d drillPos(drillEndMatrix[3], drillEndMatrix[7], drillEndMatrix[11]);
+
+	double distance = CalculationHelper::DistanceFromPointToPlane(drillPos, planeNormal, planePoint);
+	return distance >= -1.0;
 }
 
 void lancetAlgorithm::IntraOsteotomy::InitalOsteotomyModel(std::string drillEndName, std::string prosNodeName, std::string boneNodeName)
@@ -710,11 +766,19 @@ void lancetAlgorithm::IntraOsteotomy::InitalOsteotomyModel(std::string drillEndN
 		m_DrillTipMesh = MR::MeshLoad::fromAnySupportedFormat(drillTipFilePath).value();
 
 		//Ԥ
-		m_GreenMesh = *(MR::boolean(boneMesh, prosMesh, MR::BooleanOperation::Intersection)); //ͷཻ
-		m_RedMesh = *(MR::boolean(boneMesh, prosPlusMesh, MR::BooleanOperation::DifferenceAB)); //A-B
-		m_ShellMesh = *(MR::boolean(boneMesh, prosPlusMesh, MR::BooleanOperation::OutsideA));   //ͷģ  ཻ ͷĲ
+		MR::Mesh greenMesh = *(MR::boolean(boneMesh, prosMesh, MR::BooleanOperation::Intersection)); //ͷཻ
+		MR::Mesh redMesh = *(MR::boolean(boneMesh, prosPlusMesh, MR::BooleanOperation::DifferenceAB)); //A-B
+		MR::Mesh shellMesh = *(MR::boolean(boneMesh, prosPlusMesh, MR::BooleanOperation::OutsideA));   //ͷģ  ཻ ͷĲ
 		MR::Mesh tmp_mesh = *(MR::boolean(boneMesh, prosPlusMesh, MR::BooleanOperation::Intersection)); //ͷģཻĲ
-		m_BufferMesh = *(MR::boolean(tmp_mesh, prosMesh, MR::BooleanOperation::DifferenceAB));   //A-B
+		MR::Mesh bufferMesh = *(MR::boolean(tmp_mesh, prosMesh, MR::BooleanOperation::DifferenceAB));   //A-B
+
+		// cut buffers of the zones, the nodes switch to them at their first cut
+		m_GreenZone.SetMesh(greenMesh);
+		m_RedZone.SetMesh(redMesh);
+		m_ShellZone.SetMesh(shellMesh);
+		m_BufferZone.SetMesh(bufferMesh);
+		m_SweptVolume.SetTool(m_DrillTipMesh);
+		m_LastDrillPoseTimestamp = 0;
 
 		vtkSmartPointer<vtkPolyData> greenPolyData = vtkSmartPointer<vtkPolyData>::New();
 		vtkSmartPointer<vtkPolyData> redPolyData = vtkSmartPointer<vtkPolyData>::New();
@@ -723,10 +787,18 @@ void lancetAlgorithm::IntraOsteotomy::InitalOsteotomyModel(std::string drillEndN
 		vtkSmartPointer<vtkPolyData> bufferPolyData = vtkSmartPointer<vtkPolyData>::New();
 		vtkSmartPointer<vtkPolyData> drillEndPolyData = vtkSmartPointer<vtkPolyData>::New();
 
-		TurnMRMeshIntoPolyData(m_GreenMesh, greenPolyData);
-		TurnMRMeshIntoPolyData(m_RedMesh, redPolyData);
-		TurnMRMeshIntoPolyData(m_ShellMesh, tmpShellPolyData);
+		TurnMRMeshIntoPolyData(greenMesh, greenPolyData);
+		TurnMRMeshIntoPolyData(redMesh, redPolyData);
+		TurnMRMeshIntoPolyData(shellMesh, tmpShellPolyData);
 		TurnMRMeshIntoPolyData(m_DrillTipMesh, drillEndPolyData);
+		m_CollisionService->SetTool(drillEndPolyData);
+
+		// a copy of the red zone that is never cut, its locator is built once
+		vtkSmartPointer<vtkPolyData> redSafetyPolyData = vtkSmartPointer<vtkPolyData>::New();
+		redSafetyPolyData->DeepCopy(redPolyData);
+		auto redSafetySurface = mitk::Surface::New();
+		redSafetySurface->SetVtkPolyData(redSafetyPolyData);
+		m_CollisionService->AddSurface(RedZoneSafetyName, redSafetySurface, true);
 
 		vtkSmartPointer<vtkPolyDataNormals> normals = vtkSmartPointer<vtkPolyDataNormals>::New();
 		normals->SetInputData(tmpShellPolyData);
@@ -745,7 +817,7 @@ void lancetAlgorithm::IntraOsteotomy::InitalOsteotomyModel(std::string drillEndN
 		normals_->SetInputData(warper->GetPolyDataOutput());
 		normals_->Update();
 		shellPolyData->DeepCopy(normals->GetOutput());
-		TurnMRMeshIntoPolyData(m_BufferMesh, bufferPolyData);
+		TurnMRMeshIntoPolyData(bufferMesh, bufferPolyData);
 		
 		PKARenderHelper::DisplaySingleNode(m_DataStorage, drillEndName);
 		auto redNode = PKARenderHelper::AddPolyData2DataStorage(m_DataStorage, "red", redPolyData, 1, 0, 0);
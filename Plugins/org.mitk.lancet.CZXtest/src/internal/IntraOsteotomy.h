@@ -16,6 +16,9 @@
 #include "ChunLITray.h"
 #include "PKAEnum.h"
 #include <AimCamera.h>
+#include "DrillZoneMesh.h"
+#include "DrillSweptVolume.h"
+#include <surfacecollisionservice.h>
 
 //meshlib
 #include <MRMesh/MRMesh.h>
@@ -70,14 +73,6 @@ namespace lancetAlgorithm
 		/// <returns></returns>
 		vtkSmartPointer<vtkMatrix4x4> CalculateFemurDrillEndTipPos(Eigen::Vector3d pointInPlane, Eigen::Vector3d planeNormal);
 
-		void CalculateBoolean(std::string nodeNameA, MR::Mesh& MeshA, MR::Mesh& MeshB, MR::BooleanOperation operationOne,
-			std::string nodeNameB, MR::Mesh& MeshC, MR::Mesh& MeshD,
-			MR::BooleanOperation operationTwo, MR::BooleanOperation operationThree);
-
-		void CalculateBoolean(std::string nodeName, MR::Mesh& MeshA, MR::Mesh& MeshB,
-			MR::BooleanOperation operationOne, MR::BooleanOperation operationTwo, int compareSize);
-
-
 		void TurnMRMeshIntoPolyData(MR::Mesh MRMesh, vtkSmartPointer<vtkPolyData> PolyData);
 
 		void InitalOsteotomyModel(std::string drillEndName, std::string prosNodeName, std::string boneNodeName);
@@ -91,6 +86,20 @@ namespace lancetAlgorithm
 		bool IsDrillInSecurityBoundary(CutPlane aCutPlane);
 		bool IsDrillInSecurityDepth(CutPlane aCutPlane);
 
+		/// <summary>
+		/// Safety checks of the drill end at its current pose: security boundary and depth of aCutPlane, and the
+		/// red zone through the collision service. For every tracking frame, whether the drill cuts or not.
+		/// False if a check fails or cannot run yet, e.g. before the implant and the tray are loaded.
+		/// </summary>
+		bool CheckDrillSafety(CutPlane aCutPlane);
+
+		/// <summary>
+		/// Tests the drill end at its current pose against the static surface registered with the collision service
+		/// as surfaceName, e.g. the uncut red zone set up by InitalOsteotomyModel. Its locator is built once, so
+		/// this is cheap enough for every tracking frame.
+		/// </summary>
+		bool QueryDrillCollision(const std::string& surfaceName, SurfaceCollisionService::Result& result);
+
 	private:
 		template<typename... Args>
 		bool ValidateRequiredNodes(const std::string& nodeName1, const Args&... args)
@@ -109,15 +118,44 @@ namespace lancetAlgorithm
 			return true;
 		}
 
+		/// <summary>
+		/// Cuts one zone locally and shows its cut buffer in the node nodeName.
+		/// </summary>
+		bool CutZone(const std::string& nodeName, DrillZoneMesh& zone, const MR::Mesh& tool, const MR::AffineXf3f& toolToZone,
+			const MR::Box3f& sweptBox, MR::BooleanOperation operation, int compareSize);
+
+		/// <summary>
+		/// Point and normal of aCutPlane, false if its implant or tray is not loaded.
+		/// </summary>
+		bool GetCutPlane(CutPlane aCutPlane, Eigen::Vector3d& planePoint, Eigen::Vector3d& planeNormal);
+
+		/// <summary>
+		/// Registers the surface of the node nodeName with the collision service, false if there is none.
+		/// </summary>
+		bool RegisterCollisionSurface(const std::string& nodeName, bool closed);
+
+		/// <summary>
+		/// Appends the drill end poses in the zones tracked by the camera since the last call, at most
+		/// MaxDrillSweepWindow back and oldest first, with currentPose as the newest one. Every drill pose is
+		/// mapped with the pose of the bone aBoneName from the same camera frame. runStarts receives the poses
+		/// that follow a frame without drill or bone or a longer gap, they are not swept to from the pose before. False if the
+		/// drill or the bone is not tracked now; the sweep is reset then and nothing should be cut.
+		/// </summary>
+		bool CollectDrillPoses(const std::string& aBoneName, const MR::AffineXf3f& currentPose,
+			std::vector<MR::AffineXf3f>& poses, std::vector<size_t>& runStarts);
+
 	private:
 		mitk::DataStorage* m_DataStorage;
 		AimCamera* m_Camera;
-		MR::Mesh m_GreenMesh;
-		MR::Mesh m_BufferMesh;
-		MR::Mesh m_ShellMesh;
-		MR::Mesh m_RedMesh;
+		DrillZoneMesh m_GreenZone;
+		DrillZoneMesh m_BufferZone;
+		DrillZoneMesh m_ShellZone;
+		DrillZoneMesh m_RedZone;
 		MR::Mesh m_DrillTipMesh;
-		vtkSmartPointer<vtkMatrix4x4> m_LastRoundMatrix;
+		DrillSweptVolume m_SweptVolume;
+		SurfaceCollisionService::Pointer m_CollisionService;
+		std::vector<TrackedToolPose> m_DrillPoseHistory;
+		long long m_LastDrillPoseTimestamp{ 0 };
 		std::string m_DesktopPKAIntraOsteotomyFilePath = std::string(getenv("USERPROFILE")) + "\\Desktop\\PKAModelData\\IntraOsteotomy\\";
 
 		ChunLiTray* m_ChunLiTray;
@@ -0,0 +1,209 @@
+#pragma once
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+namespace lancetAlgorithm
+{
+	struct TriangleBox
+	{
+		float min[3]{ FLT_MAX, FLT_MAX, FLT_MAX };
+		float max[3]{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		void Include(const float* aPoint)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				min[i] = std::min(min[i], aPoint[i]);
+				max[i] = std::max(max[i], aPoint[i]);
+			}
+		}
+
+		void Include(const TriangleBox& aBox)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				min[i] = std::min(min[i], aBox.min[i]);
+				max[i] = std::max(max[i], aBox.max[i]);
+			}
+		}
+
+		void Expand(float aMargin)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				min[i] -= aMargin;
+				max[i] += aMargin;
+			}
+		}
+
+		bool Overlaps(const TriangleBox& aBox) const
+		{
+			return min[0] <= aBox.max[0] && aBox.min[0] <= max[0]
+				&& min[1] <= aBox.max[1] && aBox.min[1] <= max[1]
+				&& min[2] <= aBox.max[2] && aBox.min[2] <= max[2];
+		}
+
+		float Center(int aAxis) const
+		{
+			return 0.5f * (min[aAxis] + max[aAxis]);
+		}
+	};
+
+	/// <summary>
+	/// Bounding volume hierarchy over the triangle boxes of a mesh that is cut locally.
+	/// Build() sorts all boxes into the tree once; triangles added later are kept in a pending list that
+	/// Query() searches linearly until the owner rebuilds. Removed triangles stay in the tree, the owner
+	/// filters them, so a cut never touches the tree outside the cut region.
+	/// </summary>
+	class TriangleBoxTree
+	{
+	public:
+		/// <summary>
+		/// Builds the tree over the boxes of the triangles 0 .. aBoxes.size() - 1.
+		/// </summary>
+		void Build(std::vector<TriangleBox> aBoxes)
+		{
+			m_Boxes = std::move(aBoxes);
+			m_NumberOfBuilt = m_Boxes.size();
+			m_Pending.clear();
+			m_Nodes.clear();
+			m_Order.resize(m_Boxes.size());
+			for (size_t i = 0; i < m_Order.size(); ++i)
+			{
+				m_Order[i] = static_cast<int>(i);
+			}
+			if (!m_Order.empty())
+			{
+				m_Nodes.reserve(2 * m_Order.size() / LeafSize + 1);
+				BuildNode(0, static_cast<int>(m_Order.size()));
+			}
+		}
+
+		/// <summary>
+		/// Adds the triangle aId == number of triangles so far to the pending list.
+		/// </summary>
+		void Add(int aId, const TriangleBox& aBox)
+		{
+			if (aId >= static_cast<int>(m_Boxes.size()))
+			{
+				m_Boxes.resize(aId + 1);
+			}
+			m_Boxes[aId] = aBox;
+			m_Pending.push_back(aId);
+		}
+
+		/// <summary>
+		/// Appends the ids of all triangles whose box overlaps aBox, removed ones included.
+		/// </summary>
+		void Query(const TriangleBox& aBox, std::vector<int>& aIds) const
+		{
+			if (!m_Nodes.empty())
+			{
+				int stack[64];
+				int size = 0;
+				stack[size++] = 0;
+				while (size > 0)
+				{
+					const Node& node = m_Nodes[stack[--size]];
+					if (!node.box.Overlaps(aBox))
+					{
+						continue;
+					}
+					if (node.count > 0)
+					{
+						for (int i = node.first; i < node.first + node.count; ++i)
+						{
+							if (m_Boxes[m_Order[i]].Overlaps(aBox))
+							{
+								aIds.push_back(m_Order[i]);
+							}
+						}
+						continue;
+					}
+					stack[size++] = node.right;
+					stack[size++] = static_cast<int>(&node - m_Nodes.data()) + 1;
+				}
+			}
+			for (int id : m_Pending)
+			{
+				if (m_Boxes[id].Overlaps(aBox))
+				{
+					aIds.push_back(id);
+				}
+			}
+		}
+
+		const TriangleBox& GetBox(int aId) const
+		{
+			return m_Boxes[aId];
+		}
+
+		size_t GetNumberOfBuilt() const
+		{
+			return m_NumberOfBuilt;
+		}
+
+		size_t GetNumberOfPending() const
+		{
+			return m_Pending.size();
+		}
+
+	private:
+		static constexpr int LeafSize = 4;
+
+		struct Node
+		{
+			TriangleBox box;
+			int first{ 0 };
+			int count{ 0 };	// 0: inner node, the left child follows it, right is stored
+			int right{ 0 };
+		};
+
+		int BuildNode(int aBegin, int aEnd)
+		{
+			const int index = static_cast<int>(m_Nodes.size());
+			m_Nodes.emplace_back();
+
+			TriangleBox box;
+			TriangleBox centers;
+			for (int i = aBegin; i < aEnd; ++i)
+			{
+				const TriangleBox& triangle = m_Boxes[m_Order[i]];
+				box.Include(triangle);
+				const float center[3] = { triangle.Center(0), triangle.Center(1), triangle.Center(2) };
+				centers.Include(center);
+			}
+			m_Nodes[index].box = box;
+			if (aEnd - aBegin <= LeafSize)
+			{
+				m_Nodes[index].first = aBegin;
+				m_Nodes[index].count = aEnd - aBegin;
+				return index;
+			}
+
+			// median split along the longest extent of the centers keeps the depth at log2(n / LeafSize)
+			int axis = 0;
+			for (int i = 1; i < 3; ++i)
+			{
+				if (centers.max[i] - centers.min[i] > centers.max[axis] - centers.min[axis])
+				{
+					axis = i;
+				}
+			}
+			const int middle = (aBegin + aEnd) / 2;
+			std::nth_element(m_Order.begin() + aBegin, m_Order.begin() + middle, m_Order.begin() + aEnd,
+				[this, axis](int a, int b) { return m_Boxes[a].Center(axis) < m_Boxes[b].Center(axis); });
+			BuildNode(aBegin, middle);
+			const int right = BuildNode(middle, aEnd);
+			m_Nodes[index].right = right;
+			return index;
+		}
+
+		std::vector<TriangleBox> m_Boxes;
+		std::vector<int> m_Order;
+		std::vector<Node> m_Nodes;
+		std::vector<int> m_Pending;
+		size_t m_NumberOfBuilt{ 0 };
+	};
+}
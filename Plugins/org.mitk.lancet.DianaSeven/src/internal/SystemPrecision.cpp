@@ -48,27 +48,15 @@ void lancetAlgorithm::SystemPrecision::DisplayProbe()
 
 void lancetAlgorithm::SystemPrecision::LandmarkRegistration(mitk::PointSet* target)
 {
-	vtkSmartPointer<vtkPoints> pSource =
-		vtkSmartPointer<vtkPoints>::New();
-	vtkSmartPointer<vtkPoints> pTarget =
-		vtkSmartPointer<vtkPoints>::New();
-
-	for (int i = 0; i < target->GetSize(); i++)
+	mitk::LandmarkSolver::Result landmarkResult;
+	if (!mitk::LandmarkSolver::Solve(m_LandmarkPoints, target, landmarkResult))
 	{
-		auto pointVega = m_LandmarkPoints->GetPoint(i);
-		pSource->InsertNextPoint(pointVega[0], pointVega[1], pointVega[2]);
-		auto pointSTL = target->GetPoint(i);
-		pTarget->InsertNextPoint(pointSTL[0], pointSTL[1], pointSTL[2]);
+		MITK_ERROR << "SystemPrecision: landmark registration failed with " << m_LandmarkPoints->GetSize()
+			<< " collected landmarks, keeping the previous registration";
+		return;
 	}
-	vtkSmartPointer<vtkLandmarkTransform> landmarkTransform =
-		vtkSmartPointer<vtkLandmarkTransform>::New();
 
-	landmarkTransform->SetSourceLandmarks(pSource);
-	landmarkTransform->SetTargetLandmarks(pTarget);
-	landmarkTransform->SetMode(VTK_LANDMARK_RIGIDBODY);
-	landmarkTransform->Update();
-	
-	m_LandmarkRegistrationMatrix->DeepCopy(landmarkTransform->GetMatrix());
+	m_LandmarkRegistrationMatrix->DeepCopy(landmarkResult.matrix);
 	m_FinalRegistrationMatrix->DeepCopy(m_LandmarkRegistrationMatrix);
 	PrintDataHelper::CoutMatrix("m_LandmarkRegistrationMatrix: ", m_LandmarkRegistrationMatrix);
 }
@@ -9,6 +9,7 @@
 #include <vtkLandmarkTransform.h>
 #include <qthread.h>
 #include "surfaceregistraion.h"
+#include <landmarkSolver.h>
 #include <PrintDataHelper.h>
 #include <mitkIRenderWindowPart.h>
 #include <vtkRenderWindow.h>
@@ -59,6 +59,7 @@ found in the LICENSE file.
 #include "mitkMatrixConvert.h"
 #include "mitkNavigationToolStorageDeserializer.h"
 #include "mitkPointSet.h"
+#include "pointSetMatcher.h"
 #include "mitkSurfaceToImageFilter.h"
 #include "QmitkDataStorageTreeModel.h"
 #include "QmitkRenderWindow.h"
@@ -3627,25 +3628,8 @@ void DentalAccuracy::ClipTeeth()
 
 void DentalAccuracy::UpdateAllBallFingerPrint(mitk::PointSet::Pointer stdSteelballCenters)
 {
-	int pointNum = stdSteelballCenters->GetSize();
-
-	int currentIndex{ 0 };
-	for (int i{ 0 }; i < pointNum; i++)
-	{
-
-		int currentColumn{ 0 };
-		for (int j{ 0 }; j < pointNum; j++)
-		{
-			if (i != j)
-			{
-				allBallFingerPrint[currentIndex] = GetPointDistance(stdSteelballCenters->GetPoint(i), stdSteelballCenters->GetPoint(j));
-				//m_Controls.textBrowser->append(QString::number(currentIndex)+": "+ QString::number(allBallFingerPrint[3 * i + currentColumn]));
-				currentColumn += 1;
-				currentIndex += 1;
-			}
-		}
-	}
-
+	// distances of every ball to all the other ones, same layout as used by ScreenCoarseSteelballCenters
+	mitk::PointSetMatcher::ComputeDistanceFingerprints(stdSteelballCenters, allBallFingerPrint);
 }
 
 double DentalAccuracy::GetPointDistance(const mitk::Point3D p0, const mitk::Point3D p1)
@@ -201,8 +201,6 @@ protected:
   mitk::Point3D CalculateMassCenter(const mitk::PointSet::Pointer& pointSet);
   bool ComparePointsByDistance(const mitk::Point3D& massCenter, const mitk::Point3D& point1, const mitk::Point3D& point2);
   void SortPointSetByDistance(mitk::PointSet::Pointer inputPointSet, mitk::PointSet::Pointer outputPointSet);
-  void GenerateCombinations(int m, int n, int index, std::vector<int>& currentCombination, std::vector<std::vector<int>>& result);
-  std::vector<std::vector<int>> GenerateAllCombinations(int m, int n);
 
 
   void on_pushButton_startNavi_clicked();
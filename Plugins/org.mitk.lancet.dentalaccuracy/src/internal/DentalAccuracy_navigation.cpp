@@ -52,6 +52,7 @@ found in the LICENSE file.
 #include "mitkMatrixConvert.h"
 #include "mitkNavigationToolStorageDeserializer.h"
 #include "mitkPointSet.h"
+#include "pointSetMatcher.h"
 #include "QmitkDataStorageTreeModel.h"
 #include "QmitkRenderWindow.h"
 #include "surfaceregistraion.h"
@@ -138,59 +139,28 @@ void DentalAccuracy::on_pushButton_imageRegisNew_clicked()
 	}
 
 	// Step 4: Calculate m_T_patientRFtoImage
-	int collectedPointNum = m_probeDitchPset_rf->GetSize();
-	int totalPointNum = probePoints_image->GetSize();
+	// The collected points are an unordered subset of the probe ditch points: find the subset,
+	// the correspondences and the transform at once instead of trying every combination
+	mitk::PointSetMatcher matcher;
+	matcher.SetSourcePoints(probePoints_image);
+	matcher.SetTargetPoints(m_probeDitchPset_rf);
+	matcher.SetTolerance(1.5);
+	matcher.Match();
+	const auto& matchResult = matcher.GetResult();
 
-	auto sorted_probeDitchPset_rf = mitk::PointSet::New();
-	SortPointSetByDistance(m_probeDitchPset_rf, sorted_probeDitchPset_rf);
-
-	// Generate the tmp landmark_src
-	auto tmp_landmark_src = mitk::PointSet::New();
-	auto sorted_landmark_src = mitk::PointSet::New();
 	double maxError{ 1000 };
 	double avgError{ 1000 };
-
-	std::vector<std::vector<int>> combinations = GenerateAllCombinations(totalPointNum-1, collectedPointNum);
-
-	for (const auto& combination : combinations) {
-
-		tmp_landmark_src->Clear();
-
-		for (int value : combination) {
-			tmp_landmark_src->InsertPoint(probePoints_image->GetPoint(value));
-		}
-
-		SortPointSetByDistance(tmp_landmark_src, sorted_landmark_src);
-
-		auto tmpLandmarkRegistrator = mitk::SurfaceRegistration::New();
-		tmpLandmarkRegistrator->SetLandmarksSrc(sorted_landmark_src);
-		tmpLandmarkRegistrator->SetLandmarksTarget(sorted_probeDitchPset_rf);
-
-		m_Controls.textBrowser->append("sorted_landmark_src Pnum: " + QString::number(sorted_landmark_src->GetSize()));
-
-		m_Controls.textBrowser->append("sorted_probeDitchPset_rf Pnum: " + QString::number(sorted_probeDitchPset_rf->GetSize()));
-
-		tmpLandmarkRegistrator->ComputeLandMarkResult();
-		double tmpMaxError = tmpLandmarkRegistrator->GetmaxLandmarkError();
-		double tmpAvgError = tmpLandmarkRegistrator->GetavgLandmarkError();
-
-		if(tmpMaxError < maxError && tmpAvgError < avgError)
-		{
-			maxError = tmpMaxError;
-			avgError = tmpAvgError;
-
-			m_Controls.lineEdit_maxError->setText(QString::number(tmpMaxError));
-			m_Controls.lineEdit_avgError->setText(QString::number(tmpAvgError));
-
-			memcpy_s(m_T_patientRFtoImage, sizeof(double) * 16, tmpLandmarkRegistrator->GetResult()->GetData(), sizeof(double) * 16);
-		}
-
-		if (maxError < 0.5)
-		{
-			break;
-		}
-
+	if (matchResult.success)
+	{
+		maxError = matchResult.maxError;
+		avgError = matchResult.avgError;
+		memcpy_s(m_T_patientRFtoImage, sizeof(double) * 16, matchResult.matrix, sizeof(double) * 16);
 	}
+	m_Controls.lineEdit_maxError->setText(QString::number(maxError));
+	m_Controls.lineEdit_avgError->setText(QString::number(avgError));
+	m_Controls.textBrowser->append("Matched " + QString::number(matchResult.numberOfMatches) + " of "
+		+ QString::number(m_probeDitchPset_rf->GetSize()) + " probe ditch points in "
+		+ QString::number(matchResult.elapsedTime) + " ms");
 
 	if(maxError < 1.5 && avgError < 1.5)
 	{
@@ -269,29 +239,6 @@ void DentalAccuracy::on_pushButton_imageRegisNew_clicked()
 
 }
 
-void DentalAccuracy::GenerateCombinations(int m, int n, int index, std::vector<int>& currentCombination, std::vector<std::vector<int>>& result)
-{
-	if (currentCombination.size() == n) {
-		result.push_back(currentCombination);
-		return;
-	}
-	for (int i = index; i <= m; ++i) {
-		currentCombination.push_back(i);
-		GenerateCombinations(m, n, i + 1, currentCombination, result);
-		currentCombination.pop_back();
-	}
-}
-
-std::vector<std::vector<int>> DentalAccuracy::GenerateAllCombinations(int m, int n)
-{
-	std::vector<std::vector<int>> result;
-	std::vector<int> currentCombination;
-	GenerateCombinations(m, n, 0, currentCombination, result);
-	return result;
-}
-
-
-
 // Function to calculate the Euclidean distance between two points
 double DentalAccuracy::CalculateDistance(const mitk::Point3D& point1, const mitk::Point3D& point2)
 {
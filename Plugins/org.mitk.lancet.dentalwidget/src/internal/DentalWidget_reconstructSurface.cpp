@@ -12,9 +12,12 @@
 #include "mitkNodePredicateDataType.h"
 #include "mitkPointSet.h"
 #include "mitkSurface.h"
+#include "pointSetMatcher.h"
 #include "surfaceregistraion.h"
 #include "vtkImageCast.h"
 
+#include <algorithm>
+
 void DentalWidget::CheckUseSmoothing()
 {
 	if (m_Controls.lineEdit_smoothIteration->isEnabled())
@@ -928,25 +931,10 @@ void DentalWidget::GetSteelballCenters_modelCBCT()
 
 void DentalWidget::UpdateAllBallFingerPrint(mitk::PointSet::Pointer stdSteelballCenters)
 {
-	int pointNum = stdSteelballCenters->GetSize();
-
-	int currentIndex{ 0 };
-	for(int i{0}; i < pointNum; i++)
-	{
-
-		int currentColumn{ 0 };
-		for(int j{0}; j < pointNum; j++)
-		{
-			if(i != j)
-			{
-				allBallFingerPrint[currentIndex] = GetPointDistance(stdSteelballCenters->GetPoint(i), stdSteelballCenters->GetPoint(j));
-				//m_Controls.textBrowser->append(QString::number(currentIndex)+": "+ QString::number(allBallFingerPrint[3 * i + currentColumn]));
-				currentColumn += 1;
-				currentIndex += 1;
-			}
-		}
-	}
-	
+	// distances of every ball to all the other ones, 6 per ball for the 7 standard balls
+	std::vector<double> fingerPrints;
+	mitk::PointSetMatcher::ComputeDistanceFingerprints(stdSteelballCenters, fingerPrints);
+	std::copy_n(fingerPrints.begin(), std::min(fingerPrints.size(), sizeof(allBallFingerPrint) / sizeof(double)), allBallFingerPrint);
 }
 
 void DentalWidget::UpdateStdCenters()
@@ -204,12 +204,7 @@ bool KukaRobotControl::ConnectKuka()
 		MITK_INFO << "TCP:" << tcp[0] << "," << tcp[1] << "," << tcp[2] << "," << tcp[3] << "," << tcp[4] << "," << tcp[5];
 		//set tcp to robot
 		  //set tcp
-		QThread::msleep(1000);
-		m_KukaTrackingDevice->RequestExecOperate("movel", QStringList{ QString::number(tcp[0]),QString::number(tcp[1]),QString::number(tcp[2]),QString::number(tcp[3]),QString::number(tcp[4]),QString::number(tcp[5]) });
-		QThread::msleep(1000);
-		m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "11" });
-		QThread::msleep(1000);
-		m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "5" });
+		m_KukaTrackingDevice->RequestExecOperate("applytcpvalue", QStringList{ QString::number(tcp[0]),QString::number(tcp[1]),QString::number(tcp[2]),QString::number(tcp[3]),QString::number(tcp[4]),QString::number(tcp[5]) });
 	}
 
 	return true;
@@ -6,6 +6,8 @@ set(INTERNAL_CPP_FILES
   org_mitk_Panorama_Activator.cpp
   PanoramaView.cpp
   CBCTPanorama.cpp
+  PanoramaEngine.cpp
+  PanoramaCPR.cpp
   mitkGraphcutSegmentationToSurfaceFilter.cpp
 )
 
@@ -1,4 +1,5 @@
 ﻿#include "CBCTPanorama.h"
+#include "PanoramaCPR.h"
 
 Panorama::Panorama(std::string resultDir,
                    std::string mipFile,
@@ -326,7 +327,30 @@ DCMImage2DType::Pointer Panorama::Arch(std::vector<Point> controlPoints,
 {
   reset();
   //»ñµÃÄâºÏµã
-  result = spline(controlPoints, 2, 1.0 / thinPixelNum);
+  result = FitArch(controlPoints);
+  auto image = DrawArch(result, morph);
+  try
+  {
+    dcmWriter->SetFileName(splineFile);
+    dcmWriter->SetImageIO(dcmIO);
+    dcmWriter->SetInput(image);
+    dcmWriter->UpdateLargestPossibleRegion();
+    return image;
+  }
+  catch (itk::ExceptionObject &e)
+  {
+    std::cerr << e << std::endl;
+    return nullptr;
+  }
+}
+
+std::vector<Panorama::Point> Panorama::FitArch(const std::vector<Point> &controlPoints)
+{
+  return spline(controlPoints, 2, 1.0 / thinPixelNum);
+}
+
+DCMImage2DType::Pointer Panorama::DrawArch(const std::vector<Point> &result, DCMImage2DType::Pointer morph)
+{
   //»ñµÃÑÀ¹­ÏßÇøÓò
   DCMImage2DType::Pointer image = DCMImage2DType::New();
   image->SetRegions(morph->GetBufferedRegion());
@@ -341,19 +365,7 @@ DCMImage2DType::Pointer Panorama::Arch(std::vector<Point> controlPoints,
     index[1] = (int)point.y;
     image->SetPixel(index, 255);
   }
-  try
-  {
-    dcmWriter->SetFileName(splineFile);
-    dcmWriter->SetImageIO(dcmIO);
-    dcmWriter->SetInput(image);
-    dcmWriter->UpdateLargestPossibleRegion();
-    return image;
-  }
-  catch (itk::ExceptionObject &e)
-  {
-    std::cerr << e << std::endl;
-    return nullptr;
-  }
+  return image;
 }
 
 //Éú³ÉÈ«¾°Í¼
@@ -363,139 +375,124 @@ DCMImage2DType::Pointer Panorama::GeneratePanorama(DCMImage3DType::Pointer teeth
                                                    std::vector<std::vector<Panorama::Point>> &interpoMap)
 {
   reset();
-  DCMImage2DType::Pointer panoramaImg = DCMImage2DType::New();
-  DCMImage2DType::IndexType panoramaStart;
-  panoramaStart.Fill(0);
-  DCMImage2DType::SizeType panoramSize;
-  //È«¾°Í¼³¤¿í
-  panoramSize[0] = result.size();
-  panoramSize[1] = teeth->GetLargestPossibleRegion().GetSize()[2];
-  DCMImage2DType::RegionType panoramRegion(panoramaStart, panoramSize);
-  panoramaImg->SetRegions(panoramRegion);
-  panoramaImg->Allocate();
-  panoramaImg->FillBuffer(255);
-  //Ë«ÏßÐÔ²åÖµ·¨
+  //the same in-memory reformation the live arch editing uses, without a cache to reuse
+  PanoramaCPR cpr(this);
+  cpr.SetImage(teeth);
+  cpr.SetThickness(thickness);
+  if (!cpr.Update(result))
+  {
+    return nullptr;
+  }
+  interpoMap.insert(interpoMap.end(), cpr.GetColumns().begin(), cpr.GetColumns().end());
+  auto panoramaImg = cpr.GetPanorama();
+  return SavePanorama(panoramaImg) ? panoramaImg : nullptr;
+}
+
+std::vector<Panorama::Point> Panorama::NormalSamples(const std::vector<Point> &result, int x, int thickness)
+{
   //ÑÀ³Ýºñ¶È£¬µ¥Î»£ºÏñËØ
-  for (int x = 0; x < panoramSize[0]; x++)
-  {
-    auto pixel = result[x];
-    //»ñµÃµ±Ç°µãµÄÇ°5¸öµãºÍºó5¸öµã£¬¼ÆËãÇÐÏòÁ¿
-    auto behind = x - 5 > 0 ? result[x - 5] : pixel;
-    auto ahead = x + 5 < panoramSize[0] ? result[x + 5] : pixel;
-    //ÑùÌõÇúÏßÄâºÏµã
-    std::vector<Point> inputPoints, outputPoints;
-    Point tmp1, tmp2;
-    if (ahead.x == behind.x)
+  const int size = result.size();
+  auto pixel = result[x];
+  //»ñµÃµ±Ç°µãµÄÇ°5¸öµãºÍºó5¸öµã£¬¼ÆËãÇÐÏòÁ¿
+  auto behind = x - 5 > 0 ? result[x - 5] : pixel;
+  auto ahead = x + 5 < size ? result[x + 5] : pixel;
+  //ÑùÌõÇúÏßÄâºÏµã
+  std::vector<Point> inputPoints;
+  Point tmp1, tmp2;
+  if (ahead.x == behind.x)
+  {
+    //´¹Ö±ÇÐÏß
+    tmp1.x = pixel.x + thickness / 2;
+    tmp1.y = pixel.y;
+    tmp2.x = pixel.x - thickness / 2;
+    tmp2.y = pixel.y;
+  }
+  else if (ahead.y == behind.y)
+  {
+    //Ë®Æ½ÇÐÏß
+    tmp1.x = pixel.x;
+    tmp1.y = pixel.y + thickness / 2;
+    tmp2.x = pixel.x;
+    tmp2.y = pixel.y - thickness / 2;
+  }
+  else
+  {
+    //ÆÕÍ¨ÇÐÏß
+    double normal = -(ahead.x - behind.x) / (ahead.y - behind.y);
+    auto angle = std::atan(normal);
+    double xRange = std::abs(std::cos(angle)) * thickness;
+    double yRange = std::abs(std::sin(angle)) * thickness;
+    if (normal < 0)
     {
-      //´¹Ö±ÇÐÏß
-      tmp1.x = pixel.x + thickness / 2;
-      tmp1.y = pixel.y;
-      tmp2.x = pixel.x - thickness / 2;
-      tmp2.y = pixel.y;
-    }
-    else if (ahead.y == behind.y)
-    {
-      //Ë®Æ½ÇÐÏß
-      tmp1.x = pixel.x;
-      tmp1.y = pixel.y + thickness / 2;
-      tmp2.x = pixel.x;
-      tmp2.y = pixel.y - thickness / 2;
+      tmp1.x = pixel.x - xRange / 2;
+      tmp1.y = pixel.y + yRange / 2;
+      tmp2.x = pixel.x + xRange / 2;
+      tmp2.y = pixel.y - yRange / 2;
     }
     else
     {
-      //ÆÕÍ¨ÇÐÏß
-      double normal = -(ahead.x - behind.x) / (ahead.y - behind.y);
-      auto angle = std::atan(normal);
-      double xRange = std::abs(std::cos(angle)) * thickness;
-      double yRange = std::abs(std::sin(angle)) * thickness;
-      if (normal < 0)
-      {
-        tmp1.x = pixel.x - xRange / 2;
-        tmp1.y = pixel.y + yRange / 2;
-        tmp2.x = pixel.x + xRange / 2;
-        tmp2.y = pixel.y - yRange / 2;
-      }
-      else
-      {
-        tmp1.x = pixel.x + xRange / 2;
-        tmp1.y = pixel.y + yRange / 2;
-        tmp2.x = pixel.x - xRange / 2;
-        tmp2.y = pixel.y - yRange / 2;
-      }
-    }
-    inputPoints.push_back(tmp1);
-    inputPoints.push_back(pixel);
-    inputPoints.push_back(tmp2);
-    //·¨ÏßÉÏ²ÉÑùµã¸öÊý¾ÍÊÇÑÀ¹­ºñ¶È
-    outputPoints = spline(inputPoints, 1, 1.0 / thickness);
-    interpoMap.push_back(outputPoints);
-
-    for (int z = 0; z < panoramSize[1]; z++)
-    {
-      //Èí×éÖ¯Ç¿¶ÈÖµãÐÖµ
-      double S = 50;
-      double sum = 0;
-      for (auto samplePoint : outputPoints)
-      {
-        double value = interpo(teeth, samplePoint.x, samplePoint.y, z);
-        sum += std::exp(value / S);
-      }
-      double resultPixel = S * std::log(sum);
-      //Ó³Éä»Ò¶ÈÖµ
-      resultPixel = resultPixel > 3000 ? 3000 : resultPixel;
-      itk::Index<2> index_write;
-      index_write[0] = x;
-      //Í¼ÏñÉÏÏÂµßµ¹
-      index_write[1] = panoramSize[1] - 1 - z;
-      panoramaImg->SetPixel(index_write, (DCMPixelType)resultPixel);
+      tmp1.x = pixel.x + xRange / 2;
+      tmp1.y = pixel.y + yRange / 2;
+      tmp2.x = pixel.x - xRange / 2;
+      tmp2.y = pixel.y - yRange / 2;
     }
   }
+  inputPoints.push_back(tmp1);
+  inputPoints.push_back(pixel);
+  inputPoints.push_back(tmp2);
+  //·¨ÏßÉÏ²ÉÑùµã¸öÊý¾ÍÊÇÑÀ¹­ºñ¶È
+  return spline(inputPoints, 1, 1.0 / thickness);
+}
+
+//ÌáÈ¡µ½µÄÔöÇ¿ÏßÌõ
+DCMImage2DType::Pointer Panorama::Enhance(DCMImage2DType::Pointer panorama)
+{
   auto enhanceFilter = EnhancementFilterType::New();
   enhanceFilter->SetSigma(1);
-  enhanceFilter->SetInput(panoramaImg);
-
-  dcmWriter->SetFileName(resultDir + "\\enhance.dcm");
-  dcmWriter->SetInput(enhanceFilter->GetOutput());
-  dcmWriter->SetImageIO(dcmIO);
-
+  enhanceFilter->SetInput(panorama);
   try
   {
     enhanceFilter->UpdateLargestPossibleRegion();
-    dcmWriter->UpdateLargestPossibleRegion();
   }
   catch (itk::ExceptionObject &e)
   {
     std::cerr << e << std::endl;
     std::cerr << "image enhance error" << std::endl;
-    exit(-1);
+    return nullptr;
   }
-  //ÌáÈ¡µ½µÄÔöÇ¿ÏßÌõ
-  auto enhanceImage = enhanceFilter->GetOutput();
-  reset();
-  //ºÏ³É
-  for (int x = 0; x < panoramSize[0]; x++)
+  DCMImage2DType::Pointer enhanceImage = enhanceFilter->GetOutput();
+  enhanceImage->DisconnectPipeline();
+  return enhanceImage;
+}
+
+//ºÏ³É
+void Panorama::Blend(DCMImage2DType *projection, DCMImage2DType *enhance, DCMImage2DType *panorama)
+{
+  const DCMPixelType *projectionBuffer = projection->GetBufferPointer();
+  const DCMPixelType *enhanceBuffer = enhance->GetBufferPointer();
+  DCMPixelType *panoramaBuffer = panorama->GetBufferPointer();
+  const size_t numberOfPixels = projection->GetBufferedRegion().GetNumberOfPixels();
+  for (size_t i = 0; i < numberOfPixels; i++)
   {
-    for (int y = 0; y < panoramSize[1]; y++)
-    {
-      itk::Index<2> index = {x, y};
-      DCMPixelType originPixel = panoramaImg->GetPixel(index);
-      DCMPixelType enhancePixel = enhanceImage->GetPixel(index);
-      DCMPixelType resultPixel = 0.7 * originPixel + 0.3 * enhancePixel;
-      panoramaImg->SetPixel(index, resultPixel);
-    }
+    panoramaBuffer[i] = 0.7 * projectionBuffer[i] + 0.3 * enhanceBuffer[i];
   }
-  dcmWriter->SetInput(panoramaImg);
+}
+
+bool Panorama::SavePanorama(DCMImage2DType::Pointer panorama)
+{
+  reset();
+  dcmWriter->SetInput(panorama);
   dcmWriter->SetImageIO(dcmIO);
   dcmWriter->SetFileName(panoramaFile);
   try
   {
     dcmWriter->UpdateLargestPossibleRegion();
-    return panoramaImg;
+    return true;
   }
   catch (itk::ExceptionObject &e)
   {
     std::cerr << e << std::endl;
-    return nullptr;
+    return false;
   }
 }
 
@@ -834,36 +831,3 @@ DCMImage3DType::Pointer Panorama::BoxROI(DCMImage3DType::Pointer teeth,
     return nullptr;
   }
 }
-
-//¶ÔÈýÎ¬CBCTÊý¾Ý²åÖµ
-double Panorama::interpo(DCMImage3DType::Pointer teeth, double x, double y, double z)
-{
-  int int_x = (int)x;
-  int int_y = (int)y;
-  double alpha = x - int_x;
-  double beta = y - int_y;
-  //Ë®Æ½·½Ïò²åÖµ
-  double horiInterpo1, horiInterpo2;
-  itk::Index<3> index_read;
-  index_read[0] = int_x;
-  index_read[1] = int_y;
-  index_read[2] = z;
-  short tmp1 = teeth->GetPixel(index_read);
-  index_read[0] = int_x + 1;
-  index_read[1] = int_y;
-  index_read[2] = z;
-  short tmp2 = teeth->GetPixel(index_read);
-  horiInterpo1 = tmp1 + alpha * (tmp2 - tmp1);
-  index_read[0] = int_x;
-  index_read[1] = int_y + 1;
-  index_read[2] = z;
-  short tmp3 = teeth->GetPixel(index_read);
-  index_read[0] = int_x + 1;
-  index_read[1] = int_y + 1;
-  index_read[2] = z;
-  short tmp4 = teeth->GetPixel(index_read);
-  horiInterpo2 = tmp3 + alpha * (tmp4 - tmp3);
-  //´¹Ö±·½Ïò²åÖµ
-  double value = horiInterpo1 + beta * (horiInterpo2 - horiInterpo1);
-  return value;
-}
\ No newline at end of file
@@ -114,10 +114,22 @@ public:
   DCMImage2DType::Pointer Arch(std::vector<Point> controlPoints,
                                DCMImage2DType::Pointer morph,
                                std::vector<Point> &result);
+  //Arch samples of the control points as Arch() fits them, without drawing or writing them
+  std::vector<Point> FitArch(const std::vector<Point> &controlPoints);
+  //The arch samples drawn into an image like morph, in memory
+  DCMImage2DType::Pointer DrawArch(const std::vector<Point> &result, DCMImage2DType::Pointer morph);
   DCMImage2DType::Pointer GeneratePanorama(DCMImage3DType::Pointer teeth,
                                            std::vector<Point> &result,
                                            int thickness,
                                            std::vector<std::vector<Panorama::Point>> &interpoMap);
+  //Samples along the normal of the arch at result[x], thickness pixels long
+  std::vector<Point> NormalSamples(const std::vector<Point> &result, int x, int thickness);
+  //Gradient magnitude of the panorama, in memory
+  DCMImage2DType::Pointer Enhance(DCMImage2DType::Pointer panorama);
+  //panorama = 0.7 * projection + 0.3 * enhance, all of the same size, panorama may be projection
+  void Blend(DCMImage2DType *projection, DCMImage2DType *enhance, DCMImage2DType *panorama);
+  //Writes the panorama to panoramaFile
+  bool SavePanorama(DCMImage2DType::Pointer panorama);
   DCMImage3DType::Pointer LooseROI(DCMImage3DType::Pointer teeth,
                                    std::vector<Panorama::Point> boxPoints,
                                    std::vector<std::vector<Panorama::Point>> interpoMap);
@@ -131,7 +143,7 @@ public:
 
 private:
   //�������߻�����
-  double BaseFunc(int i, int deg, double t, std::vector<double> knot)
+  double BaseFunc(int i, int deg, double t, const std::vector<double> &knot)
   {
     if (deg == 0)
     {
@@ -186,9 +198,6 @@ private:
       return lhs.x < rhs.x;
   }
 
-  //˫���Բ�ֵ
-  double interpo(DCMImage3DType::Pointer teeth, double x, double y, double z);
-
   //����ļ���
   std::string resultDir;
   //���ǿ��ͶӰ�ļ�
@@ -0,0 +1,152 @@
+#include "PanoramaCPR.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+  bool SamePoint(const Panorama::Point &lhs, const Panorama::Point &rhs)
+  {
+    return lhs.x == rhs.x && lhs.y == rhs.y;
+  }
+}
+
+PanoramaCPR::PanoramaCPR(Panorama *panorama) : m_Panorama(panorama) {}
+
+void PanoramaCPR::SetImage(DCMImage3DType::Pointer teeth)
+{
+  m_Teeth = teeth;
+  if (teeth != nullptr)
+  {
+    m_Engine.SetImage(teeth);
+  }
+  Invalidate();
+}
+
+void PanoramaCPR::SetThickness(int thickness)
+{
+  if (thickness != m_Thickness)
+  {
+    m_Thickness = thickness;
+    Invalidate();
+  }
+}
+
+void PanoramaCPR::Invalidate()
+{
+  m_Valid = false;
+}
+
+bool PanoramaCPR::SetControlPoints(const std::vector<Panorama::Point> &controlPoints)
+{
+  if (controlPoints.empty())
+  {
+    return false;
+  }
+  return Update(m_Panorama->FitArch(controlPoints));
+}
+
+bool PanoramaCPR::Update(const std::vector<Panorama::Point> &arch)
+{
+  if (m_Teeth == nullptr || m_Thickness <= 0 || arch.empty())
+  {
+    return false;
+  }
+
+  const long long newSize = arch.size();
+  const long long oldSize = m_Valid ? m_Arch.size() : 0;
+  const long long shift = newSize - oldSize;
+
+  //the arch samples the edit did not reach
+  long long head = 0;
+  while (head < std::min(newSize, oldSize) && SamePoint(arch[head], m_Arch[head]))
+  {
+    head++;
+  }
+  long long tail = 0;
+  while (tail < std::min(newSize, oldSize) - head && SamePoint(arch[newSize - 1 - tail], m_Arch[oldSize - 1 - tail]))
+  {
+    tail++;
+  }
+  if (m_Valid && shift == 0 && head == newSize)
+  {
+    m_UpdatedBegin = m_UpdatedEnd = 0;
+    return true;
+  }
+
+  //a normal depends on the samples NormalReach before and after it, and on whether it is that
+  //close to either end of the arch, which moves with the number of samples
+  long long begin = head - NormalReach;
+  long long end = newSize - tail + NormalReach;
+  if (shift != 0)
+  {
+    begin = std::min(begin, std::min(newSize, oldSize) - NormalReach);
+    end = std::max(end, NormalReach + 1 + std::max(shift, 0LL));
+  }
+  if (!m_Valid)
+  {
+    begin = 0;
+    end = newSize;
+  }
+  begin = std::max(begin, 0LL);
+  end = std::min(end, newSize);
+
+  //frames: keep head and tail, sample the span in between
+  std::vector<std::vector<Panorama::Point>> columns(newSize);
+  for (long long x = 0; x < begin; x++)
+  {
+    columns[x] = std::move(m_Columns[x]);
+  }
+  for (long long x = end; x < newSize; x++)
+  {
+    columns[x] = std::move(m_Columns[x - shift]);
+  }
+  for (long long x = begin; x < end; x++)
+  {
+    columns[x] = m_Panorama->NormalSamples(arch, x, m_Thickness);
+  }
+
+  //projection: copy the kept columns over, project the span
+  DCMImage2DType::Pointer projection = DCMImage2DType::New();
+  DCMImage2DType::IndexType start;
+  start.Fill(0);
+  DCMImage2DType::SizeType size;
+  size[0] = newSize;
+  size[1] = m_Teeth->GetBufferedRegion().GetSize()[2];
+  projection->SetRegions(DCMImage2DType::RegionType(start, size));
+  projection->Allocate();
+  if (m_Valid && m_Projection != nullptr)
+  {
+    const DCMPixelType *from = m_Projection->GetBufferPointer();
+    DCMPixelType *to = projection->GetBufferPointer();
+    for (size_t z = 0; z < size[1]; z++, from += oldSize, to += newSize)
+    {
+      std::memcpy(to, from, begin * sizeof(DCMPixelType));
+      std::memcpy(to + end, from + end - shift, (newSize - end) * sizeof(DCMPixelType));
+    }
+  }
+  m_Engine.UpdateColumns(columns, begin, end);
+  m_Engine.Project(projection, begin, end);
+
+  //the gradient filter smooths across columns, so it and the blend run on the whole image
+  auto enhancement = m_Panorama->Enhance(projection);
+  if (enhancement == nullptr)
+  {
+    Invalidate();
+    return false;
+  }
+  DCMImage2DType::Pointer panorama = DCMImage2DType::New();
+  panorama->SetRegions(projection->GetBufferedRegion());
+  panorama->Allocate();
+  m_Panorama->Blend(projection, enhancement, panorama);
+
+  m_Arch = arch;
+  m_Columns = std::move(columns);
+  m_Projection = projection;
+  m_Enhancement = enhancement;
+  m_PanoramaImage = panorama;
+  m_UpdatedBegin = begin;
+  m_UpdatedEnd = end;
+  m_Valid = true;
+  return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+/*
+Curved planar reformation of the dental arch, cached in memory for live arch editing
+*/
+#include "CBCTPanorama.h"
+#include "PanoramaEngine.h"
+
+#include <vector>
+
+//Keeps the panorama of an arch in memory and updates it when the arch changes.
+//
+//The normal samples of every arch sample (its frame) and the projected columns are cached.
+//A control point only reaches the arch samples of its spline span, the samples before and after
+//it come out of Panorama::FitArch() unchanged. Update() therefore compares the new arch with the
+//cached one and samples and projects only the columns between the common head and tail, plus
+//the neighbours the normals are taken from; the other columns are moved over from the last
+//panorama. Projection, enhancement and panorama are memory images, nothing is written to disk.
+class PanoramaCPR
+{
+public:
+  //Samples on either side of a column its normal is taken from, as in Panorama::NormalSamples
+  static constexpr long long NormalReach = 5;
+
+  //panorama fits the arch and enhances the projection, it must outlive this
+  explicit PanoramaCPR(Panorama *panorama);
+
+  //The CBCT, drops the cache
+  void SetImage(DCMImage3DType::Pointer teeth);
+
+  //Length of the normals in pixels, drops the cache when changed
+  void SetThickness(int thickness);
+
+  //Drops the cache, the next update projects all columns
+  void Invalidate();
+
+  //Updates the panorama to the arch through the control points (pixel coordinates)
+  bool SetControlPoints(const std::vector<Panorama::Point> &controlPoints);
+
+  //Updates the panorama to the arch samples, false without image, thickness or arch
+  bool Update(const std::vector<Panorama::Point> &arch);
+
+  const std::vector<Panorama::Point> &GetArch() const { return m_Arch; }
+
+  //Normal samples of every column, the interpoMap of Panorama::GeneratePanorama
+  const std::vector<std::vector<Panorama::Point>> &GetColumns() const { return m_Columns; }
+
+  //Columns [begin, end) sampled and projected by the last update, empty if nothing moved
+  size_t GetUpdatedBegin() const { return m_UpdatedBegin; }
+  size_t GetUpdatedEnd() const { return m_UpdatedEnd; }
+
+  //The soft maximum projection along the normals
+  DCMImage2DType::Pointer GetProjection() const { return m_Projection; }
+  //Its gradient magnitude
+  DCMImage2DType::Pointer GetEnhancement() const { return m_Enhancement; }
+  //Projection and enhancement blended, what Panorama::GeneratePanorama returns
+  DCMImage2DType::Pointer GetPanorama() const { return m_PanoramaImage; }
+
+private:
+  Panorama *m_Panorama;
+  PanoramaEngine m_Engine;
+  DCMImage3DType::Pointer m_Teeth;
+  int m_Thickness = 0;
+  bool m_Valid = false;
+
+  std::vector<Panorama::Point> m_Arch;
+  std::vector<std::vector<Panorama::Point>> m_Columns;
+  size_t m_UpdatedBegin = 0;
+  size_t m_UpdatedEnd = 0;
+
+  DCMImage2DType::Pointer m_Projection;
+  DCMImage2DType::Pointer m_Enhancement;
+  DCMImage2DType::Pointer m_PanoramaImage;
+};
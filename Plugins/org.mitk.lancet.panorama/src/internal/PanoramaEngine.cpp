@@ -0,0 +1,189 @@
+#include "PanoramaEngine.h"
+#include "parallelForBlocks.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  //slices per soft maximum block, the lanes of the vectorized exp loop
+  constexpr size_t sliceBlock = 32;
+  //columns a thread takes at once
+  constexpr size_t columnBlock = 8;
+}
+
+void PanoramaEngine::SetImage(DCMImage3DType::Pointer teeth)
+{
+  m_Teeth = teeth;
+  m_Buffer = teeth->GetBufferPointer();
+  auto size = teeth->GetBufferedRegion().GetSize();
+  for (int i = 0; i < 3; i++)
+  {
+    m_Size[i] = size[i];
+  }
+  m_SliceStride = m_Size[0] * m_Size[1];
+}
+
+void PanoramaEngine::SetColumns(const std::vector<std::vector<Panorama::Point>> &columns)
+{
+  m_Columns.resize(columns.size());
+  for (size_t i = 0; i < columns.size(); i++)
+  {
+    SetColumn(i, columns[i]);
+  }
+}
+
+void PanoramaEngine::SetColumn(size_t index, const std::vector<Panorama::Point> &samples)
+{
+  auto &taps = m_Columns[index];
+  taps.clear();
+  taps.reserve(samples.size());
+  for (const auto &sample : samples)
+  {
+    taps.push_back(MakeTap(sample));
+  }
+}
+
+void PanoramaEngine::UpdateColumns(const std::vector<std::vector<Panorama::Point>> &columns, size_t begin, size_t end)
+{
+  const size_t oldSize = m_Columns.size();
+  const size_t newSize = columns.size();
+  end = std::min(end, newSize);
+  //the kept tail [end, newSize) was [end + oldSize - newSize, oldSize)
+  if (newSize > oldSize)
+  {
+    m_Columns.resize(newSize);
+    std::move_backward(m_Columns.begin() + (end - (newSize - oldSize)), m_Columns.begin() + oldSize, m_Columns.end());
+  }
+  else if (newSize < oldSize)
+  {
+    std::move(m_Columns.begin() + (end + (oldSize - newSize)), m_Columns.end(), m_Columns.begin() + end);
+    m_Columns.resize(newSize);
+  }
+  for (size_t i = begin; i < end; i++)
+  {
+    SetColumn(i, columns[i]);
+  }
+}
+
+DCMImage2DType::Pointer PanoramaEngine::Project()
+{
+  DCMImage2DType::Pointer panorama = DCMImage2DType::New();
+  DCMImage2DType::IndexType start;
+  start.Fill(0);
+  DCMImage2DType::SizeType size;
+  size[0] = m_Columns.size();
+  size[1] = m_Size[2];
+  panorama->SetRegions(DCMImage2DType::RegionType(start, size));
+  panorama->Allocate();
+  Project(panorama, 0, m_Columns.size());
+  return panorama;
+}
+
+void PanoramaEngine::Project(DCMImage2DType *panorama, size_t begin, size_t end)
+{
+  DCMPixelType *out = panorama->GetBufferPointer();
+  end = std::min(end, m_Columns.size());
+  if (m_Buffer == nullptr || begin >= end)
+  {
+    return;
+  }
+
+  lancetAlgorithm::ParallelForBlocks(end - begin, m_NumberOfThreads, columnBlock, [&](size_t first, size_t last) {
+    std::vector<double> values;
+    for (size_t column = begin + first; column < begin + last; column++)
+    {
+      ProjectColumn(column, out, values);
+    }
+  });
+}
+
+PanoramaEngine::Tap PanoramaEngine::MakeTap(const Panorama::Point &point) const
+{
+  //corner and weights of the bilinear interpolation, the neighbours clamped to the image
+  const int x = (int)point.x;
+  const int y = (int)point.y;
+  auto clamp = [](long long value, long long size) { return std::min(std::max(value, 0LL), size - 1); };
+  const long long x0 = clamp(x, m_Size[0]);
+  const long long x1 = clamp(x + 1LL, m_Size[0]);
+  const long long y0 = clamp(y, m_Size[1]);
+  const long long y1 = clamp(y + 1LL, m_Size[1]);
+
+  Tap tap;
+  tap.offset = x0 + y0 * m_Size[0];
+  tap.dx = x1 - x0;
+  tap.dy = (y1 - y0) * m_Size[0];
+  tap.alpha = point.x - x;
+  tap.beta = point.y - y;
+  return tap;
+}
+
+void PanoramaEngine::ProjectColumn(size_t column, DCMPixelType *out, std::vector<double> &values) const
+{
+  const auto &taps = m_Columns[column];
+  const size_t width = m_Columns.size();
+  const long long height = m_Size[2];
+  if (taps.empty())
+  {
+    for (long long z = 0; z < height; z++)
+    {
+      out[(height - 1 - z) * width + column] = 0;
+    }
+    return;
+  }
+
+  values.resize(taps.size() * sliceBlock);
+  double maxima[sliceBlock];
+  double sums[sliceBlock];
+  const double invSoftTissue = 1.0 / SoftTissue;
+
+  for (long long z0 = 0; z0 < height; z0 += sliceBlock)
+  {
+    const size_t lanes = static_cast<size_t>(std::min<long long>(sliceBlock, height - z0));
+
+    //bilinear samples of the block, one row of lanes per normal sample
+    for (size_t s = 0; s < taps.size(); s++)
+    {
+      const Tap &tap = taps[s];
+      const DCMPixelType *voxel = m_Buffer + tap.offset + z0 * m_SliceStride;
+      double *row = values.data() + s * sliceBlock;
+      for (size_t l = 0; l < lanes; l++, voxel += m_SliceStride)
+      {
+        //the voxels were read as short before, keep that
+        const double v1 = (short)voxel[0];
+        const double v2 = (short)voxel[tap.dx];
+        const double v3 = (short)voxel[tap.dy];
+        const double v4 = (short)voxel[tap.dx + tap.dy];
+        const double horizontal1 = v1 + tap.alpha * (v2 - v1);
+        const double horizontal2 = v3 + tap.alpha * (v4 - v3);
+        row[l] = horizontal1 + tap.beta * (horizontal2 - horizontal1);
+      }
+    }
+
+    //S * log(sum(exp(v / S))) = m + S * log(sum(exp((v - m) / S)))
+    std::copy(values.begin(), values.begin() + lanes, maxima);
+    for (size_t s = 1; s < taps.size(); s++)
+    {
+      const double *row = values.data() + s * sliceBlock;
+      for (size_t l = 0; l < lanes; l++)
+      {
+        maxima[l] = std::max(maxima[l], row[l]);
+      }
+    }
+    std::fill(sums, sums + lanes, 0.0);
+    for (size_t s = 0; s < taps.size(); s++)
+    {
+      const double *row = values.data() + s * sliceBlock;
+      for (size_t l = 0; l < lanes; l++)
+      {
+        sums[l] += std::exp((row[l] - maxima[l]) * invSoftTissue);
+      }
+    }
+    for (size_t l = 0; l < lanes; l++)
+    {
+      double result = maxima[l] + SoftTissue * std::log(sums[l]);
+      result = result > MaximumValue ? MaximumValue : result;
+      out[(height - 1 - (z0 + (long long)l)) * width + column] = (DCMPixelType)result;
+    }
+  }
+}
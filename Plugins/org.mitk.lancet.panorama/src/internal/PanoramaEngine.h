@@ -0,0 +1,71 @@
+#pragma once
+/*
+Parallel panorama projection straight on the CBCT voxel buffer
+*/
+#include "CBCTPanorama.h"
+
+#include <vector>
+
+//Projects the CBCT along the normals of the dental arch into the panorama.
+//
+//SetColumns() turns the normal samples of every arch position into buffer offsets and bilinear
+//weights once; Project() then reads the voxel buffer through them, slice by slice, and spreads
+//the columns over threads. The soft maximum S * log(sum(exp(v / S))) of a column is computed
+//for a block of slices at once, with the largest value factored out, so the exp loop runs over
+//contiguous lanes and never overflows.
+class PanoramaEngine
+{
+public:
+  //Soft tissue intensity S of the soft maximum, 50 as in Panorama::GeneratePanorama
+  static constexpr double SoftTissue = 50;
+  //Panorama values are clamped to this
+  static constexpr double MaximumValue = 3000;
+
+  //The CBCT, kept by pointer; its buffer must stay valid while projecting
+  void SetImage(DCMImage3DType::Pointer teeth);
+
+  //Normal samples (pixel coordinates in a slice) of every panorama column
+  void SetColumns(const std::vector<std::vector<Panorama::Point>> &columns);
+
+  //Replaces the samples of column index, SetColumns() must have been called
+  void SetColumn(size_t index, const std::vector<Panorama::Point> &samples);
+
+  //Resizes to columns.size() and rebuilds only the columns [begin, end) from columns: the columns
+  //before begin are kept, those from end on are the last ones before, moved by the size change
+  void UpdateColumns(const std::vector<std::vector<Panorama::Point>> &columns, size_t begin, size_t end);
+
+  //0 uses all hardware threads
+  void SetNumberOfThreads(unsigned int numberOfThreads) { m_NumberOfThreads = numberOfThreads; }
+
+  size_t GetNumberOfColumns() const { return m_Columns.size(); }
+
+  //Panorama of all columns, width = number of columns, height = number of slices, upside down
+  //like the CBCT slices
+  DCMImage2DType::Pointer Project();
+
+  //Projects the columns [begin, end) into panorama, which has the size Project() returns
+  void Project(DCMImage2DType *panorama, size_t begin, size_t end);
+
+private:
+  //Bilinear sample: offset of the lower corner in a slice, offsets to the +x and +y neighbours
+  //(0 at the border) and the weights of the neighbours
+  struct Tap
+  {
+    long long offset = 0;
+    long long dx = 0;
+    long long dy = 0;
+    double alpha = 0;
+    double beta = 0;
+  };
+
+  Tap MakeTap(const Panorama::Point &point) const;
+  void ProjectColumn(size_t column, DCMPixelType *out, std::vector<double> &values) const;
+
+  DCMImage3DType::Pointer m_Teeth;
+  const DCMPixelType *m_Buffer = nullptr;
+  long long m_Size[3] = {0, 0, 0};
+  long long m_SliceStride = 0;
+
+  std::vector<std::vector<Tap>> m_Columns;
+  unsigned int m_NumberOfThreads = 0;
+};
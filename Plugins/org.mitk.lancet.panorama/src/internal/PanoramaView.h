@@ -14,14 +14,17 @@ found in the LICENSE file.
 #define PanoramaView_h
 
 #include "CBCTPanorama.h"
+#include "PanoramaCPR.h"
 #include "mitkGraphcutSegmentationToSurfaceFilter.h"
 #include "qstackedwidget.h"
 #include "ui_PanoramaViewControls.h"
+#include <QMessageBox>
 #include <QString>
 #include <QmitkAbstractView.h>
 #include <QmitkIOUtil.h>
 #include <QmitkPointListModel.h>
 #include <QmitkRenderWindow.h>
+#include <itkCommand.h>
 #include <mitkDataNode.h>
 #include <mitkIRenderWindowPartListener.h>
 #include <mitkITKImageImport.h>
@@ -60,6 +63,9 @@ private:
   void OnSegBoxROI();
   void OnToothSegment();
   void OnMarchingCube();
+  //Control points moved, updates arch and panorama from the cache
+  void OnControlPointsModified();
+  std::vector<Panorama::Point> GetControlPoints(DCMImage2DType::Pointer morph);
 
   //�������ò���
   void OnResetMip();
@@ -71,6 +77,12 @@ private:
   void ResetViewBasicFunc(std::vector<std::string> show, std::vector<std::string> hide, std::string locate);
   static PanoramaView *m_self;
   Panorama *panorama;
+  //Panorama of the current arch, kept for live arch editing
+  PanoramaCPR *cpr;
+  //Set once a panorama was generated, the control points then update it while dragged
+  bool m_LivePanorama = false;
+  DCMImage2DType::Pointer m_MorphITKImage;
+  unsigned long m_PointSetObserverTag = 0;
   Ui::PanoramaViewControls *m_Controls;
   mitk::DataNode::Pointer m_PointSetNode;
   mitk::DataInteractor::Pointer m_DataInteractor;
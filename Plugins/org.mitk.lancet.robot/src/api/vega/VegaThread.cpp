@@ -97,6 +97,7 @@ private:
 	unsigned int fps;
 	static constexpr const int WARNING_CODE_OFFSET = 1000;
 	CombinedApi capi;
+	TrackingFrame trackingFrame; ///< Decoded in place every frame
 	bool capiConnected;
 	bool apiSupportsBX2;
 	int trackingTimerId;
@@ -332,11 +333,18 @@ void Vega::tracking()
 	// Demonstrate BX or BX2 command
 	this->toolDataMapLock.lockForWrite();
 	//std::vector<ToolData> toolDatas = apiSupportsBX2 ? this->capi.getTrackingDataBX2() : this->capi.getTrackingDataBX();
-	// Force using BX command
-	std::vector<ToolData> toolDatas = this->capi.getTrackingDataBX();
-	for (std::size_t i = 0; i < toolDatas.size(); ++i)
+	// Force using BX command, decoded into the preallocated frame and copied into the existing map entries
+	if (this->capi.getTrackingDataBX(this->trackingFrame))
 	{
-		this->toolDataMap.insert(toolDatas[i].transform.toolHandle, toolDatas[i]);
+		for (int i = 0; i < this->trackingFrame.numberOfTools; ++i)
+		{
+			const TrackingFrame::Tool &tool = this->trackingFrame.tools[i];
+			ToolData &toolData = this->toolDataMap[tool.transform.toolHandle];
+			toolData.transform = tool.transform;
+			toolData.portStatus = tool.portStatus;
+			toolData.frameNumber = tool.frameNumber;
+			toolData.systemStatus = this->trackingFrame.systemStatus;
+		}
 	}
 	this->toolDataMapLock.unlock();
 	emit this->trackerUpdatedImp();
@@ -0,0 +1,128 @@
+//----------------------------------------------------------------------------
+//
+//  CRC16 micro-benchmark: how many tracking replies per second can be validated.
+//
+//  Usage: CAPIcrcBenchmark [numberOfTools = 8] [seconds per method = 1]
+//
+//  A BX reply with numberOfTools tools carrying transform data is synthesized and, like
+//  CombinedApi::readBinaryReply(), its header CRC16 and its data CRC16 are verified over and
+//  over with the original per-byte SystemCRC loop, the 256-entry table and slice-by-8.
+//
+//----------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "Crc16.h"
+
+namespace
+{
+	//! The loop SystemCRC::calculateCRC16 used before Crc16, for reference
+	unsigned int referenceCRC16(const char* reply, int replyLength)
+	{
+		static unsigned int crcTable[256] = {0};
+		if (crcTable[1] == 0)
+		{
+			for (int i = 0; i < 256; i++)
+			{
+				long lCrcTable = i;
+				for (int j = 0; j < 8; j++)
+				{
+					lCrcTable = ( lCrcTable >> 1 ) ^ (( lCrcTable & 1 ) ? 0xA001L : 0 );
+				}
+				crcTable[i] = (unsigned int) lCrcTable & 0xFFFF;
+			}
+		}
+		unsigned int uCrc = 0;
+		for (int m = 0; m < replyLength ; m++)
+		{
+			uCrc = crcTable[ (uCrc ^ reply[m]) & 0xFF] ^ (uCrc >> 8);
+			uCrc &= 0xFFFF;
+		}
+		return uCrc;
+	}
+
+	void append16(std::vector<uint8_t>& reply, unsigned int value)
+	{
+		reply.push_back((uint8_t) (value & 0xFF));
+		reply.push_back((uint8_t) ((value >> 8) & 0xFF));
+	}
+
+	//! A BX 0801 reply: header, handle count, per tool handle + status + 8 floats + port status + frame, system status, CRC
+	std::vector<uint8_t> makeReply(int numberOfTools)
+	{
+		std::vector<uint8_t> body;
+		body.push_back((uint8_t) numberOfTools);
+		for (int t = 0; t < numberOfTools; t++)
+		{
+			body.push_back((uint8_t) (t + 1));
+			body.push_back(0x01);
+			for (int i = 0; i < 32 + 8; i++)
+			{
+				body.push_back((uint8_t) std::rand());
+			}
+		}
+		append16(body, 0);
+
+		std::vector<uint8_t> reply;
+		append16(reply, 0xA5C4);
+		append16(reply, (unsigned int) body.size());
+		append16(reply, Crc16::calculate(&reply[0], 4));
+		reply.insert(reply.end(), body.begin(), body.end());
+		append16(reply, Crc16::calculate(&body[0], body.size()));
+		return reply;
+	}
+
+	//! Validates the reply like CombinedApi::readBinaryReply()
+	template <typename CRC>
+	bool validate(const std::vector<uint8_t>& reply, CRC crc)
+	{
+		const size_t length = reply[2] | (reply[3] << 8);
+		return crc(&reply[0], 4) == (unsigned int) (reply[4] | (reply[5] << 8))
+			&& crc(&reply[6], length) == (unsigned int) (reply[6 + length] | (reply[7 + length] << 8));
+	}
+
+	template <typename CRC>
+	void run(const char* name, const std::vector<uint8_t>& reply, double seconds, CRC crc)
+	{
+		typedef std::chrono::steady_clock Clock;
+		const Clock::time_point start = Clock::now();
+		long long frames = 0;
+		long long failures = 0;
+		double elapsed = 0.0;
+		do
+		{
+			for (int i = 0; i < 10000; i++)
+			{
+				failures += validate(reply, crc) ? 0 : 1;
+			}
+			frames += 10000;
+			elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+		} while (elapsed < seconds);
+
+		const double framesPerSecond = frames / elapsed;
+		std::cout << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(0)
+				  << std::setw(12) << framesPerSecond << " frames/s  "
+				  << std::setprecision(1) << std::setw(8) << framesPerSecond * reply.size() / 1.0e6 << " MB/s"
+				  << (failures > 0 ? "  CRC MISMATCH" : "") << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const int numberOfTools = argc > 1 ? std::atoi(argv[1]) : 8;
+	const double seconds = argc > 2 ? std::atof(argv[2]) : 1.0;
+	const std::vector<uint8_t> reply = makeReply(numberOfTools);
+	std::cout << "BX reply with " << numberOfTools << " tools: " << reply.size() << " bytes" << std::endl;
+
+	run("per byte", reply, seconds, [](const uint8_t* data, size_t length)
+		{ return referenceCRC16((const char*) data, (int) length); });
+	run("table", reply, seconds, [](const uint8_t* data, size_t length)
+		{ return (unsigned int) Crc16::updateBytewise(0, data, length); });
+	run("slice-by-8", reply, seconds, [](const uint8_t* data, size_t length)
+		{ return (unsigned int) Crc16::update(0, data, length); });
+	return 0;
+}
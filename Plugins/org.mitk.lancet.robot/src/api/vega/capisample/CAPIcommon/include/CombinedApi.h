@@ -54,8 +54,10 @@
 
 #include "PortHandleInfo.h"
 #include "ToolData.h"
+#include "TrackingFrame.h"
 
 // Forward declarations
+class BufferedReader;
 class Connection;
 class SystemCRC;
 
@@ -280,6 +282,47 @@ public:
 	 */
 	std::vector<ToolData> getTrackingDataBX2(std::string options = "--6d=tools --3d=all --sensor=all --1d=buttons") const;
 
+	/**
+	 * @brief Retrieves binary tracking data using BX and decodes the transforms into frame.
+	 * @details The reply is read in two bulk reads into a buffer reused from call to call, the CRCs are
+	 *          verified in place and no memory is allocated once the buffer has grown to the reply size.
+	 * @param frame Receives the tools of the reply, it is cleared first.
+	 * @param options TrackingReplyOption flags, only TransformData and AllTransforms can be decoded.
+	 * @returns True if a valid reply was decoded.
+	 */
+	bool getTrackingDataBX(TrackingFrame& frame, const uint16_t options = TrackingReplyOption::TransformData | TrackingReplyOption::AllTransforms) const;
+
+	/**
+	 * @brief Retrieves binary tracking data using BX2 and decodes the 6D data into frame, see getTrackingDataBX(TrackingFrame&).
+	 * @param frame Receives the tools that have new data since the last BX2, it is cleared first.
+	 * @param options The BX2 options, 3D, button and alert data is skipped.
+	 * @returns True if a valid reply was decoded.
+	 */
+	bool getTrackingDataBX2(TrackingFrame& frame, std::string options = "--6d=tools") const;
+
+	/**
+	 * @brief Makes the device push the reply of command continuously using STREAM.
+	 * @details Once streaming, read the replies with readStreamedFrame() instead of polling with BX2.
+	 *          Other commands may still be sent, their replies are interleaved with the stream.
+	 * @param command The command to stream, a BX2 command for readStreamedFrame().
+	 * @param streamId The name of the stream, used to stop it.
+	 * @returns Zero for success, or the error code associated with the command.
+	 */
+	int startStreaming(std::string command = "BX2 --6d=tools", std::string streamId = "capi") const;
+
+	/**
+	 * @brief Stops a stream started by startStreaming() using USTREAM.
+	 * @details Streamed replies sent before the device received the command are discarded.
+	 * @returns Zero for success, or the error code associated with the command.
+	 */
+	int stopStreaming(std::string streamId = "capi") const;
+
+	/**
+	 * @brief Blocks until the device pushes the next streamed BX2 reply and decodes its 6D data into frame.
+	 * @returns True if a valid streamed reply was decoded.
+	 */
+	bool readStreamedFrame(TrackingFrame& frame) const;
+
 	/**
 	 * @brief  Converts the input string to an integer
 	 * @param input A string containing a hexadecimal number to convert to its integer equivalent.
@@ -317,9 +360,17 @@ private:
 
 	/**
 	 * @brief Reads the response from the device, and verifies the CRC.
+	 * @param response The beginning of the response if it was already read from the connection.
 	 * @returns The response as a std::string with trailing CR + CRC16 removed.
 	 */
-	std::string readResponse() const;
+	std::string readResponse(std::string response = std::string("")) const;
+
+	/**
+	 * @brief Reads a complete binary reply into binaryReader_ and verifies both of its CRC16s in place.
+	 * @param startSequence Receives the start sequence of the reply.
+	 * @returns True if the reply was read and is valid. The reader is then positioned after the 6 byte header.
+	 */
+	bool readBinaryReply(uint16_t& startSequence) const;
 
 	/**
 	 * @brief Converts the input integer to a string in decimal
@@ -345,6 +396,9 @@ private:
 	//! This member validates CRC16s sent along with the data
 	SystemCRC* crcValidator_;
 
+	//! Reused for every binary reply, so its buffer does not need to be allocated each frame
+	BufferedReader* binaryReader_;
+
 	//! The carriage return character is important for terminating ASCII replies
 	static const char CR = '\r';
 
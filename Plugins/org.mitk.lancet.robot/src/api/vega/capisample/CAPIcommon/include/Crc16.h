@@ -0,0 +1,97 @@
+#ifndef CRC16_HPP
+#define CRC16_HPP
+
+#include <stddef.h> // for size_t
+#include <stdint.h> // for uint8_t etc...
+
+/**
+ * @brief Header-only CRC16 (polynomial X^16 + X^15 + X^2 + 1, reflected, initial value 0) as used by
+ *        NDI devices and the robot protocols, the same value SystemCRC computes.
+ * @details update() processes eight bytes per step with slice-by-8 tables (8 x 256 entries, built once
+ *          on first use), updateBytewise() is the classic one-table loop. Neither depends on the rest of
+ *          the CAPI, so any protocol stack can include this header.
+ */
+class Crc16
+{
+public:
+	/**
+	 * @brief Calculates the CRC16 of length bytes.
+	 */
+	static uint16_t calculate(const void* data, size_t length)
+	{
+		return update(0, data, length);
+	}
+
+	/**
+	 * @brief Continues the CRC16 crc over length more bytes, slice-by-8.
+	 */
+	static uint16_t update(uint16_t crc, const void* data, size_t length)
+	{
+		const uint16_t (*t)[256] = tables().t;
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		while (length >= 8)
+		{
+			// The first two bytes absorb the running CRC, the other six only go through their tables
+			const uint16_t low = crc ^ (uint16_t)(bytes[0] | (bytes[1] << 8));
+			crc = t[7][low & 0xFF] ^ t[6][low >> 8]
+				^ t[5][bytes[2]] ^ t[4][bytes[3]] ^ t[3][bytes[4]]
+				^ t[2][bytes[5]] ^ t[1][bytes[6]] ^ t[0][bytes[7]];
+			bytes += 8;
+			length -= 8;
+		}
+		while (length-- > 0)
+		{
+			crc = t[0][(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+		}
+		return crc;
+	}
+
+	/**
+	 * @brief Continues the CRC16 crc over length more bytes, one table lookup per byte.
+	 */
+	static uint16_t updateBytewise(uint16_t crc, const void* data, size_t length)
+	{
+		const uint16_t* t = tables().t[0];
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		while (length-- > 0)
+		{
+			crc = t[(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+		}
+		return crc;
+	}
+
+private:
+	struct Tables
+	{
+		Tables()
+		{
+			for (int i = 0; i < 256; i++)
+			{
+				uint16_t crc = (uint16_t) i;
+				for (int j = 0; j < 8; j++)
+				{
+					crc = (crc >> 1) ^ ((crc & 1) ? 0xA001 : 0);
+				}
+				t[0][i] = crc;
+			}
+			// t[k][i]: CRC of byte i followed by k zero bytes
+			for (int k = 1; k < 8; k++)
+			{
+				for (int i = 0; i < 256; i++)
+				{
+					t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+				}
+			}
+		}
+
+		uint16_t t[8][256];
+	};
+
+	static const Tables& tables()
+	{
+		static const Tables instance;
+		return instance;
+	}
+};
+
+#endif // CRC16_HPP
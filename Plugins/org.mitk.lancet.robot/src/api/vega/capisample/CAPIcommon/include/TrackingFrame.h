@@ -0,0 +1,88 @@
+#ifndef TRACKING_FRAME_HPP
+#define TRACKING_FRAME_HPP
+
+// Expose classes/methods as public in the library by using the tag 'CAPICOMMON_API'
+#ifdef _WIN32
+	#ifdef CAPICOMMON_EXPORTS
+		#define CAPICOMMON_API __declspec(dllexport)
+	#else
+		#define CAPICOMMON_API __declspec(dllimport)
+	#endif
+#else
+	#define CAPICOMMON_API __attribute__ ((visibility ("default")))
+#endif
+
+#include <stdint.h> // for uint8_t etc...
+
+#include "Transform.h"
+
+/**
+ * @brief The tool transforms of one BX, BX2 or streamed reply, decoded in place.
+ * @details Unlike std::vector<ToolData>, a TrackingFrame has a fixed capacity and holds no
+ *          heap memory, so the same object can be filled frame after frame without allocating.
+ */
+class CAPICOMMON_API TrackingFrame
+{
+public:
+	//! The number of tools a frame can hold, further tools in a reply are dropped
+	static const int MAX_TOOLS = 32;
+
+	/**
+	 * @brief The 6D data of a single tool and the frame it was measured in.
+	 */
+	struct Tool
+	{
+		//! The transform, check Transform::isMissing() before using it
+		Transform transform;
+
+		//! The status of the tool (BX only)
+		uint32_t portStatus;
+
+		//! The frame number that identifies when the data was collected
+		uint32_t frameNumber;
+
+		//! Indicates what type of frame gathered the data (BX2 only), see FrameType
+		uint8_t frameType;
+
+		//! The timestamp of the frame (BX2 only)
+		uint32_t timespec_s;
+		uint32_t timespec_ns;
+	};
+
+	TrackingFrame() : numberOfTools(0), systemStatus(0) {}
+
+	//! Empties the frame before decoding the next reply
+	void clear()
+	{
+		numberOfTools = 0;
+		systemStatus = 0;
+	}
+
+	//! Returns the next free tool, or NULL if the frame is full
+	Tool* addTool()
+	{
+		if (numberOfTools >= MAX_TOOLS)
+		{
+			return NULL;
+		}
+		Tool& tool = tools[numberOfTools++];
+		tool.transform = Transform();
+		tool.portStatus = 0;
+		tool.frameNumber = 0;
+		tool.frameType = 0;
+		tool.timespec_s = 0;
+		tool.timespec_ns = 0;
+		return &tool;
+	}
+
+	//! The number of valid entries in tools
+	int numberOfTools;
+
+	//! The status of the measurement device itself (BX only)
+	uint16_t systemStatus;
+
+	//! The decoded tools, in the order of the reply
+	Tool tools[MAX_TOOLS];
+};
+
+#endif // TRACKING_FRAME_HPP
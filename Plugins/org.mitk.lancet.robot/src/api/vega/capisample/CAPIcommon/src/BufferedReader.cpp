@@ -44,6 +44,12 @@ BufferedReader::BufferedReader(Connection* connection)
 	currentIndex_ = 0;
 }
 
+void BufferedReader::reset()
+{
+	buffer_.clear();
+	currentIndex_ = 0;
+}
+
 std::string BufferedReader::toString() const
 {
 	std::stringstream stream;
@@ -62,22 +68,38 @@ std::string BufferedReader::getData(size_t start, size_t length) const
 	std::string retVal = "";
 	if ((start + length) <= buffer_.size())
 	{
-		for (size_t i = start; i < (start + length); i++)
-		{
-			retVal += (char) buffer_[i];
-		}
+		retVal.assign((const char*) &buffer_[start], length);
 	}
 	return retVal;
 }
 
-void BufferedReader::readBytes(int numBytes)
+const byte_t* BufferedReader::data(size_t start) const
+{
+	return buffer_.data() + start;
+}
+
+size_t BufferedReader::size() const
 {
-	byte_t buffer = 0x00;
-	while (numBytes-- > 0)
+	return buffer_.size();
+}
+
+bool BufferedReader::readBytes(int numBytes)
+{
+	// Read straight into the end of the buffer, a read may return fewer bytes than requested
+	size_t offset = buffer_.size();
+	buffer_.resize(offset + numBytes);
+	while (numBytes > 0)
 	{
-		connection_->read(&buffer, 1);
-		buffer_.push_back(buffer);
+		int bytesRead = connection_->read(&buffer_[offset], numBytes);
+		if (bytesRead <= 0)
+		{
+			buffer_.resize(offset);
+			return false;
+		}
+		offset += bytesRead;
+		numBytes -= bytesRead;
 	}
+	return true;
 }
 
 void BufferedReader::skipBytes(int numBytes)
@@ -51,10 +51,12 @@ CombinedApi::CombinedApi()
 {
 	connection_ = NULL;
 	crcValidator_ = new SystemCRC();
+	binaryReader_ = NULL;
 }
 
 CombinedApi::~CombinedApi()
 {
+	delete binaryReader_;
 	delete connection_;
 	delete crcValidator_;
 }
@@ -103,6 +105,10 @@ int CombinedApi::connect(std::string hostname)
 		errorCode = connection_->isConnected() ? 0 : -1;
 	}
 
+	// Binary replies are read by a single reader that keeps its buffer between replies
+	delete binaryReader_;
+	binaryReader_ = new BufferedReader(connection_);
+
 	return errorCode;
 }
 
@@ -373,111 +379,105 @@ std::string CombinedApi::getTrackingDataTX(const uint16_t options) const
 
 std::vector<ToolData> CombinedApi::getTrackingDataBX(const uint16_t options) const
 {
-	// Send the BX command
-	std::string command =  std::string("BX ").append(intToHexString(options, 4));
-	sendCommand(command);
-
-	// Open a buffered reader on the connection to easily parse the binary reply
-	BufferedReader reader(connection_);
-	reader.readBytes(6);
-	uint16_t startSequence = reader.get_uint16();
-	uint16_t replyLengthBytes = reader.get_uint16();
-
-	// Verify the CRC16 of the header
-	unsigned int headerCRC16 = (unsigned int) reader.get_uint16();
-	unsigned int calculatedCRC16 = crcValidator_->calculateCRC16(reader.getData(0, 4).c_str(), 4);
-	if (calculatedCRC16 != headerCRC16)
+	// Decode the reply, then copy the tools into ToolData objects
+	std::vector<ToolData> toolDataVector;
+	TrackingFrame frame;
+	if (!getTrackingDataBX(frame, options))
 	{
-		std::cout << "CRC16 failed!" << std::endl;
-		return std::vector<ToolData>();
+		return toolDataVector;
 	}
 
-	// In the case of an unexpected binary header, return an empty vector
-	if (startSequence != START_SEQUENCE)
+	for (int t = 0; t < frame.numberOfTools; t++)
 	{
-		std::cout << "Unrecognized start sequence: " << startSequence << std::endl;
-		return std::vector<ToolData>();
+		toolDataVector.push_back(ToolData());
+		toolDataVector.back().transform = frame.tools[t].transform;
+		toolDataVector.back().portStatus = frame.tools[t].portStatus;
+		toolDataVector.back().frameNumber = frame.tools[t].frameNumber;
+		toolDataVector.back().systemStatus = frame.systemStatus;
 	}
 
-	// Get all of the data once we know how many bytes to read: replyLengthBytes + 2 bytes for trailing CRC16
-	reader.readBytes(replyLengthBytes + 2);
+	// Return the tool data
+	return toolDataVector;
+}
 
-	// Verify the CRC16 of the data
-	reader.skipBytes(replyLengthBytes);
-	unsigned int dataCRC16 = reader.get_uint16();
-	if (crcValidator_->calculateCRC16(reader.getData(6, replyLengthBytes).c_str(), replyLengthBytes) != dataCRC16)
+bool CombinedApi::getTrackingDataBX(TrackingFrame& frame, const uint16_t options) const
+{
+	frame.clear();
+
+	// TODO: support all BX options. Just return if there are unexpected options, we would be binary misaligned anyway.
+	if ((options & ~(TrackingReplyOption::TransformData | TrackingReplyOption::AllTransforms)) != 0x0000)
 	{
-		std::cout << "CRC16 failed!" << std::endl;
-		return std::vector<ToolData>();
+		std::cout << "Reply parsing has not implemented options: " << intToHexString(options, 4) << std::endl;
+		return false;
 	}
-	reader.skipBytes(-replyLengthBytes -2); // move the BufferedReader's pointer back so we can parse the data
 
-	// Debugging: print the raw binary and/or interpreted strings
-	/*std::cout << reader.toString() << std::endl;
-	std::cout << "startSequence=" << intToHexString(startSequence, 4) << std::endl
-		   << "replyLengthBytes=" << intToHexString(replyLengthBytes, 4) << std::endl
-		   << "headerCRC16=" << intToHexString(headerCRC16, 4) << std::endl;*/
+	// Send the BX command
+	std::string command =  std::string("BX ").append(intToHexString(options, 4));
+	sendCommand(command);
 
-	// TODO: support all BX options. Just return if there are unexpected options, we will be binary misaligned anyway.
-	if ((options & ~(TrackingReplyOption::TransformData | TrackingReplyOption::AllTransforms)) != 0x0000)
+	// Read the whole reply and verify its CRCs
+	uint16_t startSequence = 0;
+	if (!readBinaryReply(startSequence))
 	{
-		std::cout << "Reply parsing has not implemented options: " << intToHexString(options, 4) << std::endl;
-		return std::vector<ToolData>();
+		return false;
 	}
 
-	std::vector<ToolData> toolDataVector;
+	// In the case of an unexpected binary header, return an empty frame
+	if (startSequence != START_SEQUENCE)
+	{
+		std::cout << "Unrecognized start sequence: " << startSequence << std::endl;
+		return false;
+	}
+
+	// Tools that do not fit into the frame are still read to stay aligned
+	BufferedReader& reader = *binaryReader_;
+	TrackingFrame::Tool overflow;
 	uint8_t numHandles = reader.get_byte();
 	for (uint8_t i = 0; i < numHandles; i++)
 	{
-		// Create a new ToolData
-		toolDataVector.push_back(ToolData());
-
 		// From each two byte handle, extract the handle index and status
-		toolDataVector.back().transform.toolHandle = (uint16_t) reader.get_byte();
+		uint16_t toolHandle = (uint16_t) reader.get_byte();
 		uint8_t handleStatus = reader.get_byte();
 
+		// Disabled markers have no transform, status, or frame number: don't return a tool for it
+		if (handleStatus == 0x04)
+		{
+			continue;
+		}
+
+		TrackingFrame::Tool* tool = frame.addTool();
+		if (tool == NULL)
+		{
+			tool = &overflow;
+		}
+		tool->transform.toolHandle = toolHandle;
+
 		// Parse BX 0001 - See API guide for protocol details
 		if (options & TrackingReplyOption::TransformData)
 		{
 			// The transform is not transmitted at all if it is missing
-			switch (handleStatus)
+			if (handleStatus == 0x01) // Valid
 			{
-				case 0x01: // Valid
-					toolDataVector.back().transform.status = TransformStatus::Enabled;
-					toolDataVector.back().transform.q0 = reader.get_double();
-					toolDataVector.back().transform.qx = reader.get_double();
-					toolDataVector.back().transform.qy = reader.get_double();
-					toolDataVector.back().transform.qz = reader.get_double();
-					toolDataVector.back().transform.tx = reader.get_double();
-					toolDataVector.back().transform.ty = reader.get_double();
-					toolDataVector.back().transform.tz = reader.get_double();
-					toolDataVector.back().transform.error = reader.get_double();
-				break;
-				case 0x04: // Disabled
-					// Disabled markers have no transform, status, or frame number
-					toolDataVector.pop_back(); // don't return a ToolData for it, there's nothing there
-					continue;
-				default:
-					// case 0x02: Missing or anything unexpected
-					// do nothing --> blank Transform object is already initialized as missing
-				break;
-			};
+				tool->transform.status = TransformStatus::Enabled;
+				tool->transform.q0 = reader.get_double();
+				tool->transform.qx = reader.get_double();
+				tool->transform.qy = reader.get_double();
+				tool->transform.qz = reader.get_double();
+				tool->transform.tx = reader.get_double();
+				tool->transform.ty = reader.get_double();
+				tool->transform.tz = reader.get_double();
+				tool->transform.error = reader.get_double();
+			}
+			// case 0x02: Missing or anything unexpected --> the Transform is already initialized as missing
 
 			// Regardless of transform status, there is info about the port and frame
-			toolDataVector.back().portStatus = reader.get_uint32() & 0x0000FFFF;
-			toolDataVector.back().frameNumber = reader.get_uint32();
+			tool->portStatus = reader.get_uint32() & 0x0000FFFF;
+			tool->frameNumber = reader.get_uint32();
 		}
 	}
 
-	// Add the systemStatus to each ToolData
-	uint16_t systemStatus = reader.get_uint16();
-	for (int t = 0; t < toolDataVector.size(); t++)
-	{
-		toolDataVector[t].systemStatus = systemStatus;
-	}
-
-	// Return the tool data
-	return toolDataVector;
+	frame.systemStatus = reader.get_uint16();
+	return true;
 }
 
 std::vector<ToolData> CombinedApi::getTrackingDataBX2(std::string options) const
@@ -486,23 +486,10 @@ std::vector<ToolData> CombinedApi::getTrackingDataBX2(std::string options) const
 	std::string command =  std::string("BX2 ").append(options);
 	sendCommand(command);
 
-	// Open a buffered reader on the connection to easily parse the binary reply
-	BufferedReader reader(connection_);
-
-	// The BX2 reply begins with a 6 byte header:
-	// (2-bytes) StartSequence: indicates how to parse the reply. A5C4 (normal)
-	// (2-bytes) ReplyLength: length of the reply in bytes
-	// (2-bytes) CRC16
-	reader.readBytes(6);
-	uint16_t startSequence = reader.get_uint16();
-	uint16_t replyLengthBytes = reader.get_uint16();
-
-	// Verify the CRC16 of the header
-	unsigned int headerCRC16 = (unsigned int) reader.get_uint16();
-	unsigned int calculatedCRC16 = crcValidator_->calculateCRC16(reader.getData(0, 4).c_str(), 4);
-	if (calculatedCRC16 != headerCRC16)
+	// Read the whole reply and verify its CRCs
+	uint16_t startSequence = 0;
+	if (!readBinaryReply(startSequence))
 	{
-		std::cout << "CRC16 failed!" << std::endl;
 		return std::vector<ToolData>();
 	}
 
@@ -514,30 +501,8 @@ std::vector<ToolData> CombinedApi::getTrackingDataBX2(std::string options) const
 		return std::vector<ToolData>();
 	}
 
-	// Get all of the data once we know how many bytes to read: replyLengthBytes + 2 bytes for trailing CRC16
-	reader.readBytes(replyLengthBytes + 2);
-
-	// Verify the CRC16 of the data
-	reader.skipBytes(replyLengthBytes);
-	unsigned int dataCRC16 = reader.get_uint16();
-	if (crcValidator_->calculateCRC16(reader.getData(6, replyLengthBytes).c_str(), replyLengthBytes) != dataCRC16)
-	{
-		std::cout << "CRC16 failed!" << std::endl;
-		return std::vector<ToolData>();
-	}
-	reader.skipBytes(-replyLengthBytes -2); // move the BufferedReader's pointer back so we can parse the data
-
 	// Parse the binary into meaningful objects
-	GbfContainer container(reader);
-
-	// Debugging: print the raw binary and/or interpreted strings
-	/*std::cout << reader.toString() << std::endl;
-	std::cout << "-----GbfHeader" << std::endl
-		      << "startSequence=" << std::setw(4) << static_cast<unsigned>(startSequence) << std::endl
-		      << "replyLengthBytes=" << std::setw(4) << static_cast<unsigned>(replyLengthBytes) << std::endl
-		      << "headerCRC16=" << std::setw(4) << static_cast<unsigned>(headerCRC) << std::endl
-		      << container.toString()
-		      << "dataCRC16=" << std::setw(4) << static_cast<unsigned>(reader.get_uint16()) << std::endl << std::endl;*/
+	GbfContainer container(*binaryReader_);
 
 	// Search the root GbfContainer to find the frame component
 	std::vector<ToolData> retVal;
@@ -555,6 +520,145 @@ std::vector<ToolData> CombinedApi::getTrackingDataBX2(std::string options) const
 	return retVal;
 }
 
+bool CombinedApi::getTrackingDataBX2(TrackingFrame& frame, std::string options) const
+{
+	frame.clear();
+
+	// Send the BX2 command
+	std::string command =  std::string("BX2 ").append(options);
+	sendCommand(command);
+
+	// Read the whole reply and verify its CRCs
+	uint16_t startSequence = 0;
+	if (!readBinaryReply(startSequence))
+	{
+		return false;
+	}
+	if (startSequence != START_SEQUENCE)
+	{
+		std::cout << "Unrecognized BX2 reply header: " << std::setw(4) << startSequence << " - Not implemented yet!" << std::endl;
+		return false;
+	}
+
+	GbfContainer::decodeTransforms(*binaryReader_, frame, TrackingFrame::Tool());
+	return true;
+}
+
+int CombinedApi::startStreaming(std::string command, std::string streamId) const
+{
+	// Send the STREAM command
+	std::string streamCommand = std::string("STREAM --id=").append(streamId).append(" --cmd=\"").append(command).append("\"");
+	sendCommand(streamCommand);
+	return getErrorCodeFromResponse(readResponse());
+}
+
+int CombinedApi::stopStreaming(std::string streamId) const
+{
+	// Send the USTREAM command
+	std::string command = std::string("USTREAM --id=").append(streamId);
+	sendCommand(command);
+
+	// Streamed replies may still arrive before the ASCII reply, skip them
+	while (binaryReader_ != NULL)
+	{
+		binaryReader_->reset();
+		if (!binaryReader_->readBytes(2))
+		{
+			return -1;
+		}
+		if (binaryReader_->get_uint16() != START_SEQUENCE_STREAMING)
+		{
+			// These two bytes are the start of the ASCII reply
+			return getErrorCodeFromResponse(readResponse(binaryReader_->getData(0, 2)));
+		}
+		binaryReader_->readBytes(4);
+		binaryReader_->get_uint16();
+		uint16_t replyLengthBytes = binaryReader_->get_uint16();
+		binaryReader_->readBytes(replyLengthBytes + 2);
+	}
+	return -1;
+}
+
+bool CombinedApi::readStreamedFrame(TrackingFrame& frame) const
+{
+	frame.clear();
+
+	uint16_t startSequence = 0;
+	if (!readBinaryReply(startSequence))
+	{
+		return false;
+	}
+	if (startSequence != START_SEQUENCE_STREAMING)
+	{
+		std::cout << "Unrecognized streaming reply header: " << std::setw(4) << startSequence << std::endl;
+		return false;
+	}
+
+	// A streamed reply carries the NUL terminated stream id followed by the reply of the streamed command.
+	// If that reply has its own header, skip it: the CRC of the streamed reply already covers it.
+	BufferedReader& reader = *binaryReader_;
+	while (reader.get_byte() != 0x00)
+	{
+	}
+	if (reader.get_uint16() == START_SEQUENCE)
+	{
+		reader.skipBytes(4);
+	}
+	else
+	{
+		reader.skipBytes(-2);
+	}
+
+	GbfContainer::decodeTransforms(reader, frame, TrackingFrame::Tool());
+	return true;
+}
+
+bool CombinedApi::readBinaryReply(uint16_t& startSequence) const
+{
+	if (binaryReader_ == NULL)
+	{
+		std::cout << "Cannot read reply - No open connection!" << std::endl;
+		return false;
+	}
+
+	// The binary reply begins with a 6 byte header:
+	// (2-bytes) StartSequence: indicates how to parse the reply. A5C4 (normal)
+	// (2-bytes) ReplyLength: length of the reply in bytes
+	// (2-bytes) CRC16
+	BufferedReader& reader = *binaryReader_;
+	reader.reset();
+	if (!reader.readBytes(6))
+	{
+		return false;
+	}
+	startSequence = reader.get_uint16();
+	uint16_t replyLengthBytes = reader.get_uint16();
+
+	// Verify the CRC16 of the header
+	unsigned int headerCRC16 = (unsigned int) reader.get_uint16();
+	if (crcValidator_->calculateCRC16((const char*) reader.data(0), 4) != headerCRC16)
+	{
+		std::cout << "CRC16 failed!" << std::endl;
+		return false;
+	}
+
+	// Get all of the data once we know how many bytes to read: replyLengthBytes + 2 bytes for trailing CRC16
+	if (!reader.readBytes(replyLengthBytes + 2))
+	{
+		return false;
+	}
+
+	// Verify the CRC16 of the data where it lies in the buffer
+	const byte_t* dataCRC16Bytes = reader.data(6 + replyLengthBytes);
+	unsigned int dataCRC16 = dataCRC16Bytes[0] | (dataCRC16Bytes[1] << 8);
+	if (crcValidator_->calculateCRC16((const char*) reader.data(6), replyLengthBytes) != dataCRC16)
+	{
+		std::cout << "CRC16 failed!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
 std::string CombinedApi::intToString(int input, int width) const
 {
 	std::stringstream convert;
@@ -597,11 +701,10 @@ int CombinedApi::getErrorCodeFromResponse(std::string response) const
 	return errorCode * -1;
 }
 
-std::string CombinedApi::readResponse() const
+std::string CombinedApi::readResponse(std::string response) const
 {
-	// Declare an empty string to hold the response
-	std::string response = std::string("");
-	char lastChar = '\0';
+	// The response may already hold its first characters
+	char lastChar = response.empty() ? '\0' : response[response.size() - 1];
 
 	// Read from the device until we encounter a terminating carriage return (CR)
 	while (lastChar != CR)
@@ -38,6 +38,7 @@
 #include <sstream>
 
 #include "GbfContainer.h"
+#include "GbfData6D.h"
 
 GbfContainer::GbfContainer(BufferedReader& reader)
 {
@@ -53,6 +54,66 @@ GbfContainer::GbfContainer(BufferedReader& reader)
 	}
 }
 
+void GbfContainer::decodeTransforms(BufferedReader& reader, TrackingFrame& frame, const TrackingFrame::Tool& frameInfo)
+{
+	reader.get_uint16(); // gbfVersion
+	uint16_t count = reader.get_uint16();
+	for ( uint16_t i = 0; i < count; i++ )
+	{
+		// Same component header as GbfComponent::buildComponent()
+		uint16_t componentType = reader.get_uint16();
+		uint32_t componentSize = reader.get_uint32();
+		reader.get_uint16(); // itemOption
+		uint32_t itemCount = reader.get_uint32();
+
+		if (componentType == GbfComponentType::Frame)
+		{
+			// Same layout as GbfFrameDataItem, followed by its own container
+			for ( uint32_t item = 0; item < itemCount; item++ )
+			{
+				TrackingFrame::Tool itemInfo = frameInfo;
+				itemInfo.frameType = reader.get_byte();
+				reader.get_byte(); // frameSequenceIndex
+				reader.get_uint16(); // frameStatus
+				itemInfo.frameNumber = reader.get_uint32();
+				itemInfo.timespec_s = reader.get_uint32();
+				itemInfo.timespec_ns = reader.get_uint32();
+				decodeTransforms(reader, frame, itemInfo);
+			}
+		}
+		else if (componentType == GbfComponentType::Data6D)
+		{
+			for ( uint32_t item = 0; item < itemCount; item++ )
+			{
+				Transform data6D;
+				GbfData6D::readTransform(reader, data6D);
+
+				// Like GbfFrame::getToolData(), a tool appears once
+				TrackingFrame::Tool* tool = NULL;
+				for ( int t = 0; t < frame.numberOfTools; t++ )
+				{
+					if (frame.tools[t].transform.toolHandle == data6D.toolHandle)
+					{
+						tool = &frame.tools[t];
+						break;
+					}
+				}
+				if (tool == NULL && (tool = frame.addTool()) == NULL)
+				{
+					continue;
+				}
+				*tool = frameInfo;
+				tool->transform = data6D;
+			}
+		}
+		else
+		{
+			// Skip the component minus the 12 byte header we just read
+			reader.skipBytes(componentSize - 12);
+		}
+	}
+}
+
 GbfContainer::~GbfContainer()
 {
 	for ( int i = 0; i < components.size(); i++)
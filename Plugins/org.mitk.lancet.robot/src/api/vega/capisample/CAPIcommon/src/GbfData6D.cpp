@@ -44,35 +44,40 @@ GbfData6D::GbfData6D(BufferedReader& reader, int numberOfTools)
 	for ( int i = 0; i < numberOfTools; i++)
 	{
 		Transform data6D;
-		data6D.toolHandle = reader.get_uint16();
-		data6D.status = reader.get_uint16();
-
-		if (data6D.isMissing())
-		{
-			data6D.q0 = BAD_FLOAT;
-			data6D.qx = BAD_FLOAT;
-			data6D.qy = BAD_FLOAT;
-			data6D.qz = BAD_FLOAT;
-			data6D.tx = BAD_FLOAT;
-			data6D.ty = BAD_FLOAT;
-			data6D.tz = BAD_FLOAT;
-			data6D.error = BAD_FLOAT;
-		}
-		else
-		{
-			data6D.q0 = reader.get_double();
-			data6D.qx = reader.get_double();
-			data6D.qy = reader.get_double();
-			data6D.qz = reader.get_double();
-			data6D.tx = reader.get_double();
-			data6D.ty = reader.get_double();
-			data6D.tz = reader.get_double();
-			data6D.error = reader.get_double();
-		}
+		readTransform(reader, data6D);
 		toolTransforms.push_back(data6D);
 	}
 }
 
+void GbfData6D::readTransform(BufferedReader& reader, Transform& data6D)
+{
+	data6D.toolHandle = reader.get_uint16();
+	data6D.status = reader.get_uint16();
+
+	if (data6D.isMissing())
+	{
+		data6D.q0 = BAD_FLOAT;
+		data6D.qx = BAD_FLOAT;
+		data6D.qy = BAD_FLOAT;
+		data6D.qz = BAD_FLOAT;
+		data6D.tx = BAD_FLOAT;
+		data6D.ty = BAD_FLOAT;
+		data6D.tz = BAD_FLOAT;
+		data6D.error = BAD_FLOAT;
+	}
+	else
+	{
+		data6D.q0 = reader.get_double();
+		data6D.qx = reader.get_double();
+		data6D.qy = reader.get_double();
+		data6D.qz = reader.get_double();
+		data6D.tx = reader.get_double();
+		data6D.ty = reader.get_double();
+		data6D.tz = reader.get_double();
+		data6D.error = reader.get_double();
+	}
+}
+
 std::string GbfData6D::toString() const
 {
 	std::stringstream stream;
@@ -36,6 +36,7 @@
 
 #include <stdio.h>
 
+#include "Crc16.h"
 #include "SystemCRC.h"
 
 unsigned int SystemCRC::crcTable_[256] = {0};
@@ -62,10 +63,6 @@ unsigned int SystemCRC::calcValue(unsigned int crc, int data) const
 
 unsigned int SystemCRC::calculateCRC16(const char* reply, int replyLength) const
 {
-	unsigned int uCrc = 0;
-	for (int m = 0; m < replyLength ; m++)
-	{
-		uCrc = calcValue(uCrc, reply[m]);
-	}
-	return uCrc;
+	// Same polynomial as crcTable_, eight bytes per step
+	return replyLength > 0 ? Crc16::calculate(reply, (size_t) replyLength) : 0;
 }
\ No newline at end of file
@@ -55,6 +55,12 @@ public:
 	 */
 	BufferedReader(Connection* connection);
 
+	/**
+	 * @brief Empties the buffer so the reader can be reused for the next reply.
+	 * @details The memory of the buffer is kept, so reading replies of similar size does not allocate.
+	 */
+	void reset();
+
 	/**
 	 * @brief Returns the contents of the buffer in hex with a fixed width of two characters.
 	 */
@@ -66,10 +72,21 @@ public:
 	std::string getData(size_t start, size_t length) const;
 
 	/**
-	 * @brief Reads a specified number of bytes from the connection.
+	 * @brief Returns a pointer into the buffer, valid until the next readBytes() or reset().
+	 */
+	const byte_t* data(size_t start = 0) const;
+
+	/**
+	 * @brief Returns the number of bytes read into the buffer.
+	 */
+	size_t size() const;
+
+	/**
+	 * @brief Reads a specified number of bytes from the connection with as few reads as possible.
 	 * @param numBytes The number of bytes to read.
+	 * @returns True if all bytes were read, false if the connection failed.
 	 */
-	void readBytes(int numBytes);
+	bool readBytes(int numBytes);
 
 	/**
 	 * @brief Move ahead in the buffer by a specified number of bytes.
@@ -40,6 +40,7 @@
 
 #include "BufferedReader.h"
 #include "GbfComponent.h"
+#include "TrackingFrame.h"
 
 /**
  * @brief The most basic GBF object stores only a version and the number of items to read.
@@ -63,6 +64,16 @@ public:
 	 */
 	std::string toString() const;
 
+	/**
+	 * @brief Decodes only the 6D data of a container straight into frame, without building components.
+	 * @details Walks the same structure as the constructor: frames and their frame data items are
+	 *          descended into, every other component type is skipped using its size.
+	 * @param reader The BufferedReader positioned at the start of the container.
+	 * @param frame The frame the tools are appended to. Later data of a tool handle replaces earlier data.
+	 * @param frameInfo The frame number, type and timestamp assigned to the tools found.
+	 */
+	static void decodeTransforms(BufferedReader& reader, TrackingFrame& frame, const TrackingFrame::Tool& frameInfo);
+
 	// Public member data
 	uint16_t gbfVersion;
 	uint16_t componentCount;
@@ -54,6 +54,11 @@ public:
 	 */
 	virtual std::string toString() const;
 
+	/**
+	 * @brief Reads the handle, status and, unless it is missing, the 6D of a single tool.
+	 */
+	static void readTransform(BufferedReader& reader, Transform& data6D);
+
 	// Public members
 	std::vector<Transform> toolTransforms;
 };
@@ -49,7 +49,7 @@ public:
 	virtual ~SystemCRC(){};
 
 	/**
-	 * @brief Calculates the CRC16 of the ASCII reply
+	 * @brief Calculates the CRC16 of the ASCII or binary reply, using the slice-by-8 tables of Crc16
 	 * @param reply The reply without its trailing CRC16 + CR
 	 * @param replyLength The length of the reply, including its trailing CRC
 	 * @returns The CRC16 of the reply
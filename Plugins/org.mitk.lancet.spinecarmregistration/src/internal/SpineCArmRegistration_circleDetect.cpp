@@ -551,7 +551,8 @@ int SpineCArmRegistration::on_pushButton_recursiveSearch_clicked()
 	clock_t start_time1 = clock();
 
 	auto resultPset = mitk::PointSet::New();
-	GM.FindAllGeoMatchModel(graySearchImg, minScore, greediness,
+	// one score map for all the balls instead of one full image scan per ball
+	GM.FindAllGeoMatchModelSinglePass(graySearchImg, minScore,
 		searchNum, x_spacing, y_spacing, steelballSize,
 		resultPset);
 
@@ -20,6 +20,8 @@ found in the LICENSE file.
 
 // Qt
 #include <QMessageBox>
+#include <QApplication>
+#include <QPointer>
 
 // mitk image
 #include <mitkImage.h>
@@ -573,12 +575,7 @@ void SurgicalSimulate::OnRobotCapture()
 	MITK_INFO << "TCP:" << tcp[0] << "," << tcp[1] << "," << tcp[2] << "," << tcp[3] << "," << tcp[4] << "," << tcp[5];
 	//set tcp to robot
 	  //set tcp
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("movel", QStringList{QString::number( tcp[0]),QString::number(tcp[1]),QString::number(tcp[2]),QString::number(tcp[3]),QString::number(tcp[4]),QString::number(tcp[5]) });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "11" });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "5" });
+	ApplyRobotTcp(tcp);
   }
 
 }
@@ -623,20 +620,21 @@ void SurgicalSimulate::OnAutoMove()
 	  MITK_INFO << "TCP:" << tcp[0] << "," << tcp[1] << "," << tcp[2] << "," << tcp[3] << "," << tcp[4] << "," << tcp[5];
 	  //set tcp to robot
 		//set tcp
-	  QThread::msleep(1000);
-	  m_KukaTrackingDevice->RequestExecOperate("movel", QStringList{ QString::number(tcp[0]),QString::number(tcp[1]),QString::number(tcp[2]),QString::number(tcp[3]),QString::number(tcp[4]),QString::number(tcp[5]) });
-	  QThread::msleep(1000);
-	  m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "11" });
-	  QThread::msleep(1000);
-	  m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "5" });
-
-	  // record the initial position into m_initial_robotBaseToFlange
-  	RecordInitial();
-
-    affine->Translate(plusY);
-    mitk::TransferItkTransformToVtkMatrix(affine.GetPointer(), vtkMatrix);
-
-    m_KukaTrackingDevice->RobotMove(vtkMatrix);
+	  // the move starts from the pose with the new tcp, so it continues once the robot applied it
+	  ApplyRobotTcp(tcp, [this, plusY]
+	  {
+		  // the pose read above is the one before the tcp changed, take the new one
+		  m_KukaSource->Update();
+		  // record the initial position into m_initial_robotBaseToFlange
+		  RecordInitial();
+
+		  mitk::AffineTransform3D::Pointer initial = m_KukaSource->GetOutput(0)->GetAffineTransform3D()->Clone();
+		  initial->Translate(plusY);
+		  vtkNew<vtkMatrix4x4> target;
+		  mitk::TransferItkTransformToVtkMatrix(initial.GetPointer(), target.GetPointer());
+
+		  m_KukaTrackingDevice->RobotMove(target.GetPointer());
+	  });
     break;
 
   case 2: //y - 75
@@ -1170,12 +1168,7 @@ void SurgicalSimulate::OnUsePreRobotRegitration()
 
 	//set tcp to robot
 	  //set tcp
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("movel", QStringList{ QString::number(tcp[0]),QString::number(tcp[1]),QString::number(tcp[2]),QString::number(tcp[3]),QString::number(tcp[4]),QString::number(tcp[5]) });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "11" });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "5" });
+	ApplyRobotTcp(tcp);
 
   m_KukaVisualizeTimer->stop();
   m_KukaVisualizer->ConnectTo(m_KukaApplyRegistrationFilter);
@@ -1199,12 +1192,7 @@ void SurgicalSimulate::OnUsePreRobotRegitration()
   MITK_INFO << "TCP:" << tcp[0] << "," << tcp[1] << "," << tcp[2] << "," << tcp[3] << "," << tcp[4] << "," << tcp[5];
   //set tcp to robot
 	//set tcp
-  QThread::msleep(1000);
-  m_KukaTrackingDevice->RequestExecOperate("movel", QStringList{ QString::number(tcp[0]),QString::number(tcp[1]),QString::number(tcp[2]),QString::number(tcp[3]),QString::number(tcp[4]),QString::number(tcp[5]) });
-  QThread::msleep(1000);
-  m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "11" });
-  QThread::msleep(1000);
-  m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "5" });
+  ApplyRobotTcp(tcp);
 }
 
 
@@ -2029,19 +2017,35 @@ vtkMatrix4x4* SurgicalSimulate::getVtkMatrix4x4(mitk::NavigationData::Pointer nd
 	return matrix;
 }
 
+bool SurgicalSimulate::ApplyRobotTcp(const double tcp[6], std::function<void()> applied)
+{
+	// the queue applies the tcp on its own thread, the GUI thread continues with applied once the robot did
+	QPointer<SurgicalSimulate> self(this);
+	auto callback = [self, applied](bool success)
+	{
+		QMetaObject::invokeMethod(qApp, [self, applied, success]
+		{
+			if (!success)
+			{
+				MITK_ERROR << "Robot tcp could not be applied";
+				return;
+			}
+			if (self && applied)
+				applied();
+		}, Qt::QueuedConnection);
+	};
+	auto result = m_KukaTrackingDevice->RequestExecOperateAsync("applytcpvalue", QStringList{ QString::number(tcp[0]),QString::number(tcp[1]),QString::number(tcp[2]),QString::number(tcp[3]),QString::number(tcp[4]),QString::number(tcp[5]) }, callback);
+	// only a rejected operation is resolved right away
+	return result.wait_for(std::chrono::seconds(0)) != std::future_status::ready || result.get();
+}
+
 bool SurgicalSimulate::ResetRobotTcp()
 {
 	double tcp[6]{ 0 };
 	MITK_INFO << "TCP:" << tcp[0] << "," << tcp[1] << "," << tcp[2] << "," << tcp[3] << "," << tcp[4] << "," << tcp[5];
 	//set tcp to robot
 	  //set tcp
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("movel", QStringList{ QString::number(tcp[0]),QString::number(tcp[1]),QString::number(tcp[2]),QString::number(tcp[3]),QString::number(tcp[4]),QString::number(tcp[5]) });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "11" });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "5" });
-	return true;
+	return ApplyRobotTcp(tcp);
 }
 
 bool SurgicalSimulate::SetPrecisionTestTcp()
@@ -2099,14 +2103,7 @@ bool SurgicalSimulate::SetPrecisionTestTcp()
 	MITK_INFO << "TCP:" << tcp[0] << "," << tcp[1] << "," << tcp[2] << "," << tcp[3] << "," << tcp[4] << "," << tcp[5];
 	//set tcp to robot
 	  //set tcp
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("movel", QStringList{ QString::number(tcp[0]),QString::number(tcp[1]),QString::number(tcp[2]),QString::number(tcp[3]),QString::number(tcp[4]),QString::number(tcp[5]) });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "11" });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "5" });
-
-	return true;
+	return ApplyRobotTcp(tcp);
 }
 
 // bool SurgicalSimulate::SetPlanePrecisionTestTcp()
@@ -2266,13 +2263,7 @@ bool SurgicalSimulate::SetPlanePrecisionTestTcp()
 	MITK_INFO << "TCP:" << tcp[0] << "," << tcp[1] << "," << tcp[2] << "," << tcp[3] << "," << tcp[4] << "," << tcp[5];
 	//set tcp to robot
 	  //set tcp
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("movel", QStringList{ QString::number(tcp[0]),QString::number(tcp[1]),QString::number(tcp[2]),QString::number(tcp[3]),QString::number(tcp[4]),QString::number(tcp[5]) });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "11" });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "5" });
-	return true;
+	return ApplyRobotTcp(tcp);
 }
 
 
@@ -2649,42 +2640,36 @@ void SurgicalSimulate::On_pushButton_a7_p_clicked()
 
 void SurgicalSimulate::on_pushButton_robotCube_clicked()
 {
-	QThread::msleep(1000);
 	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "16" });
 }
 
 void SurgicalSimulate::on_pushButton_robotTwoPts_clicked()
 {
-	QThread::msleep(1000);
 	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "17" });
 }
 
 void SurgicalSimulate::on_pushButton_robotEmergencyBrake_clicked()
 {
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "18" });
+	// the brake must not wait behind the queued motions
+	m_KukaTrackingDevice->ExecOperateNow("setworkmode", { "18" });
 }
 
 void SurgicalSimulate::on_pushButton_thaMaxSpace_clicked()
 {
-	QThread::msleep(1000);
 	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "9" });
 }
 
 void SurgicalSimulate::on_pushButton_thaEffectiveSpace_clicked()
 {
-	QThread::msleep(1000);
 	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "8" });
 }
 
 void SurgicalSimulate::on_pushButton_tkaMaxSpace_clicked()
 {
-	QThread::msleep(1000);
 	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "13" });
 }
 
 void SurgicalSimulate::on_pushButton_tkaEffectiveSpace_clicked()
 {
-	QThread::msleep(1000);
 	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "14" });
 }
\ No newline at end of file
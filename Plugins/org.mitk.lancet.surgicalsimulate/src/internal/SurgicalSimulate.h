@@ -243,6 +243,9 @@ protected:
   bool ResetRobotTcp();
   bool SetPrecisionTestTcp();
   bool SetPlanePrecisionTestTcp();
+  // Queues tcp (x, y, z, rz, ry, rx) on the robot without waiting, false if the operation was rejected.
+  // applied runs on the GUI thread once the robot applied the tcp, it is not called if that failed
+  bool ApplyRobotTcp(const double tcp[6], std::function<void()> applied = std::function<void()>());
 
 
 	// Move Kuka robot
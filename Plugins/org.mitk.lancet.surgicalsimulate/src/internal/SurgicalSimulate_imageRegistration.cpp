@@ -42,7 +42,7 @@ found in the LICENSE file.
 #include "mitkNodePredicateProperty.h"
 #include "QmitkDataStorageTreeModel.h"
 #include <QmitkSingleNodeSelectionWidget.h>
-#include <vtkImplicitPolyDataDistance.h>
+#include <surfaceDistanceCache.h>
 
 #include "lancetTreeCoords.h"
 
@@ -437,13 +437,7 @@ bool SurgicalSimulate::ApplySurfaceRegistration_staticImage()
 	MITK_INFO << "TCP:" << tcp[0] << "," << tcp[1] << "," << tcp[2] << "," << tcp[3] << "," << tcp[4] << "," << tcp[5];
 	//set tcp to robot
 	  //set tcp
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("movel", QStringList{ QString::number(tcp[0]),QString::number(tcp[1]),QString::number(tcp[2]),QString::number(tcp[3]),QString::number(tcp[4]),QString::number(tcp[5]) });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "11" });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "5" });
-	return true;
+	return ApplyRobotTcp(tcp);
 }
 
 bool SurgicalSimulate::ApplyPreexistingImageSurfaceRegistration_staticImage()
@@ -566,13 +560,7 @@ bool SurgicalSimulate::ApplyPreexistingImageSurfaceRegistration_staticImage()
 	MITK_INFO << "TCP:" << tcp[0] << "," << tcp[1] << "," << tcp[2] << "," << tcp[3] << "," << tcp[4] << "," << tcp[5];
 	//set tcp to robot
 	  //set tcp
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("movel", QStringList{ QString::number(tcp[0]),QString::number(tcp[1]),QString::number(tcp[2]),QString::number(tcp[3]),QString::number(tcp[4]),QString::number(tcp[5]) });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "11" });
-	QThread::msleep(1000);
-	m_KukaTrackingDevice->RequestExecOperate("setworkmode", { "5" });
-	return true;
+	return ApplyRobotTcp(tcp);
 }
 
 
@@ -903,12 +891,16 @@ bool SurgicalSimulate::ProbeSurface()
 	};
 
 
-	auto surfacePolyData = dynamic_cast<mitk::Surface*>(m_Controls.mitkNodeSelectWidget_surface_regis->GetSelectedNode()->GetData())->GetVtkPolyData();
-	vtkNew<vtkImplicitPolyDataDistance> implicitPolyDataDistance;
-
-	implicitPolyDataDistance->SetInput(surfacePolyData);
+	auto surface = dynamic_cast<mitk::Surface*>(m_Controls.mitkNodeSelectWidget_surface_regis->GetSelectedNode()->GetData());
+	// the distance query is built once and cached on the surface
+	auto distanceCache = mitk::SurfaceDistanceCache::GetOrCreate(surface);
+	if (distanceCache.IsNull())
+	{
+		m_Controls.textBrowser->append("The selected surface has no polygons");
+		return false;
+	}
 
-	double currentError = implicitPolyDataDistance->EvaluateFunction(probeTipInImage);
+	double currentError = distanceCache->EvaluateSignedDistance(probeTipInImage);
 
 	// double distance = sqrt(pow(probeTipInImage[0] - imageCheckPoint[0], 2) +
 	// 	pow(probeTipInImage[1] - imageCheckPoint[1], 2) +
@@ -23,6 +23,7 @@ found in the LICENSE file.
 #include<qbuttongroup.h>
 // mitk image
 #include <mitkImage.h>
+#include <landmarkSolver.h>
 #include "AimPositionAPI.h"
 #include "AimPositionDef.h"
 const std::string Zzxtest::VIEW_ID = "org.mitk.views.zzxtest";
@@ -1212,34 +1213,15 @@ void Zzxtest::landmarkRegistration()
 }
 vtkSmartPointer<vtkMatrix4x4> Zzxtest::ComputeTransformMartix(mitk::PointSet::Pointer points_set1, mitk::PointSet::Pointer points_set2)
 {
-	// Creat vtkPointset
-	vtkSmartPointer<vtkPoints> vtkPoints1 = vtkSmartPointer<vtkPoints>::New();
-	vtkSmartPointer<vtkPoints> vtkPoints2 = vtkSmartPointer<vtkPoints>::New();
-	// Convert mitk::PointSet to vtkPoints
-	for (unsigned int i = 0; i < points_set1->GetSize(); ++i)
+	// Rigid landmark transform from points_set1 to points_set2
+	mitk::LandmarkSolver::Result landmarkResult;
+	if (!mitk::LandmarkSolver::Solve(points_set1, points_set2, landmarkResult))
 	{
-		mitk::PointSet::PointType point = points_set1->GetPoint(i);
-		vtkPoints1->InsertNextPoint(point[0], point[1], point[2]);
+		m_Controls.textBrowser->append("Landmark registration failed, identity matrix used");
 	}
 
-	for (unsigned int i = 0; i < points_set2->GetSize(); ++i)
-	{
-		mitk::PointSet::PointType point = points_set2->GetPoint(i);
-		vtkPoints2->InsertNextPoint(point[0], point[1], point[2]);
-	}
-
-
-	vtkSmartPointer<vtkLandmarkTransform> tmpTrans = vtkSmartPointer<vtkLandmarkTransform>::New();
-	tmpTrans->SetModeToRigidBody();
-
-	// Set source point and target point into vtkLandmarkTransform
-	tmpTrans->SetSourceLandmarks(vtkPoints1);
-	tmpTrans->SetTargetLandmarks(vtkPoints2);
-
-	tmpTrans->Update();
-
 	vtkSmartPointer<vtkMatrix4x4> transformationMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
-	transformationMatrix->DeepCopy(tmpTrans->GetMatrix());
+	transformationMatrix->DeepCopy(landmarkResult.matrix);
 
 	return transformationMatrix;
 }
@@ -246,6 +246,9 @@ void VCView::CreateQtPartControl(QWidget *parent)
   {*/
       m_femurRightGroup = NodeBinder::New();
   /*}*/
+  // dragging a bone moves its bound nodes at most at the display refresh rate
+  m_femurLeftGroup->SetMaximumUpdateRate(60);
+  m_femurRightGroup->SetMaximumUpdateRate(60);
 //test here
       connect(m_Controls.pushButton_test, &QPushButton::clicked, this, &VCView::Test);
       connect(m_Controls.pushButton_test2, &QPushButton::clicked, this, &VCView::Test2);